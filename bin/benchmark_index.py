@@ -2,6 +2,8 @@
 DESC = """
 Compare two mgs-workflow index releases and emit per-DB size diffs, genome
 add/drop/per-species deltas, infection-status transitions, and a params diff.
+With --runtime, also time RUN's viral screen and alignment stages against both
+releases on the same synthetic reads (needs nucleaze, bowtie2 and minimap2).
 Intended to be run before promoting a new index to production so reviewers can
 spot regressions driven by upstream Virus-Host-DB or NCBI taxonomy drift.
 
@@ -12,7 +14,8 @@ Usage:
     python bin/benchmark_index.py \\
         --old s3://nao-mgs-index/20250825 \\
         --new s3://nao-mgs-index/20260518 \\
-        --out ./bench-20250825-vs-20260518/
+        --out ./bench-20250825-vs-20260518/ \\
+        [--runtime]
 """
 
 ###########
@@ -24,10 +27,13 @@ import difflib
 import gzip
 import json
 import logging
+import os
+import random
 import re
 import shutil
 import subprocess
 import tempfile
+import time
 import urllib.request
 from collections import Counter, defaultdict
 from dataclasses import dataclass
@@ -868,6 +874,310 @@ def write_params_tables(
     return old_params, new_params
 
 
+##############
+# 6. RUNTIME #
+##############
+
+# RUN stages timed against each release, with the index entry under
+# output/results/ that each one loads.
+RUNTIME_STAGES = {
+    "NUCLEAZE": "virus-genomes-masked.nucleaze.bin",
+    "BOWTIE2_VIRUS": "bt2-virus-index",
+    "MINIMAP2_VIRUS": "mm2-virus-index",
+}
+RUNTIME_METRICS = "reads_per_s", "peak_rss_mb", "index_load_s"
+# Alignment settings of RUN's viral stages (EXTRACT_VIRAL_READS_SHORT / _ONT),
+# minus pairing options since the synthetic reads are single-end.
+BT2_VIRUS_ARGS = [
+    "--local",
+    "--very-sensitive-local",
+    "--score-min",
+    "G,0.1,19",
+    "-k",
+    "10",
+]
+MM2_VIRUS_ARGS = ["-N", "10"]
+NUCLEAZE_MINHITS = "1"
+# Fraction of synthetic reads drawn from viral genomes; the rest are random
+# background, which the screen should reject.
+VIRAL_READ_FRACTION = 0.5
+# Per-base substitution rate applied to viral reads
+READ_ERROR_RATE = 0.01
+
+
+@dataclass
+class RunStats:
+    """Wall time and peak resident memory of one tool invocation."""
+
+    wall_s: float
+    peak_rss_mb: float
+
+
+def stage_entry(prefix: str, subpath: str, local_dir: Path) -> Path | None:
+    """Return a local path for an index file or directory, downloading it from
+    S3 if needed (local entries are used in place, not copied); None if the
+    release has no such entry."""
+    src = f"{prefix.rstrip('/')}/{subpath}"
+    if not src.startswith("s3://"):
+        return Path(src) if Path(src).exists() else None
+    dst = local_dir / Path(subpath).name
+    listing = subprocess.run(
+        ["aws", "s3", "ls", src], capture_output=True, text=True, check=False
+    ).stdout
+    if not listing.strip():
+        return None
+    # A "PRE <name>/" line means src is a prefix (directory), not a file
+    recursive = ["--recursive"] if f"PRE {dst.name}/" in listing else []
+    local_dir.mkdir(parents=True, exist_ok=True)
+    logger.info(f"Downloading {src} -> {dst}")
+    subprocess.run(["aws", "s3", "cp", *recursive, src, str(dst)], check=True)
+    return dst
+
+
+def synthetic_reads(
+    genomes_fasta: Path, out_path: Path, n_reads: int, read_len: int, seed: int
+) -> Path:
+    """Write a deterministic single-end FASTQ of `n_reads` reads: one window
+    from each of a reservoir sample of genomes, with READ_ERROR_RATE
+    substitutions, topped up with random background reads. Only the sampled
+    windows are held in memory."""
+    rng = random.Random(seed)
+    n_viral = int(n_reads * VIRAL_READ_FRACTION)
+    windows: list[str] = []
+    seen = 0
+
+    def offer(seq: str) -> None:
+        nonlocal seen
+        if len(seq) < read_len:
+            return
+        seen += 1
+        slot = len(windows) if len(windows) < n_viral else rng.randrange(seen)
+        if slot >= n_viral:
+            return
+        start = rng.randrange(len(seq) - read_len + 1)
+        window = seq[start : start + read_len].upper()
+        if slot == len(windows):
+            windows.append(window)
+        else:
+            windows[slot] = window
+
+    with gzip.open(genomes_fasta, "rt") as f:
+        chunks: list[str] = []
+        for line in f:
+            if line.startswith(">"):
+                offer("".join(chunks))
+                chunks = []
+            else:
+                chunks.append(line.strip())
+        offer("".join(chunks))
+    reads = [
+        "".join(
+            rng.choice("ACGT") if rng.random() < READ_ERROR_RATE else base
+            for base in window
+        )
+        for window in windows
+    ]
+    while len(reads) < n_reads:
+        reads.append("".join(rng.choices("ACGT", k=read_len)))
+    quality = "I" * read_len
+    with open(out_path, "w") as f:
+        for i, seq in enumerate(reads):
+            f.write(f"@synthetic_{i}\n{seq}\n+\n{quality}\n")
+    return out_path
+
+
+def run_timed(cmd: list[str], log_path: Path) -> RunStats:
+    """Run `cmd` with stdout discarded and stderr logged, returning its wall
+    time and peak RSS (including waited-for subprocesses, e.g. bowtie2's
+    aligner binary)."""
+    with open(log_path, "w") as log:
+        start = time.perf_counter()
+        proc = subprocess.Popen(cmd, stdout=subprocess.DEVNULL, stderr=log)
+        _, status, usage = os.wait4(proc.pid, 0)
+        wall_s = time.perf_counter() - start
+    proc.returncode = os.waitstatus_to_exitcode(status)
+    if proc.returncode != 0:
+        tail = log_path.read_text().splitlines()[-5:]
+        raise RuntimeError(
+            f"{cmd[0]} exited with {proc.returncode}: " + " | ".join(tail)
+        )
+    # ru_maxrss is in KiB on Linux
+    return RunStats(wall_s, usage.ru_maxrss / 1024)
+
+
+def stage_command(
+    stage: str, index: Path, reads: Path, threads: int, index_params: dict
+) -> list[str]:
+    """Command line for one RUN stage against a staged index, discarding
+    outputs so only screening/alignment work is timed."""
+    if stage == "NUCLEAZE":
+        return [
+            "nucleaze",
+            "--in",
+            str(reads),
+            "--outm",
+            "/dev/null",
+            "--outu",
+            "/dev/null",
+            "--binref",
+            str(index),
+            "--k",
+            str(index_params.get("nucleaze_k", 24)),
+            "--minhits",
+            NUCLEAZE_MINHITS,
+            "--canonical",
+            "--threads",
+            str(threads),
+        ]
+    if stage == "BOWTIE2_VIRUS":
+        return [
+            "bowtie2",
+            "--threads",
+            str(threads),
+            "--mm",
+            *BT2_VIRUS_ARGS,
+            "-x",
+            str(index / "bt2_index"),
+            "-U",
+            str(reads),
+            "-S",
+            "/dev/null",
+        ]
+    if stage == "MINIMAP2_VIRUS":
+        return [
+            "minimap2",
+            "-a",
+            *MM2_VIRUS_ARGS,
+            "-t",
+            str(threads),
+            "-o",
+            "/dev/null",
+            str(index / "mm2_index.mmi"),
+            str(reads),
+        ]
+    raise ValueError(f"Unknown runtime stage: {stage}")
+
+
+def measure_stage(
+    stage: str,
+    index: Path,
+    reads: Path,
+    one_read: Path,
+    n_reads: int,
+    threads: int,
+    index_params: dict,
+    log_dir: Path,
+) -> dict[str, float]:
+    """Time one stage: a single-read run approximates index load time, which
+    is subtracted from the full run's wall time to get throughput."""
+    load = run_timed(
+        stage_command(stage, index, one_read, threads, index_params),
+        log_dir / f"{stage}.load.log",
+    )
+    full = run_timed(
+        stage_command(stage, index, reads, threads, index_params),
+        log_dir / f"{stage}.log",
+    )
+    work_s = max(full.wall_s - load.wall_s, 1e-3)
+    return {
+        "reads_per_s": round(n_reads / work_s, 1),
+        "peak_rss_mb": round(max(load.peak_rss_mb, full.peak_rss_mb), 1),
+        "index_load_s": round(load.wall_s, 3),
+    }
+
+
+def compare_runtime(
+    old: dict[str, dict[str, float]],
+    new: dict[str, dict[str, float]],
+    tolerance_pct: float,
+) -> tuple[pd.DataFrame, list[str]]:
+    """Long-format runtime comparison (columns: stage, metric, old, new, delta,
+    pct_change) plus the stages whose throughput dropped by more than
+    `tolerance_pct` percent."""
+    rows = [
+        (stage, metric, old[stage][metric], new[stage][metric])
+        for stage in RUNTIME_STAGES
+        if stage in old and stage in new
+        for metric in RUNTIME_METRICS
+    ]
+    out = pd.DataFrame(rows, columns=["stage", "metric", "old", "new"])
+    out["delta"] = out["new"] - out["old"]
+    out["pct_change"] = (out["delta"] / out["old"] * 100).round(2)
+    out.loc[out["old"].eq(0), "pct_change"] = float("nan")
+    throughput = out[out["metric"] == "reads_per_s"]
+    regressions = sorted(
+        throughput.loc[throughput["pct_change"] < -tolerance_pct, "stage"]
+    )
+    return out, regressions
+
+
+def write_runtime_tables(
+    out_dir: Path,
+    old_prefix: str,
+    new_prefix: str,
+    old_params: dict,
+    new_params: dict,
+    args: argparse.Namespace,
+    work_dir: Path,
+) -> None:
+    """Time each RUN stage against both releases on the same synthetic reads
+    and write runtime.tsv plus a runtime_summary.json of throughput
+    regressions. Stages whose index is missing from either release are
+    skipped."""
+    logger.info(f"Timing {', '.join(RUNTIME_STAGES)} on {args.runtime_reads} reads.")
+    genomes = fetch(
+        old_prefix, "output/results/virus-genomes-masked.fasta.gz", work_dir / "old"
+    )
+    reads = synthetic_reads(
+        genomes, work_dir / "reads.fastq", args.runtime_reads, args.read_length, 0
+    )
+    one_read = work_dir / "one_read.fastq"
+    with open(reads) as f:
+        one_read.write_text("".join(next(f) for _ in range(4)))
+    results: dict[str, dict[str, dict[str, float]]] = {"old": {}, "new": {}}
+    releases = ("old", old_prefix, old_params), ("new", new_prefix, new_params)
+    for label, prefix, index_params in releases:
+        log_dir = out_dir / "runtime_logs" / label
+        log_dir.mkdir(parents=True, exist_ok=True)
+        for stage, entry in RUNTIME_STAGES.items():
+            index = stage_entry(
+                prefix, f"output/results/{entry}", work_dir / label / "idx"
+            )
+            if index is None:
+                logger.warning(f"Skipping {stage} for {label}: no {entry}.")
+                continue
+            results[label][stage] = measure_stage(
+                stage,
+                index,
+                reads,
+                one_read,
+                args.runtime_reads,
+                args.threads,
+                index_params,
+                log_dir,
+            )
+            # Free staging space before the next (possibly large) index
+            if prefix.startswith("s3://"):
+                if index.is_dir():
+                    shutil.rmtree(index)
+                else:
+                    index.unlink()
+    runtime, regressions = compare_runtime(
+        results["old"], results["new"], args.runtime_tolerance
+    )
+    runtime.to_csv(out_dir / "runtime.tsv", sep="\t", index=False)
+    _write_json(
+        out_dir / "runtime_summary.json",
+        {
+            "n_reads": args.runtime_reads,
+            "read_length": args.read_length,
+            "threads": args.threads,
+            "tolerance_pct": args.runtime_tolerance,
+            "throughput_regressions": regressions,
+        },
+    )
+
+
 ########
 # MAIN #
 ########
@@ -894,6 +1204,35 @@ def parse_arguments() -> argparse.Namespace:
         required=True,
         help="Output directory for benchmark tables and summaries.",
     )
+    parser.add_argument(
+        "--runtime",
+        action="store_true",
+        help="Also time NUCLEAZE, BOWTIE2_VIRUS and MINIMAP2_VIRUS on both indexes.",
+    )
+    parser.add_argument(
+        "--runtime-reads",
+        type=int,
+        default=200_000,
+        help="Number of synthetic reads for --runtime (default: 200000).",
+    )
+    parser.add_argument(
+        "--read-length",
+        type=int,
+        default=150,
+        help="Synthetic read length for --runtime (default: 150).",
+    )
+    parser.add_argument(
+        "--threads",
+        type=int,
+        default=os.cpu_count() or 1,
+        help="Threads per tool for --runtime (default: all CPUs).",
+    )
+    parser.add_argument(
+        "--runtime-tolerance",
+        type=float,
+        default=10.0,
+        help="Throughput drop (%%) reported as a regression (default: 10).",
+    )
     return parser.parse_args()
 
 
@@ -924,6 +1263,16 @@ def main() -> None:
         )
         write_infection_status_tables(args.out, old_db, new_db, coverage)
         write_staleness_table(new_params, args.out / "staleness.tsv")
+        if args.runtime:
+            write_runtime_tables(
+                args.out,
+                args.old,
+                args.new,
+                old_params,
+                new_params,
+                args,
+                work_dir,
+            )
     logger.info(f"Done. Outputs in {args.out.resolve()}")
 
 
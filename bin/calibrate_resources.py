@@ -0,0 +1,350 @@
+#!/usr/bin/env python3
+"""Fit input-size scaling coefficients for resource tiers from Nextflow traces.
+
+Reads one or more Nextflow trace files (as written by configs/logging.config),
+pairs each completed task of the selected processes with its total staged input
+size, and fits peak RSS as a linear function of input bytes by least squares.
+It then suggests input-size thresholds for a list of memory tiers, keeping the
+requested headroom between predicted peak RSS and the allocation, in the format
+used by the input-size-aware labels in configs/resources.config.
+
+Input size is taken from the staged-input symlinks in each task's local work
+directory (`--size-source workdir`, the default) or, when work directories are
+no longer available (e.g. S3 work dirs), approximated by the trace `rchar`
+column (`--size-source rchar`).
+"""
+
+###########
+# IMPORTS #
+###########
+
+import argparse
+import csv
+import logging
+import os
+import re
+import sys
+from dataclasses import dataclass
+from datetime import UTC, datetime
+from pathlib import Path
+
+###########
+# LOGGING #
+###########
+
+
+class UTCFormatter(logging.Formatter):
+    """Custom logging formatter that displays timestamps in UTC."""
+
+    def formatTime(self, record: logging.LogRecord, datefmt: str | None = None) -> str:
+        """Format log timestamps in UTC timezone.
+        Args:
+            record: The log record to format.
+            datefmt: Optional date format string (unused).
+        Returns:
+            Formatted timestamp string in UTC.
+        """
+        dt = datetime.fromtimestamp(record.created, UTC)
+        return dt.strftime("%Y-%m-%d %H:%M:%S UTC")
+
+
+logger = logging.getLogger()
+logger.setLevel(logging.INFO)
+handler = logging.StreamHandler()
+formatter = UTCFormatter("[%(asctime)s] %(message)s")
+handler.setFormatter(formatter)
+logger.handlers.clear()
+logger.addHandler(handler)
+
+###########
+# CLASSES #
+###########
+
+
+@dataclass
+class TaskSample:
+    """One completed task: its process, input size and peak RSS (bytes)."""
+
+    process: str
+    input_bytes: int
+    peak_rss_bytes: int
+
+
+@dataclass
+class ScalingFit:
+    """Least-squares fit of peak RSS against input size for one process."""
+
+    process: str
+    n_tasks: int
+    intercept_bytes: float
+    slope: float
+    r_squared: float
+    max_input_bytes: int
+    max_peak_rss_bytes: int
+
+
+###########
+# HELPERS #
+###########
+
+_UNITS = {"B": 1, "KB": 1024, "MB": 1024**2, "GB": 1024**3, "TB": 1024**4}
+_SIZE_PATTERN = re.compile(r"^\s*([0-9]*\.?[0-9]+)\s*([KMGT]?B)?\s*$", re.IGNORECASE)
+
+
+def parse_size(value: str | None) -> int | None:
+    """Parse a Nextflow trace memory value (e.g. '1.5 GB', '512 MB', '1024').
+    Args:
+        value: Trace field value; raw byte counts and '-' are also accepted.
+    Returns:
+        Size in bytes, or None if the value is missing.
+    """
+    if value is None or value.strip() in ("", "-"):
+        return None
+    match = _SIZE_PATTERN.match(value)
+    if not match:
+        raise ValueError(f"Unparseable size value: {value!r}")
+    number, unit = match.groups()
+    return int(float(number) * _UNITS[(unit or "B").upper()])
+
+
+def format_size(n_bytes: float) -> str:
+    """Format a byte count in the 'N.N GB' style used by resources.config.
+    Args:
+        n_bytes: Byte count.
+    Returns:
+        Human-readable size string in GB.
+    """
+    return f"{n_bytes / 1024**3:.1f} GB"
+
+
+def staged_input_bytes(workdir: Path) -> int | None:
+    """Sum the sizes of the files staged into a task work directory.
+    Nextflow stages inputs as symlinks to upstream outputs. Links pointing back
+    into the same work directory (the `input_*` test links emitted by modules)
+    are skipped so inputs are not double-counted.
+    Args:
+        workdir: Local task work directory.
+    Returns:
+        Total staged input size in bytes, or None if the directory is missing.
+    """
+    if not workdir.is_dir():
+        return None
+    total = 0
+    local = workdir.resolve()
+    for entry in workdir.iterdir():
+        if not entry.is_symlink():
+            continue
+        link = Path(os.readlink(entry))
+        if not link.is_absolute():
+            link = local / link
+        if link.parent.resolve() == local:
+            continue
+        target = Path(os.path.realpath(entry))
+        if not target.exists():
+            continue
+        if target.is_dir():
+            total += sum(f.stat().st_size for f in target.rglob("*") if f.is_file())
+        else:
+            total += target.stat().st_size
+    return total
+
+
+def read_trace_samples(
+    trace_paths: list[str], processes: set[str] | None, size_source: str
+) -> list[TaskSample]:
+    """Collect (input size, peak RSS) samples for completed tasks.
+    Args:
+        trace_paths: Paths to Nextflow trace TSV files.
+        processes: Simple process names to keep (None keeps all).
+        size_source: 'workdir' or 'rchar'.
+    Returns:
+        List of task samples with known input size and peak RSS.
+    """
+    samples = []
+    for trace_path in trace_paths:
+        with open(trace_path, newline="") as f:
+            reader = csv.DictReader(f, delimiter="\t")
+            for row in reader:
+                if row.get("status") not in ("COMPLETED", "CACHED"):
+                    continue
+                # Trace process names are fully qualified (RUN:...:MODULE)
+                process = row["process"].split(":")[-1]
+                if processes is not None and process not in processes:
+                    continue
+                peak_rss = parse_size(row.get("peak_rss", "-"))
+                if size_source == "rchar":
+                    input_bytes = parse_size(row.get("rchar", "-"))
+                else:
+                    input_bytes = staged_input_bytes(Path(row.get("workdir", "")))
+                if peak_rss is None or input_bytes is None:
+                    continue
+                samples.append(TaskSample(process, input_bytes, peak_rss))
+    return samples
+
+
+def fit_scaling(process: str, samples: list[TaskSample]) -> ScalingFit:
+    """Fit peak_rss = intercept + slope * input_bytes by least squares.
+    Args:
+        process: Process name the samples belong to.
+        samples: Task samples for that process (at least one).
+    Returns:
+        Fitted scaling coefficients.
+    """
+    n = len(samples)
+    xs = [float(s.input_bytes) for s in samples]
+    ys = [float(s.peak_rss_bytes) for s in samples]
+    mean_x = sum(xs) / n
+    mean_y = sum(ys) / n
+    sxx = sum((x - mean_x) ** 2 for x in xs)
+    sxy = sum((x - mean_x) * (y - mean_y) for x, y in zip(xs, ys, strict=True))
+    syy = sum((y - mean_y) ** 2 for y in ys)
+    slope = sxy / sxx if sxx > 0 else 0.0
+    intercept = mean_y - slope * mean_x
+    r_squared = (sxy * sxy) / (sxx * syy) if sxx > 0 and syy > 0 else 0.0
+    return ScalingFit(
+        process=process,
+        n_tasks=n,
+        intercept_bytes=intercept,
+        slope=slope,
+        r_squared=r_squared,
+        max_input_bytes=max(s.input_bytes for s in samples),
+        max_peak_rss_bytes=max(s.peak_rss_bytes for s in samples),
+    )
+
+
+def suggest_thresholds(
+    fit: ScalingFit, memories_bytes: list[int], headroom: float
+) -> list[float | None]:
+    """Suggest input-size thresholds for all but the top memory tier.
+    A tier with memory M can take inputs up to the size whose predicted peak
+    RSS is M / headroom.
+    Args:
+        fit: Fitted scaling coefficients.
+        memories_bytes: Tier memory allocations in ascending order.
+        headroom: Required ratio of allocation to predicted peak RSS.
+    Returns:
+        One threshold (bytes) per tier boundary; None where the fit has no
+        positive slope or the tier cannot hold even an empty input.
+    """
+    thresholds: list[float | None] = []
+    for memory in memories_bytes[:-1]:
+        budget = memory / headroom - fit.intercept_bytes
+        if fit.slope <= 0 or budget <= 0:
+            thresholds.append(None)
+        else:
+            thresholds.append(budget / fit.slope)
+    return thresholds
+
+
+def write_report(
+    fits: list[ScalingFit], memories: list[str], headroom: float, out: str | None
+) -> None:
+    """Write one TSV row per process with its fit and suggested thresholds.
+    Args:
+        fits: Per-process fits.
+        memories: Tier memory strings (e.g. ['32 GB', '64 GB', '128 GB']).
+        headroom: Required ratio of allocation to predicted peak RSS.
+        out: Output path, or None for stdout.
+    """
+    memories_bytes = [parse_size(m) or 0 for m in memories]
+    handle = open(out, "w", newline="") if out else sys.stdout
+    try:
+        writer = csv.writer(handle, delimiter="\t", lineterminator="\n")
+        writer.writerow(
+            [
+                "process",
+                "n_tasks",
+                "intercept_gb",
+                "rss_gb_per_input_gb",
+                "r_squared",
+                "max_input_gb",
+                "max_peak_rss_gb",
+                "suggested_thresholds",
+            ]
+        )
+        for fit in fits:
+            thresholds = suggest_thresholds(fit, memories_bytes, headroom)
+            writer.writerow(
+                [
+                    fit.process,
+                    fit.n_tasks,
+                    f"{fit.intercept_bytes / 1024**3:.3f}",
+                    f"{fit.slope:.3f}",
+                    f"{fit.r_squared:.3f}",
+                    f"{fit.max_input_bytes / 1024**3:.3f}",
+                    f"{fit.max_peak_rss_bytes / 1024**3:.3f}",
+                    ",".join("NA" if t is None else format_size(t) for t in thresholds),
+                ]
+            )
+    finally:
+        if out:
+            handle.close()
+
+
+##############
+# MAIN LOGIC #
+##############
+
+
+def parse_arguments() -> argparse.Namespace:
+    """Parse command-line arguments.
+    Returns:
+        Parsed arguments namespace.
+    """
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("traces", nargs="+", help="Nextflow trace TSV file(s).")
+    parser.add_argument(
+        "-p",
+        "--process",
+        action="append",
+        help="Simple process name to calibrate (repeatable; default: all).",
+    )
+    parser.add_argument(
+        "-m",
+        "--memories",
+        default="32 GB,64 GB,128 GB",
+        help="Comma-separated tier memories, ascending (default: %(default)s).",
+    )
+    parser.add_argument(
+        "--headroom",
+        type=float,
+        default=1.5,
+        help="Allocation / predicted peak RSS ratio to keep (default: %(default)s).",
+    )
+    parser.add_argument(
+        "--size-source",
+        choices=["workdir", "rchar"],
+        default="workdir",
+        help="How to measure task input size (default: %(default)s).",
+    )
+    parser.add_argument(
+        "--min-tasks",
+        type=int,
+        default=3,
+        help="Skip processes with fewer usable tasks (default: %(default)s).",
+    )
+    parser.add_argument("-o", "--output", help="Output TSV (default: stdout).")
+    return parser.parse_args()
+
+
+def main() -> None:
+    """Fit per-process scaling coefficients and print tier suggestions."""
+    args = parse_arguments()
+    processes = set(args.process) if args.process else None
+    samples = read_trace_samples(args.traces, processes, args.size_source)
+    logger.info(f"Read {len(samples)} usable task records.")
+    by_process: dict[str, list[TaskSample]] = {}
+    for sample in samples:
+        by_process.setdefault(sample.process, []).append(sample)
+    fits = []
+    for process, process_samples in sorted(by_process.items()):
+        if len(process_samples) < args.min_tasks:
+            logger.info(f"Skipping {process}: only {len(process_samples)} tasks.")
+            continue
+        fits.append(fit_scaling(process, process_samples))
+    memories = [m.strip() for m in args.memories.split(",")]
+    write_report(fits, memories, args.headroom, args.output)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,241 @@
+#!/usr/bin/env python3
+"""Gather per-tool metrics files from a run's tasks into one table.
+
+With `task_metrics = true`, instrumented tools (the nao_io-based Python scripts
+and the Rust tools using the task_metrics crate) write `<tool>.metrics.json`
+into their task directory: lines and bytes read and written (on disk and
+uncompressed), wall and CPU time per phase, and peak RSS. This script reads a
+RUN or DOWNSTREAM Nextflow trace, finds the metrics files in each completed
+task's work directory, and writes one TSV row per tool with its totals and one
+per phase, alongside the task's own trace timings for comparison.
+"""
+
+###########
+# IMPORTS #
+###########
+
+import argparse
+import csv
+import json
+import logging
+import sys
+from collections.abc import Iterator
+from dataclasses import dataclass
+from datetime import UTC, datetime
+from pathlib import Path
+from typing import Any
+
+from compare_ribo_split import parse_duration
+
+###########
+# LOGGING #
+###########
+
+
+class UTCFormatter(logging.Formatter):
+    """Custom logging formatter that displays timestamps in UTC."""
+
+    def formatTime(self, record: logging.LogRecord, datefmt: str | None = None) -> str:
+        """Format log timestamps in UTC timezone.
+        Args:
+            record: The log record to format.
+            datefmt: Optional date format string (unused).
+        Returns:
+            Formatted timestamp string in UTC.
+        """
+        dt = datetime.fromtimestamp(record.created, UTC)
+        return dt.strftime("%Y-%m-%d %H:%M:%S UTC")
+
+
+logger = logging.getLogger()
+logger.setLevel(logging.INFO)
+handler = logging.StreamHandler()
+formatter = UTCFormatter("[%(asctime)s] %(message)s")
+handler.setFormatter(formatter)
+logger.handlers.clear()
+logger.addHandler(handler)
+
+#############
+# CONSTANTS #
+#############
+
+METRICS_GLOB = "*.metrics.json"
+COUNTER_FIELDS = [
+    "rows_in",
+    "rows_out",
+    "bytes_read",
+    "bytes_read_uncompressed",
+    "bytes_written",
+    "bytes_written_uncompressed",
+    "peak_rss_bytes",
+]
+OUTPUT_FIELDS = [
+    "process",
+    "tag",
+    "hash",
+    "tool",
+    "phase",
+    "wall_s",
+    "cpu_s",
+    *COUNTER_FIELDS,
+    "task_realtime_s",
+    "task_peak_rss",
+]
+
+###########
+# CLASSES #
+###########
+
+
+@dataclass
+class Task:
+    """A completed task from the trace."""
+
+    process: str
+    tag: str
+    hash: str
+    workdir: str
+    realtime_s: float | None
+    peak_rss: str
+
+
+###########
+# HELPERS #
+###########
+
+
+def read_tasks(trace_path: str) -> list[Task]:
+    """Read completed and cached tasks from a Nextflow trace.
+    Args:
+        trace_path: Nextflow trace TSV path.
+    Returns:
+        Tasks in trace order.
+    """
+    tasks = []
+    with open(trace_path, newline="") as f:
+        for row in csv.DictReader(f, delimiter="\t"):
+            if row.get("status") not in ("COMPLETED", "CACHED"):
+                continue
+            tasks.append(
+                Task(
+                    process=row["process"],
+                    tag=row.get("tag", ""),
+                    hash=row.get("hash", ""),
+                    workdir=row["workdir"],
+                    realtime_s=parse_duration(row.get("realtime")),
+                    peak_rss=row.get("peak_rss", ""),
+                )
+            )
+    return tasks
+
+
+def load_metrics(workdir: Path) -> list[dict[str, Any]]:
+    """Load the metrics files in a task work directory.
+    Args:
+        workdir: Task work directory.
+    Returns:
+        Parsed metrics, sorted by tool name.
+    """
+    metrics = [json.loads(p.read_text()) for p in workdir.glob(METRICS_GLOB)]
+    return sorted(metrics, key=lambda m: m["tool"])
+
+
+def metrics_rows(task: Task, metrics: dict[str, Any]) -> Iterator[dict[str, Any]]:
+    """Table rows for one tool's metrics: a 'total' row, then one per phase.
+    Args:
+        task: The task that ran the tool.
+        metrics: Parsed metrics file.
+    Yields:
+        Output rows keyed by OUTPUT_FIELDS (missing values are 'NA').
+    """
+    base = {
+        "process": task.process,
+        "tag": task.tag,
+        "hash": task.hash,
+        "tool": metrics["tool"],
+    }
+    task_fields = {
+        "task_realtime_s": "NA" if task.realtime_s is None else task.realtime_s,
+        "task_peak_rss": task.peak_rss or "NA",
+    }
+    counters = {
+        field: "NA" if metrics.get(field) is None else metrics[field]
+        for field in COUNTER_FIELDS
+    }
+    yield {
+        **base,
+        "phase": "total",
+        "wall_s": metrics["wall_s"],
+        "cpu_s": metrics["cpu_s"],
+        **counters,
+        **task_fields,
+    }
+    for phase, timings in metrics.get("phases", {}).items():
+        yield {
+            **base,
+            "phase": phase,
+            "wall_s": timings["wall_s"],
+            "cpu_s": timings["cpu_s"],
+            **dict.fromkeys(COUNTER_FIELDS, "NA"),
+            **task_fields,
+        }
+
+
+def collect(trace_paths: list[str]) -> Iterator[dict[str, Any]]:
+    """Rows for every metrics file of every completed task in the traces.
+    Args:
+        trace_paths: Nextflow trace TSV paths.
+    Yields:
+        Output rows.
+    """
+    n_tasks = n_files = n_remote = 0
+    for trace_path in trace_paths:
+        for task in read_tasks(trace_path):
+            n_tasks += 1
+            if "://" in task.workdir:
+                n_remote += 1
+                continue
+            for metrics in load_metrics(Path(task.workdir)):
+                n_files += 1
+                yield from metrics_rows(task, metrics)
+    logger.info(f"Found {n_files} metrics files across {n_tasks} tasks.")
+    if n_remote:
+        logger.warning(
+            f"Skipped {n_remote} tasks with remote work directories; "
+            "sync them locally and point the trace's workdir column at the copies."
+        )
+
+
+##############
+# MAIN LOGIC #
+##############
+
+
+def parse_arguments() -> argparse.Namespace:
+    """Parse command-line arguments.
+    Returns:
+        Parsed arguments namespace.
+    """
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("traces", nargs="+", help="Trace TSV(s) of the run.")
+    parser.add_argument("-o", "--output", help="Output TSV (default: stdout).")
+    return parser.parse_args()
+
+
+def main() -> None:
+    """Write the per-run metrics table."""
+    args = parse_arguments()
+    handle = open(args.output, "w", newline="") if args.output else sys.stdout
+    try:
+        writer = csv.DictWriter(
+            handle, fieldnames=OUTPUT_FIELDS, delimiter="\t", lineterminator="\n"
+        )
+        writer.writeheader()
+        writer.writerows(collect(args.traces))
+    finally:
+        if args.output:
+            handle.close()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,279 @@
+#!/usr/bin/env python3
+"""Compare PROFILE's BBDuk and Nucleaze ribosomal splits on the same reads.
+
+Takes the Nextflow trace files of two RUN workflows over the same samples, one
+with the default BBDuk ribosomal split and one with `nucleaze_ribo = true`. For
+each sample it locates the BBDUK and NUCLEAZE_STREAMED task work directories,
+reads their match/nomatch FASTQs, and reports per-sample concordance of the
+ribosomal/non-ribosomal assignment (by read ID) alongside each tool's
+throughput in reads per second of task wall time.
+"""
+
+###########
+# IMPORTS #
+###########
+
+import argparse
+import csv
+import gzip
+import logging
+import re
+import sys
+from dataclasses import dataclass
+from datetime import UTC, datetime
+from pathlib import Path
+
+###########
+# LOGGING #
+###########
+
+
+class UTCFormatter(logging.Formatter):
+    """Custom logging formatter that displays timestamps in UTC."""
+
+    def formatTime(self, record: logging.LogRecord, datefmt: str | None = None) -> str:
+        """Format log timestamps in UTC timezone.
+        Args:
+            record: The log record to format.
+            datefmt: Optional date format string (unused).
+        Returns:
+            Formatted timestamp string in UTC.
+        """
+        dt = datetime.fromtimestamp(record.created, UTC)
+        return dt.strftime("%Y-%m-%d %H:%M:%S UTC")
+
+
+logger = logging.getLogger()
+logger.setLevel(logging.INFO)
+handler = logging.StreamHandler()
+formatter = UTCFormatter("[%(asctime)s] %(message)s")
+handler.setFormatter(formatter)
+logger.handlers.clear()
+logger.addHandler(handler)
+
+###########
+# CLASSES #
+###########
+
+
+@dataclass
+class SplitTask:
+    """One ribosomal-split task: its work directory and wall time (seconds)."""
+
+    workdir: Path
+    realtime_s: float | None
+
+
+@dataclass
+class SplitComparison:
+    """Per-read agreement between two ribosomal splits of the same reads."""
+
+    n_reads: int
+    both_ribo: int
+    bbduk_only: int
+    nucleaze_only: int
+    neither: int
+
+    @property
+    def concordance(self) -> float:
+        """Fraction of reads assigned the same ribosomal status by both tools."""
+        if self.n_reads == 0:
+            return 1.0
+        return (self.both_ribo + self.neither) / self.n_reads
+
+
+###########
+# HELPERS #
+###########
+
+_DURATION_UNITS = {"d": 86400.0, "h": 3600.0, "m": 60.0, "s": 1.0, "ms": 0.001}
+_DURATION_PART = re.compile(r"([0-9]*\.?[0-9]+)(ms|d|h|m|s)")
+
+
+def parse_duration(value: str | None) -> float | None:
+    """Parse a Nextflow trace duration (e.g. '1h 2m 3s', '850ms').
+    Args:
+        value: Trace field value; '-' and empty values are treated as missing.
+    Returns:
+        Duration in seconds, or None if the value is missing.
+    """
+    if value is None or value.strip() in ("", "-"):
+        return None
+    parts = _DURATION_PART.findall(value.replace(" ", ""))
+    if not parts:
+        raise ValueError(f"Unparseable duration value: {value!r}")
+    return sum(float(number) * _DURATION_UNITS[unit] for number, unit in parts)
+
+
+def read_ids(path: Path) -> list[str]:
+    """Read record IDs from a (gzipped) FASTQ, one per record.
+    Args:
+        path: FASTQ path.
+    Returns:
+        Read IDs (header up to the first whitespace, without '@' or /1, /2).
+    """
+    opener = gzip.open if path.suffix == ".gz" else open
+    ids = []
+    with opener(path, "rt") as f:
+        for i, line in enumerate(f):
+            if i % 4 == 0 and line.strip():
+                read_id = line[1:].split(maxsplit=1)[0]
+                ids.append(re.sub(r"/[12]$", "", read_id))
+    return ids
+
+
+def find_split_tasks(trace_path: str, process: str) -> dict[str, SplitTask]:
+    """Find completed tasks of one process in a trace, keyed by sample.
+    Args:
+        trace_path: Nextflow trace TSV path.
+        process: Simple process name (e.g. 'BBDUK').
+    Returns:
+        Mapping from sample (from the `id=` tag) to its task.
+    """
+    tasks = {}
+    with open(trace_path, newline="") as f:
+        for row in csv.DictReader(f, delimiter="\t"):
+            if row.get("status") not in ("COMPLETED", "CACHED"):
+                continue
+            qualified = row["process"].split(":")
+            # Only the ribosomal split inside PROFILE, not other uses of the module
+            if qualified[-1] != process or "PROFILE" not in qualified:
+                continue
+            match = re.match(r"id=([^,]+)", row.get("tag", ""))
+            if not match:
+                continue
+            tasks[match.group(1)] = SplitTask(
+                Path(row["workdir"]), parse_duration(row.get("realtime"))
+            )
+    return tasks
+
+
+def split_outputs(workdir: Path) -> tuple[Path, Path]:
+    """Locate the match and nomatch FASTQs in a split task's work directory.
+    Args:
+        workdir: Task work directory.
+    Returns:
+        Paths to the match and nomatch FASTQs.
+    """
+    match = sorted(workdir.glob("*_match.fastq.gz"))
+    nomatch = sorted(workdir.glob("*_nomatch.fastq.gz"))
+    if len(match) != 1 or len(nomatch) != 1:
+        raise FileNotFoundError(
+            f"Expected one match and one nomatch FASTQ in {workdir}"
+        )
+    return match[0], nomatch[0]
+
+
+def compare_splits(
+    bbduk_match: list[str],
+    bbduk_nomatch: list[str],
+    nucleaze_match: list[str],
+    nucleaze_nomatch: list[str],
+) -> SplitComparison:
+    """Compare two splits of the same reads by read ID.
+    Args:
+        bbduk_match: IDs BBDuk assigned as ribosomal.
+        bbduk_nomatch: IDs BBDuk assigned as non-ribosomal.
+        nucleaze_match: IDs Nucleaze assigned as ribosomal.
+        nucleaze_nomatch: IDs Nucleaze assigned as non-ribosomal.
+    Returns:
+        Per-read agreement counts.
+    """
+    bbduk_ribo = set(bbduk_match)
+    nucleaze_ribo = set(nucleaze_match)
+    bbduk_all = bbduk_ribo | set(bbduk_nomatch)
+    nucleaze_all = nucleaze_ribo | set(nucleaze_nomatch)
+    if bbduk_all != nucleaze_all:
+        raise ValueError(
+            f"Splits cover different reads ({len(bbduk_all ^ nucleaze_all)} differ); "
+            "were both runs given the same input?"
+        )
+    return SplitComparison(
+        n_reads=len(bbduk_all),
+        both_ribo=len(bbduk_ribo & nucleaze_ribo),
+        bbduk_only=len(bbduk_ribo - nucleaze_ribo),
+        nucleaze_only=len(nucleaze_ribo - bbduk_ribo),
+        neither=len(bbduk_all - bbduk_ribo - nucleaze_ribo),
+    )
+
+
+def reads_per_second(n_records: int, task: SplitTask) -> str:
+    """Format a task's throughput for the report.
+    Args:
+        n_records: FASTQ records processed by the task.
+        task: The split task.
+    Returns:
+        Reads per second of wall time, or 'NA' if the wall time is unknown.
+    """
+    if not task.realtime_s:
+        return "NA"
+    return f"{n_records / task.realtime_s:.1f}"
+
+
+##############
+# MAIN LOGIC #
+##############
+
+
+def parse_arguments() -> argparse.Namespace:
+    """Parse command-line arguments.
+    Returns:
+        Parsed arguments namespace.
+    """
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("bbduk_trace", help="Trace TSV of the BBDuk-split RUN.")
+    parser.add_argument("nucleaze_trace", help="Trace TSV of the Nucleaze-split RUN.")
+    parser.add_argument("-o", "--output", help="Output TSV (default: stdout).")
+    return parser.parse_args()
+
+
+def main() -> None:
+    """Write per-sample concordance and throughput of the two splits."""
+    args = parse_arguments()
+    bbduk_tasks = find_split_tasks(args.bbduk_trace, "BBDUK")
+    nucleaze_tasks = find_split_tasks(args.nucleaze_trace, "NUCLEAZE_STREAMED")
+    samples = sorted(bbduk_tasks.keys() & nucleaze_tasks.keys())
+    logger.info(f"Comparing ribosomal splits for {len(samples)} samples.")
+    handle = open(args.output, "w", newline="") if args.output else sys.stdout
+    try:
+        writer = csv.writer(handle, delimiter="\t", lineterminator="\n")
+        writer.writerow(
+            [
+                "sample",
+                "n_reads",
+                "both_ribo",
+                "bbduk_only",
+                "nucleaze_only",
+                "neither",
+                "concordance",
+                "bbduk_reads_per_s",
+                "nucleaze_reads_per_s",
+            ]
+        )
+        for sample in samples:
+            bbduk_outputs = split_outputs(bbduk_tasks[sample].workdir)
+            nucleaze_outputs = split_outputs(nucleaze_tasks[sample].workdir)
+            bbduk_m, bbduk_u = (read_ids(p) for p in bbduk_outputs)
+            nuc_m, nuc_u = (read_ids(p) for p in nucleaze_outputs)
+            comparison = compare_splits(bbduk_m, bbduk_u, nuc_m, nuc_u)
+            n_records = len(bbduk_m) + len(bbduk_u)
+            writer.writerow(
+                [
+                    sample,
+                    comparison.n_reads,
+                    comparison.both_ribo,
+                    comparison.bbduk_only,
+                    comparison.nucleaze_only,
+                    comparison.neither,
+                    f"{comparison.concordance:.4f}",
+                    reads_per_second(n_records, bbduk_tasks[sample]),
+                    reads_per_second(n_records, nucleaze_tasks[sample]),
+                ]
+            )
+    finally:
+        if args.output:
+            handle.close()
+
+
+if __name__ == "__main__":
+    main()
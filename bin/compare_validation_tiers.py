@@ -0,0 +1,221 @@
+#!/usr/bin/env python3
+"""Compare DOWNSTREAM validation with and without minimap2 tiering.
+
+Takes the validation hits TSVs of two DOWNSTREAM runs over the same groups,
+one BLAST-only and one with `tiered_validation = true`, and reports for each
+validation column the fraction of reads (and of cluster representatives) given
+the same value by both runs. If the tiered run's triage decision TSVs are
+given, also reports how many representatives each decision covered, i.e. the
+fraction of BLAST work the tiering saved.
+"""
+
+###########
+# IMPORTS #
+###########
+
+import argparse
+import csv
+import gzip
+import logging
+import sys
+from collections import Counter
+from dataclasses import dataclass
+from datetime import UTC, datetime
+from pathlib import Path
+
+###########
+# LOGGING #
+###########
+
+
+class UTCFormatter(logging.Formatter):
+    """Custom logging formatter that displays timestamps in UTC."""
+
+    def formatTime(self, record: logging.LogRecord, datefmt: str | None = None) -> str:
+        """Format log timestamps in UTC timezone.
+        Args:
+            record: The log record to format.
+            datefmt: Optional date format string (unused).
+        Returns:
+            Formatted timestamp string in UTC.
+        """
+        dt = datetime.fromtimestamp(record.created, UTC)
+        return dt.strftime("%Y-%m-%d %H:%M:%S UTC")
+
+
+logger = logging.getLogger()
+logger.setLevel(logging.INFO)
+handler = logging.StreamHandler()
+formatter = UTCFormatter("[%(asctime)s] %(message)s")
+handler.setFormatter(formatter)
+logger.handlers.clear()
+logger.addHandler(handler)
+
+#############
+# CONSTANTS #
+#############
+
+SEQ_ID_FIELD = "seq_id"
+REP_ID_FIELD = "vsearch_cluster_rep_id"
+COMPARE_FIELDS = [
+    "validation_staxid_lca",
+    "validation_distance_aligner",
+    "validation_distance_validation",
+]
+
+###########
+# CLASSES #
+###########
+
+
+@dataclass
+class FieldAgreement:
+    """Agreement of one validation column between two runs."""
+
+    field: str
+    subset: str
+    n_reads: int
+    n_agree: int
+
+    @property
+    def agreement(self) -> float:
+        """Fraction of reads given the same value by both runs."""
+        if self.n_reads == 0:
+            return 1.0
+        return self.n_agree / self.n_reads
+
+
+###########
+# HELPERS #
+###########
+
+
+def read_tsv(path: str) -> list[dict[str, str]]:
+    """Read a (gzipped) TSV with a header into a list of rows.
+    Args:
+        path: TSV path.
+    Returns:
+        Rows as dicts keyed by column name.
+    """
+    opener = gzip.open if path.endswith(".gz") else open
+    with opener(path, "rt", newline="") as f:
+        return list(csv.DictReader(f, delimiter="\t"))
+
+
+def index_hits(paths: list[str]) -> dict[str, dict[str, str]]:
+    """Read validation hits TSVs and key their rows by seq_id.
+    Args:
+        paths: Validation hits TSV paths (e.g. one per group).
+    Returns:
+        Mapping from seq_id to row.
+    """
+    hits = {}
+    for path in paths:
+        for row in read_tsv(path):
+            hits[row[SEQ_ID_FIELD]] = row
+    return hits
+
+
+def compare_hits(
+    blast_hits: dict[str, dict[str, str]],
+    tiered_hits: dict[str, dict[str, str]],
+    fields: list[str],
+) -> list[FieldAgreement]:
+    """Compare validation columns of two runs, per read and per representative.
+    Args:
+        blast_hits: BLAST-only hits keyed by seq_id.
+        tiered_hits: Tiered hits keyed by seq_id.
+        fields: Columns to compare.
+    Returns:
+        Agreement of each field over all reads and over representatives.
+    """
+    if blast_hits.keys() != tiered_hits.keys():
+        n_diff = len(blast_hits.keys() ^ tiered_hits.keys())
+        raise ValueError(
+            f"Runs cover different reads ({n_diff} differ); "
+            "were both runs given the same input?"
+        )
+    reps = [k for k, row in blast_hits.items() if row[REP_ID_FIELD] == k]
+    results = []
+    for subset, keys in (("all", list(blast_hits)), ("representatives", reps)):
+        for field in fields:
+            n_agree = sum(blast_hits[k][field] == tiered_hits[k][field] for k in keys)
+            results.append(FieldAgreement(field, subset, len(keys), n_agree))
+    return results
+
+
+def count_decisions(paths: list[str]) -> Counter[str]:
+    """Count representatives by triage decision.
+    Args:
+        paths: Triage decision TSV paths from the tiered run.
+    Returns:
+        Counts of each decision.
+    """
+    return Counter(row["decision"] for path in paths for row in read_tsv(path))
+
+
+##############
+# MAIN LOGIC #
+##############
+
+
+def parse_arguments() -> argparse.Namespace:
+    """Parse command-line arguments.
+    Returns:
+        Parsed arguments namespace.
+    """
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument(
+        "--blast", nargs="+", required=True, help="Validation hits, BLAST-only run."
+    )
+    parser.add_argument(
+        "--tiered", nargs="+", required=True, help="Validation hits of the tiered run."
+    )
+    parser.add_argument(
+        "--decisions", nargs="*", default=[], help="Triage decisions of the tiered run."
+    )
+    parser.add_argument("-o", "--output", help="Output TSV (default: stdout).")
+    return parser.parse_args()
+
+
+def main() -> None:
+    """Write per-field agreement and triage decision counts of the two runs."""
+    args = parse_arguments()
+    blast_hits = index_hits(args.blast)
+    tiered_hits = index_hits(args.tiered)
+    logger.info(f"Comparing validation of {len(blast_hits)} reads.")
+    agreements = compare_hits(blast_hits, tiered_hits, COMPARE_FIELDS)
+    decisions = count_decisions(args.decisions)
+    handle = open(args.output, "w", newline="") if args.output else sys.stdout
+    try:
+        writer = csv.writer(handle, delimiter="\t", lineterminator="\n")
+        writer.writerow(["metric", "subset", "n", "n_match", "fraction"])
+        for result in agreements:
+            writer.writerow(
+                [
+                    result.field,
+                    result.subset,
+                    result.n_reads,
+                    result.n_agree,
+                    f"{result.agreement:.4f}",
+                ]
+            )
+        n_reps = sum(decisions.values())
+        for decision, count in sorted(decisions.items()):
+            fraction = count / n_reps if n_reps else 0.0
+            writer.writerow(
+                [
+                    f"decision_{decision}",
+                    "representatives",
+                    n_reps,
+                    count,
+                    f"{fraction:.4f}",
+                ]
+            )
+    finally:
+        if args.output:
+            handle.close()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+"""Look up the rows for given read IDs in an indexed hits TSV.
+
+With `index_hits = true`, RUN writes `<sample>_virus_hits.tsv.gz` and DOWNSTREAM
+writes `<group>_validation_hits.tsv.gz` as BGZF (still readable with zcat or
+gzip) sorted by `seq_id`, each with a `.idx` sidecar giving the first `seq_id`
+and virtual offset of every block. This script binary-searches the index and
+decompresses only the blocks that can hold the requested IDs, so a lookup reads
+a few 64 KiB blocks rather than the whole file. `lookup_hits` is the same
+lookup as a Python function.
+"""
+
+###########
+# IMPORTS #
+###########
+
+import argparse
+import sys
+from pathlib import Path
+
+from nao_io import INDEX_SUFFIX, lookup_indexed
+
+#############
+# FUNCTIONS #
+#############
+
+
+def read_ids(ids: list[str], ids_file: str | None) -> list[str]:
+    """Combine IDs given on the command line with IDs listed in a file.
+    Args:
+        ids: IDs given directly.
+        ids_file: Optional path to a file with one ID per line.
+    Returns:
+        All IDs, with blank lines dropped.
+    """
+    combined = list(ids)
+    if ids_file:
+        with open(ids_file) as f:
+            combined.extend(line.strip() for line in f if line.strip())
+    return combined
+
+
+def lookup_hits(
+    hits_path: str | Path, ids: list[str], index_path: str | Path | None = None
+) -> tuple[list[str], list[str]]:
+    """Fetch the rows of an indexed hits TSV for the given read IDs.
+    Args:
+        hits_path: Path to a BGZF hits TSV written with an index.
+        ids: Read IDs (seq_id values) to look up.
+        index_path: Path to the index (default <hits_path>.idx).
+    Returns:
+        The header fields, and the matching rows (without newlines) in file order.
+    Raises:
+        FileNotFoundError: If the index does not exist.
+    """
+    index = Path(index_path) if index_path else Path(f"{hits_path}{INDEX_SUFFIX}")
+    if not index.exists():
+        raise FileNotFoundError(
+            f"No index at {index}; hits files are indexed when index_hits is enabled."
+        )
+    return lookup_indexed(hits_path, ids, index)
+
+
+##############
+# MAIN LOGIC #
+##############
+
+
+def parse_arguments() -> argparse.Namespace:
+    """Parse command-line arguments.
+    Returns:
+        Parsed arguments namespace.
+    """
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("hits", help="Indexed hits TSV (.tsv.gz).")
+    parser.add_argument("ids", nargs="*", help="Read IDs to look up.")
+    parser.add_argument("-f", "--ids-file", help="File of read IDs, one per line.")
+    parser.add_argument("-i", "--index", help="Index path (default: <hits>.idx).")
+    parser.add_argument("-o", "--output", help="Output TSV (default: stdout).")
+    return parser.parse_args()
+
+
+def main() -> None:
+    """Write the header and matching rows for the requested IDs."""
+    args = parse_arguments()
+    ids = read_ids(args.ids, args.ids_file)
+    header, rows = lookup_hits(args.hits, ids, args.index)
+    handle = open(args.output, "w") if args.output else sys.stdout
+    try:
+        if header:
+            handle.write("\t".join(header) + "\n")
+        handle.writelines(row + "\n" for row in rows)
+    finally:
+        if args.output:
+            handle.close()
+
+
+if __name__ == "__main__":
+    main()
@@ -29,14 +29,19 @@ from benchmark_index import (
     check_kraken_staleness,
     check_silva_staleness,
     compare_metrics,
+    compare_runtime,
     diff_params,
     infection_status_changes,
     infection_status_columns,
     infection_status_transitions,
     load_overrides,
     metadata_deltas,
+    run_timed,
+    stage_command,
+    stage_entry,
     summarise_params_changes,
     surveilled_taxids,
+    synthetic_reads,
     write_genome_taxonomy_tables,
     write_metrics_table,
     write_staleness_table,
@@ -1434,5 +1439,90 @@ class TestWriteGenomeTaxonomyTables:
             )
 
 
+class TestRuntime:
+    def _genomes(self, tmp_path: Path) -> Path:
+        path = tmp_path / "genomes.fasta.gz"
+        with gzip.open(path, "wt") as f:
+            f.write(">g1\n" + "ACGT" * 50 + "\n>short\nACGT\n>g2\n")
+            f.write("GGCC" * 25 + "\n" + "TTAA" * 25 + "\n")
+        return path
+
+    def test_synthetic_reads_are_deterministic(self, tmp_path: Path) -> None:
+        genomes = self._genomes(tmp_path)
+        a = synthetic_reads(genomes, tmp_path / "a.fastq", 10, 50, seed=0)
+        b = synthetic_reads(genomes, tmp_path / "b.fastq", 10, 50, seed=0)
+        assert a.read_text() == b.read_text()
+        lines = a.read_text().splitlines()
+        assert len(lines) == 40
+        assert all(len(seq) == 50 for seq in lines[1::4])
+        assert lines[0] == "@synthetic_0"
+
+    def test_synthetic_reads_skip_genomes_shorter_than_reads(
+        self, tmp_path: Path
+    ) -> None:
+        # Only two genomes are long enough, so at most two reads are viral;
+        # the rest are random background.
+        genomes = self._genomes(tmp_path)
+        reads = synthetic_reads(genomes, tmp_path / "r.fastq", 8, 150, seed=1)
+        seqs = reads.read_text().splitlines()[1::4]
+        assert len(seqs) == 8
+        assert all(len(seq) == 150 for seq in seqs)
+
+    def test_compare_runtime_flags_throughput_regressions(self) -> None:
+        metrics = "reads_per_s", "peak_rss_mb", "index_load_s"
+        old = {
+            "NUCLEAZE": dict(zip(metrics, (1000.0, 10.0, 1.0), strict=True)),
+            "BOWTIE2_VIRUS": dict(zip(metrics, (100.0, 5.0, 2.0), strict=True)),
+        }
+        new = {
+            "NUCLEAZE": dict(zip(metrics, (950.0, 12.0, 1.0), strict=True)),
+            "BOWTIE2_VIRUS": dict(zip(metrics, (80.0, 6.0, 3.0), strict=True)),
+        }
+        table, regressions = compare_runtime(old, new, tolerance_pct=10)
+        assert list(table["stage"].unique()) == ["NUCLEAZE", "BOWTIE2_VIRUS"]
+        rss = table[(table["stage"] == "NUCLEAZE") & (table["metric"] == "peak_rss_mb")]
+        assert rss.iloc[0]["pct_change"] == 20.0
+        # A 5% throughput drop is within tolerance; a 20% drop is not.
+        assert regressions == ["BOWTIE2_VIRUS"]
+
+    def test_compare_runtime_skips_stages_missing_from_a_release(self) -> None:
+        stats = {"reads_per_s": 1.0, "peak_rss_mb": 1.0, "index_load_s": 1.0}
+        table, regressions = compare_runtime(
+            {"NUCLEAZE": stats}, {"NUCLEAZE": stats, "MINIMAP2_VIRUS": stats}, 10
+        )
+        assert set(table["stage"]) == {"NUCLEAZE"}
+        assert regressions == []
+
+    def test_run_timed_reports_wall_time_and_memory(self, tmp_path: Path) -> None:
+        stats = run_timed(["sleep", "0.1"], tmp_path / "sleep.log")
+        assert stats.wall_s >= 0.1
+        assert stats.peak_rss_mb > 0
+
+    def test_run_timed_raises_with_log_tail(self, tmp_path: Path) -> None:
+        cmd = ["sh", "-c", "echo broken index >&2; exit 3"]
+        with pytest.raises(RuntimeError, match="exited with 3: broken index"):
+            run_timed(cmd, tmp_path / "fail.log")
+
+    def test_stage_entry_uses_local_entries_in_place(self, tmp_path: Path) -> None:
+        results = tmp_path / "output" / "results"
+        (results / "bt2-virus-index").mkdir(parents=True)
+        staged = stage_entry(
+            str(tmp_path), "output/results/bt2-virus-index", tmp_path / "stage"
+        )
+        assert staged == results / "bt2-virus-index"
+        missing = stage_entry(
+            str(tmp_path), "output/results/mm2-virus-index", tmp_path / "stage"
+        )
+        assert missing is None
+
+    def test_stage_command_reads_nucleaze_k_from_index_params(self) -> None:
+        cmd = stage_command(
+            "NUCLEAZE", Path("idx.bin"), Path("r.fq"), 4, {"nucleaze_k": 31}
+        )
+        assert cmd[cmd.index("--k") + 1] == "31"
+        with pytest.raises(ValueError, match="Unknown runtime stage"):
+            stage_command("BBDUK", Path("idx"), Path("r.fq"), 4, {})
+
+
 if __name__ == "__main__":
     pytest.main([__file__, "-v"])
@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+"""Unit tests for calibrate_resources.py"""
+
+import sys
+from pathlib import Path
+
+import pytest
+
+sys.path.insert(0, str(Path(__file__).parent))
+from calibrate_resources import (
+    TaskSample,
+    fit_scaling,
+    parse_size,
+    read_trace_samples,
+    staged_input_bytes,
+    suggest_thresholds,
+)
+
+GB = 1024**3
+
+
+class TestParseSize:
+    @pytest.mark.parametrize(
+        "value, expected",
+        [
+            ("1.5 GB", int(1.5 * GB)),
+            ("512 MB", 512 * 1024**2),
+            ("10 KB", 10240),
+            ("2048", 2048),
+            ("-", None),
+            ("", None),
+        ],
+        ids=["gb", "mb", "kb", "raw-bytes", "dash", "empty"],
+    )
+    def test_parses(self, value: str, expected: int | None) -> None:
+        assert parse_size(value) == expected
+
+    def test_invalid(self) -> None:
+        with pytest.raises(ValueError):
+            parse_size("lots")
+
+
+class TestFitScaling:
+    def test_exact_linear_fit(self) -> None:
+        samples = [TaskSample("P", x * GB, (2 + 3 * x) * GB) for x in (1, 2, 4, 8)]
+        fit = fit_scaling("P", samples)
+        assert fit.n_tasks == 4
+        assert fit.intercept_bytes == pytest.approx(2 * GB)
+        assert fit.slope == pytest.approx(3.0)
+        assert fit.r_squared == pytest.approx(1.0)
+        assert fit.max_peak_rss_bytes == 26 * GB
+
+    def test_constant_input_has_zero_slope(self) -> None:
+        samples = [TaskSample("P", GB, y * GB) for y in (1, 2, 3)]
+        fit = fit_scaling("P", samples)
+        assert fit.slope == 0.0
+        assert fit.intercept_bytes == pytest.approx(2 * GB)
+
+
+class TestSuggestThresholds:
+    def test_thresholds_keep_headroom(self) -> None:
+        fit = fit_scaling(
+            "P", [TaskSample("P", x * GB, (2 + 3 * x) * GB) for x in (1, 2, 4)]
+        )
+        thresholds = suggest_thresholds(fit, [32 * GB, 64 * GB, 128 * GB], 1.5)
+        # (32 / 1.5 - 2) / 3 and (64 / 1.5 - 2) / 3
+        assert thresholds[0] == pytest.approx((32 / 1.5 - 2) / 3 * GB)
+        assert thresholds[1] == pytest.approx((64 / 1.5 - 2) / 3 * GB)
+        assert len(thresholds) == 2
+
+    def test_unusable_fit(self) -> None:
+        fit = fit_scaling("P", [TaskSample("P", GB, 100 * GB) for _ in range(3)])
+        assert suggest_thresholds(fit, [32 * GB, 64 * GB], 1.5) == [None]
+
+
+class TestReadTraceSamples:
+    def _write_trace(self, path: Path, rows: list[dict[str, str]]) -> str:
+        header = ["process", "status", "peak_rss", "rchar", "workdir"]
+        lines = ["\t".join(header)]
+        lines += ["\t".join(row.get(h, "-") for h in header) for row in rows]
+        path.write_text("\n".join(lines) + "\n")
+        return str(path)
+
+    def test_rchar_source_filters_process_and_status(self, tmp_path: Path) -> None:
+        trace = self._write_trace(
+            tmp_path / "trace.tsv",
+            [
+                {
+                    "process": "DOWNSTREAM:MARK:MARK_ALIGNMENT_DUPLICATES",
+                    "status": "COMPLETED",
+                    "peak_rss": "4 GB",
+                    "rchar": "1 GB",
+                },
+                {
+                    "process": "DOWNSTREAM:MARK:MARK_ALIGNMENT_DUPLICATES",
+                    "status": "FAILED",
+                    "peak_rss": "30 GB",
+                    "rchar": "9 GB",
+                },
+                {
+                    "process": "DOWNSTREAM:OTHER",
+                    "status": "COMPLETED",
+                    "peak_rss": "1 GB",
+                    "rchar": "1 GB",
+                },
+            ],
+        )
+        samples = read_trace_samples([trace], {"MARK_ALIGNMENT_DUPLICATES"}, "rchar")
+        assert samples == [TaskSample("MARK_ALIGNMENT_DUPLICATES", GB, 4 * GB)]
+
+    def test_workdir_source(self, tmp_path: Path) -> None:
+        upstream = tmp_path / "upstream"
+        upstream.mkdir()
+        (upstream / "hits.tsv.gz").write_bytes(b"x" * 1000)
+        workdir = tmp_path / "work"
+        workdir.mkdir()
+        (workdir / "hits.tsv.gz").symlink_to(upstream / "hits.tsv.gz")
+        # Test link back into the work dir must not be double-counted
+        (workdir / "input_hits.tsv.gz").symlink_to(workdir / "hits.tsv.gz")
+        (workdir / "out.tsv.gz").write_bytes(b"y" * 50)
+        assert staged_input_bytes(workdir) == 1000
+        trace = self._write_trace(
+            tmp_path / "trace.tsv",
+            [
+                {
+                    "process": "P",
+                    "status": "COMPLETED",
+                    "peak_rss": "1 MB",
+                    "workdir": str(workdir),
+                }
+            ],
+        )
+        samples = read_trace_samples([trace], None, "workdir")
+        assert samples == [TaskSample("P", 1000, 1024**2)]
+
+    def test_missing_workdir_is_skipped(self, tmp_path: Path) -> None:
+        trace = self._write_trace(
+            tmp_path / "trace.tsv",
+            [
+                {
+                    "process": "P",
+                    "status": "COMPLETED",
+                    "peak_rss": "1 MB",
+                    "workdir": str(tmp_path / "gone"),
+                }
+            ],
+        )
+        assert read_trace_samples([trace], None, "workdir") == []
@@ -0,0 +1,97 @@
+#!/usr/bin/env python3
+"""Unit tests for collect_task_metrics.py"""
+
+import csv
+import json
+import sys
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).parent))
+from collect_task_metrics import OUTPUT_FIELDS, collect, load_metrics, read_tasks
+
+METRICS = {
+    "tool": "join_tsvs",
+    "rows_in": 6,
+    "rows_out": 3,
+    "bytes_read": 79,
+    "bytes_read_uncompressed": 26,
+    "bytes_written": 53,
+    "bytes_written_uncompressed": 19,
+    "wall_s": 0.5,
+    "cpu_s": 0.4,
+    "phases": {
+        "parse": {"wall_s": 0.2, "cpu_s": 0.1},
+        "write": {"wall_s": 0.3, "cpu_s": 0.3},
+    },
+    "peak_rss_bytes": 1024,
+}
+
+
+def _write_trace(path: Path, rows: list[list[str]]) -> Path:
+    header = ["hash", "process", "tag", "status", "realtime", "peak_rss", "workdir"]
+    with open(path, "w", newline="") as f:
+        writer = csv.writer(f, delimiter="\t")
+        writer.writerow(header)
+        writer.writerows(rows)
+    return path
+
+
+class TestReadTasks:
+    def test_completed_and_cached_only(self, tmp_path: Path) -> None:
+        trace = _write_trace(
+            tmp_path / "trace.tsv",
+            [
+                ["ab/1", "RUN:JOIN", "id=s1", "COMPLETED", "2s", "10 MB", "/w/1"],
+                ["ab/2", "RUN:JOIN", "id=s2", "FAILED", "1s", "-", "/w/2"],
+                ["ab/3", "RUN:JOIN", "id=s3", "CACHED", "-", "-", "/w/3"],
+            ],
+        )
+        tasks = read_tasks(str(trace))
+        assert [t.tag for t in tasks] == ["id=s1", "id=s3"]
+        assert tasks[0].realtime_s == 2.0
+        assert tasks[1].realtime_s is None
+
+
+class TestCollect:
+    def test_rows_per_tool_and_phase(self, tmp_path: Path) -> None:
+        workdir = tmp_path / "work"
+        workdir.mkdir()
+        (workdir / "join_tsvs.metrics.json").write_text(json.dumps(METRICS))
+        (workdir / "sort_tsv.metrics.json").write_text(
+            json.dumps({**METRICS, "tool": "sort_tsv", "phases": {}})
+        )
+        empty = tmp_path / "empty"
+        empty.mkdir()
+        trace = _write_trace(
+            tmp_path / "trace.tsv",
+            [
+                ["ab/1", "RUN:JOIN", "id=s1", "COMPLETED", "1s", "5 MB", str(workdir)],
+                ["ab/2", "RUN:OTHER", "id=s1", "COMPLETED", "1s", "5 MB", str(empty)],
+                ["ab/3", "RUN:JOIN", "id=s2", "COMPLETED", "1s", "5 MB", "s3://b/w"],
+            ],
+        )
+        rows = list(collect([str(trace)]))
+        assert [(r["tool"], r["phase"]) for r in rows] == [
+            ("join_tsvs", "total"),
+            ("join_tsvs", "parse"),
+            ("join_tsvs", "write"),
+            ("sort_tsv", "total"),
+        ]
+        assert all(set(r) == set(OUTPUT_FIELDS) for r in rows)
+        assert rows[0]["rows_in"] == 6
+        assert rows[0]["task_realtime_s"] == 1.0
+        assert rows[1]["wall_s"] == 0.2
+        assert rows[1]["rows_in"] == "NA"
+
+    def test_null_counters(self, tmp_path: Path) -> None:
+        (tmp_path / "t.metrics.json").write_text(
+            json.dumps({**METRICS, "peak_rss_bytes": None})
+        )
+        assert load_metrics(tmp_path)[0]["peak_rss_bytes"] is None
+        trace = _write_trace(
+            tmp_path / "trace.tsv",
+            [["ab/1", "RUN:JOIN", "id=s1", "COMPLETED", "1s", "", str(tmp_path)]],
+        )
+        total = next(collect([str(trace)]))
+        assert total["peak_rss_bytes"] == "NA"
+        assert total["task_peak_rss"] == "NA"
@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+"""Unit tests for compare_ribo_split.py"""
+
+import gzip
+import sys
+from pathlib import Path
+
+import pytest
+
+sys.path.insert(0, str(Path(__file__).parent))
+from compare_ribo_split import (
+    SplitComparison,
+    compare_splits,
+    find_split_tasks,
+    parse_duration,
+    read_ids,
+    split_outputs,
+)
+
+
+def _write_fastq(path: Path, names: list[str]) -> Path:
+    records = "".join(f"@{name}\nACGT\n+\nIIII\n" for name in names)
+    with gzip.open(path, "wt") as f:
+        f.write(records)
+    return path
+
+
+class TestParseDuration:
+    @pytest.mark.parametrize(
+        "value, expected",
+        [
+            ("850ms", 0.85),
+            ("3s", 3.0),
+            ("1m 2s", 62.0),
+            ("1h 0m 1.5s", 3601.5),
+            ("1d 1h", 90000.0),
+            ("-", None),
+            ("", None),
+        ],
+        ids=["ms", "s", "m-s", "h-m-s", "d-h", "dash", "empty"],
+    )
+    def test_parses(self, value: str, expected: float | None) -> None:
+        assert parse_duration(value) == pytest.approx(expected)
+
+    def test_invalid(self) -> None:
+        with pytest.raises(ValueError):
+            parse_duration("soon")
+
+
+class TestReadIds:
+    def test_strips_comments_and_mate_suffixes(self, tmp_path: Path) -> None:
+        path = _write_fastq(tmp_path / "r.fastq.gz", ["a/1", "a/2", "b extra"])
+        assert read_ids(path) == ["a", "a", "b"]
+
+
+class TestCompareSplits:
+    def test_counts(self) -> None:
+        comparison = compare_splits(["a", "b"], ["c", "d"], ["a", "c"], ["b", "d"])
+        assert comparison == SplitComparison(
+            n_reads=4, both_ribo=1, bbduk_only=1, nucleaze_only=1, neither=1
+        )
+        assert comparison.concordance == pytest.approx(0.5)
+
+    def test_empty(self) -> None:
+        assert compare_splits([], [], [], []).concordance == 1.0
+
+    def test_mismatched_inputs(self) -> None:
+        with pytest.raises(ValueError):
+            compare_splits(["a"], ["b"], ["a"], ["c"])
+
+
+class TestFindSplitTasks:
+    def test_selects_profile_tasks(self, tmp_path: Path) -> None:
+        header = ["process", "tag", "status", "realtime", "workdir"]
+        rows = [
+            ["RUN:PROFILE:BBDUK", "id=s1", "COMPLETED", "10s", "/w/1"],
+            ["RUN:PROFILE:BBDUK", "id=s2", "FAILED", "1s", "/w/2"],
+            ["RUN:OTHER:BBDUK", "id=s3", "COMPLETED", "1s", "/w/3"],
+        ]
+        trace = tmp_path / "trace.tsv"
+        trace.write_text("\n".join("\t".join(r) for r in [header, *rows]) + "\n")
+        tasks = find_split_tasks(str(trace), "BBDUK")
+        assert list(tasks) == ["s1"]
+        assert tasks["s1"].workdir == Path("/w/1")
+        assert tasks["s1"].realtime_s == 10.0
+
+
+class TestSplitOutputs:
+    def test_finds_match_and_nomatch(self, tmp_path: Path) -> None:
+        match = _write_fastq(tmp_path / "s_ribo_nucleaze_match.fastq.gz", ["a"])
+        nomatch = _write_fastq(tmp_path / "s_ribo_nucleaze_nomatch.fastq.gz", ["b"])
+        assert split_outputs(tmp_path) == (match, nomatch)
+
+    def test_missing_outputs(self, tmp_path: Path) -> None:
+        with pytest.raises(FileNotFoundError):
+            split_outputs(tmp_path)
@@ -0,0 +1,65 @@
+#!/usr/bin/env python3
+"""Unit tests for compare_validation_tiers.py"""
+
+import gzip
+import sys
+from pathlib import Path
+
+import pytest
+
+sys.path.insert(0, str(Path(__file__).parent))
+from compare_validation_tiers import (
+    FieldAgreement,
+    compare_hits,
+    count_decisions,
+    index_hits,
+)
+
+HEADER = ["seq_id", "vsearch_cluster_rep_id", "validation_staxid_lca"]
+
+
+def _write_tsv(path: Path, header: list[str], rows: list[list[str]]) -> str:
+    lines = ["\t".join(header)] + ["\t".join(row) for row in rows]
+    with gzip.open(path, "wt") as f:
+        f.write("\n".join(lines) + "\n")
+    return str(path)
+
+
+class TestCompareHits:
+    def test_counts_agreement_per_subset(self, tmp_path):
+        blast = _write_tsv(
+            tmp_path / "blast.tsv.gz",
+            HEADER,
+            [["r1", "r1", "10"], ["r2", "r1", "10"], ["r3", "r3", "20"]],
+        )
+        tiered = _write_tsv(
+            tmp_path / "tiered.tsv.gz",
+            HEADER,
+            [["r1", "r1", "10"], ["r2", "r1", "10"], ["r3", "r3", "21"]],
+        )
+        results = compare_hits(
+            index_hits([blast]), index_hits([tiered]), ["validation_staxid_lca"]
+        )
+        assert results == [
+            FieldAgreement("validation_staxid_lca", "all", 3, 2),
+            FieldAgreement("validation_staxid_lca", "representatives", 2, 1),
+        ]
+        assert results[1].agreement == pytest.approx(0.5)
+
+    def test_rejects_different_reads(self, tmp_path):
+        blast = _write_tsv(tmp_path / "b.tsv.gz", HEADER, [["r1", "r1", "10"]])
+        tiered = _write_tsv(tmp_path / "t.tsv.gz", HEADER, [["r2", "r2", "10"]])
+        with pytest.raises(ValueError, match="different reads"):
+            compare_hits(index_hits([blast]), index_hits([tiered]), HEADER[2:])
+
+
+class TestCountDecisions:
+    def test_counts_across_files(self, tmp_path):
+        header = ["qseqid", "decision", "n_alignments", "mm2_staxid"]
+        a = _write_tsv(
+            tmp_path / "a.tsv.gz",
+            header,
+            [["r1", "resolved", "1", "10"], ["r2", "unmapped", "0", "NA"]],
+        )
+        b = _write_tsv(tmp_path / "b.tsv.gz", header, [["r3", "resolved", "2", "20"]])
+        assert count_decisions([a, b]) == {"resolved": 2, "unmapped": 1}
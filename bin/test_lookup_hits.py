@@ -0,0 +1,52 @@
+#!/usr/bin/env python3
+"""Unit tests for lookup_hits.py"""
+
+import subprocess
+import sys
+from pathlib import Path
+
+import pytest
+
+sys.path.insert(0, str(Path(__file__).parent))
+from lookup_hits import lookup_hits, read_ids
+from nao_io import open_by_suffix, write_lines
+
+SCRIPT = Path(__file__).parent / "lookup_hits.py"
+
+
+@pytest.fixture
+def hits(tmp_path: Path) -> Path:
+    path = tmp_path / "sample_virus_hits.tsv.gz"
+    with open_by_suffix(path, "w", index_key="seq_id") as f:
+        write_lines(f, ["seq_id\ttaxid"])
+        write_lines(f, (f"read{i:06d}\t{i % 7}" for i in range(50000)))
+    return path
+
+
+def test_read_ids(tmp_path: Path) -> None:
+    ids_file = tmp_path / "ids.txt"
+    ids_file.write_text("b\n\n c \n")
+    assert read_ids(["a"], str(ids_file)) == ["a", "b", "c"]
+    assert read_ids(["a"], None) == ["a"]
+
+
+def test_lookup_hits(hits: Path) -> None:
+    header, rows = lookup_hits(hits, ["read049999", "read000007", "absent"])
+    assert header == ["seq_id", "taxid"]
+    assert rows == ["read000007\t0", "read049999\t5"]
+
+
+def test_missing_index(hits: Path) -> None:
+    Path(f"{hits}.idx").unlink()
+    with pytest.raises(FileNotFoundError, match="No index"):
+        lookup_hits(hits, ["read000001"])
+
+
+def test_cli(hits: Path, tmp_path: Path) -> None:
+    out = tmp_path / "out.tsv"
+    subprocess.run(
+        [sys.executable, str(SCRIPT), str(hits), "read000010", "-o", str(out)],
+        check=True,
+        env={"PYTHONPATH": str(SCRIPT.parent)},
+    )
+    assert out.read_text() == "seq_id\ttaxid\nread000010\t3\n"
@@ -0,0 +1,320 @@
+#!/usr/bin/env python3
+"""Unit tests for nao_io.py"""
+
+import gzip
+import io
+import json
+import os
+import re
+import stat
+import sys
+from pathlib import Path
+
+import pytest
+
+sys.path.insert(0, str(Path(__file__).parent))
+import nao_io
+from nao_io import (
+    BGZF_BLOCK_SIZE,
+    BGZF_EOF,
+    TaskMetrics,
+    gzip_backend,
+    iter_lines,
+    lookup_indexed,
+    open_by_suffix,
+    read_index,
+    write_lines,
+)
+
+REPO_ROOT = Path(__file__).resolve().parent.parent
+MODULE_SCRIPTS = REPO_ROOT / "modules" / "local"
+
+# Stands in for pigz in tests: gzip accepts the same flags apart from -p
+FAKE_PIGZ = """#!/bin/sh
+args=""
+while [ $# -gt 0 ]; do
+    case "$1" in
+        -p) shift ;;
+        *) args="$args $1" ;;
+    esac
+    shift
+done
+exec gzip $args
+"""
+
+
+@pytest.fixture(params=["zlib", "pigz", "isal"])
+def backend(
+    request: pytest.FixtureRequest, monkeypatch: pytest.MonkeyPatch, tmp_path: Path
+) -> str:
+    """Force each gzip backend in turn."""
+    if request.param == "isal" and nao_io.igzip_threaded is None:
+        pytest.skip("python-isal not installed")
+    if request.param == "pigz":
+        fake_bin = tmp_path / "fake_bin"
+        fake_bin.mkdir()
+        pigz = fake_bin / "pigz"
+        pigz.write_text(FAKE_PIGZ)
+        pigz.chmod(pigz.stat().st_mode | stat.S_IEXEC)
+        monkeypatch.setenv("PATH", f"{fake_bin}:{os.environ['PATH']}")
+    monkeypatch.setenv("NAO_GZIP_BACKEND", request.param)
+    return str(request.param)
+
+
+class TestOpenBySuffix:
+    @pytest.mark.parametrize("suffix", [".tsv", ".tsv.gz"])
+    def test_roundtrip(self, backend: str, tmp_path: Path, suffix: str) -> None:
+        path = tmp_path / f"test{suffix}"
+        with open_by_suffix(path, "w") as f:
+            f.write("a\tb\nc\td\n")
+        with open_by_suffix(path) as f:
+            assert f.readline() == "a\tb\n"
+            assert f.read() == "c\td\n"
+
+    def test_gzip_output_is_standard_gzip(self, backend: str, tmp_path: Path) -> None:
+        path = tmp_path / "test.tsv.gz"
+        with open_by_suffix(str(path), "wt") as f:
+            f.write("x\n" * 1000)
+        with gzip.open(path, "rt") as f:
+            assert f.read() == "x\n" * 1000
+
+    def test_append_gzip(self, backend: str, tmp_path: Path) -> None:
+        path = tmp_path / "test.tsv.gz"
+        with open_by_suffix(path, "w") as f:
+            f.write("first\n")
+        with open_by_suffix(path, "a") as f:
+            f.write("second\n")
+        with open_by_suffix(path) as f:
+            assert f.read() == "first\nsecond\n"
+
+    def test_early_close_after_header(self, backend: str, tmp_path: Path) -> None:
+        path = tmp_path / "test.tsv.gz"
+        with gzip.open(path, "wt") as f:
+            f.write("header\n" + "row\n" * 200000)
+        with open_by_suffix(path) as f:
+            assert f.readline() == "header\n"
+
+    def test_corrupt_gzip_raises(self, backend: str, tmp_path: Path) -> None:
+        path = tmp_path / "test.tsv.gz"
+        path.write_bytes(gzip.compress(b"a\nb\n")[:-6])
+        with pytest.raises((OSError, EOFError)), open_by_suffix(path) as f:
+            f.read()
+
+    def test_universal_newlines(self, tmp_path: Path) -> None:
+        path = tmp_path / "test.tsv.gz"
+        with gzip.open(path, "wb") as f:
+            f.write(b"a\r\nb\r\n")
+        with open_by_suffix(path) as f:
+            assert f.read() == "a\nb\n"
+
+    def test_invalid_mode(self, tmp_path: Path) -> None:
+        with pytest.raises(ValueError, match="Unsupported mode"):
+            open_by_suffix(tmp_path / "test.tsv", "rb")
+
+
+class TestSettings:
+    def test_invalid_level(self, monkeypatch: pytest.MonkeyPatch) -> None:
+        monkeypatch.setenv("NAO_GZIP_LEVEL", "12")
+        with pytest.raises(ValueError, match="NAO_GZIP_LEVEL"):
+            nao_io.gzip_level()
+
+    def test_invalid_backend(self, monkeypatch: pytest.MonkeyPatch) -> None:
+        monkeypatch.setenv("NAO_GZIP_BACKEND", "bzip2")
+        with pytest.raises(ValueError, match="Unknown NAO_GZIP_BACKEND"):
+            gzip_backend()
+
+    def test_fallback_to_zlib(self, monkeypatch: pytest.MonkeyPatch) -> None:
+        monkeypatch.delenv("NAO_GZIP_BACKEND", raising=False)
+        monkeypatch.setattr(nao_io, "igzip_threaded", None)
+        monkeypatch.setattr(nao_io.shutil, "which", lambda _: None)
+        assert gzip_backend() == "zlib"
+
+
+class TestIterLines:
+    @pytest.mark.parametrize("chunk_size", [1, 3, 1 << 20])
+    def test_lines_across_chunks(self, tmp_path: Path, chunk_size: int) -> None:
+        path = tmp_path / "test.tsv.gz"
+        with gzip.open(path, "wt") as f:
+            f.write("header\nr1\tx\n\nr2\ty\nr3")
+        with open_by_suffix(path) as f:
+            assert f.readline() == "header\n"
+            assert list(iter_lines(f, chunk_size)) == ["r1\tx", "", "r2\ty", "r3"]
+
+    def test_empty(self, tmp_path: Path) -> None:
+        path = tmp_path / "test.tsv"
+        path.write_text("")
+        with open_by_suffix(path) as f:
+            assert list(iter_lines(f)) == []
+
+
+class TestWriteLines:
+    def test_batches(self, tmp_path: Path) -> None:
+        path = tmp_path / "test.tsv.gz"
+        with open_by_suffix(path, "w") as f:
+            n = write_lines(f, (str(i) for i in range(10)), batch_size=3)
+        assert n == 10
+        with gzip.open(path, "rt") as f:
+            assert f.read() == "".join(f"{i}\n" for i in range(10))
+
+    def test_nothing_to_write(self, tmp_path: Path) -> None:
+        path = tmp_path / "test.tsv"
+        with open_by_suffix(path, "w") as f:
+            assert write_lines(f, []) == 0
+        assert path.read_text() == ""
+
+
+class TestIndexedBgzf:
+    def write(self, tmp_path: Path, rows: list[str], header: str = "seq_id\tx") -> Path:
+        path = tmp_path / "hits.tsv.gz"
+        with open_by_suffix(path, "w", index_key="seq_id") as f:
+            f.write(header + "\n")
+            write_lines(f, rows)
+        return path
+
+    def rows(self, n: int, width: int = 100) -> list[str]:
+        return [f"read{i // 3:05d}\t{i:0{width}d}" for i in range(n)]
+
+    def test_readable_as_gzip(self, tmp_path: Path) -> None:
+        rows = self.rows(3000)
+        path = self.write(tmp_path, rows)
+        with gzip.open(path, "rt") as f:
+            assert f.read() == "seq_id\tx\n" + "".join(r + "\n" for r in rows)
+        assert path.read_bytes().endswith(BGZF_EOF)
+
+    def test_index_points_at_block_starts(self, tmp_path: Path) -> None:
+        rows = self.rows(3000)
+        path = self.write(tmp_path, rows)
+        key_field, keys, offsets = read_index(f"{path}.idx")
+        assert key_field == "seq_id"
+        assert len(keys) > 1
+        assert keys == sorted(keys)
+        data = path.read_bytes()
+        for key, offset in zip(keys, offsets, strict=True):
+            with gzip.GzipFile(fileobj=io.BytesIO(data[offset:])) as f:
+                assert f.readline().decode().split("\t")[0] == key
+
+    def test_lookup_matches_scan(self, tmp_path: Path) -> None:
+        rows = self.rows(3000)
+        path = self.write(tmp_path, rows)
+        # Keys spanning block boundaries, absent keys and keys past the end
+        for keys in [["read00000"], ["read00500", "read00998"], ["nope", "zzz"]]:
+            header, found = lookup_indexed(path, keys)
+            assert header == ["seq_id", "x"]
+            assert found == [r for r in rows if r.split("\t")[0] in keys]
+        boundary = read_index(f"{path}.idx")[1][1]
+        expected = [r for r in rows if r.startswith(boundary + "\t")]
+        assert lookup_indexed(path, [boundary])[1] == expected
+
+    def test_rows_longer_than_a_block(self, tmp_path: Path) -> None:
+        rows = ["a\t1", "b\t" + "x" * (3 * BGZF_BLOCK_SIZE), "c\t3"]
+        path = self.write(tmp_path, rows)
+        with gzip.open(path, "rt") as f:
+            assert f.read().splitlines()[1:] == rows
+        assert lookup_indexed(path, ["b", "c"])[1] == rows[1:]
+
+    def test_empty_and_header_only(self, tmp_path: Path) -> None:
+        path = tmp_path / "empty.tsv.gz"
+        with open_by_suffix(path, "w", index_key="seq_id"):
+            pass
+        assert gzip.open(path).read() == b""
+        assert lookup_indexed(path, ["a"]) == ([], [])
+        path = self.write(tmp_path, [])
+        assert lookup_indexed(path, ["a"]) == (["seq_id", "x"], [])
+
+    def test_unsorted_rows_raise(self, tmp_path: Path) -> None:
+        with pytest.raises(ValueError, match="not sorted by seq_id"):
+            self.write(tmp_path, ["b\t1", "a\t2"])
+
+    def test_missing_key_raises(self, tmp_path: Path) -> None:
+        with pytest.raises(ValueError, match="not in header"):
+            self.write(tmp_path, ["a\t1"], header="id\tx")
+
+    def test_requires_gzip_write_mode(self, tmp_path: Path) -> None:
+        with pytest.raises(ValueError, match="Indexed output"):
+            open_by_suffix(tmp_path / "hits.tsv", "w", index_key="seq_id")
+
+    def test_metrics(self, tmp_path: Path) -> None:
+        metrics = TaskMetrics("tool")
+        path = tmp_path / "hits.tsv.gz"
+        with open_by_suffix(path, "w", metrics, index_key="seq_id") as f:
+            write_lines(f, ["seq_id", "a", "b"])
+        result = metrics.as_dict()
+        assert result["rows_out"] == 3
+        assert result["bytes_written"] == path.stat().st_size
+
+
+class TestTaskMetrics:
+    def test_counts_through_files(self, backend: str, tmp_path: Path) -> None:
+        src = tmp_path / "in.tsv.gz"
+        with gzip.open(src, "wt") as f:
+            f.write("h\n" + "row\n" * 1000)
+        metrics = TaskMetrics("tool")
+        with (
+            open_by_suffix(src, metrics=metrics) as inp,
+            open_by_suffix(tmp_path / "out.tsv", "w", metrics=metrics) as out,
+        ):
+            assert inp.readline() == "h\n"
+            write_lines(out, iter_lines(inp))
+        result = metrics.as_dict()
+        assert result["rows_in"] == 1001
+        assert result["rows_out"] == 1000
+        assert result["bytes_read"] == src.stat().st_size
+        assert result["bytes_read_uncompressed"] == 4002
+        assert result["bytes_written"] == result["bytes_written_uncompressed"] == 4000
+        assert (tmp_path / "out.tsv").read_text() == "row\n" * 1000
+
+    def test_phases_accumulate(self) -> None:
+        metrics = TaskMetrics("tool")
+        for _ in range(2):
+            with metrics.phase("parse"):
+                sum(range(10000))
+        with metrics.phase("write"):
+            pass
+        phases = metrics.as_dict()["phases"]
+        assert list(phases) == ["parse", "write"]
+        assert phases["parse"]["wall_s"] >= phases["write"]["wall_s"] >= 0
+        assert metrics.as_dict()["peak_rss_bytes"] > 0
+
+    @pytest.mark.parametrize("value", ["", "0", "false"])
+    def test_disabled(
+        self, monkeypatch: pytest.MonkeyPatch, tmp_path: Path, value: str
+    ) -> None:
+        monkeypatch.setenv("NAO_TASK_METRICS", value)
+        monkeypatch.chdir(tmp_path)
+        with TaskMetrics("tool"):
+            pass
+        assert not list(tmp_path.iterdir())
+
+    def test_written_on_success_only(
+        self, monkeypatch: pytest.MonkeyPatch, tmp_path: Path
+    ) -> None:
+        monkeypatch.setenv("NAO_TASK_METRICS", "1")
+        monkeypatch.chdir(tmp_path)
+        with pytest.raises(RuntimeError), TaskMetrics("failed"):
+            raise RuntimeError
+        with TaskMetrics("tool") as metrics:
+            metrics.rows_in = 3
+        assert [p.name for p in tmp_path.iterdir()] == ["tool.metrics.json"]
+        result = json.loads((tmp_path / "tool.metrics.json").read_text())
+        assert result["tool"] == "tool"
+        assert result["rows_in"] == 3
+
+
+class TestModuleCopies:
+    def test_copies_identical(self) -> None:
+        source = (REPO_ROOT / "bin" / "nao_io.py").read_bytes()
+        copies = sorted(MODULE_SCRIPTS.glob("*/resources/usr/bin/nao_io.py"))
+        assert copies
+        for copy in copies:
+            assert copy.read_bytes() == source, f"{copy} is out of sync"
+
+    def test_module_scripts_use_shared_io(self) -> None:
+        for script in MODULE_SCRIPTS.glob("*/resources/usr/bin/*.py"):
+            if script.name == "nao_io.py" or script.name.startswith("test_"):
+                continue
+            text = script.read_text()
+            assert "def open_by_suffix" not in text, f"{script} has own opener"
+            calls_gzip = re.search(r"(?<!`)gzip\.open\(", text)
+            assert not calls_gzip, f"{script} calls gzip.open"
+            if "from nao_io import" in text:
+                assert (script.parent / "nao_io.py").exists(), f"{script} lacks nao_io"
@@ -0,0 +1,52 @@
+// Shared helpers for the *_BATCH module variants, which run one lightweight job per work item in a single task.
+// Files in lib/ are automatically loaded by Nextflow and callable from workflow and process code.
+//
+// Typical use, with items of the form [sample, file]:
+//     batched_ch = items_ch.toList().flatMap { items -> BatchUtils.toBatches(items, batch_size) }
+//     out_ch = SOME_PROCESS_BATCH(batched_ch, ...).output.flatMap { samples, files -> BatchUtils.fromBatch(samples, files) }
+// Items are batched in sample order once the input channel closes, rather than in arrival order (as buffer() would),
+// so each batch, and hence its task hash, is the same on every run and -resume can reuse it.
+
+class BatchUtils {
+
+    // Convert a list of [sample, file] work items into a single [samples, files] batch.
+    static List toBatch(List items) {
+        return [items.collect { it[0] }, items.collect { it[1] }]
+    }
+
+    // Split a list of [sample, file] work items into [samples, files] batches of up to batchSize items, in sample order.
+    static List toBatches(List items, int batchSize) {
+        return items.sort(false) { it[0].toString() }.collate(batchSize).collect { batch -> toBatch(batch) }
+    }
+
+    // Split a *_BATCH process output back into [sample, file] items.
+    //   samples : sample IDs of the batch, in input order
+    //   files   : output files, each written to an "out_<i>" directory for the 1-based input position i
+    // Output files are matched to samples by directory rather than by the (unspecified) order of the output glob.
+    static List fromBatch(List samples, files) {
+        def fileList = (files instanceof List) ? files : [files]
+        def byIndex = fileList.collectEntries { f ->
+            [(f.getParent().getFileName().toString() - "out_") as Integer, f]
+        }
+        if (byIndex.size() != samples.size()) {
+            throw new IllegalStateException(
+                "Batch produced ${byIndex.size()} outputs for ${samples.size()} work items")
+        }
+        return samples.withIndex().collect { sample, i -> [sample, byIndex[i + 1]] }
+    }
+
+    // Split a *_BATCH process output whose files keep their final published names back into [sample, file] items.
+    //   samples : sample IDs of the batch, in input order
+    //   files   : output files, each named "<sample>_<suffix>" in the task directory
+    // Used where outputs are published directly, so they cannot carry an "out_<i>" directory.
+    static List fromNamedBatch(List samples, files, String suffix) {
+        def fileList = (files instanceof List) ? files : [files]
+        def byName = fileList.collectEntries { f -> [f.getFileName().toString(), f] }
+        def missing = samples.findAll { sample -> !byName.containsKey("${sample}_${suffix}".toString()) }
+        if (missing || byName.size() != samples.size()) {
+            throw new IllegalStateException(
+                "Batch produced ${byName.size()} outputs for ${samples.size()} work items (missing: ${missing})")
+        }
+        return samples.collect { sample -> [sample, byName["${sample}_${suffix}".toString()]] }
+    }
+}
@@ -3,27 +3,16 @@
 import argparse
 import csv
 import datetime
-import gzip
 import time
 from collections.abc import Iterator, Sequence
-from typing import IO, cast
+
+from nao_io import open_by_suffix
 
 
 def print_log(message: str) -> None:
     print("[", datetime.datetime.now(), "]  ", message, sep="")
 
 
-def open_by_suffix(filename: str, mode: str = "r", debug: bool = False) -> IO[str]:
-    """Open file with automatic decompression based on file extension."""
-    if debug:
-        print_log(f"\tOpening file object: {filename}")
-        print_log(f"\tOpening mode: {mode}")
-        print_log(f"\tGZIP mode: {filename.endswith('.gz')}")
-    if filename.endswith(".gz"):
-        return cast(IO[str], gzip.open(filename, mode + "t", encoding="utf-8"))
-    return open(filename, mode, encoding="utf-8")
-
-
 def validate_columns(
     fieldnames: Sequence[str], chk_col: str, if_col: str, else_col: str
 ) -> None:
@@ -20,3 +20,26 @@ process ADD_FIXED_COLUMN {
         ln -s ${tsv} input_${tsv}
         """
 }
+
+// Add one or more fixed-value columns to each TSV in a batch of (sample, TSV) work items, in one task
+// Outputs are written to out_<i>/ for the 1-based item index i; split with BatchUtils.fromBatch
+process ADD_FIXED_COLUMN_BATCH {
+    label "python"
+    label "single"
+    tag "id=batch,first=${samples[0]},n=${samples.size()}"
+    input:
+        tuple val(samples), path(tsvs, arity: "1..*", stageAs: "in_*/*")
+        val(column)
+        val(value)
+        val(label)
+    output:
+        tuple val(samples), path("out_*/labeled_${label}_*"), emit: output
+    script:
+        def jobs = tsvs.withIndex().collect { tsv, i ->
+            "mkdir out_${i + 1} && add_fixed_column.py ${tsv} ${column} ${value} out_${i + 1}/labeled_${label}_${tsv.name}"
+        }.join("\n")
+        """
+        set -euo pipefail
+        ${jobs}
+        """
+}
@@ -13,17 +13,16 @@ on per-file S3 GET latency × N files.
 ###########
 
 import argparse
-import gzip
 import logging
 import os
 import subprocess
 import time
 from datetime import UTC, datetime
 from pathlib import Path
-from typing import IO
 
 import pandas as pd
 from Bio.SeqIO.FastaIO import SimpleFastaParser
+from nao_io import open_by_suffix
 
 ###########
 # LOGGING #
@@ -49,13 +48,6 @@ logger.addHandler(handler)
 #############
 
 
-def open_by_suffix(filename: str | Path, mode: str = "r") -> IO[str]:
-    """Open `.gz` or plaintext FASTA transparently in text mode."""
-    if str(filename).endswith(".gz"):
-        return gzip.open(filename, mode + "t")  # type: ignore[return-value]
-    return open(filename, mode)
-
-
 def stage_genomes_parallel(
     filepaths: list[str], staged_dir: Path, parallelism: int
 ) -> None:
@@ -18,6 +18,27 @@ process ADD_SAMPLE_COLUMN {
         """
 }
 
+// Add a column to a TSV with sample ID, writing the result directly under its final name (<sample>_<outname>)
+// The input is staged in a subdirectory, as it may already carry the output name
+process ADD_SAMPLE_COLUMN_NAMED {
+    label "python"
+    label "single"
+    tag "id=${sample}"
+    input:
+        tuple val(sample), path(tsv, stageAs: "in/*")
+        val(sample_column)
+        val(outname)
+    output:
+        tuple val(sample), path("${sample}_${outname}"), emit: output
+        tuple val(sample), path("input_${tsv.name}"), emit: input
+    script:
+        """
+        add_sample_column.py ${tsv} ${sample} ${sample_column} ${sample}_${outname}
+        # Link input files for testing
+        ln -s ${tsv} input_${tsv.name}
+        """
+}
+
 // Add group_species column to list of TSVs, extracting species from filename
 process ADD_SAMPLE_COLUMN_LIST {
     label "python"
@@ -51,3 +72,26 @@ process ADD_SAMPLE_COLUMN_LIST {
         done
         """
 }
+
+// Add a sample ID column to each TSV in a batch of (sample, TSV) work items, in one task
+// Outputs are written to out_<i>/ for the 1-based item index i; split with BatchUtils.fromBatch
+process ADD_SAMPLE_COLUMN_BATCH {
+    label "python"
+    label "single"
+    tag "id=batch,first=${samples[0]},n=${samples.size()}"
+    input:
+        tuple val(samples), path(tsvs, arity: "1..*", stageAs: "in_*/*")
+        val(sample_column)
+        val(label)
+    output:
+        tuple val(samples), path("out_*/labeled_${label}_*"), emit: output
+    script:
+        def jobs = [samples, tsvs].transpose().withIndex().collect { item, i ->
+            def (sample, tsv) = item
+            "mkdir out_${i + 1} && add_sample_column.py ${tsv} ${sample} ${sample_column} out_${i + 1}/labeled_${label}_${tsv.name}"
+        }.join("\n")
+        """
+        set -euo pipefail
+        ${jobs}
+        """
+}
@@ -0,0 +1,18 @@
+// Build a memory-mappable genome ID -> taxid index for the viral SAM processors in RUN
+process BUILD_GENOME_TAXID_INDEX {
+    label "python"
+    label "single"
+    tag "id=index"
+    input:
+        path(genome_metadata)
+        path(virus_db)
+    output:
+        path("virus-genome-taxid-index.bin"), emit: index
+        path("input_${genome_metadata}"), emit: input
+    script:
+        """
+        build_genome_taxid_index.py ${genome_metadata} ${virus_db} virus-genome-taxid-index.bin
+        # Link input file for testing
+        ln -s ${genome_metadata} input_${genome_metadata}
+        """
+}
@@ -0,0 +1,84 @@
+#!/usr/bin/env python
+"""Build the memory-mappable genome ID -> (taxid, species taxid) index used by
+the viral SAM processors in RUN, from the genome metadata TSV (with a
+`genome_id` column) and the virus taxonomy DB. See genome_taxid_index.py for
+the file layout.
+"""
+
+###########
+# IMPORTS #
+###########
+
+import argparse
+import csv
+import logging
+import time
+from collections.abc import Iterator
+from datetime import UTC, datetime
+
+from genome_taxid_index import GenomeTaxidIndex, write_genome_taxid_index
+from nao_io import open_by_suffix
+
+###########
+# LOGGING #
+###########
+
+
+class UTCFormatter(logging.Formatter):
+    def formatTime(self, record: logging.LogRecord, datefmt: str | None = None) -> str:
+        return datetime.fromtimestamp(record.created, UTC).strftime(
+            "%Y-%m-%d %H:%M:%S UTC"
+        )
+
+
+logging.basicConfig(level=logging.INFO)
+logger = logging.getLogger()
+handler = logging.StreamHandler()
+handler.setFormatter(UTCFormatter("[%(asctime)s] %(message)s"))
+logger.handlers.clear()
+logger.addHandler(handler)
+
+#############
+# FUNCTIONS #
+#############
+
+
+def read_metadata(path: str) -> Iterator[tuple[str, str, str | None]]:
+    """Yield (genome_id, taxid, species_taxid) from the genome metadata TSV."""
+    with open_by_suffix(path) as f:
+        for row in csv.DictReader(f, delimiter="\t"):
+            yield row["genome_id"], row["taxid"], row.get("species_taxid")
+
+
+def read_viral_taxids(path: str) -> set[str]:
+    """Return the taxid column of the virus taxonomy DB."""
+    with open_by_suffix(path) as f:
+        return {row["taxid"] for row in csv.DictReader(f, delimiter="\t")}
+
+
+def parse_arguments() -> argparse.Namespace:
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("metadata", help="Genome metadata TSV with genome_id column.")
+    parser.add_argument("viral_db", help="Virus taxonomy DB TSV.")
+    parser.add_argument("output", help="Output index path.")
+    return parser.parse_args()
+
+
+def main() -> None:
+    start_time = time.time()
+    logger.info("Starting build_genome_taxid_index.")
+    args = parse_arguments()
+    viral_taxids = read_viral_taxids(args.viral_db)
+    logger.info("Read %d virus taxa.", len(viral_taxids))
+    records = read_metadata(args.metadata)
+    n = write_genome_taxid_index(records, viral_taxids, args.output)
+    # Reopen to validate the written file
+    index = GenomeTaxidIndex(args.output)
+    logger.info(
+        "Wrote %d genomes (%d viral taxids referenced).", n, len(index.viral_taxids)
+    )
+    logger.info("Total time elapsed: %.2f seconds", time.time() - start_time)
+
+
+if __name__ == "__main__":
+    main()
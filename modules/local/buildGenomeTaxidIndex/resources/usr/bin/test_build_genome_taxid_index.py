@@ -0,0 +1,142 @@
+"""Tests for build_genome_taxid_index.py and genome_taxid_index.py."""
+
+import csv
+import gzip
+from pathlib import Path
+
+import pytest
+from build_genome_taxid_index import read_metadata, read_viral_taxids
+from genome_taxid_index import (
+    GenomeTaxidIndex,
+    is_genome_taxid_index,
+    write_genome_taxid_index,
+)
+
+MODULES_DIR = Path(__file__).resolve().parents[4]
+TINY_RESULTS = MODULES_DIR.parent.parent / "test-data/tiny-index/output/results"
+
+
+def _write_tsv(path: Path, header: list[str], rows: list[list[str]]) -> Path:
+    with gzip.open(path, "wt", newline="") as f:
+        w = csv.writer(f, delimiter="\t", lineterminator="\n")
+        w.writerow(header)
+        w.writerows(rows)
+    return path
+
+
+@pytest.fixture
+def index_path(tmp_path: Path) -> Path:
+    path = tmp_path / "index.bin"
+    write_genome_taxid_index(
+        [
+            ("NC_2.1", "20", "200"),
+            ("NC_1.1", "10", "100"),
+            ("MN_3.1", "30", ""),
+        ],
+        ["10", "200", "999"],
+        str(path),
+    )
+    return path
+
+
+class TestGenomeTaxidIndex:
+    def test_lookup(self, index_path: Path) -> None:
+        index = GenomeTaxidIndex(str(index_path))
+        assert len(index) == 3
+        assert index["NC_1.1"] == ("10", "100")
+        assert index["NC_2.1"] == ("20", "200")
+        assert index["MN_3.1"] == ("30", None)
+        # Repeated lookups hit the cache
+        assert index["NC_1.1"] == ("10", "100")
+
+    def test_missing_genome(self, index_path: Path) -> None:
+        index = GenomeTaxidIndex(str(index_path))
+        with pytest.raises(KeyError):
+            index["NC_0.1"]
+        assert "NC_9.1" not in index
+
+    def test_iterates_sorted_ids(self, index_path: Path) -> None:
+        assert list(GenomeTaxidIndex(str(index_path))) == ["MN_3.1", "NC_1.1", "NC_2.1"]
+
+    def test_viral_taxids_limited_to_referenced(self, index_path: Path) -> None:
+        assert GenomeTaxidIndex(str(index_path)).viral_taxids == {"10", "200"}
+
+    def test_later_duplicate_wins(self, tmp_path: Path) -> None:
+        path = tmp_path / "dup.bin"
+        write_genome_taxid_index([("A", "1", "2"), ("A", "3", "4")], [], str(path))
+        assert dict(GenomeTaxidIndex(str(path))) == {"A": ("3", "4")}
+
+    def test_empty(self, tmp_path: Path) -> None:
+        path = tmp_path / "empty.bin"
+        write_genome_taxid_index([], ["1"], str(path))
+        index = GenomeTaxidIndex(str(path))
+        assert len(index) == 0
+        assert index.viral_taxids == set()
+        assert "A" not in index
+
+    def test_missing_taxid_rejected(self, tmp_path: Path) -> None:
+        with pytest.raises(ValueError, match="Missing taxid"):
+            write_genome_taxid_index([("A", "", "2")], [], str(tmp_path / "x.bin"))
+
+    def test_sniffs_and_rejects_other_files(
+        self, index_path: Path, tmp_path: Path
+    ) -> None:
+        tsv = _write_tsv(tmp_path / "meta.tsv.gz", ["genome_id"], [["A"]])
+        assert is_genome_taxid_index(str(index_path))
+        assert not is_genome_taxid_index(str(tsv))
+        with pytest.raises(ValueError):
+            GenomeTaxidIndex(str(tsv))
+
+    def test_truncated_rejected(self, index_path: Path, tmp_path: Path) -> None:
+        truncated = tmp_path / "truncated.bin"
+        truncated.write_bytes(index_path.read_bytes()[:-2])
+        with pytest.raises(ValueError, match="Truncated"):
+            GenomeTaxidIndex(str(truncated))
+
+
+class TestBuildFromTsvs:
+    def test_matches_metadata(self, tmp_path: Path) -> None:
+        meta = _write_tsv(
+            tmp_path / "meta.tsv.gz",
+            ["assembly_accession", "taxid", "species_taxid", "genome_id"],
+            [
+                ["GCF_1", "10", "100", "NC_1.1"],
+                ["GCF_1", "10", "100", "NC_1.2"],
+                ["GCF_2", "20", "200", "NC_2.1"],
+            ],
+        )
+        virus_db = _write_tsv(
+            tmp_path / "virus.tsv.gz", ["taxid", "name"], [["10", "a"], ["200", "b"]]
+        )
+        out = tmp_path / "index.bin"
+        write_genome_taxid_index(
+            read_metadata(str(meta)), read_viral_taxids(str(virus_db)), str(out)
+        )
+        index = GenomeTaxidIndex(str(out))
+        assert dict(index) == {
+            "NC_1.1": ("10", "100"),
+            "NC_1.2": ("10", "100"),
+            "NC_2.1": ("20", "200"),
+        }
+        assert index.viral_taxids == {"10", "200"}
+
+    @pytest.mark.skipif(
+        not (TINY_RESULTS / "virus-genome-taxid-index.bin").exists(),
+        reason="tiny index not available",
+    )
+    def test_tiny_index_in_sync(self, tmp_path: Path) -> None:
+        out = tmp_path / "index.bin"
+        write_genome_taxid_index(
+            read_metadata(str(TINY_RESULTS / "virus-genome-metadata-gid.tsv.gz")),
+            read_viral_taxids(str(TINY_RESULTS / "total-virus-db-annotated.tsv.gz")),
+            str(out),
+        )
+        committed = TINY_RESULTS / "virus-genome-taxid-index.bin"
+        assert out.read_bytes() == committed.read_bytes()
+
+
+def test_loader_copies_identical() -> None:
+    source = (Path(__file__).parent / "genome_taxid_index.py").read_bytes()
+    for module in ["processViralBowtie2Sam", "processViralMinimap2Sam"]:
+        copy = MODULES_DIR / module / "resources/usr/bin/genome_taxid_index.py"
+        assert copy.read_bytes() == source, f"{copy} is out of sync"
@@ -1,7 +1,9 @@
 /*
-Given a sorted TSV file with an initial header line, check that
-every line in the file has a unique value of the specified column.
-If not, throw an error.
+Given a TSV file with an initial header line, check that every line in the
+file has a unique value of the specified column. If not, throw an error.
+The input need not be sorted: values are checked via 64-bit fingerprints
+(about 8 bytes per row), with an exact second pass over only the values whose
+fingerprints collide.
 */
 
 process CHECK_TSV_DUPLICATES {
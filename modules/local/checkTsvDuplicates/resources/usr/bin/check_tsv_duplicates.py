@@ -1,9 +1,15 @@
 #!/usr/bin/env python
 
 """
-Given a sorted TSV file with an initial header line, check that
-every line in the file has a unique value of the specified column.
-If so, write the file to the output path. If not, throw an error.
+Given a TSV file with an initial header line, check that every line in
+the file has a unique value of the specified column. If so, write the file
+to the output path. If not, throw an error.
+
+The input need not be sorted. Each value is reduced to a 64-bit fingerprint,
+held in compact arrays (8 bytes per row) bucketed by their top bits, and
+duplicate fingerprints are found one bucket at a time. Only if fingerprints
+collide is the input read a second time, to compare the colliding values
+exactly; this separates true duplicates from fingerprint collisions.
 """
 
 # =======================================================================
@@ -11,11 +17,15 @@ If so, write the file to the output path. If not, throw an error.
 # =======================================================================
 
 import argparse
-import gzip
 import logging
 import time
+from array import array
+from collections import Counter
+from collections.abc import Iterator
 from datetime import UTC, datetime
-from typing import IO, cast
+from typing import IO
+
+from nao_io import TaskMetrics, iter_lines, open_by_suffix, write_lines
 
 # =======================================================================
 # Configure logging
@@ -36,6 +46,16 @@ handler.setFormatter(formatter)
 logger.handlers.clear()
 logger.addHandler(handler)
 
+# =======================================================================
+# Define constants
+# =======================================================================
+
+FINGERPRINT_MASK = (1 << 64) - 1
+# Fingerprints are bucketed by their top bits, so that duplicates can be
+# found with one bucket's worth of set memory at a time
+BUCKET_BITS = 8
+BUCKET_SHIFT = 64 - BUCKET_BITS
+
 # =======================================================================
 # I/O functions
 # =======================================================================
@@ -45,36 +65,19 @@ def parse_args() -> argparse.Namespace:
     """Parse command-line arguments."""
     # Create parser
     desc = (
-        "Given a sorted TSV file with an initial header line, "
+        "Given a TSV file with an initial header line, "
         "check that every line has a unique value of the specified column. "
         "If so, write the file to the output path. If not, throw an error."
     )
     parser = argparse.ArgumentParser(description=desc)
     # Add arguments
-    parser.add_argument("--input", "-i", help="Path to sorted input TSV.")
+    parser.add_argument("--input", "-i", help="Path to input TSV.")
     parser.add_argument("--output", "-o", help="Path to output TSV.")
     parser.add_argument("--field", "-f", help="Field to check for duplicates.")
     # Return parsed arguments
     return parser.parse_args()
 
 
-def open_by_suffix(filename: str, mode: str = "r") -> IO[str]:
-    """
-    Open a file with appropriate compression, based on the filename suffix.
-    Args:
-        filename (str): Path to file.
-        mode (str): Mode to open file in.
-    Returns:
-        IO[str]: File object.
-    """
-    logger.debug(f"\tOpening file object: {filename}")
-    logger.debug(f"\tOpening mode: {mode}")
-    logger.debug(f"\tGZIP mode: {filename.endswith('.gz')}")
-    if filename.lower().endswith(".gz"):
-        return cast(IO[str], gzip.open(filename, mode + "t"))
-    return open(filename, mode)
-
-
 # =======================================================================
 # TSV processing functions
 # =======================================================================
@@ -115,43 +118,128 @@ def process_header(header_line: str, field: str) -> int:
     return get_header_index(headers_in, field)
 
 
-def check_duplicates(input_path: str, output_path: str, field: str) -> None:
+def iter_rows(inf: IO[str]) -> Iterator[str]:
+    """
+    Iterate over the body lines of a TSV file, stopping at the first empty line.
+    Args:
+        inf (IO[str]): Open TSV file, positioned after the header.
+    Yields:
+        str: Each line, with surrounding whitespace removed.
+    """
+    for line in iter_lines(inf):
+        line = line.strip()
+        if not line:
+            return
+        yield line
+
+
+def fingerprint(value: str) -> int:
+    """
+    Compute a 64-bit fingerprint of a field value. Uses Python's built-in
+    string hash, which is randomized per process, so fingerprints are only
+    comparable within a single run of this script.
+    Args:
+        value (str): Field value.
+    Returns:
+        int: Unsigned 64-bit fingerprint.
+    """
+    return hash(value) & FINGERPRINT_MASK
+
+
+def fingerprint_rows(
+    inf: IO[str], index: int, buckets: list[array[int]]
+) -> Iterator[str]:
     """
-    Check for duplicates in specified field of a sorted TSV file.
+    Iterate over the body lines of a TSV file, adding the fingerprint of the
+    selected field of each to its bucket.
     Args:
-        input_path (str): Path to sorted input TSV file.
+        inf (IO[str]): Open TSV file, positioned after the header.
+        index (int): Index of field to fingerprint.
+        buckets (list[array[int]]): Fingerprint buckets to add to.
+    Yields:
+        str: Each line, as from iter_rows.
+    """
+    for line in iter_rows(inf):
+        fp = fingerprint(line.split("\t", index + 1)[index])
+        buckets[fp >> BUCKET_SHIFT].append(fp)
+        yield line
+
+
+def find_colliding_fingerprints(buckets: list[array[int]]) -> set[int]:
+    """
+    Find fingerprints that occur more than once.
+    Args:
+        buckets (list[array[int]]): Fingerprints, bucketed by their top bits.
+    Returns:
+        set[int]: Fingerprints seen on more than one row.
+    """
+    colliding: set[int] = set()
+    for bucket in buckets:
+        if len(set(bucket)) == len(bucket):
+            continue
+        colliding.update(fp for fp, n in Counter(bucket).items() if n > 1)
+    return colliding
+
+
+def verify_collisions(
+    input_path: str, index: int, colliding: set[int], field: str
+) -> None:
+    """
+    Compare the values behind colliding fingerprints exactly, raising an error
+    if any value is duplicated.
+    Args:
+        input_path (str): Path to input TSV file.
+        index (int): Index of field to check.
+        colliding (set[int]): Fingerprints seen on more than one row.
+        field (str): Field to check for duplicates.
+    """
+    seen: set[str] = set()
+    with open_by_suffix(input_path) as inf:
+        inf.readline()
+        for line in iter_rows(inf):
+            value = line.split("\t", index + 1)[index]
+            if fingerprint(value) not in colliding:
+                continue
+            if value in seen:
+                msg = f"Duplicate value found in field {field}: {value}"
+                logger.error(msg)
+                raise ValueError(msg)
+            seen.add(value)
+    logger.info(f"Fingerprint collisions between {len(seen)} distinct values.")
+
+
+def check_duplicates(
+    input_path: str,
+    output_path: str,
+    field: str,
+    metrics: TaskMetrics | None = None,
+) -> None:
+    """
+    Check for duplicates in specified field of a TSV file.
+    Args:
+        input_path (str): Path to input TSV file.
         output_path (str): Path to output TSV file.
         field (str): Field to check for duplicates.
+        metrics (TaskMetrics | None): Optional task metrics.
     """
-    with open_by_suffix(input_path) as inf, open_by_suffix(output_path, "w") as outf:
+    buckets = [array("Q") for _ in range(1 << BUCKET_BITS)]
+    with (
+        open_by_suffix(input_path, "r", metrics) as inf,
+        open_by_suffix(output_path, "w", metrics) as outf,
+    ):
         # Process header line
         header_line = inf.readline().strip()
         index = process_header(header_line, field)
         # Write header to output
         outf.write(header_line + "\n")
-        # Check body for duplicates
-        field_prev = None
-        for line in inf:
-            # If empty line, break
-            line = line.strip()
-            if not line:
-                break
-            # Get value of selected field
-            field_curr = line.split("\t")[index]
-            # Check file is sorted
-            if field_prev is not None and field_curr < field_prev:
-                msg = f"File is not sorted: {field_curr} < {field_prev}"
-                logger.error(msg)
-                raise ValueError(msg)
-            # Check if field is duplicate with previous line
-            if field_prev is not None and field_curr == field_prev:
-                msg = f"Duplicate value found in field {field}: {field_curr}"
-                logger.error(msg)
-                raise ValueError(msg)
-            # Write line to output
-            outf.write(line + "\n")
-            # Update previous field
-            field_prev = field_curr
+        # Fingerprint selected field while copying body to output
+        n_rows = write_lines(outf, fingerprint_rows(inf, index, buckets))
+    logger.info(f"Fingerprinted {n_rows} rows.")
+    colliding = find_colliding_fingerprints(buckets)
+    del buckets
+    if colliding:
+        logger.info(f"Verifying {len(colliding)} colliding fingerprints.")
+        verify_collisions(input_path, index, colliding, field)
 
 
 # =======================================================================
@@ -173,7 +261,8 @@ def main() -> None:
     logger.info(f"Field to check for duplicates: {field}")
     # Check for duplicates
     logger.info("Checking for duplicates.")
-    check_duplicates(input_path, output_path, field)
+    with TaskMetrics("check_tsv_duplicates") as metrics:
+        check_duplicates(input_path, output_path, field, metrics)
     # Finish time tracking
     logger.info("Script completed successfully.")
     end_time = time.time()
@@ -44,9 +44,9 @@ class TestCheckDuplicates:
                 "Duplicate value found",
             ),
             (
-                "id\tname\tvalue\n3\tcharlie\t30\n1\talice\t10\n",
+                "id\tname\tvalue\n3\talice\t10\n1\tbob\t20\n3\tcharlie\t30\n",
                 "id",
-                "File is not sorted",
+                "Duplicate value found in field id: 3",
             ),
             (
                 "id\tname\tvalue\n1\talice\t10\n",
@@ -59,7 +59,12 @@ class TestCheckDuplicates:
                 "No header to select fields from",
             ),
         ],
-        ids=["duplicate_values", "unsorted_file", "missing_field", "empty_header"],
+        ids=[
+            "duplicate_values",
+            "unsorted_duplicates",
+            "missing_field",
+            "empty_header",
+        ],
     )
     def test_check_duplicates_errors(
         self, tsv_factory: Any, input_content: str, field: str, expected_match: str
@@ -70,3 +75,41 @@ class TestCheckDuplicates:
 
         with pytest.raises(ValueError, match=expected_match):
             check_tsv_duplicates.check_duplicates(input_file, output_file, field)
+
+    def test_unsorted_input(self, tsv_factory: Any) -> None:
+        """Test unsorted file with no duplicates passes unchanged."""
+        input_content = "id\tname\n3\tcharlie\n1\talice\n2\tbob\n"
+        input_file = tsv_factory.create_plain("input.tsv", input_content)
+        output_file = tsv_factory.get_path("output.tsv")
+        check_tsv_duplicates.check_duplicates(input_file, output_file, "id")
+        assert tsv_factory.read_plain(output_file) == input_content
+
+
+class TestFingerprintCollisions:
+    """Test exact verification of colliding fingerprints."""
+
+    @pytest.fixture(autouse=True)
+    def colliding_fingerprints(self, monkeypatch: pytest.MonkeyPatch) -> None:
+        """Map every value starting with "c" to the same fingerprint."""
+        original = check_tsv_duplicates.fingerprint
+
+        def fingerprint(value: str) -> int:
+            return 42 if value.startswith("c") else original(value)
+
+        monkeypatch.setattr(check_tsv_duplicates, "fingerprint", fingerprint)
+
+    def test_collision_without_duplicates(self, tsv_factory: Any) -> None:
+        """Test distinct values with colliding fingerprints pass."""
+        input_content = "id\tname\nc1\ta\nb\tb\nc2\tc\nc3\td\n"
+        input_file = tsv_factory.create_plain("input.tsv", input_content)
+        output_file = tsv_factory.get_path("output.tsv")
+        check_tsv_duplicates.check_duplicates(input_file, output_file, "id")
+        assert tsv_factory.read_plain(output_file) == input_content
+
+    def test_collision_with_duplicates(self, tsv_factory: Any) -> None:
+        """Test duplicates among colliding fingerprints are found."""
+        input_content = "id\tname\nc1\ta\nb\tb\nc2\tc\nc1\td\n"
+        input_file = tsv_factory.create_gzip("input.tsv.gz", input_content)
+        output_file = tsv_factory.get_path("output.tsv.gz")
+        with pytest.raises(ValueError, match="Duplicate value found in field id: c1"):
+            check_tsv_duplicates.check_duplicates(input_file, output_file, "id")
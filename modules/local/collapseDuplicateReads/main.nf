@@ -0,0 +1,39 @@
+// Collapse reads (or interleaved read pairs) with identical sequences and qualities to one representative before alignment
+process COLLAPSE_DUPLICATE_READS {
+    label "python"
+    label "single"
+    tag "id=${sample}"
+    input:
+        tuple val(sample), path(reads)
+        val(interleaved)
+    output:
+        tuple val(sample), path("${sample}_collapsed.fastq.gz"), path("${sample}_duplicate_reads.tsv.gz"), emit: output
+        tuple val(sample), path("input_${reads}"), emit: input
+    script:
+        """
+        collapse_duplicate_reads.py -i ${reads} -o ${sample}_collapsed.fastq.gz -d ${sample}_duplicate_reads.tsv.gz ${interleaved ? "--interleaved" : ""}
+        # Link input to output for testing
+        ln -s ${reads} input_${reads}
+        """
+}
+
+// Expand the SAM alignments and mapped reads of collapsed representatives back to every original read
+process EXPAND_DUPLICATE_READS {
+    label "python"
+    label "single"
+    tag "id=${sample}"
+    input:
+        tuple val(sample), path(sam), path(reads_mapped), path(duplicates)
+        val(suffix)
+    output:
+        tuple val(sample), path("${sample}_${suffix}_expanded.sam.gz"), emit: sam
+        tuple val(sample), path("${sample}_${suffix}_expanded.fastq.gz"), emit: reads_mapped
+        tuple val(sample), path("input_${sam}"), emit: input
+    script:
+        def out = "--out-sam ${sample}_${suffix}_expanded.sam.gz --out-fastq ${sample}_${suffix}_expanded.fastq.gz"
+        """
+        expand_duplicate_reads.py -s ${sam} -f ${reads_mapped} -d ${duplicates} ${out}
+        # Link input to output for testing
+        ln -s ${sam} input_${sam}
+        """
+}
@@ -0,0 +1,216 @@
+#!/usr/bin/env python
+
+DESC = """
+Collapse exact duplicate reads in a FASTQ file (or read pairs in an
+interleaved FASTQ file) to a single representative before alignment. Reads
+are duplicates if their sequences and quality strings are all identical, so
+that an aligner scores every copy identically. The first copy of each read is
+kept, in input order, and every later copy is written to a TSV mapping its
+read ID to the representative's read ID, from which the representative's
+alignments can be expanded back to every original read.
+"""
+
+# =======================================================================
+# Import libraries
+# =======================================================================
+
+import argparse
+import hashlib
+import logging
+import time
+from collections.abc import Iterator
+from datetime import UTC, datetime
+
+from nao_io import TaskMetrics, iter_lines, open_by_suffix, write_lines
+
+# =======================================================================
+# Configure logging
+# =======================================================================
+
+
+class UTCFormatter(logging.Formatter):
+    def formatTime(self, record: logging.LogRecord, datefmt: str | None = None) -> str:
+        dt = datetime.fromtimestamp(record.created, UTC)
+        return dt.strftime("%Y-%m-%d %H:%M:%S UTC")
+
+
+logging.basicConfig(level=logging.INFO)
+logger = logging.getLogger()
+handler = logging.StreamHandler()
+formatter = UTCFormatter("[%(asctime)s] %(message)s")
+handler.setFormatter(formatter)
+logger.handlers.clear()
+logger.addHandler(handler)
+
+# =======================================================================
+# Define constants
+# =======================================================================
+
+DUPLICATES_HEADER = "seq_id\trepresentative_id"
+# Digest size (bytes) of the per-read content key; 128 bits makes a collision
+# between distinct reads vanishingly unlikely at any realistic read count
+DIGEST_SIZE = 16
+# Lines buffered per output before writing
+BATCH_LINES = 8192
+
+# =======================================================================
+# I/O functions
+# =======================================================================
+
+
+def parse_args() -> argparse.Namespace:
+    """Parse command-line arguments."""
+    # Create parser
+    parser = argparse.ArgumentParser(description=DESC)
+    # Add arguments
+    parser.add_argument("--input", "-i", required=True, help="Path to input FASTQ.")
+    parser.add_argument(
+        "--output", "-o", required=True, help="Path to collapsed output FASTQ."
+    )
+    parser.add_argument(
+        "--duplicates",
+        "-d",
+        required=True,
+        help="Path to output TSV mapping duplicate read IDs to representatives.",
+    )
+    parser.add_argument(
+        "--interleaved",
+        action="store_true",
+        help="Input is interleaved paired-end; collapse whole read pairs.",
+    )
+    # Parse arguments
+    return parser.parse_args()
+
+
+def iter_records(lines: Iterator[str], size: int) -> Iterator[list[str]]:
+    """Group FASTQ lines into reads (size 4) or read pairs (size 8).
+    Args:
+        lines: FASTQ lines, without trailing newlines.
+        size: Number of lines per record.
+    Yields:
+        Lines of each record.
+    """
+    record: list[str] = []
+    for line in lines:
+        record.append(line)
+        if len(record) == size:
+            for i in range(0, size, 4):
+                if not record[i].startswith("@") or not record[i + 2].startswith("+"):
+                    raise ValueError(f"Malformed FASTQ record: {record[i]}")
+            yield record
+            record = []
+    if any(record):
+        raise ValueError(f"Truncated FASTQ record: {record[0]}")
+
+
+# =======================================================================
+# Collapsing functions
+# =======================================================================
+
+
+def read_id(header: str, paired: bool) -> str:
+    """Get the read ID an aligner reports for a FASTQ header line.
+    Args:
+        header: FASTQ header line, including the leading "@".
+        paired: Whether the read is one mate of a pair, in which case a
+            trailing "/1" or "/2" is dropped, as by Bowtie2.
+    Returns:
+        Read ID (SAM QNAME).
+    """
+    name = header[1:].split(maxsplit=1)[0] if len(header) > 1 else ""
+    if paired and name[-2:] in ("/1", "/2"):
+        name = name[:-2]
+    return name
+
+
+def content_key(record: list[str]) -> bytes:
+    """Digest the sequence and quality lines of a read or read pair.
+    Args:
+        record: Lines of a read or read pair.
+    Returns:
+        Fixed-size digest that is equal for exact duplicates.
+    """
+    lines = (record[i + j] for i in range(0, len(record), 4) for j in (1, 3))
+    content = "\n".join(lines)
+    return hashlib.blake2b(content.encode(), digest_size=DIGEST_SIZE).digest()
+
+
+def collapse_reads(
+    input_path: str,
+    output_path: str,
+    duplicates_path: str,
+    interleaved: bool,
+    metrics: TaskMetrics | None = None,
+) -> tuple[int, int]:
+    """Write the first copy of each distinct read (pair) and map later copies
+    to it.
+    Args:
+        input_path: Path to input FASTQ.
+        output_path: Path to collapsed output FASTQ.
+        duplicates_path: Path to output duplicate-to-representative TSV.
+        interleaved: Whether to collapse interleaved read pairs.
+        metrics: Optional task metrics.
+    Returns:
+        Number of input reads (pairs) and of representatives written.
+    """
+    size = 8 if interleaved else 4
+    representatives: dict[bytes, str] = {}
+    n_records = 0
+    with (
+        open_by_suffix(input_path, "r", metrics) as inf,
+        open_by_suffix(output_path, "w", metrics) as outf,
+        open_by_suffix(duplicates_path, "w", metrics) as dupf,
+    ):
+        dupf.write(DUPLICATES_HEADER + "\n")
+        kept: list[str] = []
+        duplicates: list[str] = []
+        for record in iter_records(iter_lines(inf), size):
+            n_records += 1
+            name = read_id(record[0], interleaved)
+            if interleaved and read_id(record[4], interleaved) != name:
+                raise ValueError(f"Mate read IDs differ: {record[0]}, {record[4]}")
+            representative = representatives.setdefault(content_key(record), name)
+            if representative == name:
+                kept.extend(record)
+            else:
+                duplicates.append(f"{name}\t{representative}")
+            if len(kept) >= BATCH_LINES:
+                write_lines(outf, kept)
+                kept.clear()
+            if len(duplicates) >= BATCH_LINES:
+                write_lines(dupf, duplicates)
+                duplicates.clear()
+        write_lines(outf, kept)
+        write_lines(dupf, duplicates)
+    return n_records, len(representatives)
+
+
+# =======================================================================
+# Main function
+# =======================================================================
+
+
+def main() -> None:
+    logger.info("Initializing script.")
+    start_time = time.time()
+    # Parse arguments
+    logger.info("Parsing arguments.")
+    args = parse_args()
+    logger.info(f"Arguments: {args}")
+    # Collapse reads
+    with TaskMetrics("collapse_duplicate_reads") as metrics:
+        logger.info("Collapsing exact duplicate reads.")
+        with metrics.phase("collapse"):
+            n_records, n_kept = collapse_reads(
+                args.input, args.output, args.duplicates, args.interleaved, metrics
+            )
+    unit = "read pairs" if args.interleaved else "reads"
+    logger.info(f"Kept {n_kept} of {n_records} {unit}.")
+    # Log completion
+    logger.info("Script completed successfully.")
+    end_time = time.time()
+    logger.info(f"Total time elapsed: {end_time - start_time} seconds")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,261 @@
+#!/usr/bin/env python
+
+DESC = """
+Expand the alignments of collapsed reads back to every original read. Given a
+SAM file and a FASTQ file of mapped reads produced by aligning the output of
+collapse_duplicate_reads.py, and its TSV mapping duplicate read IDs to
+representative read IDs, write each representative's SAM records and FASTQ
+records once under its own read ID and once under the read ID of each of its
+duplicates. Header lines are copied unchanged, and each duplicate's records
+directly follow its representative's.
+"""
+
+# =======================================================================
+# Import libraries
+# =======================================================================
+
+import argparse
+import itertools
+import logging
+import time
+from collections.abc import Callable, Iterator
+from datetime import UTC, datetime
+
+from nao_io import TaskMetrics, iter_lines, open_by_suffix, write_lines
+
+# =======================================================================
+# Configure logging
+# =======================================================================
+
+
+class UTCFormatter(logging.Formatter):
+    def formatTime(self, record: logging.LogRecord, datefmt: str | None = None) -> str:
+        dt = datetime.fromtimestamp(record.created, UTC)
+        return dt.strftime("%Y-%m-%d %H:%M:%S UTC")
+
+
+logging.basicConfig(level=logging.INFO)
+logger = logging.getLogger()
+handler = logging.StreamHandler()
+formatter = UTCFormatter("[%(asctime)s] %(message)s")
+handler.setFormatter(formatter)
+logger.handlers.clear()
+logger.addHandler(handler)
+
+# =======================================================================
+# Define constants
+# =======================================================================
+
+DUPLICATES_HEADER = "seq_id\trepresentative_id"
+
+# =======================================================================
+# I/O functions
+# =======================================================================
+
+
+def parse_args() -> argparse.Namespace:
+    """Parse command-line arguments."""
+    # Create parser
+    parser = argparse.ArgumentParser(description=DESC)
+    # Add arguments
+    parser.add_argument("--sam", "-s", required=True, help="Path to input SAM.")
+    parser.add_argument(
+        "--fastq", "-f", required=True, help="Path to input FASTQ of mapped reads."
+    )
+    parser.add_argument(
+        "--duplicates",
+        "-d",
+        required=True,
+        help="Path to TSV mapping duplicate read IDs to representatives.",
+    )
+    parser.add_argument("--out-sam", required=True, help="Path to output SAM.")
+    parser.add_argument("--out-fastq", required=True, help="Path to output FASTQ.")
+    # Parse arguments
+    return parser.parse_args()
+
+
+def read_duplicates(
+    duplicates_path: str, metrics: TaskMetrics | None = None
+) -> dict[str, list[str]]:
+    """Read the duplicate read IDs of each representative.
+    Args:
+        duplicates_path: Path to duplicate-to-representative TSV.
+        metrics: Optional task metrics.
+    Returns:
+        Duplicate read IDs keyed by representative read ID, in input order.
+    """
+    duplicates: dict[str, list[str]] = {}
+    with open_by_suffix(duplicates_path, "r", metrics) as inf:
+        header_line = inf.readline().rstrip("\n")
+        if header_line != DUPLICATES_HEADER:
+            raise ValueError(f"Unexpected duplicates header: {header_line}")
+        for line in iter_lines(inf):
+            seq_id, representative = line.split("\t")
+            duplicates.setdefault(representative, []).append(seq_id)
+    return duplicates
+
+
+# =======================================================================
+# Expansion functions
+# =======================================================================
+
+
+def sam_qname(line: str) -> str:
+    """Get the read ID of a SAM alignment line."""
+    return line.split("\t", 1)[0]
+
+
+def rename_sam(line: str, name: str) -> str:
+    """Replace the read ID of a SAM alignment line."""
+    return name + "\t" + line.split("\t", 1)[1]
+
+
+def fastq_name(header: str) -> str:
+    """Get the read ID of a FASTQ header line."""
+    return header[1:].split(" ", 1)[0]
+
+
+def rename_fastq(header: str, name: str) -> str:
+    """Replace the read ID of a FASTQ header line, keeping any comment."""
+    _, sep, comment = header.partition(" ")
+    return "@" + name + sep + comment
+
+
+def expand_blocks(
+    blocks: Iterator[tuple[str, list[str]]],
+    duplicates: dict[str, list[str]],
+    rename: Callable[[str, str], str],
+    lines_per_record: int,
+) -> Iterator[str]:
+    """Repeat each block of records under the read ID of each duplicate.
+    Args:
+        blocks: Read IDs and lines of consecutive records sharing that ID.
+        duplicates: Duplicate read IDs keyed by representative read ID.
+        rename: Function replacing the read ID in a record's first line.
+        lines_per_record: Number of lines in each record.
+    Yields:
+        Lines of each block, followed by lines of its renamed copies.
+    """
+    for name, block in blocks:
+        yield from block
+        for duplicate in duplicates.get(name, ()):
+            for i, line in enumerate(block):
+                yield rename(line, duplicate) if i % lines_per_record == 0 else line
+
+
+def group_records(
+    lines: Iterator[str], get_name: Callable[[str], str], lines_per_record: int
+) -> Iterator[tuple[str, list[str]]]:
+    """Group consecutive records with the same read ID.
+    Args:
+        lines: Record lines, without header lines.
+        get_name: Function getting the read ID from a record's first line.
+        lines_per_record: Number of lines in each record.
+    Yields:
+        Read ID and lines of each group of records.
+    """
+    name: str | None = None
+    block: list[str] = []
+    for i, line in enumerate(lines):
+        if i % lines_per_record == 0:
+            line_name = get_name(line)
+            if line_name != name:
+                if name is not None:
+                    yield name, block
+                name, block = line_name, []
+        block.append(line)
+    if name is not None:
+        yield name, block
+
+
+def expand_sam(
+    input_path: str,
+    output_path: str,
+    duplicates: dict[str, list[str]],
+    metrics: TaskMetrics | None = None,
+) -> int:
+    """Expand the alignments of representatives in a SAM file.
+    Args:
+        input_path: Path to input SAM.
+        output_path: Path to output SAM.
+        duplicates: Duplicate read IDs keyed by representative read ID.
+        metrics: Optional task metrics.
+    Returns:
+        Number of lines written.
+    """
+    with (
+        open_by_suffix(input_path, "r", metrics) as inf,
+        open_by_suffix(output_path, "w", metrics) as outf,
+    ):
+        lines = iter_lines(inf)
+        header: list[str] = []
+        alignments: Iterator[str] = iter(())
+        for line in lines:
+            if not line.startswith("@"):
+                alignments = itertools.chain([line], lines)
+                break
+            header.append(line)
+        blocks = group_records(alignments, sam_qname, 1)
+        expanded = expand_blocks(blocks, duplicates, rename_sam, 1)
+        return write_lines(outf, header) + write_lines(outf, expanded)
+
+
+def expand_fastq(
+    input_path: str,
+    output_path: str,
+    duplicates: dict[str, list[str]],
+    metrics: TaskMetrics | None = None,
+) -> int:
+    """Expand the records of representatives in a FASTQ file.
+    Args:
+        input_path: Path to input FASTQ.
+        output_path: Path to output FASTQ.
+        duplicates: Duplicate read IDs keyed by representative read ID.
+        metrics: Optional task metrics.
+    Returns:
+        Number of lines written.
+    """
+    with (
+        open_by_suffix(input_path, "r", metrics) as inf,
+        open_by_suffix(output_path, "w", metrics) as outf,
+    ):
+        blocks = group_records(iter_lines(inf), fastq_name, 4)
+        return write_lines(outf, expand_blocks(blocks, duplicates, rename_fastq, 4))
+
+
+# =======================================================================
+# Main function
+# =======================================================================
+
+
+def main() -> None:
+    logger.info("Initializing script.")
+    start_time = time.time()
+    # Parse arguments
+    logger.info("Parsing arguments.")
+    args = parse_args()
+    logger.info(f"Arguments: {args}")
+    with TaskMetrics("expand_duplicate_reads") as metrics:
+        # Read duplicate mapping
+        logger.info("Reading duplicate read IDs.")
+        with metrics.phase("read_duplicates"):
+            duplicates = read_duplicates(args.duplicates, metrics)
+        n_duplicates = sum(len(ids) for ids in duplicates.values())
+        logger.info(f"Read {n_duplicates} duplicates of {len(duplicates)} reads.")
+        # Expand alignments and mapped reads
+        logger.info("Expanding SAM alignments.")
+        with metrics.phase("expand_sam"):
+            n_sam = expand_sam(args.sam, args.out_sam, duplicates, metrics)
+        logger.info(f"Wrote {n_sam} SAM lines.")
+        logger.info("Expanding mapped FASTQ reads.")
+        with metrics.phase("expand_fastq"):
+            n_fastq = expand_fastq(args.fastq, args.out_fastq, duplicates, metrics)
+        logger.info(f"Wrote {n_fastq // 4} FASTQ reads.")
+    # Log completion
+    logger.info("Script completed successfully.")
+    end_time = time.time()
+    logger.info(f"Total time elapsed: {end_time - start_time} seconds")
+
+
+if __name__ == "__main__":
+    main()
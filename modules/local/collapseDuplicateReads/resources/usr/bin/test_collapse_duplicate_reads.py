@@ -0,0 +1,95 @@
+#!/usr/bin/env python
+
+from typing import Any
+
+import pytest
+from collapse_duplicate_reads import collapse_reads, content_key, read_id
+
+
+def fastq(*reads: tuple[str, str, str]) -> str:
+    """Build FASTQ text from (header, sequence, quality) tuples."""
+    return "".join(f"@{h}\n{s}\n+\n{q}\n" for h, s, q in reads)
+
+
+PAIRS = fastq(
+    ("r1 1:N", "ACGT", "IIII"),
+    ("r1 2:N", "TTGA", "IIII"),
+    ("r2 1:N", "ACGT", "IIII"),
+    ("r2 2:N", "TTGA", "IIII"),
+    ("r3 1:N", "ACGT", "IIII"),
+    ("r3 2:N", "TTGA", "II#I"),
+    ("r4 1:N", "ACGT", "IIII"),
+    ("r4 2:N", "TTGA", "IIII"),
+    ("r5 1:N", "TTGA", "IIII"),
+    ("r5 2:N", "ACGT", "IIII"),
+)
+
+
+class TestReadId:
+    def test_strips_comment(self) -> None:
+        assert read_id("@r1 1:N:0:ACGT", paired=True) == "r1"
+
+    def test_strips_mate_suffix_when_paired(self) -> None:
+        assert read_id("@r1/1", paired=True) == "r1"
+        assert read_id("@r1/2", paired=True) == "r1"
+        assert read_id("@r1/1", paired=False) == "r1/1"
+
+    def test_content_key_ignores_headers(self) -> None:
+        a = ["@a", "ACGT", "+", "IIII"]
+        b = ["@b x", "ACGT", "+a", "IIII"]
+        assert content_key(a) == content_key(b)
+        assert content_key(a) != content_key(["@a", "ACGT", "+", "III#"])
+
+
+class TestCollapseReads:
+    def run(self, tsv_factory: Any, text: str, interleaved: bool) -> tuple:
+        reads = tsv_factory.create_gzip("in.fastq.gz", text)
+        out = tsv_factory.get_path("out.fastq.gz")
+        dups = tsv_factory.get_path("dups.tsv.gz")
+        counts = collapse_reads(reads, out, dups, interleaved)
+        return counts, tsv_factory.read_gzip(out), tsv_factory.read_gzip(dups)
+
+    def test_collapses_identical_pairs(self, tsv_factory: Any) -> None:
+        counts, out, dups = self.run(tsv_factory, PAIRS, interleaved=True)
+        assert counts == (5, 3)
+        # First copy kept in input order; qualities and mate order matter
+        names = [line.split()[0] for line in out.splitlines()[::4]]
+        assert names == ["@r1", "@r1", "@r3", "@r3", "@r5", "@r5"]
+        assert dups.splitlines() == [
+            "seq_id\trepresentative_id",
+            "r2\tr1",
+            "r4\tr1",
+        ]
+
+    def test_collapses_single_reads(self, tsv_factory: Any) -> None:
+        counts, out, dups = self.run(tsv_factory, PAIRS, interleaved=False)
+        assert counts == (10, 3)
+        assert out.splitlines()[::4] == ["@r1 1:N", "@r1 2:N", "@r3 2:N"]
+        assert dups.splitlines()[1:4] == ["r2\tr1", "r2\tr1", "r3\tr1"]
+
+    def test_no_duplicates_unchanged(self, tsv_factory: Any) -> None:
+        text = fastq(("a", "AC", "II"), ("b", "AG", "II"))
+        counts, out, dups = self.run(tsv_factory, text, interleaved=False)
+        assert counts == (2, 2)
+        assert out == text
+        assert dups == "seq_id\trepresentative_id\n"
+
+    def test_empty_input(self, tsv_factory: Any) -> None:
+        counts, out, dups = self.run(tsv_factory, "", interleaved=True)
+        assert counts == (0, 0)
+        assert out == ""
+        assert dups == "seq_id\trepresentative_id\n"
+
+    def test_mismatched_mates_raise_error(self, tsv_factory: Any) -> None:
+        text = fastq(("a 1", "AC", "II"), ("b 2", "AG", "II"))
+        with pytest.raises(ValueError, match="Mate read IDs differ"):
+            self.run(tsv_factory, text, interleaved=True)
+
+    def test_truncated_input_raises_error(self, tsv_factory: Any) -> None:
+        text = fastq(("a 1", "AC", "II"), ("a 2", "AG", "II"))
+        with pytest.raises(ValueError, match="Truncated FASTQ record"):
+            self.run(tsv_factory, text + "@b 1\nAC\n", interleaved=True)
+
+    def test_malformed_input_raises_error(self, tsv_factory: Any) -> None:
+        with pytest.raises(ValueError, match="Malformed FASTQ record"):
+            self.run(tsv_factory, "a\nAC\n+\nII\n", interleaved=False)
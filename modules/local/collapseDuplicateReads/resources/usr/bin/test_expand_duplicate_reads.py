@@ -0,0 +1,96 @@
+#!/usr/bin/env python
+
+from typing import Any
+
+import pytest
+from collapse_duplicate_reads import collapse_reads
+from expand_duplicate_reads import expand_fastq, expand_sam, read_duplicates
+
+DUPLICATES = "seq_id\trepresentative_id\nr2\tr1\nr4\tr1\nr6\tr5\n"
+SAM = (
+    "@HD\tVN:1.0\n"
+    "@PG\tID:bowtie2\n"
+    "r1\t99\tg1\t10\t40\t4M\t=\t20\t14\tACGT\tIIII\tAS:i:8\n"
+    "r1\t147\tg1\t20\t40\t4M\t=\t10\t-14\tTCAA\tIIII\tAS:i:8\n"
+    "r3\t0\tg2\t5\t40\t4M\t*\t0\t0\tACGT\tII#I\tAS:i:7\n"
+    "r5\t0\tg2\t7\t40\t4M\t*\t0\t0\tTTGA\tIIII\tAS:i:8\n"
+)
+FASTQ = "@r1 1\nACGT\n+\nIIII\n@r1 2\nTTGA\n+\nIIII\n@r5\nTTGA\n+\nIIII\n"
+
+
+def fields(lines: list[str], index: int) -> list[str]:
+    """Get one field of every tab-separated line."""
+    return [line.split("\t")[index] for line in lines]
+
+
+class TestExpandDuplicateReads:
+    @pytest.fixture
+    def duplicates(self, tsv_factory: Any) -> dict[str, list[str]]:
+        return read_duplicates(tsv_factory.create_gzip("dups.tsv.gz", DUPLICATES))
+
+    def test_read_duplicates(self, duplicates: dict[str, list[str]]) -> None:
+        assert duplicates == {"r1": ["r2", "r4"], "r5": ["r6"]}
+
+    def test_bad_duplicates_header(self, tsv_factory: Any) -> None:
+        path = tsv_factory.create_plain("dups.tsv", "a\tb\n")
+        with pytest.raises(ValueError, match="Unexpected duplicates header"):
+            read_duplicates(path)
+
+    def test_expand_sam(self, tsv_factory: Any, duplicates: dict) -> None:
+        sam = tsv_factory.create_gzip("in.sam.gz", SAM)
+        out = tsv_factory.get_path("out.sam.gz")
+        assert expand_sam(sam, out, duplicates) == 11
+        lines = tsv_factory.read_gzip(out).splitlines()
+        assert lines[:2] == SAM.splitlines()[:2]
+        body = lines[2:]
+        expected = ["r1", "r1", "r2", "r2", "r4", "r4", "r3", "r5", "r6"]
+        assert fields(body, 0) == expected
+        # Copies differ from their representative's records only in the read ID
+        originals = {line.split("\t", 1)[1] for line in SAM.splitlines()[2:]}
+        assert {line.split("\t", 1)[1] for line in body} == originals
+
+    def test_expand_sam_header_only(self, tsv_factory: Any, duplicates: dict) -> None:
+        sam = tsv_factory.create_plain("in.sam", "@HD\tVN:1.0\n")
+        out = tsv_factory.get_path("out.sam")
+        assert expand_sam(sam, out, duplicates) == 1
+        assert tsv_factory.read_plain(out) == "@HD\tVN:1.0\n"
+
+    def test_expand_fastq(self, tsv_factory: Any, duplicates: dict) -> None:
+        fastq = tsv_factory.create_gzip("in.fastq.gz", FASTQ)
+        out = tsv_factory.get_path("out.fastq.gz")
+        assert expand_fastq(fastq, out, duplicates) == 32
+        lines = tsv_factory.read_gzip(out).splitlines()
+        assert lines[::4] == [
+            "@r1 1",
+            "@r1 2",
+            "@r2 1",
+            "@r2 2",
+            "@r4 1",
+            "@r4 2",
+            "@r5",
+            "@r6",
+        ]
+        assert lines[9::4] == ["ACGT", "TTGA", "ACGT", "TTGA", "TTGA", "TTGA"]
+
+    def test_round_trip_matches_uncollapsed(self, tsv_factory: Any) -> None:
+        """Expanding an identity 'alignment' of collapsed reads restores every
+        original read."""
+        reads = "".join(
+            f"@{name} {mate}\n{seq}\n+\n{qual}\n"
+            for name, seq, qual in [
+                ("a", "ACGT", "IIII"),
+                ("b", "ACGT", "IIII"),
+                ("c", "ACGA", "IIII"),
+                ("d", "ACGT", "IIII"),
+            ]
+            for mate in (1, 2)
+        )
+        path = tsv_factory.create_plain("reads.fastq", reads)
+        collapsed = tsv_factory.get_path("collapsed.fastq")
+        dups = tsv_factory.get_path("dups.tsv")
+        collapse_reads(path, collapsed, dups, interleaved=True)
+        out = tsv_factory.get_path("out.fastq")
+        expand_fastq(collapsed, out, read_duplicates(dups))
+        expected = reads.splitlines()
+        observed = tsv_factory.read_plain(out).splitlines()
+        assert sorted(zip(*[iter(observed)] * 4)) == sorted(zip(*[iter(expected)] * 4))
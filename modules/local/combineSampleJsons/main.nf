@@ -1,16 +1,18 @@
-// Combine per-sample JSON files into a single per-group JSON
+// Combine per-sample JSON files into a single per-group JSON, written directly under its final name (<group>_<outname>)
+// Inputs are staged in a subdirectory, as a single-sample group's input may already carry the output name
 process COMBINE_SAMPLE_JSONS {
     label "python"
     label "single"
     tag "id=${group}"
     input:
-        tuple val(group), path(json_files)
+        tuple val(group), path(json_files, stageAs: "in/*")
         val(suffix)
+        val(outname)
     output:
-        tuple val(group), path("${group}_combined.json"), emit: output
+        tuple val(group), path("${group}_${outname}"), emit: output
     script:
         """
         combine_sample_jsons.py --group ${group} --suffix ${suffix} \
-            --output ${group}_combined.json ${json_files}
+            --output ${group}_${outname} ${json_files}
         """
 }
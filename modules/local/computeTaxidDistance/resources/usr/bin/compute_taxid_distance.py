@@ -13,12 +13,12 @@ in the corresponding distance column.
 # =======================================================================
 
 import argparse
-import gzip
 import logging
 import time
 from collections import defaultdict
 from datetime import UTC, datetime
-from typing import IO, cast
+
+from nao_io import open_by_suffix
 
 # =======================================================================
 # Configure logging
@@ -80,14 +80,6 @@ def parse_args() -> argparse.Namespace:
     return parser.parse_args()
 
 
-def open_by_suffix(filename: str, mode: str = "r", debug: bool = False) -> IO[str]:
-    """Parse the suffix of a filename to determine the right open method
-    to use, then open the file. Can handle .gz and uncompressed files."""
-    if filename.endswith(".gz"):
-        return cast(IO[str], gzip.open(filename, mode + "t"))
-    return open(filename, mode)
-
-
 # =======================================================================
 # TSV processing functions
 # =======================================================================
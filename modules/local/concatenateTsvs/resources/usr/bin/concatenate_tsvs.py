@@ -3,25 +3,16 @@
 # Import modules
 import argparse
 import datetime
-import gzip
 import time
-from typing import IO, cast
+from typing import IO
+
+from nao_io import open_by_suffix
 
 
 def print_log(message: str) -> None:
     print("[", datetime.datetime.now(), "]  ", message, sep="")
 
 
-def open_by_suffix(filename: str, mode: str = "r", debug: bool = False) -> IO[str]:
-    if debug:
-        print_log(f"\tOpening file object: {filename}")
-        print_log(f"\tOpening mode: {mode}")
-        print_log(f"\tGZIP mode: {filename.endswith('.gz')}")
-    if filename.endswith(".gz"):
-        return cast(IO[str], gzip.open(filename, mode + "t"))
-    return open(filename, mode)
-
-
 def read_header(infile: IO[str]) -> list[str]:
     """Read header from TSV file and return as list.
     Returns empty list if file is empty."""
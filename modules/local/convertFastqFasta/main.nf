@@ -1,8 +1,9 @@
 // Convert FASTQ files (interleaved or single-end) into FASTA format
 
+// Tool source: rust-tools/fastqkit/
 process CONVERT_FASTQ_FASTA {
     label "single"
-    label "seqtk"
+    label "rust_tools"
     tag "id=${sample}"
     input:
         tuple val(sample), path(fastqs)
@@ -21,8 +22,6 @@ process CONVERT_FASTQ_FASTA {
         if (invalid_files) {
             throw new Exception("Input files ${invalid_files} do not end with .${extension}")
         }
-        def extractCmd = check_str.endsWith(".gz") ? "zcat" : "cat"
-        def compressCmd = check_str.endsWith(".gz") ? "gzip" : "cat"
         def outputs = fastqs.collect { fastq -> "converted_${fastq}".replace(".fastq", ".fasta") }
         def inputs = fastqs.collect { fastq -> "input_${fastq}" }
         """
@@ -34,7 +33,7 @@ process CONVERT_FASTQ_FASTA {
             output="\${outputs_array[i]}"
             input="\${inputs_array[i]}"
             # Perform conversion
-            ${extractCmd} \${fastq} | seqtk seq -a | ${compressCmd} > \${output}
+            fastqkit to-fasta -i \${fastq} -o \${output} -t ${task.cpus}
             # Link input to output for testing
             ln -s \${fastq} \${input}
         done
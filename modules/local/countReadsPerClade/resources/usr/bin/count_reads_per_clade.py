@@ -9,11 +9,11 @@ Output both deduplicated and total (non-deduplicated) counts.
 
 import argparse
 import csv
-import gzip
 import sys
 from collections import Counter, defaultdict
 from collections.abc import Iterator
-from typing import IO, cast
+
+from nao_io import open_by_suffix
 
 TaxId = int
 # NCBI taxonomy root node - has itself as parent
@@ -22,16 +22,6 @@ ROOT: TaxId = 1
 Tree = defaultdict[TaxId, set[TaxId]]
 
 
-def open_by_suffix(filename: str, mode: str = "r") -> IO[str]:
-    """Parse the suffix of a filename to determine the open method, then open the file.
-
-    Can handle .gz and uncompressed files.
-    """
-    if filename.endswith(".gz"):
-        return cast(IO[str], gzip.open(filename, mode + "t"))
-    return open(filename, mode)
-
-
 def read_tsv(file_path: str) -> Iterator[dict[str, str]]:
     """Read a TSV file and yield rows one at a time.
 
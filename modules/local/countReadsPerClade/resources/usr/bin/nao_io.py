@@ -0,0 +1,635 @@
+#!/usr/bin/env python
+"""
+Shared high-throughput file I/O for the pipeline's Python scripts.
+
+`open_by_suffix` opens plain or gzipped text files behind large buffers, using
+the fastest gzip implementation available in the container:
+    1. ISA-L via python-isal, with (de)compression on a background thread;
+    2. a pigz subprocess;
+    3. the standard library's zlib-based gzip module.
+Compressed output is written at NAO_GZIP_LEVEL (zlib scale, default 6) rather
+than gzip.open's default of 9; all backends produce standard gzip files.
+
+`iter_lines` and `write_lines` move text in large blocks: input is decoded in
+megabyte chunks and split on newlines in one call per chunk, and output lines
+are joined into large batches before each write, instead of one readline() or
+write() call per line.
+
+`open_by_suffix(..., index_key=...)` writes a gzipped TSV as BGZF (a series of
+independent gzip members of at most 64 KiB, still readable by zcat and gzip)
+whose blocks start on line boundaries, plus a sidecar <path>.idx TSV mapping
+the key of the first row of each block to the block's BGZF virtual offset.
+For files sorted on that key, `lookup_indexed` binary-searches the index and
+decompresses only the blocks that can hold the requested keys.
+
+`TaskMetrics` records what a tool did: lines and bytes (on disk and
+uncompressed) through files opened with `metrics=`, wall and CPU time per named
+phase, and peak RSS. When NAO_TASK_METRICS is set (see the `task_metrics`
+parameter), it is written to <tool>.metrics.json in the task directory, where
+bin/collect_task_metrics.py gathers it into one table per run. The Rust tools
+write the same schema through the task_metrics crate.
+
+The canonical copy of this file is bin/nao_io.py, which `pip install .` also
+installs as a module. Module scripts import the identical copy in their own
+resources/usr/bin directory; after editing this file, refresh them with
+    for f in modules/local/*/resources/usr/bin/nao_io.py; do
+        cp bin/nao_io.py "$f"
+    done
+"""
+
+import bisect
+import gzip
+import io
+import itertools
+import json
+import os
+import resource
+import shutil
+import struct
+import subprocess
+import time
+import zlib
+from collections.abc import Iterable, Iterator
+from contextlib import contextmanager
+from pathlib import Path
+from types import TracebackType
+from typing import IO, Any
+
+try:
+    from isal import igzip_threaded
+except ImportError:  # pragma: no cover - depends on the container
+    igzip_threaded = None  # type: ignore[assignment]
+
+BUFFER_SIZE = 1 << 20
+WRITE_BATCH_LINES = 8192
+DEFAULT_GZIP_LEVEL = 6
+METRICS_SUFFIX = ".metrics.json"
+INDEX_SUFFIX = ".idx"
+# Uncompressed bytes per BGZF block (htslib's default); a block holds at most 64 KiB
+BGZF_BLOCK_SIZE = 0xFF00
+BGZF_MAX_BLOCK = 1 << 16
+# Empty BGZF block marking the end of the file
+BGZF_EOF = bytes.fromhex("1f8b08040000000000ff0600424302001b0003000000000000000000")
+
+
+def gzip_level() -> int:
+    """Compression level for gzipped output (zlib scale 1-9)."""
+    level = int(os.environ.get("NAO_GZIP_LEVEL", DEFAULT_GZIP_LEVEL))
+    if not 1 <= level <= 9:
+        raise ValueError(f"NAO_GZIP_LEVEL must be between 1 and 9, got {level}")
+    return level
+
+
+def io_threads() -> int:
+    """Worker threads for (de)compression, from NAO_IO_THREADS (default 1)."""
+    return max(1, int(os.environ.get("NAO_IO_THREADS", 1)))
+
+
+def gzip_backend() -> str:
+    """Name of the gzip implementation open_by_suffix will use."""
+    backend = os.environ.get("NAO_GZIP_BACKEND")
+    if backend:
+        if backend not in ("isal", "pigz", "zlib"):
+            raise ValueError(f"Unknown NAO_GZIP_BACKEND: {backend}")
+        return backend
+    if igzip_threaded is not None:
+        return "isal"
+    if shutil.which("pigz"):
+        return "pigz"
+    return "zlib"
+
+
+class _PipedGzipFile(io.RawIOBase):
+    """Raw stream reading from `pigz -dc` or writing through `pigz -c`."""
+
+    def __init__(self, path: str, mode: str, level: int, threads: int) -> None:
+        super().__init__()
+        self._path = path
+        self._reading = mode == "r"
+        self._eof = False
+        self._out: IO[bytes] | None = None
+        if self._reading:
+            self._proc = subprocess.Popen(["pigz", "-dc", path], stdout=subprocess.PIPE)
+            pipe = self._proc.stdout
+        else:
+            self._out = open(path, mode + "b")
+            self._proc = subprocess.Popen(
+                ["pigz", "-c", f"-{level}", "-p", str(threads)],
+                stdin=subprocess.PIPE,
+                stdout=self._out,
+            )
+            pipe = self._proc.stdin
+        assert pipe is not None
+        self._pipe: IO[bytes] = pipe
+
+    def readable(self) -> bool:
+        return self._reading
+
+    def writable(self) -> bool:
+        return not self._reading
+
+    def readinto(self, buffer: memoryview) -> int:  # type: ignore[override]
+        n = self._pipe.readinto(buffer)  # type: ignore[attr-defined]
+        if not n and not self._eof:
+            # Surface decompression errors at end of stream, not at close
+            self._eof = True
+            self._check(self._proc.wait())
+        return n
+
+    def write(self, data: bytes) -> int:  # type: ignore[override]
+        self._pipe.write(data)
+        return len(data)
+
+    def _check(self, returncode: int) -> None:
+        if returncode != 0:
+            raise OSError(f"pigz exited with status {returncode} on {self._path}")
+
+    def close(self) -> None:
+        if self.closed:
+            return
+        try:
+            self._pipe.close()
+            if self._reading and not self._eof:
+                # Stopped reading early (e.g. header only): pigz would fail on EPIPE
+                self._proc.kill()
+                self._proc.wait()
+            elif not self._reading:
+                self._check(self._proc.wait())
+        finally:
+            if self._out is not None:
+                self._out.close()
+            super().close()
+
+
+def metrics_enabled() -> bool:
+    """Whether tools should write metrics files, from NAO_TASK_METRICS."""
+    value = os.environ.get("NAO_TASK_METRICS", "")
+    return value.lower() not in ("", "0", "false")
+
+
+def _cpu_seconds() -> float:
+    """User and system CPU time of this process and its finished children."""
+    return sum(os.times()[:4])
+
+
+def _peak_rss_bytes() -> int:
+    """Largest peak RSS of this process or any finished child (ru_maxrss is KiB)."""
+    usages = (
+        resource.getrusage(who)
+        for who in (resource.RUSAGE_SELF, resource.RUSAGE_CHILDREN)
+    )
+    return max(usage.ru_maxrss for usage in usages) * 1024
+
+
+def _file_size(path: str) -> int:
+    """On-disk size of a file, or 0 if it is not a regular file (e.g. a pipe)."""
+    try:
+        return os.path.getsize(path) if os.path.isfile(path) else 0
+    except OSError:
+        return 0
+
+
+class TaskMetrics:
+    """
+    Counters and per-phase timings for one run of a tool.
+    Use as a context manager around the tool's work; the metrics file is
+    written on successful exit if metrics are enabled. Lines and uncompressed
+    bytes are tallied for files opened with open_by_suffix(..., metrics=...);
+    rows_in and rows_out count lines, including headers.
+    """
+
+    def __init__(self, tool: str) -> None:
+        self.tool = tool
+        self.rows_in = 0
+        self.rows_out = 0
+        self.bytes_read_uncompressed = 0
+        self.bytes_written_uncompressed = 0
+        self.inputs: list[str] = []
+        self.outputs: list[str] = []
+        self.phases: dict[str, dict[str, float]] = {}
+        self._start_wall = time.perf_counter()
+        self._start_cpu = _cpu_seconds()
+
+    def __enter__(self) -> "TaskMetrics":
+        return self
+
+    def __exit__(
+        self,
+        exc_type: type[BaseException] | None,
+        exc: BaseException | None,
+        traceback: TracebackType | None,
+    ) -> None:
+        if exc_type is None:
+            self.write()
+
+    @contextmanager
+    def phase(self, name: str) -> Iterator[None]:
+        """
+        Time a phase of the tool (e.g. "parse", "group", "write"). CPU time
+        includes subprocesses (pigz, sort) that finish within the phase;
+        repeated phases of the same name accumulate.
+        Args:
+            name (str): Phase name.
+        """
+        wall = time.perf_counter()
+        cpu = _cpu_seconds()
+        try:
+            yield
+        finally:
+            totals = self.phases.setdefault(name, {"wall_s": 0.0, "cpu_s": 0.0})
+            totals["wall_s"] += time.perf_counter() - wall
+            totals["cpu_s"] += _cpu_seconds() - cpu
+
+    def as_dict(self) -> dict[str, Any]:
+        """Metrics in the shared metrics-file schema."""
+        return {
+            "tool": self.tool,
+            "rows_in": self.rows_in,
+            "rows_out": self.rows_out,
+            "bytes_read": sum(_file_size(p) for p in self.inputs),
+            "bytes_read_uncompressed": self.bytes_read_uncompressed,
+            "bytes_written": sum(_file_size(p) for p in self.outputs),
+            "bytes_written_uncompressed": self.bytes_written_uncompressed,
+            "wall_s": round(time.perf_counter() - self._start_wall, 6),
+            "cpu_s": round(_cpu_seconds() - self._start_cpu, 6),
+            "phases": {
+                name: {key: round(value, 6) for key, value in totals.items()}
+                for name, totals in self.phases.items()
+            },
+            "peak_rss_bytes": _peak_rss_bytes(),
+        }
+
+    def write(self, directory: str | Path = ".") -> Path | None:
+        """
+        Write <tool>.metrics.json if metrics are enabled.
+        Args:
+            directory (str | Path): Output directory (the task directory).
+        Returns:
+            Path | None: Path written, or None if metrics are disabled.
+        """
+        if not metrics_enabled():
+            return None
+        path = Path(directory) / f"{self.tool}{METRICS_SUFFIX}"
+        path.write_text(json.dumps(self.as_dict(), indent=2) + "\n")
+        return path
+
+
+class _CountingStream(io.BufferedIOBase):
+    """Binary stream proxy tallying the bytes and lines passing through it."""
+
+    def __init__(self, inner: IO[bytes], metrics: TaskMetrics, reading: bool) -> None:
+        super().__init__()
+        self._inner = inner
+        self._metrics = metrics
+        self._reading = reading
+
+    def readable(self) -> bool:
+        return self._reading
+
+    def writable(self) -> bool:
+        return not self._reading
+
+    def _tally_read(self, data: bytes) -> bytes:
+        self._metrics.bytes_read_uncompressed += len(data)
+        self._metrics.rows_in += data.count(b"\n")
+        return data
+
+    def read(self, size: int | None = -1) -> bytes:
+        return self._tally_read(self._inner.read(-1 if size is None else size))
+
+    def read1(self, size: int = -1) -> bytes:
+        return self._tally_read(self._inner.read1(size))  # type: ignore[attr-defined]
+
+    def write(self, data: bytes) -> int:  # type: ignore[override]
+        n = self._inner.write(data)
+        self._metrics.bytes_written_uncompressed += len(data)
+        self._metrics.rows_out += bytes(data).count(b"\n")
+        return n
+
+    def flush(self) -> None:
+        if not self.closed:
+            self._inner.flush()
+
+    def close(self) -> None:
+        if self.closed:
+            return
+        try:
+            super().close()
+        finally:
+            self._inner.close()
+
+
+def _open_gzip_binary(path: str, mode: str) -> IO[bytes]:
+    """Open a gzip file as a buffered binary stream with the best backend."""
+    level = gzip_level()
+    threads = io_threads()
+    backend = gzip_backend()
+    if backend == "isal":
+        if igzip_threaded is None:
+            raise ImportError("NAO_GZIP_BACKEND=isal but python-isal is not installed")
+        # ISA-L has levels 0-3; map the zlib scale onto them (6 -> 2, its default)
+        return igzip_threaded.open(  # type: ignore[no-any-return]
+            path,
+            mode + "b",
+            compresslevel=min(3, level // 3),
+            threads=threads,
+            block_size=BUFFER_SIZE,
+        )
+    if backend == "pigz":
+        raw = _PipedGzipFile(path, mode, level, threads)
+        if mode == "r":
+            return io.BufferedReader(raw, BUFFER_SIZE)
+        return io.BufferedWriter(raw, BUFFER_SIZE)
+    return gzip.open(path, mode + "b", compresslevel=level)
+
+
+class _BgzfIndexedWriter(io.RawIOBase):
+    """
+    Write a TSV as BGZF blocks that start on line boundaries, recording the
+    key of the first row of each block in a sidecar index. The header gets a
+    block of its own, so indexed offsets always point at data rows. Rows must
+    be sorted on the key (in Python string order) for lookups to be correct;
+    unsorted input raises ValueError. A row longer than a block spans several
+    blocks, of which only the first is indexed.
+    """
+
+    def __init__(self, path: str, mode: str, key_field: str, level: int) -> None:
+        super().__init__()
+        self._out = open(path, mode + "b")
+        self._index = open(path + INDEX_SUFFIX, mode, encoding="utf-8")
+        self._path = path
+        self._key_field = key_field
+        self._level = level
+        self._key_index: int | None = None
+        self._tail = b""
+        self._block = bytearray()
+        self._block_key: bytes | None = None
+        self._last_key: bytes | None = None
+        self._offset = 0
+
+    def writable(self) -> bool:
+        return True
+
+    def write(self, data: bytes) -> int:  # type: ignore[override]
+        lines = (self._tail + bytes(data)).split(b"\n")
+        self._tail = lines.pop()
+        for line in lines:
+            self._add_line(line + b"\n")
+        return len(data)
+
+    def _add_line(self, line: bytes) -> None:
+        if self._key_index is None:
+            header = line.rstrip(b"\r\n").decode("utf-8").split("\t")
+            if self._key_field not in header:
+                raise ValueError(
+                    f"Index key {self._key_field} not in header of {self._path}"
+                )
+            self._key_index = header.index(self._key_field)
+            self._index.write(f"{self._key_field}\tvirtual_offset\n")
+            self._write_block(line)
+            return
+        key = line.rstrip(b"\r\n").split(b"\t", self._key_index + 1)[self._key_index]
+        if self._last_key is not None and key < self._last_key:
+            raise ValueError(
+                f"Cannot index {self._path}: rows are not sorted by "
+                f"{self._key_field} ({key!r} after {self._last_key!r})."
+            )
+        self._last_key = key
+        if self._block and len(self._block) + len(line) > BGZF_BLOCK_SIZE:
+            self._flush_block()
+        if not self._block:
+            self._block_key = key
+        self._block += line
+        if len(self._block) >= BGZF_BLOCK_SIZE:
+            self._flush_block()
+
+    def _flush_block(self) -> None:
+        if not self._block:
+            return
+        key = (self._block_key or b"").decode("utf-8")
+        self._index.write(f"{key}\t{self._offset << 16}\n")
+        data = bytes(self._block)
+        for start in range(0, len(data), BGZF_BLOCK_SIZE):
+            self._write_block(data[start : start + BGZF_BLOCK_SIZE])
+        self._block.clear()
+
+    def _write_block(self, data: bytes) -> None:
+        compressed = _deflate(data, self._level)
+        if len(compressed) + 26 > BGZF_MAX_BLOCK:
+            compressed = _deflate(data, 0)
+        block_size = len(compressed) + 26
+        header = struct.pack(
+            "<BBBBIBBHBBHH", 31, 139, 8, 4, 0, 0, 255, 6, 66, 67, 2, block_size - 1
+        )
+        footer = struct.pack("<II", zlib.crc32(data), len(data))
+        self._out.write(header + compressed + footer)
+        self._offset += block_size
+
+    def close(self) -> None:
+        if self.closed:
+            return
+        try:
+            if self._tail:
+                self._add_line(self._tail + b"\n")
+                self._tail = b""
+            self._flush_block()
+            self._out.write(BGZF_EOF)
+        finally:
+            self._out.close()
+            self._index.close()
+            super().close()
+
+
+def _deflate(data: bytes, level: int) -> bytes:
+    """Raw-deflate one BGZF block's data."""
+    compressor = zlib.compressobj(level, zlib.DEFLATED, -15)
+    return compressor.compress(data) + compressor.flush()
+
+
+def open_by_suffix(
+    filename: str | Path,
+    mode: str = "r",
+    metrics: TaskMetrics | None = None,
+    index_key: str | None = None,
+) -> IO[str]:
+    """
+    Open a plain or gzipped (.gz) file in UTF-8 text mode with large buffers.
+    Args:
+        filename (str | Path): Path to file.
+        mode (str): One of "r", "w", "a" or "x" (optionally with "t").
+        metrics (TaskMetrics | None): If given, record the file and tally the
+            lines and uncompressed bytes read from or written to it.
+        index_key (str | None): If given, write a gzipped TSV sorted on this
+            column as indexed BGZF, with its index at <filename>.idx (modes
+            "w" and "x" only).
+    Returns:
+        IO[str]: Text file object (not seekable when metrics are given).
+    """
+    path = str(filename)
+    base_mode = mode.replace("t", "")
+    if base_mode not in ("r", "w", "a", "x"):
+        raise ValueError(f"Unsupported mode for open_by_suffix: {mode}")
+    if index_key is not None:
+        if base_mode not in ("w", "x") or not path.endswith(".gz"):
+            raise ValueError("Indexed output must be a .gz file opened for writing")
+        indexed = _BgzfIndexedWriter(path, base_mode, index_key, gzip_level())
+        binary = io.BufferedWriter(indexed, BUFFER_SIZE)
+        if metrics is not None:
+            metrics.outputs.append(path)
+            binary = _CountingStream(binary, metrics, False)
+        handle = io.TextIOWrapper(binary, encoding="utf-8")  # type: ignore[type-var]
+    elif metrics is not None:
+        reading = base_mode == "r"
+        (metrics.inputs if reading else metrics.outputs).append(path)
+        if path.endswith(".gz"):
+            binary = _open_gzip_binary(path, base_mode)
+        else:
+            binary = open(path, base_mode + "b", buffering=BUFFER_SIZE)
+        counted = _CountingStream(binary, metrics, reading)
+        handle = io.TextIOWrapper(counted, encoding="utf-8")  # type: ignore[type-var]
+    elif path.endswith(".gz"):
+        binary = _open_gzip_binary(path, base_mode)
+        handle = io.TextIOWrapper(binary, encoding="utf-8")  # type: ignore[type-var]
+    else:
+        handle = open(path, base_mode, buffering=BUFFER_SIZE, encoding="utf-8")
+    # Decode and encode in large chunks rather than TextIOWrapper's default 8 KiB
+    handle._CHUNK_SIZE = BUFFER_SIZE  # type: ignore[attr-defined]
+    return handle
+
+
+def iter_lines(handle: IO[str], chunk_size: int = BUFFER_SIZE) -> Iterator[str]:
+    """
+    Iterate over the remaining lines of a text file, without trailing newlines.
+    Reads large chunks and splits each with a single str.split call, which is
+    considerably faster than per-line iteration. Can follow readline() calls
+    on the same handle (e.g. after reading a header).
+    Args:
+        handle (IO[str]): Open text file.
+        chunk_size (int): Characters to read per chunk.
+    Yields:
+        str: Each line, with its newline removed.
+    """
+    tail = ""
+    while chunk := handle.read(chunk_size):
+        lines = (tail + chunk).split("\n")
+        tail = lines.pop()
+        yield from lines
+    if tail:
+        yield tail
+
+
+def write_lines(
+    handle: IO[str], lines: Iterable[str], batch_size: int = WRITE_BATCH_LINES
+) -> int:
+    """
+    Write lines (without trailing newlines) to a text file in large batches.
+    Args:
+        handle (IO[str]): Open text file.
+        lines (Iterable[str]): Lines to write; may be a lazy generator.
+        batch_size (int): Lines joined per write call.
+    Returns:
+        int: Number of lines written.
+    """
+    n_lines = 0
+    for batch in itertools.batched(lines, batch_size):
+        handle.write("\n".join(batch) + "\n")
+        n_lines += len(batch)
+    return n_lines
+
+
+def read_index(index_path: str | Path) -> tuple[str, list[str], list[int]]:
+    """
+    Read a BGZF sidecar index written by open_by_suffix(..., index_key=...).
+    Args:
+        index_path (str | Path): Path to the .idx file.
+    Returns:
+        tuple[str, list[str], list[int]]: The key field, and the first key and
+            compressed file offset of each indexed block, in file order.
+    """
+    with open(index_path, encoding="utf-8") as f:
+        header = f.readline().rstrip("\n")
+        if not header:
+            return "", [], []
+        key_field = header.split("\t")[0]
+        keys: list[str] = []
+        offsets: list[int] = []
+        for line in f:
+            key, virtual_offset = line.rstrip("\n").split("\t")
+            keys.append(key)
+            offsets.append(int(virtual_offset) >> 16)
+    return key_field, keys, offsets
+
+
+def _read_bgzf_rows(raw: IO[bytes], offset: int) -> tuple[str, int]:
+    """
+    Decompress the BGZF block at offset, plus any following blocks needed to
+    complete its last row.
+    Args:
+        raw (IO[bytes]): BGZF file opened in binary mode.
+        offset (int): Compressed offset of a block that starts a row.
+    Returns:
+        tuple[str, int]: The complete rows read (empty at the end of the file),
+            and the offset of the next block.
+    """
+    raw.seek(offset)
+    data = b""
+    while True:
+        header = raw.read(18)
+        if len(header) < 18:
+            break
+        block_size = struct.unpack("<H", header[16:18])[0] + 1
+        block = raw.read(block_size - 18)
+        offset += block_size
+        data += zlib.decompress(block[:-8], -15)
+        if not data or data.endswith(b"\n"):
+            break
+    return data.decode("utf-8"), offset
+
+
+def lookup_indexed(
+    path: str | Path, keys: Iterable[str], index_path: str | Path | None = None
+) -> tuple[list[str], list[str]]:
+    """
+    Fetch the rows of an indexed BGZF TSV whose key is one of keys, reading
+    only the blocks that can hold them.
+    Args:
+        path (str | Path): Path to the BGZF TSV.
+        keys (Iterable[str]): Keys to look up.
+        index_path (str | Path | None): Index path (default <path>.idx).
+    Returns:
+        tuple[list[str], list[str]]: The header fields, and the matching rows
+            (without newlines) in file order.
+    """
+    key_field, block_keys, offsets = read_index(index_path or f"{path}{INDEX_SUFFIX}")
+    wanted = sorted(set(keys))
+    rows: list[str] = []
+    with open(path, "rb") as raw:
+        header_text, _ = _read_bgzf_rows(raw, 0)
+        header = header_text.rstrip("\n").split("\t") if header_text else []
+        if not block_keys:
+            return header, rows
+        key_index = header.index(key_field)
+        i = 0
+        while i < len(wanted):
+            # Rows with a key may start at the end of the last block whose first
+            # key is smaller, so start there
+            offset = offsets[max(bisect.bisect_left(block_keys, wanted[i]) - 1, 0)]
+            while i < len(wanted):
+                text, offset = _read_bgzf_rows(raw, offset)
+                if not text:
+                    i = len(wanted)
+                    break
+                for line in text.rstrip("\n").split("\n"):
+                    row_key = line.split("\t", key_index + 1)[key_index]
+                    while i < len(wanted) and wanted[i] < row_key:
+                        i += 1
+                    if i == len(wanted):
+                        break
+                    if row_key == wanted[i]:
+                        rows.append(line)
+                # Skip ahead if the next key's rows start beyond the next block
+                if i < len(wanted):
+                    next_block = max(bisect.bisect_left(block_keys, wanted[i]) - 1, 0)
+                    if offsets[next_block] > offset:
+                        break
+    return header, rows
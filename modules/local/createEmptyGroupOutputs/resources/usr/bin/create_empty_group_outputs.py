@@ -13,14 +13,14 @@ table-schema exists for an output, the file includes a header row.
 
 # Standard library imports
 import argparse
-import gzip
 import json
 import logging
 import time
 import tomllib
 from datetime import UTC, datetime
 from pathlib import Path
-from typing import IO, cast
+
+from nao_io import open_by_suffix
 
 # =============================================================================
 # Logging
@@ -49,21 +49,6 @@ logger.addHandler(handler)
 # =============================================================================
 
 
-def open_by_suffix(filename: str | Path, mode: str = "r") -> IO[str]:
-    """
-    Open a file using the appropriate method based on its suffix.
-    Args:
-        filename (str | Path): Path to file to open.
-        mode (str): File open mode (default "r").
-    Returns:
-        IO[str]: File handle appropriate for the file compression type.
-    """
-    filename_str = str(filename)
-    if filename_str.endswith(".gz"):
-        return cast(IO[str], gzip.open(filename_str, mode + "t"))
-    return open(filename_str, mode)
-
-
 # =============================================================================
 # Core functions
 # =============================================================================
@@ -0,0 +1,22 @@
+// Extract the sequences of a BLAST database as a gzipped FASTA named by accession,
+// with a TSV mapping each accession (sseqid) to its taxid (staxid), so a minimap2
+// index built from the FASTA can stand in for the database in tiered validation
+process EXTRACT_BLAST_DB_FASTA {
+    label "BLAST"
+    label "small"
+    tag "id=index"
+    input:
+        path(blast_db) // Directory containing the "blast_db" alias (from DOWNLOAD_BLAST_DB)
+    output:
+        path("blast-db.fasta.gz"), emit: fasta
+        path("blast-db-taxids.tsv.gz"), emit: taxids
+    script:
+        """
+        set -euo pipefail
+        blastdbcmd -db ${blast_db}/blast_db -entry all -outfmt \$'%a\\t%s' \\
+            | awk -F '\\t' '{ print ">" \$1; print \$2 }' \\
+            | gzip -c > blast-db.fasta.gz
+        { printf 'sseqid\\tstaxid\\n'; blastdbcmd -db ${blast_db}/blast_db -entry all -outfmt \$'%a\\t%T'; } \\
+            | gzip -c > blast-db-taxids.tsv.gz
+        """
+}
@@ -1,6 +1,7 @@
 // Extract sequence IDs from a FASTA or FASTQ file
+// Tool source: rust-tools/fastqkit/
 process EXTRACT_FASTN_IDS {
-    label "seqkit"
+    label "rust_tools"
     label "single"
     label "testing_only" // Process is currently only used for testing
     tag "id=${sample}"
@@ -11,7 +12,7 @@ process EXTRACT_FASTN_IDS {
         tuple val(sample), path("input_${fastn}"), emit: input
     script:
         """
-        seqkit seq -ni ${fastn} | sort -u > ${sample}_ids.txt
+        fastqkit ids -i ${fastn} -o ${sample}_ids.txt --unique -t ${task.cpus}
         ln -s ${fastn} input_${fastn}
         """
 }
@@ -1,6 +1,7 @@
-// Extract target reads, based on the shared read ids in another FASTQ file. Only works on gzipped FASTQ files.
+// Extract target reads, based on the shared read ids in another FASTQ file.
+// Tool source: rust-tools/fastqkit/
 process EXTRACT_SHARED_FASTQ_READS {
-    label "seqtk"
+    label "rust_tools"
     label "single"
     tag "id=${sample}"
     input:
@@ -12,11 +13,8 @@ process EXTRACT_SHARED_FASTQ_READS {
         """
         set -euo pipefail
 
-        # Get target read ids
-        seqtk comp ${fastq_1} | cut -f 1 > fastq_1_ids.txt
-
-        # Create FASTQ file with cleaned, mapped reads
-        seqtk subseq ${fastq_2} fastq_1_ids.txt | gzip -c > "${sample}_shared.fastq.gz"
+        # Create FASTQ file with the reads in fastq_2 whose IDs appear in fastq_1
+        fastqkit subseq -i ${fastq_2} --ids-fastx ${fastq_1} -o "${sample}_shared.fastq.gz" -t ${task.cpus}
 
         # Link input to output for testing
         ln -s ${fastq_1} ${sample}_fastq_1.fastq.gz
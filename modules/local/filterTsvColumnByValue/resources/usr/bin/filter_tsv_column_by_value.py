@@ -11,11 +11,12 @@ Treats quote characters as regular characters, not as delimiters.
 
 import argparse
 import csv
-import gzip
 import logging
 import sys
 from datetime import UTC, datetime
-from typing import IO, Any, TextIO, cast
+from typing import Any, TextIO
+
+from nao_io import open_by_suffix
 
 
 # Configure logging
@@ -55,23 +56,6 @@ logger.addHandler(handler)
 # =======================================================================
 
 
-def open_by_suffix(filename: str, mode: str = "r") -> IO[str]:
-    """
-    Parse the suffix of a filename to determine the right open method
-    to use, then open the file. Can handle .gz and uncompressed files.
-
-    Args:
-        filename (str): Path to file to open
-        mode (str): File open mode (default "r")
-
-    Returns:
-        IO[str]: File handle appropriate for the file compression type
-    """
-    if filename.endswith(".gz"):
-        return cast(IO[str], gzip.open(filename, mode + "t"))
-    return open(filename, mode)
-
-
 def parse_args() -> argparse.Namespace:
     """
     Parse and return command-line arguments.
@@ -12,16 +12,15 @@ add missing mates for unpaired reads.
 # =======================================================================
 
 import argparse
-import gzip
 import logging
 import math
 from collections import defaultdict
 from collections.abc import Iterator
 from dataclasses import dataclass
 from datetime import UTC, datetime
-from typing import IO, cast
 
-from Bio import SeqIO
+from Bio.SeqIO.QualityIO import FastqGeneralIterator
+from nao_io import TaskMetrics, iter_lines, open_by_suffix
 
 
 # Configure logging
@@ -88,23 +87,6 @@ def parse_args() -> argparse.Namespace:
     return parser.parse_args()
 
 
-def open_by_suffix(filename: str, mode: str = "r") -> IO[str]:
-    """
-    Parse the suffix of a filename to determine the right open method
-    to use, then open the file. Can handle .gz and uncompressed files.
-
-    Args:
-        filename (str): Path to file to open
-        mode (str): File open mode (default "r")
-
-    Returns:
-        File handle appropriate for the file compression type
-    """
-    if filename.endswith(".gz"):
-        return cast(IO[str], gzip.open(filename, mode + "t"))
-    return open(filename, mode)
-
-
 # =======================================================================
 # Dataclass
 # =======================================================================
@@ -560,7 +542,9 @@ def process_all_alignments_for_read_id(
 # =======================================================================
 
 
-def stream_filtered_fastq(fastq_file: str) -> Iterator[str]:
+def stream_filtered_fastq(
+    fastq_file: str, metrics: TaskMetrics | None = None
+) -> Iterator[str]:
     """
     Stream read ids one at a time from sorted FASTQ file.
     Assumes FASTQ is sorted by read ID and handles paired reads correctly.
@@ -570,6 +554,7 @@ def stream_filtered_fastq(fastq_file: str) -> Iterator[str]:
 
     Args:
         fastq_file (str): Path to FASTQ file (can be gzipped)
+        metrics (TaskMetrics | None): Metrics to tally the file's I/O
 
     Yields:
         str: Read IDs (without @ prefix and /1, /2 suffixes) in sorted order
@@ -581,10 +566,10 @@ def stream_filtered_fastq(fastq_file: str) -> Iterator[str]:
     last_read_id = None
 
     try:
-        with open_by_suffix(fastq_file) as handle:
-            for record in SeqIO.parse(handle, "fastq"):
+        with open_by_suffix(fastq_file, metrics=metrics) as handle:
+            for title, _, _ in FastqGeneralIterator(handle):
                 # Remove /1, /2 suffixes and space-separated parts if present
-                read_id = record.id.split()[0].split("/")[0]
+                read_id = title.split()[0].split("/")[0]
                 # Only yield if this is a new read ID (handles paired reads)
                 if read_id != previous_read_id:
                     # Check if FASTQ file is sorted before yielding
@@ -600,7 +585,9 @@ def stream_filtered_fastq(fastq_file: str) -> Iterator[str]:
         raise
 
 
-def stream_sam_by_qname(sam_file: str) -> Iterator[tuple[str, list[SamAlignment]]]:
+def stream_sam_by_qname(
+    sam_file: str, metrics: TaskMetrics | None = None
+) -> Iterator[tuple[str, list[SamAlignment]]]:
     """
     Stream SAM file and yield groups of alignments by query name (also known as read id).
 
@@ -608,6 +595,7 @@ def stream_sam_by_qname(sam_file: str) -> Iterator[tuple[str, list[SamAlignment]
 
     Args:
         sam_file (str): Path to SAM file
+        metrics (TaskMetrics | None): Metrics to tally the file's I/O
 
     Yields:
         Tuple[str, list[SamAlignment]]: Tuples of (qname, list_of_alignments)
@@ -619,10 +607,8 @@ def stream_sam_by_qname(sam_file: str) -> Iterator[tuple[str, list[SamAlignment]
     current_alignments = []
     last_qname = None
 
-    with open_by_suffix(sam_file) as f:
-        for line in f:
-            if isinstance(line, bytes):
-                line = line.decode()
+    with open_by_suffix(sam_file, metrics=metrics) as f:
+        for line in iter_lines(f):
             if line.startswith("@"):
                 continue  # Skip header lines
             alignment = SamAlignment.from_sam_line(line)
@@ -657,7 +643,11 @@ def stream_sam_by_qname(sam_file: str) -> Iterator[tuple[str, list[SamAlignment]
 
 
 def filter_viral_sam(
-    input_sam: str, filtered_fastq: str, output_sam: str, score_threshold: float
+    input_sam: str,
+    filtered_fastq: str,
+    output_sam: str,
+    score_threshold: float,
+    metrics: TaskMetrics | None = None,
 ) -> None:
     """
     Filter viral SAM file using a streaming approach.
@@ -676,11 +666,12 @@ def filter_viral_sam(
         filtered_fastq (str): FASTQ file containing filtered reads to keep (sorted by read ID)
         output_sam (str): Output filtered SAM file path
         score_threshold (float): Minimum normalized alignment score threshold
+        metrics (TaskMetrics | None): Metrics to tally input and output I/O
     """
     logger.info("Initializing iterators for the FASTQ and SAM file")
     # Create iterators for streaming both files
-    filtered_read_ids_iter = stream_filtered_fastq(filtered_fastq)
-    sam_iter = stream_sam_by_qname(input_sam)
+    filtered_read_ids_iter = stream_filtered_fastq(filtered_fastq, metrics)
+    sam_iter = stream_sam_by_qname(input_sam, metrics)
     # Grab the first read id from the fastq file
     curr_read_id = next(filtered_read_ids_iter, None)
     # Initalizing counters and flags
@@ -693,7 +684,7 @@ def filter_viral_sam(
     logger.info(f"Processing SAM file with score threshold {score_threshold}")
     # The structure of this loop follows the two-pointer merge algorithm
     # however, the key nuance is that the read ids from the FASTQ file are subset of the read ids from the SAM file
-    with open_by_suffix(output_sam, "w") as outf:
+    with open_by_suffix(output_sam, "w", metrics) as outf:
         # Iterate over the SAM file, processing all alignments for each read id
         for curr_align_read_id, alignments in sam_iter:
             # Keep track of number of alignments processed and read ids
@@ -764,9 +755,14 @@ def main() -> None:
     logger.info("Parsing arguments.")
     args = parse_args()
     logger.info("Starting viral SAM filtering")
-    filter_viral_sam(
-        args.input_sam, args.filtered_fastq, args.output_sam, args.score_threshold
-    )
+    with TaskMetrics("filter_viral_sam") as metrics, metrics.phase("filter"):
+        filter_viral_sam(
+            args.input_sam,
+            args.filtered_fastq,
+            args.output_sam,
+            args.score_threshold,
+            metrics,
+        )
 
 
 if __name__ == "__main__":
@@ -17,3 +17,25 @@ process HEAD_TSV {
         ln -s ${tsv} input_${tsv}
         """
 }
+
+// Add a header line to each unheaded TSV in a batch of (sample, TSV) work items, in one task
+// Outputs are written to out_<i>/ for the 1-based item index i; split with BatchUtils.fromBatch
+process HEAD_TSV_BATCH {
+    label "python"
+    label "single"
+    tag "id=batch,first=${samples[0]},n=${samples.size()}"
+    input:
+        tuple val(samples), path(tsvs, arity: "1..*", stageAs: "in_*/*")
+        val(headers)
+        val(label)
+    output:
+        tuple val(samples), path("out_*/head_*"), emit: output
+    script:
+        def jobs = tsvs.withIndex().collect { tsv, i ->
+            "mkdir out_${i + 1} && head_tsv.py ${tsv} ${headers} out_${i + 1}/head_${tsv.name}"
+        }.join("\n")
+        """
+        set -euo pipefail
+        ${jobs}
+        """
+}
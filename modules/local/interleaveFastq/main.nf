@@ -1,9 +1,10 @@
 // Interleave paired FASTQ files into a single interleaved file
 
+// Tool source: rust-tools/fastqkit/
 process INTERLEAVE_FASTQ {
     label "testing_only" // Process is currently only used for testing
     label "single"
-    label "coreutils_gzip_gawk"
+    label "rust_tools"
     tag "id=${sample}"
     input:
         tuple val(sample), path(reads)
@@ -11,15 +12,13 @@ process INTERLEAVE_FASTQ {
         tuple val(sample), path("${sample}_interleaved.*"), emit: output
         tuple val(sample), path("input_*"), emit: input
     script:
-        def extractCmd = reads[0].toString().endsWith(".gz") ? "zcat" : "cat"
-        def compressCmd = reads[0].toString().endsWith(".gz") ? "gzip" : "cat"
         def in1 = reads[0]
         def in2 = reads[1]
         def out_suffix = reads[0].toString().endsWith(".gz") ? "fastq.gz" : "fastq"
         def out = "${sample}_interleaved.${out_suffix}"
         """
         # Perform interleaving
-        paste <(${extractCmd} ${in1} | paste - - - - ) <(${extractCmd} ${in2} | paste - - - - ) | tr "\t" "\n" | ${compressCmd} > ${out}
+        fastqkit interleave -1 ${in1} -2 ${in2} -o ${out} -t ${task.cpus}
         # Link input to output for testing
         ln -s ${in1} input_${in1}
         ln -s ${in2} input_${in2}
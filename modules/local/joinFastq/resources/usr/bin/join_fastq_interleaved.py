@@ -3,34 +3,23 @@
 # Import modules
 import argparse
 import datetime
-import gzip
 import time
-from typing import IO, cast
 
 from Bio import Seq, SeqIO
+from nao_io import open_by_suffix
 
 
 def print_log(message: str) -> None:
     print("[", datetime.datetime.now(), "]  ", message, sep="")
 
 
-def open_by_suffix(filename: str, mode: str = "r", debug: bool = False) -> IO[str]:
-    if debug:
-        print_log(f"\tOpening file object: {filename}")
-        print_log(f"\tOpening mode: {mode}")
-        print_log(f"\tGZIP mode: {filename.endswith('.gz')}")
-    if filename.endswith(".gz"):
-        return cast(IO[str], gzip.open(filename, mode + "t"))
-    return open(filename, mode)
-
-
 def join_paired_reads(
     input_file: str, output_file: str, gap: str = "N", debug: bool = False
 ) -> None:
     """Join non-overlapping paired-end reads from an interleaved FASTQ file."""
     with (
-        open_by_suffix(input_file, "r", debug) as inf,
-        open_by_suffix(output_file, "w", debug) as outf,
+        open_by_suffix(input_file, "r") as inf,
+        open_by_suffix(output_file, "w") as outf,
     ):
         # Check if file is empty
         pos = inf.tell()
@@ -13,11 +13,14 @@ side.
 
 # Import modules
 import argparse
-import gzip
 import logging
+import shutil
 import time
+from collections.abc import Iterator
 from datetime import UTC, datetime
-from typing import IO, cast
+from typing import IO
+
+from nao_io import BUFFER_SIZE, TaskMetrics, iter_lines, open_by_suffix
 
 # =======================================================================
 # Configure logging
@@ -63,17 +66,6 @@ def parse_args() -> argparse.Namespace:
     return parser.parse_args()
 
 
-def open_by_suffix(filename: str, mode: str = "r") -> IO[str]:
-    """Parse the suffix of a filename to determine the right open method
-    to use, then open the file. Can handle .gz and uncompressed files."""
-    logger.debug(f"Opening file object: {filename}")
-    logger.debug(f"Opening mode: {mode}")
-    logger.debug(f"GZIP mode: {filename.endswith('.gz')}")
-    if filename.endswith(".gz"):
-        return cast(IO[str], gzip.open(filename, mode + "t"))
-    return open(filename, mode)
-
-
 # =======================================================================
 # Auxiliary functions
 # =======================================================================
@@ -153,11 +145,11 @@ def process_headers(
 
 
 def get_line_id(
-    file: IO[str], field_index: int
-) -> tuple[str, list[str] | None, str | None]:
-    """Get the next line ID from a file."""
-    line = file.readline()
-    row = line.rstrip("\n").split("\t") if line else None
+    lines: Iterator[str], field_index: int
+) -> tuple[str | None, list[str] | None, str | None]:
+    """Get the next line ID from a file's line iterator (None at end of file)."""
+    line = next(lines, None)
+    row = line.split("\t") if line is not None else None
     id = row[field_index] if row else None
     return line, row, id
 
@@ -176,8 +168,7 @@ def check_sorting(
 def copy_file(file: IO[str], header: list[str], output: IO[str]) -> None:
     """Copy a file to the output file, starting with header."""
     write_line(header, output)
-    for line in file:
-        output.write(line)
+    shutil.copyfileobj(file, output, BUFFER_SIZE)
 
 
 def handle_empty_files(
@@ -234,14 +225,19 @@ def handle_empty_files(
 
 
 def join_tsvs(
-    input_path_1: str, input_path_2: str, field: str, join_type: str, output_path: str
+    input_path_1: str,
+    input_path_2: str,
+    field: str,
+    join_type: str,
+    output_path: str,
+    metrics: TaskMetrics | None = None,
 ) -> None:
     """Join two sorted TSV files linewise on a shared column."""
     # Open files for normal processing
     with (
-        open_by_suffix(input_path_1, "r") as file_1,
-        open_by_suffix(input_path_2, "r") as file_2,
-        open_by_suffix(output_path, "w") as output,
+        open_by_suffix(input_path_1, "r", metrics) as file_1,
+        open_by_suffix(input_path_2, "r", metrics) as file_2,
+        open_by_suffix(output_path, "w", metrics) as output,
     ):
         # Read header lines and check for empty files
         header_line_1 = file_1.readline().strip()
@@ -272,16 +268,18 @@ def join_tsvs(
         placeholder_file1 = ["NA"] * (len(header_1) - 1)
         placeholder_file2 = ["NA"] * (len(header_2) - 1)
         # Get first two lines from each file
-        line_1_curr, row_1_curr, id_1_curr = get_line_id(file_1, field_index_1)
-        line_1_next, row_1_next, id_1_next = get_line_id(file_1, field_index_1)
+        lines_1 = iter_lines(file_1)
+        lines_2 = iter_lines(file_2)
+        line_1_curr, row_1_curr, id_1_curr = get_line_id(lines_1, field_index_1)
+        line_1_next, row_1_next, id_1_next = get_line_id(lines_1, field_index_1)
         logger.debug(f"Reading current line from file 1: {row_1_curr}, {id_1_curr}")
         logger.debug(f"Reading next line from file 1: {row_1_next}, {id_1_next}")
-        line_2_curr, row_2_curr, id_2_curr = get_line_id(file_2, field_index_2)
-        line_2_next, row_2_next, id_2_next = get_line_id(file_2, field_index_2)
+        line_2_curr, row_2_curr, id_2_curr = get_line_id(lines_2, field_index_2)
+        line_2_next, row_2_next, id_2_next = get_line_id(lines_2, field_index_2)
         logger.debug(f"Reading current line from file 2: {row_2_curr}, {id_2_curr}")
         logger.debug(f"Reading next line from file 2: {row_2_next}, {id_2_next}")
         # Iterate until we exhaust either file
-        while line_1_curr and line_2_curr:
+        while line_1_curr is not None and line_2_curr is not None:
             assert row_1_curr is not None and id_1_curr is not None
             assert row_2_curr is not None and id_2_curr is not None
             # Verify that files are sorted
@@ -307,7 +305,7 @@ def join_tsvs(
                         id_1_next,
                     )
                     line_1_next, row_1_next, id_1_next = get_line_id(
-                        file_1, field_index_1
+                        lines_1, field_index_1
                     )
                     logger.debug(
                         f"Updated current line from file 1: {row_1_curr}, {id_1_curr}"
@@ -321,7 +319,7 @@ def join_tsvs(
                         id_2_next,
                     )
                     line_2_next, row_2_next, id_2_next = get_line_id(
-                        file_2, field_index_2
+                        lines_2, field_index_2
                     )
                     logger.debug(
                         f"Updated current line from file 2: {row_2_curr}, {id_2_curr}"
@@ -339,7 +337,7 @@ def join_tsvs(
                         id_2_next,
                     )
                     line_2_next, row_2_next, id_2_next = get_line_id(
-                        file_2, field_index_2
+                        lines_2, field_index_2
                     )
                     logger.debug(
                         f"Updated current line from file 2: {row_2_curr}, {id_2_curr}"
@@ -357,7 +355,7 @@ def join_tsvs(
                         id_1_next,
                     )
                     line_1_next, row_1_next, id_1_next = get_line_id(
-                        file_1, field_index_1
+                        lines_1, field_index_1
                     )
                     logger.debug(
                         f"Updated current line from file 1: {row_1_curr}, {id_1_curr}"
@@ -387,7 +385,7 @@ def join_tsvs(
                     logger.debug("Skipping line.")
                 logger.debug("Advancing file 1.")
                 line_1_curr, row_1_curr, id_1_curr = line_1_next, row_1_next, id_1_next
-                line_1_next, row_1_next, id_1_next = get_line_id(file_1, field_index_1)
+                line_1_next, row_1_next, id_1_next = get_line_id(lines_1, field_index_1)
                 logger.debug(
                     f"Updated current line from file 1: {row_1_curr}, {id_1_curr}"
                 )
@@ -416,7 +414,7 @@ def join_tsvs(
                     logger.debug("Skipping line.")
                 logger.debug("Advancing file 2.")
                 line_2_curr, row_2_curr, id_2_curr = line_2_next, row_2_next, id_2_next
-                line_2_next, row_2_next, id_2_next = get_line_id(file_2, field_index_2)
+                line_2_next, row_2_next, id_2_next = get_line_id(lines_2, field_index_2)
                 logger.debug(
                     f"Updated current line from file 2: {row_2_curr}, {id_2_curr}"
                 )
@@ -424,7 +422,7 @@ def join_tsvs(
                     f"Updated next line from file 2: {row_2_next}, {id_2_next}"
                 )
         # Read out file 1
-        while line_1_curr:
+        while line_1_curr is not None:
             assert row_1_curr is not None and id_1_curr is not None
             logger.debug(f"Reading current line from file 1 only: {id_1_curr}")
             check_sorting(id_1_curr, id_1_next, "1", input_path_1)
@@ -439,11 +437,11 @@ def join_tsvs(
                 logger.debug("Skipping line.")
             logger.debug("Advancing file 1.")
             line_1_curr, row_1_curr, id_1_curr = line_1_next, row_1_next, id_1_next
-            line_1_next, row_1_next, id_1_next = get_line_id(file_1, field_index_1)
+            line_1_next, row_1_next, id_1_next = get_line_id(lines_1, field_index_1)
             logger.debug(f"Updated current line from file 1: {row_1_curr}, {id_1_curr}")
             logger.debug(f"Updated next line from file 1: {row_1_next}, {id_1_next}")
         # Read out file 2
-        while line_2_curr:
+        while line_2_curr is not None:
             assert row_2_curr is not None and id_2_curr is not None
             logger.debug(f"Reading current line from file 2 only: {id_2_curr}")
             check_sorting(id_2_curr, id_2_next, "2", input_path_2)
@@ -464,7 +462,7 @@ def join_tsvs(
                 logger.debug("Skipping line.")
             logger.debug("Advancing file 2.")
             line_2_curr, row_2_curr, id_2_curr = line_2_next, row_2_next, id_2_next
-            line_2_next, row_2_next, id_2_next = get_line_id(file_2, field_index_2)
+            line_2_next, row_2_next, id_2_next = get_line_id(lines_2, field_index_2)
             logger.debug(f"Updated current line from file 2: {row_2_curr}, {id_2_curr}")
             logger.debug(f"Updated next line from file 2: {row_2_next}, {id_2_next}")
 
@@ -483,7 +481,15 @@ def main() -> None:
     logger.info(f"Arguments: {args}")
     # Run joining function
     logger.info("Executing join.")
-    join_tsvs(args.tsv1, args.tsv2, args.field, args.join_type, args.output_file)
+    with TaskMetrics("join_tsvs") as metrics, metrics.phase("join"):
+        join_tsvs(
+            args.tsv1,
+            args.tsv2,
+            args.field,
+            args.join_type,
+            args.output_file,
+            metrics,
+        )
     # Log completion
     logger.info("Script completed successfully.")
     end_time = time.time()
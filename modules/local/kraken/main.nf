@@ -13,19 +13,18 @@ process KRAKEN {
         tuple val(sample), path("input_${reads}"), emit: input
     script:
         def extractCmd = reads.toString().endsWith(".gz") ? "zcat" : "cat"
-        def out = "${sample}.output"
+        def out = "${sample}.output.gz"
         def report = "${sample}.report"
         def par = "--use-names --report-minimizer-data --threads ${task.cpus} --report ${report} --memory-mapping"
         """
+        set -euo pipefail
         # Download Kraken2 database if not already present
         db_local_path=\$(download_db.py "${db_path}" ${db_download_timeout})
-        # Run Kraken
-        ${extractCmd} ${reads} | kraken2 --db \${db_local_path} ${par} /dev/fd/0 > ${out}
-        # Make empty output files if needed
-        touch ${out}
+        # Run Kraken, gzipping per-read output as it is written
+        ${extractCmd} ${reads} | kraken2 --db \${db_local_path} ${par} /dev/fd/0 | gzip -c > ${out}
+        # Make empty report if needed
         touch ${report}
-        # Gzip output and report to save space
-        gzip ${out}
+        # Gzip report to save space
         gzip ${report}
         # Link input to output for testing
         ln -s ${reads} input_${reads}
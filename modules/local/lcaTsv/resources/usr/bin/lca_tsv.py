@@ -12,12 +12,13 @@ taxid across all taxids in the group.
 
 # Import libraries
 import argparse
-import gzip
 import logging
 from collections import defaultdict
 from dataclasses import dataclass
 from datetime import UTC, datetime
-from typing import IO, cast
+from typing import IO
+
+from nao_io import TaskMetrics, iter_lines, open_by_suffix
 
 
 # Configure logging
@@ -671,6 +672,7 @@ def parse_input_tsv(
     artificial_taxids: set[int],
     unclassified_taxids: set[int],
     prefix: str,
+    metrics: TaskMetrics | None = None,
 ) -> None:
     """
     Iterate linewise over input TSV, calculating the LCA for each group
@@ -687,8 +689,12 @@ def parse_input_tsv(
         unclassified_taxids (set[int]): Set of taxids that represent unclassified
             sequences.
         prefix (str): Prefix for output columns.
+        metrics (TaskMetrics | None): Metrics to tally input and output TSV I/O.
     """
-    with open_by_suffix(input_path) as inf, open_by_suffix(output_path, "w") as outf:
+    with (
+        open_by_suffix(input_path, metrics=metrics) as inf,
+        open_by_suffix(output_path, "w", metrics) as outf,
+    ):
         # Read header from input file
         header = inf.readline().strip().split("\t")
         logger.debug(f"Header: {header}")
@@ -726,7 +732,7 @@ def parse_input_tsv(
         n_entries = 1
         n_groups = 1
         path_cache: dict[int, list[int]] = {}
-        for line in inf:
+        for line in iter_lines(inf):
             # Parse fields
             fields = line.strip().split("\t")
             # Get group ID and check sorting
@@ -780,7 +786,7 @@ def parse_nodes_db(
     parent_to_children: dict[int, set[int]] = defaultdict(set)
     # Read file line by line and parse into dictionaries
     with open_by_suffix(path) as f:
-        for line in f:
+        for line in iter_lines(f):
             fields = line.strip().split("\t")
             taxid = int(fields[0])
             parent_taxid = int(fields[2])
@@ -845,7 +851,7 @@ def parse_names_db(path: str) -> dict[int, set[str]]:
     """
     names_db: dict[int, set[str]] = defaultdict(set)
     with open_by_suffix(path) as f:
-        for line in f:
+        for line in iter_lines(f):
             fields = line.strip().split("\t")
             taxid = int(fields[0])
             name = fields[2]
@@ -913,24 +919,22 @@ def parse_args() -> argparse.Namespace:
     return parser.parse_args()
 
 
-def open_by_suffix(filename: str, mode: str = "r", debug: bool = False) -> IO[str]:
-    """Parse the suffix of a filename to determine the right open method
-    to use, then open the file. Can handle .gz and uncompressed files."""
-    if filename.endswith(".gz"):
-        return cast(IO[str], gzip.open(filename, mode + "t"))
-    return open(filename, mode)
-
-
 # =======================================================================
 # Main function
 # =======================================================================
 
 
-def main() -> None:
-    logger.info("Initializing script.")
-    # Parse arguments
-    logger.info("Parsing arguments.")
-    args = parse_args()
+def load_taxonomy(
+    args: argparse.Namespace,
+) -> tuple[dict[int, int], set[int], set[int]]:
+    """
+    Load the taxonomy DBs and derive the unclassified and artificial taxid sets.
+    Args:
+        args (argparse.Namespace): Parsed arguments.
+    Returns:
+        tuple[dict[int, int], set[int], set[int]]: Child-to-parent mapping,
+            unclassified taxids (with descendants) and artificial taxids.
+    """
     # Import taxonomy DB and process into dictionaries
     logger.info("Parsing taxonomy DB.")
     child_to_parent, parent_to_children = parse_nodes_db(
@@ -954,19 +958,36 @@ def main() -> None:
     logger.info("Getting set of artificial taxids.")
     artificial_taxids = get_descendants({int(args.artificial)}, parent_to_children)
     logger.info(f"Found {len(artificial_taxids)} artificial taxids.")
-    # Parse input TSV and write LCA information to output TSV
+    return child_to_parent, unclassified_taxids_descendants, artificial_taxids
+
+
+def run_lca(args: argparse.Namespace, metrics: TaskMetrics) -> None:
+    """Load the taxonomy (parse phase), then stream LCAs over the input (group)."""
+    with metrics.phase("parse"):
+        child_to_parent, unclassified, artificial = load_taxonomy(args)
     logger.info("Parsing input TSV.")
-    parse_input_tsv(
-        args.input,
-        args.output,
-        args.group,
-        args.taxid,
-        args.score,
-        child_to_parent,
-        artificial_taxids,
-        unclassified_taxids_descendants,
-        args.prefix,
-    )
+    with metrics.phase("group"):
+        parse_input_tsv(
+            args.input,
+            args.output,
+            args.group,
+            args.taxid,
+            args.score,
+            child_to_parent,
+            artificial,
+            unclassified,
+            args.prefix,
+            metrics,
+        )
+
+
+def main() -> None:
+    logger.info("Initializing script.")
+    # Parse arguments
+    logger.info("Parsing arguments.")
+    args = parse_args()
+    with TaskMetrics("lca_tsv") as metrics:
+        run_lca(args, metrics)
     # Log completion
     logger.info("Script complete.")
 
@@ -19,3 +19,28 @@ process MARK_ALIGNMENT_DUPLICATES {
     ln -s ${tsv} input_${tsv} # Link output to input for testing
     """
 }
+
+// Mark alignment duplicates in each TSV of a batch of (sample, TSV) work items, in one task
+// Groups run concurrently on a shared thread pool; outputs keep their per-sample names, as they
+// are published directly, and are split with BatchUtils.fromNamedBatch
+process MARK_ALIGNMENT_DUPLICATES_BATCH {
+    label "mark_alignment_duplicates_resources"
+    label "rust_tools"
+    tag "id=batch,first=${samples[0]},n=${samples.size()}"
+    input:
+        tuple val(samples), path(tsv, arity: "1..*", stageAs: "in_*/*")
+        val(fuzzy_match)
+    output:
+        tuple val(samples), path("*_duplicate_reads.tsv.gz"), emit: reads
+        tuple val(samples), path("*_duplicate_stats.tsv.gz"), emit: stats
+    script:
+        // Manifest fields, one group after another; printf repeats its format for each group
+        def manifest = samples.withIndex().collect { sample, i ->
+            [sample, tsv[i], "${sample}_duplicate_reads.tsv.gz", "${sample}_duplicate_stats.tsv.gz"].collect { f -> "\"${f}\"" }.join(" ")
+        }.join(" ")
+        """
+        set -euo pipefail
+        printf '%s\\t%s\\t%s\\t%s\\n' ${manifest} > manifest.tsv
+        mark_duplicates --manifest manifest.tsv -d ${fuzzy_match} -n ${task.cpus}
+        """
+}
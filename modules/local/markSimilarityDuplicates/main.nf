@@ -5,12 +5,37 @@ process MARK_SIMILARITY_DUPLICATES {
     tag "id=${sample}"
     input:
         tuple val(sample), path(tsv)
+        val(outname)
     output:
-        tuple val(sample), path("similarity-duplicate-marked_${tsv}"), emit: output
+        tuple val(sample), path("${sample}_${outname}"), emit: output
         tuple val(sample), path("input_${tsv}"), emit: input
     script:
     """
-    mark_duplicates_similarity -i "${tsv}" -o "similarity-duplicate-marked_${tsv}"
+    mark_duplicates_similarity -i "${tsv}" -o "${sample}_${outname}"
     ln -s "${tsv}" "input_${tsv}"
     """
 }
+
+// Mark similarity duplicates in each TSV of a batch of (sample, TSV) work items, in one task
+// Up to task.cpus groups run concurrently; outputs keep their per-sample names, as they are
+// published directly, and are split with BatchUtils.fromNamedBatch
+process MARK_SIMILARITY_DUPLICATES_BATCH {
+    label "xsmall"
+    label "rust_tools"
+    tag "id=batch,first=${samples[0]},n=${samples.size()}"
+    input:
+        tuple val(samples), path(tsv, arity: "1..*", stageAs: "in_*/*")
+        val(outname)
+    output:
+        tuple val(samples), path("*_${outname}"), emit: output
+    script:
+        // Manifest fields, one group after another; printf repeats its format for each group
+        def manifest = samples.withIndex().collect { sample, i ->
+            [sample, tsv[i], "${sample}_${outname}"].collect { f -> "\"${f}\"" }.join(" ")
+        }.join(" ")
+        """
+        set -euo pipefail
+        printf '%s\\t%s\\t%s\\n' ${manifest} > manifest.tsv
+        mark_duplicates_similarity --manifest manifest.tsv -t ${task.cpus}
+        """
+}
@@ -39,3 +39,38 @@ process MASK_FASTQ_READS {
         ln -s ${reads} ${sample}_in.fastq.gz
         """
 }
+
+// Native replacement for MASK_FASTQ_READS using the same sliding-window k-mer entropy
+// criterion, multithreaded with parallel gzip output. Optionally applies filtlong-style
+// length/quality filters in the same pass (replacing a separate FILTLONG step), in which
+// case the unmasked passing reads are also emitted as `filtered`.
+// Tool source: rust-tools/mask_reads/
+process MASK_FASTQ_READS_NATIVE {
+    label "rust_tools"
+    label "small"
+    tag "id=${sample}"
+    input:
+        tuple val(sample), path(reads)
+        val(window_size)
+        val(entropy)
+        val(filter_params) // Optional: min_length, max_length, min_mean_q ([:] to skip filtering)
+    output:
+        tuple val(sample), path("${sample}_masked.fastq.gz"), emit: masked
+        tuple val(sample), path("${sample}_filtered.fastq.gz"), emit: filtered, optional: true
+        tuple val(sample), path("${sample}_in.fastq.gz"), emit: input
+    script:
+        def filter_args = [
+            filter_params.min_length != null ? "--min-length ${filter_params.min_length}" : "",
+            filter_params.max_length != null ? "--max-length ${filter_params.max_length}" : "",
+            filter_params.min_mean_q != null ? "--min-mean-q ${filter_params.min_mean_q}" : "",
+        ].findAll { it }
+        def filtered_arg = filter_args ? "--filtered-output ${sample}_filtered.fastq.gz" : ""
+        def i = reads[0]
+        """
+        set -eou pipefail
+        mask_reads -i ${i} -o ${sample}_masked.fastq.gz ${filtered_arg} \\
+            -w ${window_size} -e ${entropy} -t ${task.cpus} ${filter_args.join(" ")}
+        # Link input to output for testing
+        ln -s ${i} ${sample}_in.fastq.gz
+        """
+}
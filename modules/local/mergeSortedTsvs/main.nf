@@ -0,0 +1,21 @@
+// Merge TSVs that are each sorted on a key column into one TSV sorted on that column (streaming k-way merge),
+// optionally appending a column that holds the label, and writing the result under its final name (<label>_<outname>)
+process MERGE_SORTED_TSVS_LABELED {
+    label "python"
+    label "single"
+    tag "id=${label}"
+    input:
+        tuple val(label), path(tsvs, arity: "1..*", stageAs: "in_*/*")
+        val(key_field) // Column every input is sorted on
+        val(label_column) // Name of the label column to append (empty for none)
+        val(outname)
+    output:
+        tuple val(label), path("${label}_${outname}"), emit: output
+        tuple val(label), path("${label}_input_${tsvs[0].name}"), emit: input
+    script:
+        def label_par = label_column ? "--label-column ${label_column} --label ${label}" : ""
+        """
+        merge_sorted_tsvs.py -k ${key_field} ${label_par} -o ${label}_${outname} ${tsvs}
+        ln -s ${tsvs[0]} ${label}_input_${tsvs[0].name} # Link input to output for testing
+        """
+}
@@ -0,0 +1,217 @@
+#!/usr/bin/env python
+
+DESC = """
+Merge TSV files that are each sorted on a key column into a single TSV sorted
+on that column, with a streaming k-way merge that holds one row per input in
+memory. Columns of later inputs are reordered to match the first non-empty
+input, and an optional label column with a constant value is appended to
+every row. Empty inputs are skipped; rows with equal keys keep input order.
+"""
+
+# =======================================================================
+# Import libraries
+# =======================================================================
+
+import argparse
+import heapq
+import logging
+import time
+from collections.abc import Iterator
+from contextlib import ExitStack
+from datetime import UTC, datetime
+from operator import itemgetter
+
+from nao_io import TaskMetrics, iter_lines, open_by_suffix, write_lines
+
+# =======================================================================
+# Configure logging
+# =======================================================================
+
+
+class UTCFormatter(logging.Formatter):
+    def formatTime(self, record: logging.LogRecord, datefmt: str | None = None) -> str:
+        dt = datetime.fromtimestamp(record.created, UTC)
+        return dt.strftime("%Y-%m-%d %H:%M:%S UTC")
+
+
+logging.basicConfig(level=logging.INFO)
+logger = logging.getLogger()
+handler = logging.StreamHandler()
+formatter = UTCFormatter("[%(asctime)s] %(message)s")
+handler.setFormatter(formatter)
+logger.handlers.clear()
+logger.addHandler(handler)
+
+# =======================================================================
+# I/O functions
+# =======================================================================
+
+
+def parse_args() -> argparse.Namespace:
+    """Parse command-line arguments."""
+    # Create parser
+    parser = argparse.ArgumentParser(description=DESC)
+    # Add arguments
+    parser.add_argument("input_files", nargs="+", help="Paths to sorted input TSVs.")
+    parser.add_argument("--output", "-o", required=True, help="Path to output TSV.")
+    parser.add_argument(
+        "--key", "-k", required=True, help="Column the inputs are sorted on."
+    )
+    parser.add_argument(
+        "--label-column", help="Name of a label column to append to every row."
+    )
+    parser.add_argument("--label", help="Value of the label column.")
+    # Parse arguments
+    args = parser.parse_args()
+    if (args.label_column is None) != (args.label is None):
+        parser.error("--label-column and --label must be given together")
+    return args
+
+
+def check_header(header: list[str], reference: list[str], path: str) -> None:
+    """Check that a header has the same fields as the reference header.
+    Args:
+        header: Header fields of an input.
+        reference: Header fields of the first non-empty input.
+        path: Path of the input, for error messages.
+    Raises:
+        ValueError: If the fields differ.
+    """
+    if set(header) == set(reference) and len(header) == len(reference):
+        return
+    missing = set(reference) - set(header)
+    extra = set(header) - set(reference)
+    raise ValueError(
+        f"Headers do not match ({path}): missing fields {missing}, extra fields {extra}"
+    )
+
+
+# =======================================================================
+# Merging functions
+# =======================================================================
+
+
+def iter_keyed_rows(
+    lines: Iterator[str],
+    key_index: int,
+    mapping: list[int] | None,
+    suffix: str,
+    path: str,
+) -> Iterator[tuple[str, str]]:
+    """Yield (key, output line) for each row of a sorted input.
+    Args:
+        lines: Data lines of the input, without trailing newlines.
+        key_index: Index of the key column in the input.
+        mapping: Input column index for each output column, or None if the
+            input columns are already in output order.
+        suffix: Text appended to each output line (e.g. a label column).
+        path: Path of the input, for error messages.
+    Yields:
+        Sort key and output line of each row, in input order.
+    Raises:
+        ValueError: If the input is not sorted on the key column.
+    """
+    previous: str | None = None
+    for line in lines:
+        if not line:
+            continue
+        fields = line.split("\t")
+        key = fields[key_index]
+        if previous is not None and key < previous:
+            raise ValueError(
+                f"Input {path} is not sorted: encountered key {key} after {previous}."
+            )
+        previous = key
+        if mapping is not None:
+            line = "\t".join([fields[i] for i in mapping])
+        yield key, line + suffix
+
+
+def merge_sorted_tsvs(
+    input_paths: list[str],
+    output_path: str,
+    key_field: str,
+    label_column: str | None = None,
+    label: str | None = None,
+    metrics: TaskMetrics | None = None,
+) -> int:
+    """Merge TSVs sorted on a key column into one TSV sorted on that column.
+    Args:
+        input_paths: Paths to input TSVs, each sorted on key_field.
+        output_path: Path to output TSV.
+        key_field: Column the inputs are sorted on.
+        label_column: Optional name of a column to append to every row.
+        label: Value of the label column.
+        metrics: Optional task metrics.
+    Returns:
+        Number of data rows written.
+    """
+    suffix = f"\t{label}" if label_column is not None else ""
+    with ExitStack() as stack:
+        outf = stack.enter_context(open_by_suffix(output_path, "w", metrics))
+        reference: list[str] | None = None
+        streams: list[Iterator[tuple[str, str]]] = []
+        for path in input_paths:
+            inf = stack.enter_context(open_by_suffix(path, "r", metrics))
+            header_line = inf.readline().rstrip("\n")
+            if not header_line.strip():
+                logger.warning(f"Input file is empty, skipping: {path}")
+                continue
+            header = header_line.split("\t")
+            if reference is None:
+                if key_field not in header:
+                    raise ValueError(f"Key field '{key_field}' not in header: {path}")
+                if label_column is not None and label_column in header:
+                    raise ValueError(f"Label column already exists: {label_column}")
+                reference = header
+                outf.write("\t".join(header + ([label_column] if suffix else [])))
+                outf.write("\n")
+            else:
+                check_header(header, reference, path)
+            mapping = None
+            if header != reference:
+                mapping = [header.index(field) for field in reference]
+            key_index = header.index(key_field)
+            streams.append(
+                iter_keyed_rows(iter_lines(inf), key_index, mapping, suffix, path)
+            )
+        if reference is None:
+            logger.warning("All input files are empty; writing empty output.")
+            return 0
+        merged = heapq.merge(*streams, key=itemgetter(0))
+        return write_lines(outf, (line for _key, line in merged))
+
+
+# =======================================================================
+# Main function
+# =======================================================================
+
+
+def main() -> None:
+    logger.info("Initializing script.")
+    start_time = time.time()
+    # Parse arguments
+    logger.info("Parsing arguments.")
+    args = parse_args()
+    logger.info(f"Arguments: {args}")
+    # Merge inputs
+    with TaskMetrics("merge_sorted_tsvs") as metrics:
+        logger.info(f"Merging {len(args.input_files)} inputs sorted on {args.key}.")
+        with metrics.phase("merge"):
+            n_rows = merge_sorted_tsvs(
+                args.input_files,
+                args.output,
+                args.key,
+                args.label_column,
+                args.label,
+                metrics,
+            )
+    logger.info(f"Wrote {n_rows} rows.")
+    # Log completion
+    logger.info("Script completed successfully.")
+    end_time = time.time()
+    logger.info(f"Total time elapsed: {end_time - start_time} seconds")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,73 @@
+#!/usr/bin/env python
+
+from typing import Any
+
+import pytest
+from merge_sorted_tsvs import merge_sorted_tsvs
+
+
+class TestMergeSortedTsvs:
+    def run(self, tsv_factory: Any, contents: list[str], **kwargs: Any) -> str:
+        paths = [
+            tsv_factory.create_gzip(f"in_{i}.tsv.gz", text)
+            for i, text in enumerate(contents)
+        ]
+        out = tsv_factory.get_path("out.tsv.gz")
+        merge_sorted_tsvs(paths, out, "seq_id", **kwargs)
+        return tsv_factory.read_gzip(out)
+
+    def test_merges_in_key_order(self, tsv_factory: Any) -> None:
+        contents = [
+            "seq_id\tx\na\t1\nc\t3\nf\t6\n",
+            "seq_id\tx\nb\t2\nd\t4\n",
+            "seq_id\tx\ne\t5\n",
+        ]
+        out = self.run(tsv_factory, contents)
+        assert out == "seq_id\tx\na\t1\nb\t2\nc\t3\nd\t4\ne\t5\nf\t6\n"
+
+    def test_adds_label_column(self, tsv_factory: Any) -> None:
+        contents = ["seq_id\tx\nb\t2\n", "seq_id\tx\na\t1\n"]
+        out = self.run(tsv_factory, contents, label_column="group", label="g1")
+        assert out == "seq_id\tx\tgroup\na\t1\tg1\nb\t2\tg1\n"
+
+    def test_reorders_columns(self, tsv_factory: Any) -> None:
+        contents = ["seq_id\tx\ty\na\t1\t2\n", "y\tseq_id\tx\n4\tb\t3\n"]
+        out = self.run(tsv_factory, contents)
+        assert out == "seq_id\tx\ty\na\t1\t2\nb\t3\t4\n"
+
+    def test_equal_keys_keep_input_order(self, tsv_factory: Any) -> None:
+        contents = ["seq_id\tx\na\t2\n", "seq_id\tx\na\t1\n"]
+        assert self.run(tsv_factory, contents) == "seq_id\tx\na\t2\na\t1\n"
+
+    def test_skips_empty_inputs(self, tsv_factory: Any) -> None:
+        contents = ["", "seq_id\tx\n", "seq_id\tx\na\t1\n"]
+        assert self.run(tsv_factory, contents) == "seq_id\tx\na\t1\n"
+
+    def test_all_empty_inputs(self, tsv_factory: Any) -> None:
+        out = self.run(tsv_factory, ["", ""], label_column="group", label="g1")
+        assert out == ""
+
+    def test_matches_sorted_concatenation(self, tsv_factory: Any) -> None:
+        rows = [f"read{i:03d}\t{i}" for i in range(60)]
+        contents = [
+            "seq_id\tx\n" + "".join(r + "\n" for r in rows[i::4]) for i in range(4)
+        ]
+        out = self.run(tsv_factory, contents)
+        assert out.splitlines()[1:] == sorted(rows)
+
+    def test_unsorted_input_raises_error(self, tsv_factory: Any) -> None:
+        with pytest.raises(ValueError, match="is not sorted"):
+            self.run(tsv_factory, ["seq_id\tx\nb\t1\na\t2\n"])
+
+    def test_mismatched_headers_raise_error(self, tsv_factory: Any) -> None:
+        with pytest.raises(ValueError, match="Headers do not match"):
+            self.run(tsv_factory, ["seq_id\tx\na\t1\n", "seq_id\ty\nb\t1\n"])
+
+    def test_missing_key_raises_error(self, tsv_factory: Any) -> None:
+        with pytest.raises(ValueError, match="Key field"):
+            self.run(tsv_factory, ["id\tx\na\t1\n"])
+
+    def test_existing_label_column_raises_error(self, tsv_factory: Any) -> None:
+        with pytest.raises(ValueError, match="Label column already exists"):
+            contents = ["seq_id\tgroup\na\t1\n"]
+            self.run(tsv_factory, contents, label_column="group", label="g")
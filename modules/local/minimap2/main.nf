@@ -114,3 +114,85 @@ process MINIMAP2_NON_STREAMED {
 
         """
 }
+
+// Run human, contaminant and virus minimap2 screening as a single task, streaming
+// unmapped reads from each stage into the next rather than writing gzipped FASTQs,
+// then pull the unmasked sequences of virus-mapped reads from the unmasked input by read ID.
+// Masked and unmasked inputs must contain the same read IDs.
+process MINIMAP2_CHAINED {
+    label "max"
+    label "minimap2_samtools"
+    tag "id=${sample}"
+    input:
+        tuple val(sample), path(reads_masked), path(reads_unmasked)
+        val(index_dirs) // human, contam, virus
+        val(params_map) // human_alignment_params, contam_alignment_params, virus_alignment_params, db_download_timeout
+    output:
+        tuple val(sample), path("${sample}_virus_minimap2_mapped.sam.gz"), emit: sam
+        tuple val(sample), path("${sample}_virus_minimap2_mapped_unmasked.fastq.gz"), emit: reads_mapped
+        tuple val(sample), path("input_${reads_masked}"), path("input_${reads_unmasked}"), emit: input
+    script:
+        def sam = "${sample}_virus_minimap2_mapped.sam.gz"
+        def al = "${sample}_virus_minimap2_mapped_unmasked.fastq.gz"
+        """
+        set -euo pipefail
+        # Download Minimap2 indexes if not already present
+        human_idx=\$(download_db.py "${index_dirs.human}" "${params_map.db_download_timeout}")
+        contam_idx=\$(download_db.py "${index_dirs.contam}" "${params_map.db_download_timeout}")
+        virus_idx=\$(download_db.py "${index_dirs.virus}" "${params_map.db_download_timeout}")
+        # Stage 1: human. The contaminant index may have several parts, and minimap2
+        # re-reads its query once per part, so this stage's unmapped reads go to a plain
+        # (uncompressed) local file rather than a FIFO.
+        zcat -f ${reads_masked} \\
+            | minimap2 -a ${params_map.human_alignment_params} \${human_idx}/mm2_index.mmi /dev/fd/0 \\
+            | samtools fastq -f 4 - > no_human.fastq
+        # Stages 2-3: contaminants, then virus; unmapped reads stream through a FIFO
+        mkfifo no_contam.fastq
+        minimap2 -a ${params_map.contam_alignment_params} \${contam_idx}/mm2_index.mmi no_human.fastq \\
+            --split-prefix "mm2_split_" \\
+            | samtools fastq -f 4 - > no_contam.fastq &
+        contam_pid=\$!
+        minimap2 -a ${params_map.virus_alignment_params} \${virus_idx}/mm2_index.mmi no_contam.fastq \\
+            | samtools view -h -F 4 - | gzip -c > ${sam}
+        wait \${contam_pid}
+        rm no_human.fastq no_contam.fastq
+        # Carry over unmasked sequences of virus-mapped reads by read ID, in input order
+        zcat ${sam} | { grep -v '^@' || true; } | cut -f 1 | sort -u > virus_ids.txt
+        zcat -f ${reads_unmasked} \\
+            | awk -v ids_file=virus_ids.txt '
+                BEGIN { while ((getline id < ids_file) > 0) ids[id] = 1 }
+                NR % 4 == 1 { keep = (substr(\$1, 2) in ids) }
+                keep' \\
+            | gzip -c > ${al}
+        # Link input to output for testing
+        ln -s ${reads_masked} input_${reads_masked}
+        ln -s ${reads_unmasked} input_${reads_unmasked}
+        """
+}
+
+// Align the sequences of a FASTA file against a minimap2 index, writing all
+// primary and secondary alignments as PAF with base-level alignment (-c)
+process MINIMAP2_PAF {
+    label "max"
+    label "minimap2_samtools"
+    tag "id=${sample}"
+    input:
+        tuple val(sample), path(fasta)
+        val(index_dir)
+        val(params_map) // suffix, alignment_params, db_download_timeout
+    output:
+        tuple val(sample), path("${sample}_${params_map.suffix}.paf.gz"), emit: output
+        tuple val(sample), path("input_${fasta}"), emit: input
+    script:
+        """
+        set -euo pipefail
+        # Download Minimap2 index if not already present
+        idx_local_path=\$(download_db.py "${index_dir}" "${params_map.db_download_timeout}")
+        # Large indexes are built in several parts, which --split-prefix merges correctly
+        minimap2 -c ${params_map.alignment_params} -t ${task.cpus} --split-prefix "mm2_split_" \\
+            \${idx_local_path}/mm2_index.mmi ${fasta} \\
+            | gzip -c > ${sample}_${params_map.suffix}.paf.gz
+        # Link input to output for testing
+        ln -s ${fasta} input_${fasta}
+        """
+}
@@ -106,3 +106,105 @@ process NUCLEAZE {
         ln -s ${r2} input_${r2}
         """
 }
+
+// Nucleaze k-mer split on a single interleaved or single-end FASTQ
+// (e.g. PROFILE's ribosomal split, which previously used BBDUK).
+// Interleaved input is de-interleaved into paired FIFOs so mates are
+// classified together; outputs are interleaved (or single-end) gzipped
+// FASTQs, with the same keep_match / keep_nomatch options as NUCLEAZE.
+// Nucleaze only takes an absolute --minhits; given min_kmer_fraction instead,
+// minhits is derived per sample from the mean length of the first 10,000 reads,
+// approximating BBDuk's per-read minkmerfraction.
+process NUCLEAZE_STREAMED {
+    label "small"
+    label "rust_tools"
+    tag "id=${sample}"
+    input:
+        tuple val(sample), path(reads)   // Interleaved or single-end
+        path(index)
+        val(params_map)                  // k, minhits or min_kmer_fraction, suffix, interleaved, keep_match?, keep_nomatch?
+    output:
+        tuple val(sample), path("input_${reads}"), emit: input
+        tuple val(sample), path("${sample}_${params_map.suffix}_nucleaze_nomatch.fastq.gz"), emit: nomatch, optional: true
+        tuple val(sample), path("${sample}_${params_map.suffix}_nucleaze_match.fastq.gz"), emit: match, optional: true
+        tuple val(sample), path("${sample}_${params_map.suffix}_nucleaze.stats.txt"), emit: log
+    script:
+        def keep_match = params_map.get("keep_match", true)
+        def keep_nomatch = params_map.get("keep_nomatch", true)
+        if (!keep_match && !keep_nomatch) {
+            throw new IllegalArgumentException(
+                "NUCLEAZE_STREAMED: at least one of keep_match / keep_nomatch must be true"
+            )
+        }
+        def nomatch_out = "${sample}_${params_map.suffix}_nucleaze_nomatch.fastq.gz"
+        def match_out = "${sample}_${params_map.suffix}_nucleaze_match.fastq.gz"
+        def stats = "${sample}_${params_map.suffix}_nucleaze.stats.txt"
+        def interleaved_str = params_map.interleaved.toString()
+        def keep_match_str = keep_match.toString()
+        def keep_nomatch_str = keep_nomatch.toString()
+        def empty_match_cmd   = keep_match   ? "gzip -c < /dev/null > ${match_out}"   : ""
+        def empty_nomatch_cmd = keep_nomatch ? "gzip -c < /dev/null > ${nomatch_out}" : ""
+        def fraction = params_map.get("min_kmer_fraction")
+        def minhits_cmd = fraction ? """
+            mean_len=\$(pigz -dcf ${reads} | head -n 40000 | awk 'NR % 4 == 2 { n++; s += length(\$0) } END { print (n ? s / n : 0) }' || true)
+            minhits=\$(awk -v f=${fraction} -v l="\${mean_len}" -v k=${params_map.k} 'BEGIN { h = f * (l - k + 1); m = int(h); if (m < h) m++; print (m < 1 ? 1 : m) }')
+            >&2 echo "Mean read length \${mean_len}; using minhits \${minhits} for min_kmer_fraction ${fraction}"
+            """ : "minhits=${params_map.minhits}"
+        def nucleaze_args = "--binref ${index} --k ${params_map.k} --minhits \${minhits} --canonical --threads ${task.cpus}"
+        """
+        set -euo pipefail
+        # nucleaze emits no files on empty input — synthesise empty gzips.
+        first=\$(pigz -dcf ${reads} | head -c 1 || true)
+        if [[ -z "\${first}" ]]; then
+            >&2 echo "Warning: Input read file is empty. Creating empty output files."
+            ${empty_match_cmd}
+            ${empty_nomatch_cmd}
+            echo "No data - empty input file" > ${stats}
+        else
+            ${minhits_cmd}
+            tmpdir=\$(mktemp -d)
+            trap 'rm -rf "\${tmpdir}"' EXIT
+            PIDS=()
+            # Input: decompress via pigz into named FIFOs (see NUCLEAZE), splitting
+            # interleaved input into R1 / R2 streams (lines 1-4 / 5-8 of every 8).
+            mkfifo "\${tmpdir}/in1.fifo"
+            in_args="--in \${tmpdir}/in1.fifo"
+            if [[ "${interleaved_str}" == "true" ]]; then
+                # Each FIFO gets its own writer so the order in which nucleaze
+                # opens them cannot deadlock.
+                mkfifo "\${tmpdir}/in2.fifo" "\${tmpdir}/raw2.fifo"
+                in_args="\${in_args} --in2 \${tmpdir}/in2.fifo"
+                pigz -dcf -p 2 < ${reads} | tee "\${tmpdir}/raw2.fifo" \\
+                    | awk '(NR - 1) % 8 < 4' > "\${tmpdir}/in1.fifo" & PIDS+=(\$!)
+                awk '(NR - 1) % 8 >= 4' < "\${tmpdir}/raw2.fifo" > "\${tmpdir}/in2.fifo" & PIDS+=(\$!)
+            else
+                pigz -dcf -p 2 < ${reads} > "\${tmpdir}/in1.fifo" & PIDS+=(\$!)
+            fi
+            # Output: named FIFOs into pigz, as in NUCLEAZE.
+            outm=/dev/null; outu=/dev/null
+            if [[ "${keep_match_str}" == "true" ]]; then
+                mkfifo "\${tmpdir}/match.fifo"
+                pigz -p ${task.cpus} -1 < "\${tmpdir}/match.fifo" > ${match_out} & PIDS+=(\$!)
+                outm="\${tmpdir}/match.fifo"
+            fi
+            if [[ "${keep_nomatch_str}" == "true" ]]; then
+                mkfifo "\${tmpdir}/nomatch.fifo"
+                pigz -p ${task.cpus} -1 < "\${tmpdir}/nomatch.fifo" > ${nomatch_out} & PIDS+=(\$!)
+                outu="\${tmpdir}/nomatch.fifo"
+            fi
+            pipestatus=(0 0)
+            nucleaze \${in_args} --outm "\${outm}" --outu "\${outu}" ${nucleaze_args} 2>&1 | tee ${stats} || pipestatus=("\${PIPESTATUS[@]}")
+            nucleaze_status=\${pipestatus[0]}
+            tee_status=\${pipestatus[1]}
+            if [[ "\${nucleaze_status}" -ne 0 ]]; then
+                # Tear down FIFO helpers blocked in open() so the task fails fast.
+                kill "\${PIDS[@]}" 2>/dev/null || true
+                wait "\${PIDS[@]}" 2>/dev/null || true
+                exit "\${nucleaze_status}"
+            fi
+            for pid in "\${PIDS[@]}"; do wait "\${pid}"; done
+            [[ "\${tee_status}" -eq 0 ]] || exit "\${tee_status}"
+        fi
+        ln -s ${reads} input_${reads}
+        """
+}
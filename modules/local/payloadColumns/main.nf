@@ -0,0 +1,48 @@
+// Split wide payload columns (e.g. read sequences and qualities) out of a TSV into a row-numbered side file,
+// leaving a narrow TSV with a row-number column for downstream joins, filters and column selections.
+// The encoding map may list payload columns to pack at 2 bits per base (pack; decoded by ATTACH_PAYLOAD_COLUMNS)
+// and quality columns to bin to 8 levels (bin; lossy), or be empty to store the payload as text
+process SPLIT_PAYLOAD_COLUMNS {
+    label "python"
+    label "single"
+    tag "id=${sample}"
+    input:
+        tuple val(sample), path(tsv)
+        val(payload_cols) // List of columns to split out
+        val(encoding) // Map of payload columns to pack and bin (empty for plain text)
+    output:
+        tuple val(sample), path("${sample}_narrow.tsv.gz"), path("${sample}_payload.tsv.gz"), emit: output
+        tuple val(sample), path("input_${tsv}"), emit: input
+    script:
+        def pack_par = encoding.pack ? "--pack-columns ${encoding.pack.join(",")}" : ""
+        def bin_par = encoding.bin ? "--bin-columns ${encoding.bin.join(",")}" : ""
+        """
+        split_payload_columns.py -i ${tsv} -n ${sample}_narrow.tsv.gz -p ${sample}_payload.tsv.gz -c ${payload_cols.join(",")} ${pack_par} ${bin_par}
+        # Link input to output for testing
+        ln -s ${tsv} input_${tsv}
+        """
+}
+
+// Re-attach payload columns to a narrow TSV derived from SPLIT_PAYLOAD_COLUMNS output (row order preserved, rows may be dropped),
+// writing the columns in the given order under the final output name (<sample>_<outname>)
+process ATTACH_PAYLOAD_COLUMNS {
+    label "python"
+    label "single"
+    tag "id=${sample}"
+    input:
+        tuple val(sample), path(narrow, stageAs: "in/*"), path(payload, stageAs: "in/*")
+        val(columns) // List of output columns, in order
+        val(outname)
+        val(index_key) // Column to index BGZF output on, for files sorted by it (empty for plain gzip)
+    output:
+        tuple val(sample), path("${sample}_${outname}"), emit: output
+        tuple val(sample), path("${sample}_${outname}.idx"), emit: index, optional: true
+        tuple val(sample), path("input_${narrow.name}"), emit: input
+    script:
+        def index_par = index_key ? "--index-key ${index_key}" : ""
+        """
+        attach_payload_columns.py -n ${narrow} -p ${payload} -o ${sample}_${outname} -c ${columns.join(",")} ${index_par}
+        # Link input to output for testing
+        ln -s ${narrow} input_${narrow.name}
+        """
+}
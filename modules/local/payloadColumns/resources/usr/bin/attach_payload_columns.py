@@ -0,0 +1,247 @@
+#!/usr/bin/env python
+
+DESC = """
+Re-attach payload columns split out by split_payload_columns.py to a narrow
+TSV derived from the split table (e.g. after joins, filters and column
+selections that keep row order). Each narrow row is matched to its payload by
+the row-number column, which must be strictly increasing, so the payload file
+is streamed once. Writes the columns in a given order, without the row-number
+column. Payload columns packed by split_payload_columns.py are decoded back
+to their original text.
+"""
+
+# =======================================================================
+# Import libraries
+# =======================================================================
+
+import argparse
+import logging
+import time
+from collections.abc import Iterator
+from datetime import UTC, datetime
+
+from nao_io import TaskMetrics, iter_lines, open_by_suffix, write_lines
+from payload_codec import PACKED_SUFFIX, decode_bases
+
+# =======================================================================
+# Configure logging
+# =======================================================================
+
+
+class UTCFormatter(logging.Formatter):
+    def formatTime(self, record: logging.LogRecord, datefmt: str | None = None) -> str:
+        dt = datetime.fromtimestamp(record.created, UTC)
+        return dt.strftime("%Y-%m-%d %H:%M:%S UTC")
+
+
+logging.basicConfig(level=logging.INFO)
+logger = logging.getLogger()
+handler = logging.StreamHandler()
+formatter = UTCFormatter("[%(asctime)s] %(message)s")
+handler.setFormatter(formatter)
+logger.handlers.clear()
+logger.addHandler(handler)
+
+# =======================================================================
+# Define constants
+# =======================================================================
+
+ROW_COLUMN = "payload_row"
+
+# =======================================================================
+# I/O functions
+# =======================================================================
+
+
+def parse_args() -> argparse.Namespace:
+    """Parse command-line arguments."""
+    # Create parser
+    parser = argparse.ArgumentParser(description=DESC)
+    # Add arguments
+    parser.add_argument("--narrow", "-n", required=True, help="Path to narrow TSV.")
+    parser.add_argument(
+        "--payload", "-p", required=True, help="Path to payload TSV."
+    )
+    parser.add_argument("--output", "-o", required=True, help="Path to output TSV.")
+    parser.add_argument(
+        "--columns",
+        "-c",
+        required=True,
+        help="Comma-separated output columns, in order.",
+    )
+    parser.add_argument(
+        "--row-column",
+        "-r",
+        default=ROW_COLUMN,
+        help=f"Name of the row-number column (default {ROW_COLUMN}).",
+    )
+    parser.add_argument(
+        "--index-key",
+        help="Write BGZF output with an <output>.idx index on this column.",
+    )
+    # Parse arguments
+    return parser.parse_args()
+
+
+# =======================================================================
+# Attaching functions
+# =======================================================================
+
+
+def column_sources(
+    columns: list[str], narrow_header: list[str], payload_header: list[str]
+) -> list[tuple[int, int]]:
+    """Locate each output column in the narrow or payload table.
+    Args:
+        columns: Output columns, in order.
+        narrow_header: Narrow table columns, without the row-number column.
+        payload_header: Payload table columns.
+    Returns:
+        (table, index) for each output column, where table is 0 for the narrow
+        table and 1 for the payload table.
+    Raises:
+        ValueError: If the output columns are not exactly the input columns.
+    """
+    available = narrow_header + payload_header
+    if sorted(columns) != sorted(available):
+        missing = set(available) - set(columns)
+        extra = set(columns) - set(available)
+        raise ValueError(
+            f"Output columns must match input columns: "
+            f"missing {missing}, unknown {extra}"
+        )
+    return [
+        (0, narrow_header.index(c))
+        if c in narrow_header
+        else (1, payload_header.index(c))
+        for c in columns
+    ]
+
+
+def iter_attached(
+    rows: Iterator[str],
+    payload_rows: Iterator[str],
+    row_index: int,
+    sources: list[tuple[int, int]],
+    packed: list[int] | None = None,
+) -> Iterator[str]:
+    """Yield output lines, matching each narrow row to its payload row.
+    Args:
+        rows: Narrow data lines.
+        payload_rows: Payload data lines, in original row order.
+        row_index: Index of the row-number column in the narrow table.
+        sources: (table, index) for each output column.
+        packed: Indices of packed payload columns to decode.
+    Yields:
+        Output lines.
+    Raises:
+        ValueError: If row numbers are not strictly increasing or exceed the
+            payload rows.
+    """
+    last_row = -1
+    n_consumed = 0
+    payload_line = ""
+    for line in rows:
+        if not line:
+            continue
+        fields = line.split("\t")
+        row = int(fields.pop(row_index))
+        if row <= last_row:
+            raise ValueError(
+                f"Row numbers are not strictly increasing: {row} after {last_row}."
+            )
+        while n_consumed <= row:
+            next_line = next(payload_rows, None)
+            if next_line is None:
+                raise ValueError(f"Row {row} is beyond the end of the payload file.")
+            payload_line = next_line
+            n_consumed += 1
+        last_row = row
+        payload_fields = payload_line.split("\t")
+        for i in packed or []:
+            payload_fields[i] = decode_bases(payload_fields[i])
+        tables = (fields, payload_fields)
+        yield "\t".join([tables[t][i] for t, i in sources])
+
+
+def attach_payload_columns(
+    narrow_path: str,
+    payload_path: str,
+    output_path: str,
+    columns: list[str],
+    row_column: str = ROW_COLUMN,
+    metrics: TaskMetrics | None = None,
+    index_key: str | None = None,
+) -> int:
+    """Re-attach payload columns to a narrow TSV by row number.
+    Args:
+        narrow_path: Path to narrow TSV with a row-number column.
+        payload_path: Path to payload TSV written by split_payload_columns.py.
+        output_path: Path to output TSV.
+        columns: Output columns, in order.
+        row_column: Name of the row-number column.
+        metrics: Optional task metrics.
+        index_key: If given, write BGZF output indexed on this column.
+    Returns:
+        Number of data rows written.
+    """
+    with (
+        open_by_suffix(narrow_path, "r", metrics) as narrowf,
+        open_by_suffix(payload_path, "r", metrics) as payloadf,
+        open_by_suffix(output_path, "w", metrics, index_key) as outf,
+    ):
+        narrow_line = narrowf.readline().rstrip("\n")
+        if not narrow_line:
+            logger.warning("Narrow file is empty; writing empty output.")
+            return 0
+        narrow_header = narrow_line.split("\t")
+        if row_column not in narrow_header:
+            raise ValueError(f"Row column not in narrow header: {row_column}")
+        row_index = narrow_header.index(row_column)
+        narrow_header.pop(row_index)
+        payload_line = payloadf.readline().rstrip("\n")
+        payload_header = payload_line.split("\t") if payload_line else []
+        packed = [i for i, c in enumerate(payload_header) if c.endswith(PACKED_SUFFIX)]
+        payload_header = [c.removesuffix(PACKED_SUFFIX) for c in payload_header]
+        sources = column_sources(columns, narrow_header, payload_header)
+        outf.write("\t".join(columns) + "\n")
+        attached = iter_attached(
+            iter_lines(narrowf), iter_lines(payloadf), row_index, sources, packed
+        )
+        return write_lines(outf, attached)
+
+
+# =======================================================================
+# Main function
+# =======================================================================
+
+
+def main() -> None:
+    logger.info("Initializing script.")
+    start_time = time.time()
+    # Parse arguments
+    logger.info("Parsing arguments.")
+    args = parse_args()
+    logger.info(f"Arguments: {args}")
+    # Attach payload columns
+    with TaskMetrics("attach_payload_columns") as metrics:
+        logger.info("Attaching payload columns.")
+        with metrics.phase("attach"):
+            n_rows = attach_payload_columns(
+                args.narrow,
+                args.payload,
+                args.output,
+                args.columns.split(","),
+                args.row_column,
+                metrics,
+                args.index_key,
+            )
+    logger.info(f"Wrote {n_rows} rows.")
+    # Log completion
+    logger.info("Script completed successfully.")
+    end_time = time.time()
+    logger.info(f"Total time elapsed: {end_time - start_time} seconds")
+
+
+if __name__ == "__main__":
+    main()
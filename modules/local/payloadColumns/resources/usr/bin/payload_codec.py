@@ -0,0 +1,93 @@
+"""
+Compact text encodings for payload columns in intermediate TSVs.
+
+Sequences made only of A, C, G, T and N are packed at two bits per base
+(N stored as A), base64-encoded and written as "<length>:<bases>:<N runs>",
+where N runs is a comma-separated list of "<start>+<length>" pairs (usually
+empty). Any other value is stored verbatim behind an ESCAPE prefix, so
+decoding always restores the original text exactly. Packed columns are
+marked by PACKED_SUFFIX on their header name.
+
+Quality binning is lossy and needs no decoding: Phred+33 scores are mapped
+to the representative values of Illumina's 8-level binning scheme, which
+compresses much better than full-resolution scores.
+"""
+
+import base64
+import re
+
+###########
+# CONSTANTS
+###########
+
+PACKED_SUFFIX = "@2bit"
+ESCAPE = "~"
+_BASES = "ACGT"
+# Map bases to base-4 digits; N is packed as A and restored from its runs
+_TO_DIGITS = str.maketrans("ACGTN", "01230")
+_DELETE_BASES = str.maketrans("", "", "ACGTN")
+# Each packed byte unpacks to four bases
+_UNPACK = [
+    "".join(_BASES[(byte >> shift) & 3] for shift in (6, 4, 2, 0))
+    for byte in range(256)
+]
+_N_RUN = re.compile("N+")
+# Illumina 8-level binning: (lowest Phred score, binned score)
+QUALITY_BINS = [(2, 6), (10, 15), (20, 22), (25, 27), (30, 33), (35, 37), (40, 40)]
+_BIN_QUALITIES = str.maketrans(
+    {
+        chr(q + 33): chr(next(b for lo, b in reversed(QUALITY_BINS) if q >= lo) + 33)
+        for q in range(QUALITY_BINS[0][0], 94)
+    }
+)
+
+###########
+# FUNCTIONS
+###########
+
+
+def encode_bases(seq: str) -> str:
+    """
+    Pack a sequence at two bits per base, escaping values that are not ACGTN.
+    Args:
+        seq (str): Sequence text.
+    Returns:
+        str: Encoded value, decoded exactly by decode_bases.
+    """
+    if seq.translate(_DELETE_BASES) or seq.startswith(ESCAPE):
+        return ESCAPE + seq
+    digits = seq.translate(_TO_DIGITS)
+    digits += "0" * (-len(digits) % 4)
+    packed = int(digits, 4).to_bytes(len(digits) // 4, "big") if digits else b""
+    text = base64.b64encode(packed).decode("ascii").rstrip("=")
+    runs = ""
+    if "N" in seq:
+        runs = ",".join(
+            f"{m.start()}+{m.end() - m.start()}" for m in _N_RUN.finditer(seq)
+        )
+    return f"{len(seq)}:{text}:{runs}"
+
+
+def decode_bases(value: str) -> str:
+    """
+    Restore a sequence encoded by encode_bases.
+    Args:
+        value (str): Encoded value.
+    Returns:
+        str: Original sequence text.
+    """
+    if value.startswith(ESCAPE):
+        return value[len(ESCAPE) :]
+    length, text, runs = value.split(":")
+    packed = base64.b64decode(text + "=" * (-len(text) % 4))
+    seq = "".join(map(_UNPACK.__getitem__, packed))[: int(length)]
+    if runs:
+        for run in runs.split(","):
+            start, n = map(int, run.split("+"))
+            seq = seq[:start] + "N" * n + seq[start + n :]
+    return seq
+
+
+def bin_qualities(qual: str) -> str:
+    """Map Phred+33 quality scores to Illumina 8-level bin values."""
+    return qual.translate(_BIN_QUALITIES)
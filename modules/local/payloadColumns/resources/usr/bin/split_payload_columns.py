@@ -0,0 +1,219 @@
+#!/usr/bin/env python
+
+DESC = """
+Split wide payload columns (e.g. read sequences and qualities) out of a TSV,
+so that downstream joins, filters and column selections move only a narrow
+table. Writes a narrow TSV with the payload columns removed and a row-number
+column appended, and a payload TSV holding the payload columns of every input
+row, in input order. attach_payload_columns.py restores the payload by row
+number once the narrow table has been processed. Optionally packs sequence
+columns at two bits per base (restored exactly on re-attachment) and bins
+quality columns to Illumina's 8 levels (lossy), shrinking the payload file.
+"""
+
+# =======================================================================
+# Import libraries
+# =======================================================================
+
+import argparse
+import logging
+import time
+from collections.abc import Callable
+from datetime import UTC, datetime
+
+from nao_io import TaskMetrics, iter_lines, open_by_suffix, write_lines
+from payload_codec import PACKED_SUFFIX, bin_qualities, encode_bases
+
+# =======================================================================
+# Configure logging
+# =======================================================================
+
+
+class UTCFormatter(logging.Formatter):
+    def formatTime(self, record: logging.LogRecord, datefmt: str | None = None) -> str:
+        dt = datetime.fromtimestamp(record.created, UTC)
+        return dt.strftime("%Y-%m-%d %H:%M:%S UTC")
+
+
+logging.basicConfig(level=logging.INFO)
+logger = logging.getLogger()
+handler = logging.StreamHandler()
+formatter = UTCFormatter("[%(asctime)s] %(message)s")
+handler.setFormatter(formatter)
+logger.handlers.clear()
+logger.addHandler(handler)
+
+# =======================================================================
+# Define constants
+# =======================================================================
+
+ROW_COLUMN = "payload_row"
+# Lines buffered per output before writing
+BATCH_LINES = 8192
+
+# =======================================================================
+# I/O functions
+# =======================================================================
+
+
+def parse_args() -> argparse.Namespace:
+    """Parse command-line arguments."""
+    # Create parser
+    parser = argparse.ArgumentParser(description=DESC)
+    # Add arguments
+    parser.add_argument("--input", "-i", required=True, help="Path to input TSV.")
+    parser.add_argument(
+        "--narrow", "-n", required=True, help="Path to output narrow TSV."
+    )
+    parser.add_argument(
+        "--payload", "-p", required=True, help="Path to output payload TSV."
+    )
+    parser.add_argument(
+        "--columns",
+        "-c",
+        required=True,
+        help="Comma-separated payload columns to split out.",
+    )
+    parser.add_argument(
+        "--row-column",
+        "-r",
+        default=ROW_COLUMN,
+        help=f"Name of the row-number column (default {ROW_COLUMN}).",
+    )
+    parser.add_argument(
+        "--pack-columns",
+        default="",
+        help="Comma-separated payload sequence columns to pack at 2 bits per base.",
+    )
+    parser.add_argument(
+        "--bin-columns",
+        default="",
+        help="Comma-separated payload quality columns to bin to 8 levels (lossy).",
+    )
+    # Parse arguments
+    return parser.parse_args()
+
+
+# =======================================================================
+# Splitting functions
+# =======================================================================
+
+
+def split_payload_columns(
+    input_path: str,
+    narrow_path: str,
+    payload_path: str,
+    payload_columns: list[str],
+    row_column: str = ROW_COLUMN,
+    metrics: TaskMetrics | None = None,
+    pack_columns: list[str] | None = None,
+    bin_columns: list[str] | None = None,
+) -> int:
+    """Split payload columns out of a TSV into a row-numbered side file.
+    Args:
+        input_path: Path to input TSV.
+        narrow_path: Path to output TSV without the payload columns, with a
+            0-based row-number column appended.
+        payload_path: Path to output TSV of the payload columns of each row.
+        payload_columns: Columns to split out; all must be present.
+        row_column: Name of the row-number column.
+        metrics: Optional task metrics.
+        pack_columns: Payload sequence columns to pack at two bits per base;
+            their payload header names get PACKED_SUFFIX.
+        bin_columns: Payload quality columns to bin to Illumina's 8 levels.
+    Returns:
+        Number of data rows split.
+    """
+    pack_columns = pack_columns or []
+    bin_columns = bin_columns or []
+    unknown = [c for c in pack_columns + bin_columns if c not in payload_columns]
+    if unknown:
+        raise ValueError(f"Columns to encode are not payload columns: {unknown}")
+    if set(pack_columns) & set(bin_columns):
+        raise ValueError("Columns cannot be both packed and binned.")
+    encoders: list[tuple[int, Callable[[str], str]]] = [
+        (i, encode_bases if c in pack_columns else bin_qualities)
+        for i, c in enumerate(payload_columns)
+        if c in pack_columns or c in bin_columns
+    ]
+    with (
+        open_by_suffix(input_path, "r", metrics) as inf,
+        open_by_suffix(narrow_path, "w", metrics) as narrowf,
+        open_by_suffix(payload_path, "w", metrics) as payloadf,
+    ):
+        header_line = inf.readline().rstrip("\n")
+        if not header_line:
+            logger.warning("Input file is empty; writing empty outputs.")
+            return 0
+        header = header_line.split("\t")
+        missing = [c for c in payload_columns if c not in header]
+        if missing:
+            raise ValueError(f"Payload columns not in input header: {missing}")
+        if row_column in header:
+            raise ValueError(f"Row column already exists: {row_column}")
+        payload_index = [header.index(c) for c in payload_columns]
+        narrow_index = [i for i in range(len(header)) if i not in payload_index]
+        narrowf.write("\t".join([header[i] for i in narrow_index] + [row_column]))
+        narrowf.write("\n")
+        payload_header = [
+            c + PACKED_SUFFIX if c in pack_columns else c for c in payload_columns
+        ]
+        payloadf.write("\t".join(payload_header) + "\n")
+        n_rows = 0
+        narrow: list[str] = []
+        payload: list[str] = []
+        for line in iter_lines(inf):
+            if not line:
+                continue
+            fields = line.split("\t")
+            narrow.append("\t".join([fields[i] for i in narrow_index] + [str(n_rows)]))
+            values = [fields[i] for i in payload_index]
+            for i, encode in encoders:
+                values[i] = encode(values[i])
+            payload.append("\t".join(values))
+            n_rows += 1
+            if len(narrow) >= BATCH_LINES:
+                write_lines(narrowf, narrow)
+                write_lines(payloadf, payload)
+                narrow.clear()
+                payload.clear()
+        write_lines(narrowf, narrow)
+        write_lines(payloadf, payload)
+    return n_rows
+
+
+# =======================================================================
+# Main function
+# =======================================================================
+
+
+def main() -> None:
+    logger.info("Initializing script.")
+    start_time = time.time()
+    # Parse arguments
+    logger.info("Parsing arguments.")
+    args = parse_args()
+    logger.info(f"Arguments: {args}")
+    # Split payload columns
+    with TaskMetrics("split_payload_columns") as metrics:
+        logger.info("Splitting payload columns.")
+        with metrics.phase("split"):
+            n_rows = split_payload_columns(
+                args.input,
+                args.narrow,
+                args.payload,
+                args.columns.split(","),
+                args.row_column,
+                metrics,
+                [c for c in args.pack_columns.split(",") if c],
+                [c for c in args.bin_columns.split(",") if c],
+            )
+    logger.info(f"Split {n_rows} rows.")
+    # Log completion
+    logger.info("Script completed successfully.")
+    end_time = time.time()
+    logger.info(f"Total time elapsed: {end_time - start_time} seconds")
+
+
+if __name__ == "__main__":
+    main()
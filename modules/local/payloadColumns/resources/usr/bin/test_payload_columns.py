@@ -0,0 +1,182 @@
+#!/usr/bin/env python
+
+from typing import Any
+
+import pytest
+from attach_payload_columns import attach_payload_columns
+from nao_io import lookup_indexed
+from payload_codec import bin_qualities, decode_bases, encode_bases
+from split_payload_columns import split_payload_columns
+
+HITS = (
+    "seq_id\ttaxid\tquery_seq\tquery_qual\n"
+    "r1\t10\tACGT\tIIII\n"
+    "r2\t20\tTTGA\tII#I\n"
+    "r3\t30\tGGCC\tIIII\n"
+)
+PAYLOAD = ["query_seq", "query_qual"]
+
+
+class TestSplitPayloadColumns:
+    def run(self, tsv_factory: Any, text: str, columns: list[str]) -> tuple:
+        path = tsv_factory.create_gzip("in.tsv.gz", text)
+        narrow = tsv_factory.get_path("narrow.tsv.gz")
+        payload = tsv_factory.get_path("payload.tsv.gz")
+        n_rows = split_payload_columns(path, narrow, payload, columns)
+        return n_rows, tsv_factory.read_gzip(narrow), tsv_factory.read_gzip(payload)
+
+    def test_splits_columns(self, tsv_factory: Any) -> None:
+        n_rows, narrow, payload = self.run(tsv_factory, HITS, PAYLOAD)
+        assert n_rows == 3
+        assert narrow == (
+            "seq_id\ttaxid\tpayload_row\nr1\t10\t0\nr2\t20\t1\nr3\t30\t2\n"
+        )
+        assert payload == "query_seq\tquery_qual\nACGT\tIIII\nTTGA\tII#I\nGGCC\tIIII\n"
+
+    def test_empty_input(self, tsv_factory: Any) -> None:
+        assert self.run(tsv_factory, "", PAYLOAD) == (0, "", "")
+
+    def test_header_only(self, tsv_factory: Any) -> None:
+        n_rows, narrow, payload = self.run(tsv_factory, HITS.splitlines()[0], PAYLOAD)
+        assert (n_rows, narrow) == (0, "seq_id\ttaxid\tpayload_row\n")
+        assert payload == "query_seq\tquery_qual\n"
+
+    def test_missing_column_raises_error(self, tsv_factory: Any) -> None:
+        with pytest.raises(ValueError, match="not in input header"):
+            self.run(tsv_factory, HITS, ["query_seq_rev"])
+
+    def test_existing_row_column_raises_error(self, tsv_factory: Any) -> None:
+        text = "seq_id\tpayload_row\tquery_seq\nr1\t0\tACGT\n"
+        with pytest.raises(ValueError, match="already exists"):
+            self.run(tsv_factory, text, ["query_seq"])
+
+    def test_encodes_columns(self, tsv_factory: Any) -> None:
+        path = tsv_factory.create_gzip("in.tsv.gz", HITS)
+        payload = tsv_factory.get_path("payload.tsv.gz")
+        narrow = tsv_factory.get_path("narrow.tsv.gz")
+        split_payload_columns(
+            path,
+            narrow,
+            payload,
+            PAYLOAD,
+            pack_columns=["query_seq"],
+            bin_columns=["query_qual"],
+        )
+        assert tsv_factory.read_gzip(payload) == (
+            "query_seq@2bit\tquery_qual\n4:Gw:\tIIII\n4:+A:\tII'I\n4:pQ:\tIIII\n"
+        )
+
+    def test_encoding_non_payload_column_raises_error(self, tsv_factory: Any) -> None:
+        with pytest.raises(ValueError, match="not payload columns"):
+            split_payload_columns(
+                tsv_factory.create_gzip("in.tsv.gz", HITS),
+                tsv_factory.get_path("narrow.tsv.gz"),
+                tsv_factory.get_path("payload.tsv.gz"),
+                PAYLOAD,
+                pack_columns=["taxid"],
+            )
+
+
+class TestPayloadCodec:
+    @pytest.mark.parametrize(
+        "seq", ["", "A", "ACGTA", "NNNN", "ANNCGTNA" * 40, "NA", "acgt", "~AC", "AR"]
+    )
+    def test_bases_round_trip(self, seq: str) -> None:
+        assert decode_bases(encode_bases(seq)) == seq
+
+    def test_packs_bases(self) -> None:
+        assert encode_bases("ACGTNNAC") == "8:GwE:4+2"
+        assert encode_bases("ACGR") == "~ACGR"
+
+    def test_bins_qualities(self) -> None:
+        # Q0, Q2, Q10, Q20, Q30, Q40, Q41
+        assert bin_qualities("!#+5?IJ") == "!'07BII"
+
+
+class TestAttachPayloadColumns:
+    def split(
+        self, tsv_factory: Any, text: str = HITS, pack: list[str] | None = None
+    ) -> tuple[str, str]:
+        path = tsv_factory.create_gzip("in.tsv.gz", text)
+        narrow = tsv_factory.get_path("narrow.tsv.gz")
+        payload = tsv_factory.get_path("payload.tsv.gz")
+        split_payload_columns(path, narrow, payload, PAYLOAD, pack_columns=pack)
+        return narrow, payload
+
+    def run(
+        self, tsv_factory: Any, narrow_text: str, payload: str, columns: list[str]
+    ) -> str:
+        narrow = tsv_factory.create_gzip("narrow_in.tsv.gz", narrow_text)
+        out = tsv_factory.get_path("out.tsv.gz")
+        attach_payload_columns(narrow, payload, out, columns)
+        return tsv_factory.read_gzip(out)
+
+    def test_round_trip(self, tsv_factory: Any) -> None:
+        narrow, payload = self.split(tsv_factory)
+        out = tsv_factory.get_path("out.tsv.gz")
+        columns = HITS.splitlines()[0].split("\t")
+        assert attach_payload_columns(narrow, payload, out, columns) == 3
+        assert tsv_factory.read_gzip(out) == HITS
+
+    def test_packed_round_trip(self, tsv_factory: Any) -> None:
+        text = HITS + "r4\t40\tNNACGTRN\tIIIIIIII\n"
+        narrow, payload = self.split(tsv_factory, text, ["query_seq"])
+        out = tsv_factory.get_path("out.tsv.gz")
+        columns = HITS.splitlines()[0].split("\t")
+        assert attach_payload_columns(narrow, payload, out, columns) == 4
+        assert tsv_factory.read_gzip(out) == text
+
+    def test_indexed_output(self, tsv_factory: Any) -> None:
+        narrow, payload = self.split(tsv_factory)
+        out = tsv_factory.get_path("out.tsv.gz")
+        columns = HITS.splitlines()[0].split("\t")
+        attach_payload_columns(narrow, payload, out, columns, index_key="seq_id")
+        assert tsv_factory.read_gzip(out) == HITS
+        assert lookup_indexed(out, ["r2"])[1] == ["r2\t20\tTTGA\tII#I"]
+
+    def test_filtered_and_reordered(self, tsv_factory: Any) -> None:
+        """Rows dropped from the narrow table are skipped in the payload, and
+        narrow columns may be renamed or added before attaching."""
+        _, payload = self.split(tsv_factory)
+        narrow = "payload_row\tseq_id\tlca\n0\tr1\t1\n2\tr3\t3\n"
+        columns = ["seq_id", "query_seq", "lca", "query_qual"]
+        out = self.run(tsv_factory, narrow, payload, columns)
+        assert out == (
+            "seq_id\tquery_seq\tlca\tquery_qual\n"
+            "r1\tACGT\t1\tIIII\n"
+            "r3\tGGCC\t3\tIIII\n"
+        )
+
+    def test_empty_narrow(self, tsv_factory: Any) -> None:
+        _, payload = self.split(tsv_factory)
+        assert self.run(tsv_factory, "", payload, ["seq_id"]) == ""
+
+    def test_header_only_narrow(self, tsv_factory: Any) -> None:
+        _, payload = self.split(tsv_factory)
+        narrow = "seq_id\tpayload_row\n"
+        out = self.run(tsv_factory, narrow, payload, ["seq_id"] + PAYLOAD)
+        assert out == "seq_id\tquery_seq\tquery_qual\n"
+
+    def test_unordered_rows_raise_error(self, tsv_factory: Any) -> None:
+        _, payload = self.split(tsv_factory)
+        narrow = "seq_id\tpayload_row\nr2\t1\nr1\t0\n"
+        with pytest.raises(ValueError, match="not strictly increasing"):
+            self.run(tsv_factory, narrow, payload, ["seq_id"] + PAYLOAD)
+
+    def test_repeated_rows_raise_error(self, tsv_factory: Any) -> None:
+        _, payload = self.split(tsv_factory)
+        narrow = "seq_id\tpayload_row\nr1\t0\nr1\t0\n"
+        with pytest.raises(ValueError, match="not strictly increasing"):
+            self.run(tsv_factory, narrow, payload, ["seq_id"] + PAYLOAD)
+
+    def test_row_beyond_payload_raises_error(self, tsv_factory: Any) -> None:
+        _, payload = self.split(tsv_factory)
+        narrow = "seq_id\tpayload_row\nr4\t3\n"
+        with pytest.raises(ValueError, match="beyond the end"):
+            self.run(tsv_factory, narrow, payload, ["seq_id"] + PAYLOAD)
+
+    def test_column_mismatch_raises_error(self, tsv_factory: Any) -> None:
+        _, payload = self.split(tsv_factory)
+        narrow = "seq_id\tpayload_row\nr1\t0\n"
+        with pytest.raises(ValueError, match="must match input columns"):
+            self.run(tsv_factory, narrow, payload, ["seq_id", "query_seq"])
@@ -0,0 +1,16 @@
+// Prefix every sequence name in a (optionally gzipped) FASTA file, e.g. to label its source in a combined reference
+process PREFIX_FASTA_HEADERS {
+    label "single"
+    label "coreutils"
+    tag "id=index,name=${prefix}"
+    input:
+        path(fasta)
+        val(prefix) // Added to each sequence name, followed by "|"
+    output:
+        path("${prefix}_prefixed.fasta.gz")
+    script:
+        """
+        set -euo pipefail
+        zcat -f ${fasta} | sed 's/^>/>${prefix}|/' | gzip -c > ${prefix}_prefixed.fasta.gz
+        """
+}
@@ -7,14 +7,14 @@ outputs metadata compatible with filter_viral_genbank_metadata.py.
 
 import argparse
 import csv
-import gzip
 import logging
 import os
 import re
 import time
 from datetime import UTC, datetime
 from pathlib import Path
-from typing import IO, cast
+
+from nao_io import open_by_suffix
 
 
 class UTCFormatter(logging.Formatter):
@@ -32,13 +32,6 @@ logger.handlers.clear()
 logger.addHandler(handler)
 
 
-def open_by_suffix(path: str, mode: str = "r") -> IO[str]:
-    """Open a file, transparently handling .gz compression."""
-    if path.endswith(".gz"):
-        return cast(IO[str], gzip.open(path, mode + "t"))
-    return cast(IO[str], open(path, mode))
-
-
 def build_species_taxid_map(virus_db_path: str) -> dict[str, str]:
     """Build taxid -> species_taxid mapping from virus taxonomy DB.
     Args:
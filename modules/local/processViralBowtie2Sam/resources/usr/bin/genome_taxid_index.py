@@ -0,0 +1,167 @@
+#!/usr/bin/env python
+"""
+Compact, memory-mappable genome ID -> (taxid, species taxid) index.
+
+Built once by INDEX from the Genbank genome metadata and the virus taxonomy DB,
+and opened by the per-sample SAM processors in place of loading both TSVs into
+dicts. The file is mapped read-only, so opening it is effectively instant and
+concurrent tasks on the same host share its pages.
+
+Layout (all integers little-endian):
+    magic            8 bytes  b"NAOGTX01"
+    n_genomes        u64
+    n_viral_taxids   u64
+    id_blob_size     u64
+    id_offsets       u64[n_genomes + 1]  (byte offsets into id_blob)
+    taxids           u32[n_genomes]
+    species_taxids   u32[n_genomes]      (0 if missing)
+    viral_taxids     u32[n_viral_taxids] (sorted)
+    padding          to an 8-byte boundary
+    id_blob          genome IDs concatenated in sorted byte order
+
+Keep the copies of this file in processViralBowtie2Sam and
+processViralMinimap2Sam identical to this one.
+"""
+
+import mmap
+import struct
+import sys
+from collections.abc import Iterable, Iterator, Mapping
+
+MAGIC = b"NAOGTX01"
+_HEADER = struct.Struct("<8sQQQ")
+
+
+def _layout(n_genomes: int, n_viral: int) -> tuple[int, int, int, int, int]:
+    """Byte offsets of the offset, taxid, species, viral-taxid and ID-blob sections."""
+    offsets_at = _HEADER.size
+    taxids_at = offsets_at + 8 * (n_genomes + 1)
+    species_at = taxids_at + 4 * n_genomes
+    viral_at = species_at + 4 * n_genomes
+    blob_at = viral_at + 4 * n_viral
+    blob_at += -blob_at % 8
+    return offsets_at, taxids_at, species_at, viral_at, blob_at
+
+
+def _parse_taxid(value: str | None, genome_id: str, required: bool) -> int:
+    """Convert a taxid field to an unsigned integer (0 for a missing optional one)."""
+    if value is None or value.strip() in ("", "NA", "na", "nan"):
+        if required:
+            raise ValueError(f"Missing taxid for genome ID: {genome_id}")
+        return 0
+    taxid = int(value)
+    if not 0 < taxid < 2**32:
+        raise ValueError(f"Taxid out of range for genome ID {genome_id}: {value}")
+    return taxid
+
+
+def write_genome_taxid_index(
+    records: Iterable[tuple[str, str, str | None]],
+    viral_taxids: Iterable[str],
+    path: str,
+) -> int:
+    """
+    Write a genome taxid index.
+    Args:
+        records: (genome_id, taxid, species_taxid) tuples. Later duplicates of a
+            genome ID replace earlier ones, as when loading into a dict.
+        viral_taxids: Taxids present in the virus taxonomy DB.
+        path: Output path.
+    Returns:
+        Number of genomes written.
+    """
+    genomes: dict[bytes, tuple[int, int]] = {}
+    for genome_id, taxid, species_taxid in records:
+        genomes[genome_id.encode()] = (
+            _parse_taxid(taxid, genome_id, required=True),
+            _parse_taxid(species_taxid, genome_id, required=False),
+        )
+    # Only viral taxids that some genome refers to are needed for lookups
+    referenced = {t for pair in genomes.values() for t in pair if t}
+    viral = sorted(referenced.intersection(int(t) for t in viral_taxids))
+    ids = sorted(genomes)
+    offsets = [0]
+    for genome_id in ids:
+        offsets.append(offsets[-1] + len(genome_id))
+    n = len(ids)
+    _, _, _, _, blob_at = _layout(n, len(viral))
+    with open(path, "wb") as f:
+        f.write(_HEADER.pack(MAGIC, n, len(viral), offsets[-1]))
+        f.write(struct.pack(f"<{n + 1}Q", *offsets))
+        f.write(struct.pack(f"<{n}I", *(genomes[g][0] for g in ids)))
+        f.write(struct.pack(f"<{n}I", *(genomes[g][1] for g in ids)))
+        f.write(struct.pack(f"<{len(viral)}I", *viral))
+        f.write(b"\0" * (blob_at - f.tell()))
+        f.write(b"".join(ids))
+    return n
+
+
+def is_genome_taxid_index(path: str) -> bool:
+    """Return True if the file at path starts with the genome taxid index magic."""
+    with open(path, "rb") as f:
+        return f.read(len(MAGIC)) == MAGIC
+
+
+class GenomeTaxidIndex(Mapping[str, tuple[str, str | None]]):
+    """
+    Read-only mapping from genome ID to (taxid, species_taxid) backed by a
+    memory-mapped index file. Taxids are returned as strings, and a missing
+    species taxid as None, matching the dicts built from the metadata TSV.
+    """
+
+    def __init__(self, path: str) -> None:
+        if sys.byteorder != "little":
+            raise RuntimeError("Genome taxid index requires a little-endian host")
+        with open(path, "rb") as f:
+            self._mm = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+        magic, n, n_viral, blob_size = _HEADER.unpack_from(self._mm, 0)
+        if magic != MAGIC:
+            raise ValueError(f"Not a genome taxid index: {path}")
+        offsets_at, taxids_at, species_at, viral_at, blob_at = _layout(n, n_viral)
+        if blob_at + blob_size != len(self._mm):
+            raise ValueError(f"Truncated or corrupt genome taxid index: {path}")
+        view = memoryview(self._mm)
+        self._n = n
+        self._offsets = view[offsets_at:taxids_at].cast("Q")
+        self._taxids = view[taxids_at:species_at].cast("I")
+        self._species = view[species_at:viral_at].cast("I")
+        self._viral = view[viral_at : viral_at + 4 * n_viral].cast("I")
+        self._blob = view[blob_at:]
+        self._cache: dict[str, tuple[str, str | None]] = {}
+
+    def _id_at(self, i: int) -> bytes:
+        return bytes(self._blob[self._offsets[i] : self._offsets[i + 1]])
+
+    def _find(self, key: bytes) -> int:
+        """Binary search for a genome ID; returns its row or -1."""
+        lo, hi = 0, self._n
+        while lo < hi:
+            mid = (lo + hi) // 2
+            if self._id_at(mid) < key:
+                lo = mid + 1
+            else:
+                hi = mid
+        return lo if lo < self._n and self._id_at(lo) == key else -1
+
+    def __getitem__(self, genome_id: str) -> tuple[str, str | None]:
+        hit = self._cache.get(genome_id)
+        if hit is not None:
+            return hit
+        i = self._find(genome_id.encode())
+        if i < 0:
+            raise KeyError(genome_id)
+        species = self._species[i]
+        hit = (str(self._taxids[i]), str(species) if species else None)
+        self._cache[genome_id] = hit
+        return hit
+
+    def __len__(self) -> int:
+        return self._n
+
+    def __iter__(self) -> Iterator[str]:
+        return (self._id_at(i).decode() for i in range(self._n))
+
+    @property
+    def viral_taxids(self) -> set[str]:
+        """Taxids referenced by the index that are present in the virus DB."""
+        return {str(t) for t in self._viral}
@@ -10,18 +10,19 @@ Given a sorted Bowtie2 SAM file, extract information about the alignments and wr
 
 # Import modules
 import argparse
-import gzip
 import logging
 import math
 import re
 import sys
 import time
-from collections.abc import Sequence
+from collections.abc import Mapping, Sequence
 from datetime import UTC, datetime
-from typing import IO, cast
+from typing import IO
 
 import pandas as pd
 from Bio import Seq
+from genome_taxid_index import GenomeTaxidIndex, is_genome_taxid_index
+from nao_io import open_by_suffix
 
 # Type alias for SAM field dictionaries that contain mixed value types
 type FieldValue = str | int | bool | float | None
@@ -111,23 +112,6 @@ logger.addHandler(handler)
 # =======================================================================
 
 
-def open_by_suffix(filename: str, mode: str = "r") -> IO[str]:
-    """
-    Open a file with the appropriate compression, as inferred from the filename suffix.
-    Args:
-        filename (str): Path to file.
-        mode (str): Mode to open file in.
-    Returns:
-        IO[str]: File object.
-    """
-    logger.debug(f"\tOpening file object: {filename}")
-    logger.debug(f"\tOpening mode: {mode}")
-    logger.debug(f"\tGZIP mode: {filename.endswith('.gz')}")
-    if filename.endswith(".gz"):
-        return cast(IO[str], gzip.open(filename, mode + "t"))
-    return open(filename, mode)
-
-
 def parse_args() -> argparse.Namespace:
     """Parse and return command-line arguments."""
     parser = argparse.ArgumentParser(
@@ -144,7 +128,8 @@ def parse_args() -> argparse.Namespace:
         "-m",
         "--metadata",
         required=True,
-        help="Path to Genbank download metadata file containing genomeID and taxid information.",
+        help="Path to Genbank download metadata file containing genomeID and taxid information, "
+        "or to a genome taxid index built from it (in which case --viral_db is not read).",
     )
     parser.add_argument(
         "-v",
@@ -328,13 +313,15 @@ def extract_optional_fields(opt_list: list[str]) -> dict[str, str | None]:
 
 
 def extract_viral_taxid(
-    genome_id: str, genbank_metadata: dict[str, tuple[str, str]], viral_taxids: set[str]
+    genome_id: str,
+    genbank_metadata: Mapping[str, tuple[str, str | None]],
+    viral_taxids: set[str],
 ) -> str:
     """
     Extract taxid from the appropriate field of Genbank metadata.
     Args:
         genome_id (str): Genome ID to extract taxid for.
-        genbank_metadata (dict[str, tuple[str, str]]): Genbank metadata mapping genome IDs to taxids.
+        genbank_metadata (Mapping[str, tuple[str, str | None]]): Genbank metadata mapping genome IDs to taxids.
         viral_taxids (set[str]): Set of viral taxids.
     Returns:
         str: Taxid.
@@ -354,7 +341,7 @@ def extract_viral_taxid(
 
 def process_sam_alignment(
     sam_line: str,
-    genbank_metadata: dict[str, tuple[str, str]],
+    genbank_metadata: Mapping[str, tuple[str, str | None]],
     viral_taxids: set[str],
     paired: bool,
 ) -> FieldDict:
@@ -362,7 +349,7 @@ def process_sam_alignment(
     Process a SAM alignment line into a dictionary of fields.
     Args:
         sam_line (str): SAM alignment line.
-        genbank_metadata (dict[str, tuple[str, str]]): Genbank metadata mapping genome IDs to taxids.
+        genbank_metadata (Mapping[str, tuple[str, str | None]]): Genbank metadata mapping genome IDs to taxids.
         viral_taxids (set[str]): Set of viral taxids.
         paired (bool): Whether the SAM file is paired.
     Returns:
@@ -676,7 +663,7 @@ def check_pair_status(line_dict: FieldDict, paired: bool) -> None:
 def process_paired_sam(
     inf: IO[str],
     outf: IO[str],
-    genbank_metadata: dict[str, tuple[str, str]],
+    genbank_metadata: Mapping[str, tuple[str, str | None]],
     viral_taxids: set[str],
 ) -> None:
     """
@@ -684,7 +671,7 @@ def process_paired_sam(
     Args:
         inf (IO[str]): Input SAM file.
         outf (IO[str]): Output TSV file.
-        genbank_metadata (dict[str, tuple[str, str]]): Genbank metadata mapping genome IDs to taxids.
+        genbank_metadata (Mapping[str, tuple[str, str | None]]): Genbank metadata mapping genome IDs to taxids.
         viral_taxids (set[str]): Set of viral taxids.
     """
     # Write headers
@@ -767,7 +754,7 @@ def process_paired_sam(
 def process_unpaired_sam(
     inf: IO[str],
     outf: IO[str],
-    genbank_metadata: dict[str, tuple[str, str]],
+    genbank_metadata: Mapping[str, tuple[str, str | None]],
     viral_taxids: set[str],
 ) -> None:
     """
@@ -775,7 +762,7 @@ def process_unpaired_sam(
     Args:
         inf (IO[str]): Input SAM file.
         outf (IO[str]): Output TSV file.
-        genbank_metadata (dict[str, tuple[str, str]]): Genbank metadata mapping genome IDs to taxids.
+        genbank_metadata (Mapping[str, tuple[str, str | None]]): Genbank metadata mapping genome IDs to taxids.
         viral_taxids (set[str]): Set of viral taxids.
     """
     # Write headers
@@ -839,10 +826,16 @@ def main() -> None:
         logger.info(f"Output path: {args.output}")
         logger.info(f"Processing file as paired: {args.paired}")
         # Import metadata and viral DB
-        logger.info("Importing Genbank metadata file...")
-        gid_taxid_dict = read_genbank_metadata(args.metadata)
-        logger.info("Importing viral DB file...")
-        virus_taxa = get_viral_taxids(args.viral_db)
+        gid_taxid_dict: Mapping[str, tuple[str, str | None]]
+        if is_genome_taxid_index(args.metadata):
+            logger.info("Opening genome taxid index...")
+            genome_index = GenomeTaxidIndex(args.metadata)
+            gid_taxid_dict, virus_taxa = genome_index, genome_index.viral_taxids
+        else:
+            logger.info("Importing Genbank metadata file...")
+            gid_taxid_dict = read_genbank_metadata(args.metadata)
+            logger.info("Importing viral DB file...")
+            virus_taxa = get_viral_taxids(args.viral_db)
         logger.info(f"Imported {len(virus_taxa)} virus taxa.")
         # Process SAM
         logger.info("Processing SAM file...")
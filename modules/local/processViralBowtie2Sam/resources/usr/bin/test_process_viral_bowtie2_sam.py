@@ -4,6 +4,7 @@ import gzip
 from pathlib import Path
 
 import process_viral_bowtie2_sam
+from genome_taxid_index import GenomeTaxidIndex, write_genome_taxid_index
 
 
 class TestProcessViralBowtie2Sam:
@@ -61,3 +62,28 @@ class TestProcessViralBowtie2Sam:
         # Verify all expected headers are present and in the right order
         for i in range(len(expected_headers)):
             assert headers[i] == expected_headers[i]
+
+    def test_genome_taxid_index_matches_tsvs(self, tmp_path: Path) -> None:
+        """Test that taxids resolved via a genome taxid index match the TSV path."""
+        genbank_metadata = tmp_path / "genbank_metadata.tsv.gz"
+        with gzip.open(genbank_metadata, "wt") as f:
+            f.write("genome_id\ttaxid\tspecies_taxid\n")
+            f.write("g1\t111\t222\ng2\t333\t444\ng3\t555\t666\n")
+        virus_db = tmp_path / "virus_db.tsv.gz"
+        with gzip.open(virus_db, "wt") as f:
+            f.write("taxid\n222\n333\n")
+        metadata_dict = process_viral_bowtie2_sam.read_genbank_metadata(
+            str(genbank_metadata)
+        )
+        viral_taxids = process_viral_bowtie2_sam.get_viral_taxids(str(virus_db))
+        index_path = str(tmp_path / "index.bin")
+        write_genome_taxid_index(
+            [(g, t, s) for g, (t, s) in metadata_dict.items()], viral_taxids, index_path
+        )
+        index = GenomeTaxidIndex(index_path)
+        for genome_id in ["g1", "g2", "g3"]:
+            assert process_viral_bowtie2_sam.extract_viral_taxid(
+                genome_id, index, index.viral_taxids
+            ) == process_viral_bowtie2_sam.extract_viral_taxid(
+                genome_id, metadata_dict, viral_taxids
+            )
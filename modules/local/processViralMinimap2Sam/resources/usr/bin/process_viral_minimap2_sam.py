@@ -1,18 +1,20 @@
 #!/usr/bin/env python3
 
 import argparse
-import gzip
 import logging
 import math
 import sys
 import tempfile
 import time
+from collections.abc import Mapping, Sequence
 from datetime import UTC, datetime
 from typing import Any
 
 import pandas as pd
 import pysam
 from Bio.Seq import Seq
+from genome_taxid_index import GenomeTaxidIndex, is_genome_taxid_index
+from nao_io import open_by_suffix
 from sort_fastq import sort_fastq
 from sort_sam import sort_sam
 
@@ -75,7 +77,9 @@ def read_fastq_record(fh: Any) -> tuple[str, str, str] | None:
 
 
 def extract_viral_taxid(
-    genome_id: str, genbank_metadata: dict[str, list[str]], viral_taxids: set[str]
+    genome_id: str,
+    genbank_metadata: Mapping[str, Sequence[str | None]],
+    viral_taxids: set[str],
 ) -> str:
     """Return taxid for a genome, preferring whichever of taxid/species_taxid is viral."""
     try:
@@ -91,7 +95,7 @@ def extract_viral_taxid(
 
 def parse_sam_alignment(
     read: Any,
-    genbank_metadata: dict[str, list[str]],
+    genbank_metadata: Mapping[str, Sequence[str | None]],
     viral_taxids: set[str],
     clean_seq: str,
     clean_qual: str,
@@ -138,7 +142,7 @@ def parse_sam_alignment(
 def process_sam(
     sam_file: str,
     out_file: str,
-    genbank_metadata: dict[str, list[str]],
+    genbank_metadata: Mapping[str, Sequence[str | None]],
     viral_taxids: set[str],
     fastq_file: str,
 ) -> None:
@@ -147,7 +151,7 @@ def process_sam(
     Both sam_file and fastq_file must be sorted by read ID.
     """
     header = "\t".join(HEADER_FIELDS) + "\n"
-    with gzip.open(out_file, "wt") as out_fh:
+    with open_by_suffix(out_file, "w") as out_fh:
         out_fh.write(header)
         with pysam.AlignmentFile(sam_file, "r") as sam_fh, open(fastq_file) as fastq_fh:
             num_reads = 0
@@ -204,7 +208,11 @@ def parse_arguments() -> argparse.Namespace:
         help="Path to gzipped FASTQ file with non-masked viral reads.",
     )
     parser.add_argument(
-        "-m", "--metadata", required=True, help="Path to Genbank metadata file."
+        "-m",
+        "--metadata",
+        required=True,
+        help="Path to Genbank metadata file, or to a genome taxid index built from it "
+        "(in which case --viral_db is not read).",
     )
     parser.add_argument(
         "-v",
@@ -224,18 +232,23 @@ def main() -> None:
         logger.info("Starting process.")
         start_time = time.time()
 
-        meta_db = pd.read_csv(args.metadata, sep="\t", dtype=str)
-        genbank_metadata = {
-            genome_id: [taxid, species_taxid]
-            for genome_id, taxid, species_taxid in zip(
-                meta_db["genome_id"],
-                meta_db["taxid"],
-                meta_db["species_taxid"],
-                strict=True,
-            )
-        }
-        virus_db = pd.read_csv(args.viral_db, sep="\t", dtype=str)
-        viral_taxids = set(virus_db["taxid"].values)
+        genbank_metadata: Mapping[str, Sequence[str | None]]
+        if is_genome_taxid_index(args.metadata):
+            genome_index = GenomeTaxidIndex(args.metadata)
+            genbank_metadata, viral_taxids = genome_index, genome_index.viral_taxids
+        else:
+            meta_db = pd.read_csv(args.metadata, sep="\t", dtype=str)
+            genbank_metadata = {
+                genome_id: [taxid, species_taxid]
+                for genome_id, taxid, species_taxid in zip(
+                    meta_db["genome_id"],
+                    meta_db["taxid"],
+                    meta_db["species_taxid"],
+                    strict=True,
+                )
+            }
+            virus_db = pd.read_csv(args.viral_db, sep="\t", dtype=str)
+            viral_taxids = set(virus_db["taxid"].values)
         logger.info(
             f"Imported {len(genbank_metadata)} genomes, {len(viral_taxids)} virus taxa."
         )
@@ -4,10 +4,11 @@ We use this Python wrapper to keep the sorting logic pytest-able and out of the
 shell block, and we sort internally to the process so that it doesn't require sorted
 inputs."""
 
-import gzip
 import os
 import subprocess
 
+from nao_io import open_by_suffix
+
 
 def sort_fastq(input_fastq_gz: str, output_fastq: str, sort_memory: str = "2G") -> None:
     """Sort a gzipped FASTQ file by read ID using GNU sort.
@@ -26,7 +27,7 @@ def sort_fastq(input_fastq_gz: str, output_fastq: str, sort_memory: str = "2G")
     # Asserts placate the type checker; stdin/stdout are set because we passed PIPE above
     assert sort_proc.stdin is not None and sort_proc.stdout is not None
 
-    with gzip.open(input_fastq_gz, "rt") as fh:
+    with open_by_suffix(input_fastq_gz) as fh:
         while True:
             lines = [fh.readline() for _ in range(4)]
             if not lines[0]:
@@ -1,10 +1,11 @@
 #!/usr/bin/env python3
 """Sort a gzipped SAM file by read ID (QNAME), preserving headers."""
 
-import gzip
 import os
 import subprocess
 
+from nao_io import open_by_suffix
+
 
 def sort_sam(input_sam_gz: str, output_sam: str, sort_memory: str = "2G") -> None:
     """Sort a gzipped SAM file by QNAME using GNU sort.
@@ -13,7 +14,7 @@ def sort_sam(input_sam_gz: str, output_sam: str, sort_memory: str = "2G") -> Non
     streamed through GNU sort. Sort manages its own memory budget via -S,
     spilling to disk only if needed — no Python-side temp files required.
     """
-    with gzip.open(input_sam_gz, "rt") as fh, open(output_sam, "w") as out:
+    with open_by_suffix(input_sam_gz) as fh, open(output_sam, "w") as out:
         sort_proc = subprocess.Popen(
             ["sort", "-t\t", "-k1,1", f"-S{sort_memory}", "-T."],
             stdin=subprocess.PIPE,
@@ -8,6 +8,7 @@ from typing import Any
 
 import process_viral_minimap2_sam
 import pytest
+from genome_taxid_index import GenomeTaxidIndex, write_genome_taxid_index
 
 
 @pytest.fixture
@@ -78,6 +79,23 @@ class TestExtractViralTaxid:
                 "missing", self.METADATA, {"111"}
             )
 
+    @pytest.mark.parametrize(
+        "viral", [{"111"}, {"222"}, {"111", "222"}, {"999"}], ids=str
+    )
+    def test_genome_taxid_index_matches_dict(
+        self, viral: set[str], tmp_path: Path
+    ) -> None:
+        path = str(tmp_path / "index.bin")
+        write_genome_taxid_index([("g1", "111", "222")], viral, path)
+        index = GenomeTaxidIndex(path)
+        assert process_viral_minimap2_sam.extract_viral_taxid(
+            "g1", index, index.viral_taxids
+        ) == process_viral_minimap2_sam.extract_viral_taxid("g1", self.METADATA, viral)
+        with pytest.raises(ValueError, match="No matching genome ID found: missing"):
+            process_viral_minimap2_sam.extract_viral_taxid(
+                "missing", index, index.viral_taxids
+            )
+
 
 # -- parse_sam_alignment --------------------------------------------------------
 
@@ -17,3 +17,51 @@ process REHEAD_TSV {
         ln -s ${tsv} input_${tsv}
         """
 }
+
+// Rename fields in a TSV header, writing the result directly under its final name (<sample>_<outname>),
+// optionally as indexed BGZF with a <sample>_<outname>.idx sidecar
+// The input is staged in a subdirectory, as it may already carry the output name
+process REHEAD_TSV_NAMED {
+    label "python"
+    label "single"
+    tag "id=${sample}"
+    input:
+        tuple val(sample), path(tsv, stageAs: "in/*")
+        val(old_fields)
+        val(new_fields)
+        val(outname)
+        val(index_key) // Column to index BGZF output on, for files sorted by it (empty for plain gzip)
+    output:
+        tuple val(sample), path("${sample}_${outname}"), emit: output
+        tuple val(sample), path("${sample}_${outname}.idx"), emit: index, optional: true
+        tuple val(sample), path("input_${tsv.name}"), emit: input
+    script:
+        def index_par = index_key ? "--index-key ${index_key}" : ""
+        """
+        rehead_tsv.py ${tsv} ${old_fields} ${new_fields} ${sample}_${outname} ${index_par}
+        # Link input to output for testing
+        ln -s ${tsv} input_${tsv.name}
+        """
+}
+
+// Rename fields in the header of each TSV in a batch of (sample, TSV) work items, in one task
+// Outputs are written to out_<i>/ for the 1-based item index i; split with BatchUtils.fromBatch
+process REHEAD_TSV_BATCH {
+    label "python"
+    label "single"
+    tag "id=batch,first=${samples[0]},n=${samples.size()}"
+    input:
+        tuple val(samples), path(tsvs, arity: "1..*", stageAs: "in_*/*")
+        val(old_fields)
+        val(new_fields)
+    output:
+        tuple val(samples), path("out_*/renamed_*"), emit: output
+    script:
+        def jobs = tsvs.withIndex().collect { tsv, i ->
+            "mkdir out_${i + 1} && rehead_tsv.py ${tsv} ${old_fields} ${new_fields} out_${i + 1}/renamed_${tsv.name}"
+        }.join("\n")
+        """
+        set -euo pipefail
+        ${jobs}
+        """
+}
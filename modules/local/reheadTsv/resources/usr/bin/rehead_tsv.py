@@ -3,33 +3,30 @@
 # Import modules
 import argparse
 import datetime
-import gzip
 import time
-from typing import IO, cast
+
+from nao_io import open_by_suffix
 
 
 def print_log(message: str) -> None:
     print("[", datetime.datetime.now(), "]  ", message, sep="")
 
 
-def open_by_suffix(filename: str, mode: str = "r", debug: bool = False) -> IO[str]:
-    if debug:
-        print_log(f"\tOpening file object: {filename}")
-        print_log(f"\tOpening mode: {mode}")
-        print_log(f"\tGZIP mode: {filename.endswith('.gz')}")
-    if filename.endswith(".gz"):
-        return cast(IO[str], gzip.open(filename, mode + "t"))
-    return open(filename, mode)
-
-
 def rename_columns(
-    input_path: str, input_fields: list[str], output_fields: list[str], out_path: str
+    input_path: str,
+    input_fields: list[str],
+    output_fields: list[str],
+    out_path: str,
+    index_key: str | None = None,
 ) -> None:
-    """Rename columns in TSV file."""
+    """Rename columns in TSV file, optionally writing indexed BGZF output."""
     if len(input_fields) != len(output_fields):
         raise ValueError("Input and output field lists must be the same length.")
 
-    with open_by_suffix(input_path) as inf, open_by_suffix(out_path, "w") as outf:
+    with (
+        open_by_suffix(input_path) as inf,
+        open_by_suffix(out_path, "w", index_key=index_key) as outf,
+    ):
         # Read the header line
         header_line = inf.readline().strip()
 
@@ -74,6 +71,10 @@ def main() -> None:
         "output_fields", help="Comma-separated list of output field names."
     )
     parser.add_argument("output_file", help="Path to output TSV.")
+    parser.add_argument(
+        "--index-key",
+        help="Write BGZF output with a <output_file>.idx index on this column.",
+    )
     args = parser.parse_args()
     input_path = args.input_path
     input_fields = args.input_fields.split(",")
@@ -87,9 +88,10 @@ def main() -> None:
     print_log(f"Input fields: {input_fields}")
     print_log(f"Output fields: {output_fields}")
     print_log(f"Output TSV file: {out_path}")
+    print_log(f"Index key: {args.index_key}")
     # Run labeling function
     print_log("Renaming columns in TSV...")
-    rename_columns(input_path, input_fields, output_fields, out_path)
+    rename_columns(input_path, input_fields, output_fields, out_path, args.index_key)
     print_log("...done.")
     # Finish time tracking
     end_time = time.time()
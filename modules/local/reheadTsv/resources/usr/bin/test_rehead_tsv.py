@@ -6,6 +6,7 @@ from typing import Any
 
 import pytest
 import rehead_tsv
+from nao_io import lookup_indexed
 
 
 class TestReheadTsv:
@@ -136,3 +137,14 @@ class TestReheadTsv:
 
         result = tsv_factory.read_plain(output_file)
         assert result == ""
+
+    def test_indexed_output(self, tsv_factory: Any) -> None:
+        """Test that indexed output matches plain output and supports lookups."""
+        input_content = "x\ty\tz\n0\t1\t2\n3\t4\t5\n"
+        input_file = tsv_factory.create_plain("input.tsv", input_content)
+        output_file = tsv_factory.get_path("output.tsv.gz")
+
+        rehead_tsv.rename_columns(input_file, ["x"], ["a"], output_file, "a")
+
+        assert tsv_factory.read_gzip(output_file) == "a\ty\tz\n0\t1\t2\n3\t4\t5\n"
+        assert lookup_indexed(output_file, ["3"]) == (["a", "y", "z"], ["3\t4\t5"])
@@ -12,11 +12,11 @@ return a new TSV containing either:
 # =======================================================================
 
 import argparse
-import gzip
 import logging
 import time
 from datetime import UTC, datetime
-from typing import IO, cast
+
+from nao_io import open_by_suffix
 
 # =======================================================================
 # Configure logging
@@ -68,23 +68,6 @@ def parse_args() -> argparse.Namespace:
     return parser.parse_args()
 
 
-def open_by_suffix(filename: str, mode: str = "r") -> IO[str]:
-    """
-    Open a file with the appropriate compression, as inferred from the filename suffix.
-    Args:
-        filename (str): Path to file.
-        mode (str): Mode to open file in.
-    Returns:
-        IO[str]: File object.
-    """
-    logger.debug(f"\tOpening file object: {filename}")
-    logger.debug(f"\tOpening mode: {mode}")
-    logger.debug(f"\tGZIP mode: {filename.endswith('.gz')}")
-    if filename.endswith(".gz"):
-        return cast(IO[str], gzip.open(filename, mode + "t"))
-    return open(filename, mode)
-
-
 # =======================================================================
 # TSV processing functions
 # =======================================================================
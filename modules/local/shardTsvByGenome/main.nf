@@ -0,0 +1,18 @@
+// Split a viral hits TSV into a fixed number of shards by hashed normalised genome ID
+process SHARD_TSV_BY_GENOME {
+    label "python"
+    label "single"
+    tag "id=${sample}"
+    input:
+        tuple val(sample), path(tsv)
+        val(column) // Header of genome ID column
+        val(n_shards) // Number of output shards
+    output:
+        tuple val(sample), path("shard_*_${tsv}"), emit: output
+        tuple val(sample), path("input_${tsv}"), emit: input
+    script:
+        """
+        shard_tsv_by_genome.py -i ${tsv} -c ${column} -n ${n_shards}
+        ln -s ${tsv} input_${tsv} # Link input to output for testing
+        """
+}
@@ -0,0 +1,187 @@
+#!/usr/bin/env python
+
+DESC = """
+Split a viral hits TSV into a fixed number of shards by a hash of each read's
+normalised genome ID (the "/"-separated genome IDs of a split assignment,
+sorted and rejoined, as used by mark_duplicates). All reads that could be
+alignment duplicates of one another land in the same shard, and each shard
+keeps the input header and the input order of its rows. Every shard file is
+written, even if it receives no rows.
+"""
+
+# =======================================================================
+# Import libraries
+# =======================================================================
+
+import argparse
+import logging
+import os
+import time
+import zlib
+from datetime import UTC, datetime
+from typing import IO
+
+from nao_io import TaskMetrics, iter_lines, open_by_suffix, write_lines
+
+# =======================================================================
+# Configure logging
+# =======================================================================
+
+
+class UTCFormatter(logging.Formatter):
+    def formatTime(self, record: logging.LogRecord, datefmt: str | None = None) -> str:
+        dt = datetime.fromtimestamp(record.created, UTC)
+        return dt.strftime("%Y-%m-%d %H:%M:%S UTC")
+
+
+logging.basicConfig(level=logging.INFO)
+logger = logging.getLogger()
+handler = logging.StreamHandler()
+formatter = UTCFormatter("[%(asctime)s] %(message)s")
+handler.setFormatter(formatter)
+logger.handlers.clear()
+logger.addHandler(handler)
+
+# =======================================================================
+# Define constants
+# =======================================================================
+
+GENOME_SEPARATOR = "/"
+# Rows buffered per shard before writing
+BATCH_LINES = 10000
+
+# =======================================================================
+# I/O functions
+# =======================================================================
+
+
+def parse_args() -> argparse.Namespace:
+    """Parse command-line arguments."""
+    # Create parser
+    parser = argparse.ArgumentParser(description=DESC)
+    # Add arguments
+    parser.add_argument("--input", "-i", required=True, help="Path to input TSV.")
+    parser.add_argument(
+        "--column", "-c", required=True, help="Header of genome ID column."
+    )
+    parser.add_argument(
+        "--shards", "-n", type=int, required=True, help="Number of output shards."
+    )
+    # Parse arguments
+    return parser.parse_args()
+
+
+def shard_path(input_path: str, index: int) -> str:
+    """Get the output path for a shard of the input TSV.
+    Args:
+        input_path: Path to input TSV.
+        index: Shard index.
+    Returns:
+        Shard path in the working directory, prefixed to the input filename.
+    """
+    return f"shard_{index}_{os.path.basename(input_path)}"
+
+
+# =======================================================================
+# Sharding functions
+# =======================================================================
+
+
+def normalise_genome_id(genome_id: str) -> str:
+    """Normalise a genome ID so both mates' orderings of a split
+    assignment compare equal.
+    Args:
+        genome_id: Genome ID, or "/"-separated genome IDs.
+    Returns:
+        The genome IDs, sorted and rejoined.
+    """
+    if GENOME_SEPARATOR not in genome_id:
+        return genome_id
+    return GENOME_SEPARATOR.join(sorted(genome_id.split(GENOME_SEPARATOR)))
+
+
+def shard_index(genome_id: str, n_shards: int) -> int:
+    """Assign a genome ID to a shard, stably across runs and platforms.
+    Args:
+        genome_id: Genome ID of a read.
+        n_shards: Number of shards.
+    Returns:
+        Shard index in [0, n_shards).
+    """
+    key = normalise_genome_id(genome_id).encode()
+    return zlib.crc32(key) % n_shards
+
+
+def shard_tsv(
+    input_path: str,
+    column: str,
+    n_shards: int,
+    metrics: TaskMetrics | None = None,
+) -> list[int]:
+    """Split a TSV into shards by hashed normalised genome ID.
+    Args:
+        input_path: Path to input TSV.
+        column: Header of genome ID column.
+        n_shards: Number of shards.
+        metrics: Optional task metrics.
+    Returns:
+        Number of rows written to each shard.
+    """
+    if n_shards < 1:
+        raise ValueError(f"Number of shards must be positive: {n_shards}")
+    with open_by_suffix(input_path, "r", metrics) as inf:
+        header_line = inf.readline().rstrip("\n")
+        if not header_line:
+            raise ValueError("Input file is empty.")
+        headers = header_line.split("\t")
+        if column not in headers:
+            raise ValueError(f"Required column is missing from header line: {column}")
+        index = headers.index(column)
+        outfs: list[IO[str]] = []
+        try:
+            for i in range(n_shards):
+                outf = open_by_suffix(shard_path(input_path, i), "w", metrics)
+                outfs.append(outf)
+                outf.write(header_line + "\n")
+            buffers: list[list[str]] = [[] for _ in range(n_shards)]
+            counts = [0] * n_shards
+            for line in iter_lines(inf):
+                i = shard_index(line.split("\t", index + 1)[index], n_shards)
+                buffers[i].append(line)
+                if len(buffers[i]) >= BATCH_LINES:
+                    counts[i] += write_lines(outfs[i], buffers[i])
+                    buffers[i].clear()
+            for i, buffer in enumerate(buffers):
+                counts[i] += write_lines(outfs[i], buffer)
+        finally:
+            for outf in outfs:
+                outf.close()
+    return counts
+
+
+# =======================================================================
+# Main function
+# =======================================================================
+
+
+def main() -> None:
+    logger.info("Initializing script.")
+    start_time = time.time()
+    # Parse arguments
+    logger.info("Parsing arguments.")
+    args = parse_args()
+    logger.info(f"Arguments: {args}")
+    # Shard input
+    with TaskMetrics("shard_tsv_by_genome") as metrics:
+        logger.info(f"Sharding input TSV into {args.shards} shards.")
+        with metrics.phase("shard"):
+            counts = shard_tsv(args.input, args.column, args.shards, metrics)
+    logger.info(f"Rows per shard: {counts}")
+    # Log completion
+    logger.info("Script completed successfully.")
+    end_time = time.time()
+    logger.info(f"Total time elapsed: {end_time - start_time} seconds")
+
+
+if __name__ == "__main__":
+    main()
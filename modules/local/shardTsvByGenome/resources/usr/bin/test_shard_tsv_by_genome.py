@@ -0,0 +1,106 @@
+#!/usr/bin/env python
+
+import os
+from collections.abc import Iterator
+from pathlib import Path
+from typing import Any
+
+import pytest
+from shard_tsv_by_genome import normalise_genome_id, shard_index, shard_tsv
+
+HEADER = "seq_id\tprim_align_genome_id_all\tquery_seq"
+ROWS = [
+    "r1\tg1\tACGT",
+    "r2\tg0/g1\tACGA",
+    "r3\tg2\tACGC",
+    "r4\tg1/g0\tACGG",
+    "r5\tg1\tACTT",
+    "r6\tg3/g2\tAGGT",
+    "r7\tg2/g3\tATGT",
+]
+
+
+@pytest.fixture
+def workdir(tmp_path: Path) -> Iterator[Path]:
+    """Run in a temporary directory, where shards are written."""
+    original_cwd = os.getcwd()
+    os.chdir(tmp_path)
+    try:
+        yield tmp_path
+    finally:
+        os.chdir(original_cwd)
+
+
+def read_shards(tsv_factory: Any, name: str, n_shards: int) -> list[list[str]]:
+    """Read every shard of an input file as lists of lines."""
+    shards = []
+    for i in range(n_shards):
+        path = f"shard_{i}_{name}"
+        if name.endswith(".gz"):
+            text = tsv_factory.read_gzip(path)
+        else:
+            text = tsv_factory.read_plain(path)
+        shards.append(text.splitlines())
+    return shards
+
+
+class TestNormaliseGenomeId:
+    def test_single_genome_unchanged(self) -> None:
+        assert normalise_genome_id("NC_001.1") == "NC_001.1"
+
+    def test_split_assignment_sorted(self) -> None:
+        assert normalise_genome_id("g1/g0") == normalise_genome_id("g0/g1") == "g0/g1"
+
+    def test_shard_index_in_range_and_stable(self) -> None:
+        indices = [shard_index(f"g{i}", 4) for i in range(100)]
+        assert set(indices) == {0, 1, 2, 3}
+        assert shard_index("g1/g0", 4) == shard_index("g0/g1", 4)
+        assert all(shard_index("g5", 1) == 0 for _ in range(3))
+
+
+class TestShardTsv:
+    def test_shards_partition_input(self, tsv_factory: Any, workdir: Path) -> None:
+        tsv_factory.create_plain("in.tsv", "\n".join([HEADER, *ROWS]) + "\n")
+        counts = shard_tsv("in.tsv", "prim_align_genome_id_all", 3)
+        shards = read_shards(tsv_factory, "in.tsv", 3)
+        assert counts == [len(s) - 1 for s in shards]
+        assert all(s[0] == HEADER for s in shards)
+        # Every row lands in exactly one shard, in input order
+        body = [row for s in shards for row in s[1:]]
+        assert sorted(body) == sorted(ROWS)
+        for s in shards:
+            assert s[1:] == [row for row in ROWS if row in s[1:]]
+        # All reads with the same normalised genome ID share a shard
+        shard_of: dict[str, int] = {}
+        for i, s in enumerate(shards):
+            for row in s[1:]:
+                genome = normalise_genome_id(row.split("\t")[1])
+                assert shard_of.setdefault(genome, i) == i
+        assert len(shard_of) == 4
+
+    def test_empty_shards_written(self, tsv_factory: Any, workdir: Path) -> None:
+        tsv_factory.create_gzip("in.tsv.gz", "\n".join([HEADER, ROWS[0]]) + "\n")
+        counts = shard_tsv("in.tsv.gz", "prim_align_genome_id_all", 4)
+        assert sorted(counts) == [0, 0, 0, 1]
+        shards = read_shards(tsv_factory, "in.tsv.gz", 4)
+        assert sorted(len(s) for s in shards) == [1, 1, 1, 2]
+
+    def test_header_only_input(self, tsv_factory: Any, workdir: Path) -> None:
+        tsv_factory.create_plain("in.tsv", HEADER + "\n")
+        assert shard_tsv("in.tsv", "prim_align_genome_id_all", 2) == [0, 0]
+        assert read_shards(tsv_factory, "in.tsv", 2) == [[HEADER], [HEADER]]
+
+    def test_empty_file_raises_error(self, tsv_factory: Any, workdir: Path) -> None:
+        tsv_factory.create_plain("in.tsv", "")
+        with pytest.raises(ValueError, match="Input file is empty"):
+            shard_tsv("in.tsv", "prim_align_genome_id_all", 2)
+
+    def test_missing_column_raises_error(self, tsv_factory: Any, workdir: Path) -> None:
+        tsv_factory.create_plain("in.tsv", "seq_id\tx\nr1\tg1\n")
+        with pytest.raises(ValueError, match="Required column is missing"):
+            shard_tsv("in.tsv", "prim_align_genome_id_all", 2)
+
+    def test_invalid_shard_count(self, tsv_factory: Any, workdir: Path) -> None:
+        tsv_factory.create_plain("in.tsv", HEADER + "\n")
+        with pytest.raises(ValueError, match="must be positive"):
+            shard_tsv("in.tsv", "prim_align_genome_id_all", 0)
@@ -19,3 +19,24 @@ process SORT_TSV {
         ln -s ${tsv} input_${tsv}
         """
 }
+
+// Sort a TSV file by a specified column header, writing the result directly under its final name (<sample>_<outname>)
+// The input is staged in a subdirectory, as it may already carry the output name
+process SORT_TSV_NAMED {
+    label "python"
+    label "single_cpu_16GB_memory"
+    tag "id=${sample}"
+    input:
+        tuple val(sample), path(tsv, stageAs: "in/*")
+        val(sort_field)
+        val(outname)
+    output:
+        tuple val(sample), path("${sample}_${outname}"), emit: sorted
+        tuple val(sample), path("input_${tsv.name}"), emit: input
+    script:
+        """
+        sort_tsv.py -m ${task.memory.toGiga()} ${tsv} ${sort_field} ${sample}_${outname}
+        # Link input to output for testing
+        ln -s ${tsv} input_${tsv.name}
+        """
+}
@@ -9,7 +9,6 @@ Sort a TSV file by a specific column header using GNU sort.
 # =======================================================================
 
 import argparse
-import gzip
 import logging
 import math
 import os
@@ -19,7 +18,8 @@ import sys
 import tempfile
 import time
 from datetime import UTC, datetime
-from typing import IO, cast
+
+from nao_io import TaskMetrics, open_by_suffix
 
 # =======================================================================
 # Configure logging
@@ -61,24 +61,6 @@ def parse_args() -> argparse.Namespace:
     return parser.parse_args()
 
 
-def open_by_suffix(filename: str, mode: str = "r") -> IO[str]:
-    """
-    Open a file with the appropriate compression, based on
-    the filename suffix.
-    Args:
-        filename (str): The path to the file to open.
-        mode (str): The mode to open the file in.
-    Returns:
-        IO[str]: The opened file object.
-    """
-    logger.debug(f"Opening file object: {filename}")
-    logger.debug(f"Opening mode: {mode}")
-    logger.debug(f"GZIP mode: {filename.endswith('.gz')}")
-    if filename.endswith(".gz"):
-        return cast(IO[str], gzip.open(filename, mode + "t"))
-    return open(filename, mode)
-
-
 def process_header(header_line: str, sort_field: str) -> int | None:
     """
     Process the header line and find the index of the sort field.
@@ -112,7 +94,11 @@ def process_header(header_line: str, sort_field: str) -> int | None:
 
 
 def sort_tsv_file(
-    input_file: str, output_file: str, sort_field: str, memory_limit: int
+    input_file: str,
+    output_file: str,
+    sort_field: str,
+    memory_limit: int,
+    metrics: TaskMetrics | None = None,
 ) -> None:
     """
     Sort a TSV file by a specific column header.
@@ -120,7 +106,10 @@ def sort_tsv_file(
         input_file (str): The input TSV file path.
         output_file (str): The output TSV file path.
         sort_field (str): The column header to sort by.
+        metrics (TaskMetrics | None): Metrics to tally I/O and time phases in.
     """
+    if metrics is None:
+        metrics = TaskMetrics("sort_tsv")
     # Create local temp directory base if it doesn't exist
     temp_base = "sort_tsv_tmp"
     temp_base_exists = os.path.exists(temp_base)
@@ -129,8 +118,8 @@ def sort_tsv_file(
     # Use local directory to avoid memory-based tmpfs
     with (
         tempfile.TemporaryDirectory(dir=temp_base) as temp_dir,
-        open_by_suffix(input_file) as infile,
-        open_by_suffix(output_file, "w") as outfile,
+        open_by_suffix(input_file, metrics=metrics) as infile,
+        open_by_suffix(output_file, "w", metrics) as outfile,
     ):
         # Define temporary file paths
         logger.debug(f"Temporary directory: {temp_dir}")
@@ -151,14 +140,15 @@ def sort_tsv_file(
             logger.warning("No data rows to sort, writing header only")
             return
         # Otherwise, write data lines to temp file
-        with open_by_suffix(temp_body, "w") as temp:
+        with metrics.phase("parse"), open_by_suffix(temp_body, "w") as temp:
             temp.write(first_data_line + "\n")
             for line in infile:
                 temp.write(line)
         # Sort temporary file (with custom temp directory for GNU sort)
-        run_sort(temp_body, temp_body_sorted, col_index, temp_base, memory_limit)
+        with metrics.phase("sort"):
+            run_sort(temp_body, temp_body_sorted, col_index, temp_base, memory_limit)
         # Write sorted data to output
-        with open_by_suffix(temp_body_sorted) as temp:
+        with metrics.phase("write"), open_by_suffix(temp_body_sorted) as temp:
             for line in temp:
                 outfile.write(line)
     # Clean up temporary directory
@@ -226,7 +216,10 @@ def main() -> None:
     logger.info(f"Memory limit: {memory_limit} GB")
     # Sort the TSV file
     logger.info("Sorting TSV file.")
-    sort_tsv_file(args.input_file, args.output_file, args.sort_field, memory_limit)
+    with TaskMetrics("sort_tsv") as metrics:
+        sort_tsv_file(
+            args.input_file, args.output_file, args.sort_field, memory_limit, metrics
+        )
     # Finish time tracking
     logger.info("Script completed successfully.")
     end_time = time.time()
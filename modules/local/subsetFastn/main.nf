@@ -1,6 +1,7 @@
 // Subsample single or interleaved FASTQ / FASTA based on read IDs
+// Tool source: rust-tools/fastqkit/
 process SUBSET_FASTN {
-    label "seqkit"
+    label "rust_tools"
     label "single"
     label "testing_only" // Process is currently only used for testing
     tag "id=${sample}"
@@ -42,12 +43,13 @@ process SUBSET_FASTN {
             exit 0
         fi
         # Get unique read IDs from input file
-        seqkit seq -ni ${fastn} | sort -u > all_ids.txt
+        fastqkit ids -i ${fastn} -o all_ids.txt --unique -t ${task.cpus}
         echo "Input IDs: \$(cat all_ids.txt | wc -l)"
         # Subsample IDs
         echo "Target read percentage: ${rpc}%"
         echo "Random seed: ${rseed}"
         RANDOM=${rseed}
+        touch sample_ids.txt
         while IFS= read -r line; do
             rand_val=\$((RANDOM % 100))
             threshold=${rpc}
@@ -57,7 +59,7 @@ process SUBSET_FASTN {
         done < all_ids.txt
         echo "Output IDs: \$(cat sample_ids.txt | wc -l)"
         # Subsample sequences based on IDs
-        seqkit grep -f sample_ids.txt ${fastn} | ${fastn.toString().endsWith(".gz") ? 'gzip -c' : 'cat'} > ${out}
+        fastqkit subseq -i ${fastn} --ids sample_ids.txt -o ${out} -t ${task.cpus}
         ln -s ${fastn} ${in_file}
         """
 }
@@ -0,0 +1,39 @@
+/*
+Given minimap2 alignments of a group's cluster representatives against the
+BLAST DB sequences, resolve representatives whose filtered alignments all hit
+one taxid concordant with their aligner_taxid_lca, writing those alignments in
+the filtered BLAST table format. All other representatives are written to a
+FASTA for validation with blastn (only if there are any), and each
+representative's decision is recorded in a decisions TSV.
+
+The input map params_map should specify the following fields:
+- blast_perc_id: Minimum percent identity of an alignment
+- blast_qcov_hsp_perc: Minimum percent query coverage of an alignment
+- blast_max_rank: Keep alignments up to this dense bitscore rank per representative
+- blast_min_frac: Keep alignments with at least this fraction of the best bitscore
+*/
+
+process TRIAGE_VALIDATION_HITS {
+    label "python"
+    label "single"
+    tag "id=${sample}"
+    input:
+        tuple val(sample), path(paf), path(reps_fasta), path(hits_tsv)
+        path(taxids_tsv) // TSV mapping BLAST DB sequences (sseqid) to taxids (staxid)
+        path(nodes_db) // TSV containing taxonomic structure (mapping taxids to parent taxids)
+        val(params_map)
+    output:
+        tuple val(sample), path("${sample}_validation_minimap2.tsv.gz"), emit: resolved
+        tuple val(sample), path("${sample}_escalated.fasta.gz"), emit: escalated, optional: true
+        tuple val(sample), path("${sample}_validation_triage.tsv.gz"), emit: decisions
+        tuple val(sample), path("input_${paf}"), emit: input
+    script:
+        def io = "--paf ${paf} --fasta ${reps_fasta} --hits ${hits_tsv} --taxids ${taxids_tsv} -n ${nodes_db}"
+        def out = "--resolved ${sample}_validation_minimap2.tsv.gz --escalated ${sample}_escalated.fasta.gz --decisions ${sample}_validation_triage.tsv.gz"
+        def par = "--perc-id ${params_map.blast_perc_id} --qcov ${params_map.blast_qcov_hsp_perc} --max-rank ${params_map.blast_max_rank} --min-frac ${params_map.blast_min_frac}"
+        """
+        triage_validation_hits.py ${io} ${out} ${par}
+        # Link input to output for testing
+        ln -s ${paf} input_${paf}
+        """
+}
@@ -0,0 +1,230 @@
+#!/usr/bin/env python
+
+import argparse
+import gzip
+from pathlib import Path
+
+import pytest
+from compute_taxid_distance import parse_nodes_db
+from triage_validation_hits import (
+    BLAST_HEADER,
+    parse_paf_line,
+    select_alignments,
+    triage_representatives,
+    triage_validation_hits,
+)
+
+MODULES_DIR = Path(__file__).resolve().parents[4]
+
+NODES = (
+    "1\t|\t1\n"
+    "9000\t|\t1\n"
+    "9001\t|\t9000\n"
+    "9003\t|\t9000\n"
+    "9004\t|\t9003\n"
+    "9005\t|\t9004\n"
+    "8000\t|\t1\n"
+    "8001\t|\t8000\n"
+)
+FASTA = ">R1\nACGT\n>R2 extra\nACGT\n>R3\nACGT\n>R4\nACGT\n>R5\nACGT\n>R6\nACGT\n"
+HITS = (
+    "seq_id\taligner_taxid_lca\textra\n"
+    "R1\t9004\ta\n"
+    "R2\t9003\tb\n"
+    "R3\t9004\tc\n"
+    "R4\t9004\td\n"
+    "R5\t9004\te\n"
+    "R6\t9004\tf\n"
+    "H1\t8001\tg\n"
+)
+TAXIDS = "sseqid\tstaxid\nS1\t9005\nS2\t9005\nS3\t8001\nS4\t9001\nS5\t9004\n"
+
+
+def paf(query: str, subject: str, n_match: int, length: int, **kwargs: int) -> str:
+    """Build a PAF line for a 100 bp query aligned over its first `length` bases."""
+    fields = [
+        query,
+        "100",
+        "0",
+        str(kwargs.get("qend", length)),
+        kwargs.get("strand", "+"),
+        subject,
+        "1000",
+        "10",
+        str(10 + length),
+        str(n_match),
+        str(length),
+        "60",
+        f"NM:i:{length - n_match}",
+    ]
+    return "\t".join(str(f) for f in fields)
+
+
+PAF = "\n".join(
+    [
+        # R1: resolved (two subjects of a descendant of its taxid)
+        paf("R1", "S1", 100, 100),
+        paf("R1", "S2", 99, 100),
+        # R2: resolved on the minus strand (9004 lies within 9003)
+        paf("R2", "S5", 100, 100, strand="-"),
+        # R3: ambiguous (near-equal hits to two taxids)
+        paf("R3", "S1", 100, 100),
+        paf("R3", "S4", 100, 100),
+        # R4: discordant with its assigned taxid
+        paf("R4", "S3", 100, 100),
+        # R5: only a low-identity alignment
+        paf("R5", "S1", 50, 100),
+        # R6: unmapped
+    ]
+)
+THRESHOLDS = {"perc_id": 60.0, "qcov": 30.0, "max_rank": 10, "min_frac": 0.9}
+
+
+def write(path: Path, content: str) -> str:
+    if path.suffix == ".gz":
+        with gzip.open(path, "wt") as f:
+            f.write(content)
+    else:
+        path.write_text(content)
+    return str(path)
+
+
+def read(path: Path) -> list[str]:
+    with gzip.open(path, "rt") as f:
+        return f.read().splitlines()
+
+
+class TestParsePafLine:
+    def test_reads_edit_distance_tag(self) -> None:
+        aln = parse_paf_line(paf("R1", "S1", 95, 100))
+        assert (aln.query, aln.subject, aln.n_match, aln.n_edit) == ("R1", "S1", 95, 5)
+        assert aln.identity == pytest.approx(95.0)
+        assert aln.query_coverage == pytest.approx(100.0)
+
+    def test_falls_back_without_tag(self) -> None:
+        line = "\t".join(paf("R1", "S1", 90, 100).split("\t")[:12])
+        assert parse_paf_line(line).n_edit == 10
+
+    def test_rejects_short_line(self) -> None:
+        with pytest.raises(ValueError, match="PAF line has"):
+            parse_paf_line("R1\t100")
+
+
+class TestSelectAlignments:
+    def test_filters_like_blast(self) -> None:
+        alignments = [
+            parse_paf_line(paf("R1", "S1", 100, 100)),
+            parse_paf_line(paf("R1", "S1", 90, 100)),  # Worse alignment, same subject
+            parse_paf_line(paf("R1", "S2", 99, 100)),
+            parse_paf_line(paf("R1", "S3", 70, 100)),  # Below min_frac
+            parse_paf_line(paf("R1", "S4", 100, 20, qend=20)),  # Below qcov
+        ]
+        selected = select_alignments(alignments, 60.0, 30.0, 10, 0.9)
+        assert [(a.subject, rank) for a, rank, _ in selected] == [("S1", 1), ("S2", 2)]
+        assert selected[0][2] == 1.0
+
+    def test_max_rank(self) -> None:
+        alignments = [
+            parse_paf_line(paf("R1", "S1", 100, 100)),
+            parse_paf_line(paf("R1", "S2", 99, 100)),
+        ]
+        selected = select_alignments(alignments, 60.0, 30.0, 1, 0.9)
+        assert [a.subject for a, _, _ in selected] == ["S1"]
+
+
+class TestTriageRepresentatives:
+    def test_decisions(self, tmp_path: Path) -> None:
+        child_to_parent, _ = parse_nodes_db(write(tmp_path / "nodes.dmp", NODES))
+        alignments: dict = {}
+        for line in PAF.splitlines():
+            aln = parse_paf_line(line)
+            alignments.setdefault(aln.query, []).append(aln)
+        records = [(f"R{i}", "ACGT") for i in range(1, 7)]
+        subject_taxids = dict(r.split("\t") for r in TAXIDS.splitlines()[1:])
+        rep_taxids = {f"R{i}": "9004" for i in range(1, 7)} | {"R2": "9003"}
+        rows, escalated, decisions = triage_representatives(
+            records, alignments, subject_taxids, rep_taxids, child_to_parent, THRESHOLDS
+        )
+        assert [d.split("\t")[1] for d in decisions] == [
+            "resolved",
+            "resolved",
+            "ambiguous",
+            "discordant",
+            "low_identity",
+            "unmapped",
+        ]
+        assert [h for h, _ in escalated] == ["R3", "R4", "R5", "R6"]
+        assert [r.split("\t")[:2] for r in rows] == [
+            ["R1", "S1"],
+            ["R1", "S2"],
+            ["R2", "S5"],
+        ]
+        # Minus-strand alignments report subject coordinates in reverse, as BLAST
+        r2 = dict(zip(BLAST_HEADER, rows[2].split("\t")))
+        assert (r2["sstrand"], r2["sstart"], r2["send"]) == ("minus", "110", "11")
+        assert all(len(r.split("\t")) == len(BLAST_HEADER) for r in rows)
+
+
+class TestTriageValidationHits:
+    def test_writes_outputs(self, tmp_path: Path) -> None:
+        args = argparse.Namespace(
+            paf=write(tmp_path / "reps.paf.gz", PAF + "\n"),
+            fasta=write(tmp_path / "reps.fasta", FASTA),
+            hits=write(tmp_path / "hits.tsv.gz", HITS),
+            taxids=write(tmp_path / "taxids.tsv.gz", TAXIDS),
+            nodes_db=write(tmp_path / "nodes.dmp", NODES),
+            taxid_field="aligner_taxid_lca",
+            resolved=str(tmp_path / "resolved.tsv.gz"),
+            escalated=str(tmp_path / "escalated.fasta.gz"),
+            decisions=str(tmp_path / "decisions.tsv.gz"),
+            **THRESHOLDS,
+        )
+        triage_validation_hits(args)
+        resolved = read(tmp_path / "resolved.tsv.gz")
+        assert resolved[0].split("\t") == BLAST_HEADER
+        assert {r.split("\t")[0] for r in resolved[1:]} == {"R1", "R2"}
+        # Escalated records keep their full FASTA headers
+        escalated = read(tmp_path / "escalated.fasta.gz")
+        assert escalated[::2] == [">R3", ">R4", ">R5", ">R6"]
+        decisions = read(tmp_path / "decisions.tsv.gz")
+        assert decisions[0] == "qseqid\tdecision\tn_alignments\tmm2_staxid"
+        assert decisions[2] == "R2\tresolved\t1\t9004"
+
+    def test_skips_escalated_fasta_when_all_resolved(self, tmp_path: Path) -> None:
+        args = argparse.Namespace(
+            paf=write(tmp_path / "reps.paf", paf("R1", "S1", 100, 100) + "\n"),
+            fasta=write(tmp_path / "reps.fasta", ">R1\nACGT\n"),
+            hits=write(tmp_path / "hits.tsv", HITS),
+            taxids=write(tmp_path / "taxids.tsv", TAXIDS),
+            nodes_db=write(tmp_path / "nodes.dmp", NODES),
+            taxid_field="aligner_taxid_lca",
+            resolved=str(tmp_path / "resolved.tsv.gz"),
+            escalated=str(tmp_path / "escalated.fasta.gz"),
+            decisions=str(tmp_path / "decisions.tsv.gz"),
+            **THRESHOLDS,
+        )
+        triage_validation_hits(args)
+        assert not (tmp_path / "escalated.fasta.gz").exists()
+        assert len(read(tmp_path / "resolved.tsv.gz")) == 2
+
+    def test_missing_taxid_column(self, tmp_path: Path) -> None:
+        args = argparse.Namespace(
+            paf=write(tmp_path / "reps.paf", paf("R1", "S1", 100, 100) + "\n"),
+            fasta=write(tmp_path / "reps.fasta", ">R1\nACGT\n"),
+            hits=write(tmp_path / "hits.tsv", "seq_id\ttaxid\nR1\t9004\n"),
+            taxids=write(tmp_path / "taxids.tsv", TAXIDS),
+            nodes_db=write(tmp_path / "nodes.dmp", NODES),
+            taxid_field="aligner_taxid_lca",
+            resolved=str(tmp_path / "resolved.tsv.gz"),
+            escalated=str(tmp_path / "escalated.fasta.gz"),
+            decisions=str(tmp_path / "decisions.tsv.gz"),
+            **THRESHOLDS,
+        )
+        with pytest.raises(ValueError, match="Missing column in hits TSV"):
+            triage_validation_hits(args)
+
+
+def test_taxonomy_copy_identical() -> None:
+    source = MODULES_DIR / "computeTaxidDistance/resources/usr/bin"
+    copy = (Path(__file__).parent / "compute_taxid_distance.py").read_bytes()
+    assert copy == (source / "compute_taxid_distance.py").read_bytes()
@@ -0,0 +1,562 @@
+#!/usr/bin/env python
+
+DESC = """
+Given minimap2 alignments (PAF, with base-level alignment) of a group's
+cluster representatives against the BLAST DB sequences, decide which
+representatives minimap2 resolves and which must be escalated to blastn.
+Alignments are filtered like BLAST's (minimum percent identity and query
+coverage, best alignment per subject, then top-ranked alignments by
+estimated bitscore). A representative is resolved if its retained
+alignments all hit one taxid that equals, contains or lies within its
+aligner_taxid_lca; its alignments are written in the filtered BLAST table
+format, so LCA and distance columns are computed exactly as for BLAST hits.
+Unmapped, low-identity, ambiguous and discordant representatives are written
+to a FASTA for blastn, and every decision is recorded in a decisions TSV.
+"""
+
+# =======================================================================
+# Import libraries
+# =======================================================================
+
+import argparse
+import logging
+import math
+import time
+from dataclasses import dataclass
+from datetime import UTC, datetime
+
+from compute_taxid_distance import (
+    compute_taxonomic_distance,
+    parse_nodes_db,
+    parse_taxid,
+)
+from nao_io import TaskMetrics, iter_lines, open_by_suffix, write_lines
+
+# =======================================================================
+# Configure logging
+# =======================================================================
+
+
+class UTCFormatter(logging.Formatter):
+    def formatTime(self, record: logging.LogRecord, datefmt: str | None = None) -> str:
+        dt = datetime.fromtimestamp(record.created, UTC)
+        return dt.strftime("%Y-%m-%d %H:%M:%S UTC")
+
+
+logging.basicConfig(level=logging.INFO)
+logger = logging.getLogger()
+handler = logging.StreamHandler()
+formatter = UTCFormatter("[%(asctime)s] %(message)s")
+handler.setFormatter(formatter)
+logger.handlers.clear()
+logger.addHandler(handler)
+
+# =======================================================================
+# Define constants
+# =======================================================================
+
+SEQ_ID_FIELD = "seq_id"
+SUBJECT_FIELD = "sseqid"
+TAXID_FIELD = "staxid"
+PLACEHOLDER = "NA"
+# Columns of the filtered BLAST table (see filter_blast.py)
+BLAST_HEADER = [
+    "qseqid",
+    "sseqid",
+    "sgi",
+    "staxid",
+    "qlen",
+    "evalue",
+    "bitscore",
+    "qcovs",
+    "length",
+    "pident",
+    "mismatch",
+    "gapopen",
+    "sstrand",
+    "qstart",
+    "qend",
+    "sstart",
+    "send",
+    "bitscore_rank_dense",
+    "bitscore_fraction",
+]
+DECISIONS_HEADER = ["qseqid", "decision", "n_alignments", "mm2_staxid"]
+# Karlin-Altschul parameters of blastn's default megablast scoring (reward 1,
+# penalty -2), used to put minimap2 alignments on BLAST's bitscore scale
+REWARD = 1
+PENALTY = 2
+LAMBDA = 1.28
+K = 0.46
+# Decisions
+RESOLVED = "resolved"
+UNMAPPED = "unmapped"
+LOW_IDENTITY = "low_identity"
+AMBIGUOUS = "ambiguous"
+DISCORDANT = "discordant"
+
+# =======================================================================
+# I/O functions
+# =======================================================================
+
+
+def parse_args() -> argparse.Namespace:
+    """Parse command-line arguments."""
+    # Create parser
+    parser = argparse.ArgumentParser(description=DESC)
+    # Add arguments
+    parser.add_argument(
+        "--paf", required=True, help="Path to minimap2 PAF for representatives."
+    )
+    parser.add_argument(
+        "--fasta", required=True, help="Path to FASTA of cluster representatives."
+    )
+    parser.add_argument("--hits", required=True, help="Path to viral hits TSV.")
+    parser.add_argument(
+        "--taxids",
+        required=True,
+        help="Path to TSV mapping BLAST DB sequences (sseqid) to taxids (staxid).",
+    )
+    parser.add_argument(
+        "--nodes-db", "-n", required=True, help="Path to taxonomy nodes DB."
+    )
+    parser.add_argument(
+        "--taxid-field",
+        default="aligner_taxid_lca",
+        help="Column header for the hits' assigned taxid (default aligner_taxid_lca).",
+    )
+    parser.add_argument(
+        "--perc-id",
+        type=float,
+        default=60.0,
+        help="Minimum percent identity of an alignment.",
+    )
+    parser.add_argument(
+        "--qcov",
+        type=float,
+        default=30.0,
+        help="Minimum percent query coverage of an alignment.",
+    )
+    parser.add_argument(
+        "--max-rank",
+        type=int,
+        default=10,
+        help="Keep alignments up to this dense bitscore rank per representative.",
+    )
+    parser.add_argument(
+        "--min-frac",
+        type=float,
+        default=0.9,
+        help="Keep alignments with at least this fraction of the best bitscore.",
+    )
+    parser.add_argument(
+        "--resolved",
+        required=True,
+        help="Output TSV of resolved alignments, in filtered BLAST format.",
+    )
+    parser.add_argument(
+        "--escalated",
+        required=True,
+        help="Output FASTA of escalated representatives (only written if any).",
+    )
+    parser.add_argument(
+        "--decisions", required=True, help="Output TSV of per-representative decisions."
+    )
+    # Return parsed arguments
+    return parser.parse_args()
+
+
+@dataclass
+class Alignment:
+    """One minimap2 alignment of a representative, from a PAF line."""
+
+    query: str
+    query_len: int
+    query_start: int
+    query_end: int
+    strand: str
+    subject: str
+    subject_start: int
+    subject_end: int
+    n_match: int
+    length: int
+    n_edit: int
+
+    @property
+    def identity(self) -> float:
+        """Percent identity over the alignment, as BLAST's pident."""
+        return 100.0 * self.n_match / self.length if self.length else 0.0
+
+    @property
+    def query_coverage(self) -> float:
+        """Percent of the query covered by the alignment."""
+        return 100.0 * (self.query_end - self.query_start) / self.query_len
+
+    @property
+    def bitscore(self) -> float:
+        """
+        Bitscore estimated with blastn's default scoring, treating each edit
+        (mismatch or gap base) as a mismatch.
+        """
+        raw = REWARD * self.n_match - PENALTY * self.n_edit
+        return (LAMBDA * raw - math.log(K)) / math.log(2)
+
+
+def parse_paf_line(line: str) -> Alignment:
+    """
+    Parse one PAF line. The edit distance is read from the NM tag, falling
+    back on the unmatched alignment columns if it is absent.
+    Args:
+        line (str): PAF line, without newline.
+    Returns:
+        Alignment: Parsed alignment.
+    """
+    fields = line.split("\t")
+    if len(fields) < 12:
+        msg = f"PAF line has {len(fields)} fields (expected at least 12): {line}"
+        logger.error(msg)
+        raise ValueError(msg)
+    n_match, length = int(fields[9]), int(fields[10])
+    n_edit = length - n_match
+    for tag in fields[12:]:
+        if tag.startswith("NM:i:"):
+            n_edit = int(tag[5:])
+    return Alignment(
+        query=fields[0],
+        query_len=int(fields[1]),
+        query_start=int(fields[2]),
+        query_end=int(fields[3]),
+        strand=fields[4],
+        subject=fields[5],
+        subject_start=int(fields[7]),
+        subject_end=int(fields[8]),
+        n_match=n_match,
+        length=length,
+        n_edit=n_edit,
+    )
+
+
+def load_alignments(
+    path: str, metrics: TaskMetrics | None = None
+) -> dict[str, list[Alignment]]:
+    """
+    Load minimap2 alignments grouped by representative.
+    Args:
+        path (str): Path to PAF file.
+        metrics (TaskMetrics | None): Optional metrics to record I/O in.
+    Returns:
+        dict[str, list[Alignment]]: Alignments of each representative.
+    """
+    alignments: dict[str, list[Alignment]] = {}
+    with open_by_suffix(path, "r", metrics) as f:
+        for line in iter_lines(f):
+            if not line:
+                continue
+            aln = parse_paf_line(line)
+            alignments.setdefault(aln.query, []).append(aln)
+    logger.info(f"Loaded alignments for {len(alignments)} representatives.")
+    return alignments
+
+
+def read_fasta(path: str, metrics: TaskMetrics | None = None) -> list[tuple[str, str]]:
+    """
+    Read FASTA records in file order.
+    Args:
+        path (str): Path to FASTA file.
+        metrics (TaskMetrics | None): Optional metrics to record I/O in.
+    Returns:
+        list[tuple[str, str]]: (header without ">", sequence) records.
+    """
+    records: list[tuple[str, str]] = []
+    header: str | None = None
+    seq: list[str] = []
+    with open_by_suffix(path, "r", metrics) as f:
+        for line in iter_lines(f):
+            if line.startswith(">"):
+                if header is not None:
+                    records.append((header, "".join(seq)))
+                header, seq = line[1:], []
+            elif line:
+                seq.append(line)
+    if header is not None:
+        records.append((header, "".join(seq)))
+    return records
+
+
+def record_id(header: str) -> str:
+    """Return a FASTA record's ID: its header up to the first whitespace."""
+    return (header.split(maxsplit=1) or [""])[0]
+
+
+def load_keyed_column(
+    path: str,
+    key_field: str,
+    value_field: str,
+    keys: set[str],
+    label: str,
+    metrics: TaskMetrics | None = None,
+) -> dict[str, str]:
+    """
+    Scan two columns of a TSV, keeping values for the given keys only.
+    Only the leading columns up to the rightmost of the two are split.
+    Args:
+        path (str): Path to TSV.
+        key_field (str): Column header for the key.
+        value_field (str): Column header for the value.
+        keys (set[str]): Keys to keep.
+        label (str): Name of the table for error messages.
+        metrics (TaskMetrics | None): Optional metrics to record I/O in.
+    Returns:
+        dict[str, str]: Mapping from each key found to its value.
+    """
+    values: dict[str, str] = {}
+    with open_by_suffix(path, "r", metrics) as f:
+        header = f.readline().rstrip("\n").split("\t")
+        for field in (key_field, value_field):
+            if field not in header:
+                msg = f"Missing column in {label} TSV: {field}"
+                logger.error(msg)
+                raise ValueError(msg)
+        key_index = header.index(key_field)
+        value_index = header.index(value_field)
+        max_split = max(key_index, value_index) + 1
+        for line in iter_lines(f):
+            if not line:
+                continue
+            fields = line.split("\t", max_split)
+            if fields[key_index] in keys:
+                values[fields[key_index]] = fields[value_index]
+    return values
+
+
+# =======================================================================
+# Triage functions
+# =======================================================================
+
+
+def select_alignments(
+    alignments: list[Alignment],
+    perc_id: float,
+    qcov: float,
+    max_rank: int,
+    min_frac: float,
+) -> list[tuple[Alignment, int, float]]:
+    """
+    Filter one representative's alignments as BLAST_FASTA filters BLAST hits:
+    drop alignments below the identity and coverage thresholds, keep the
+    best alignment per subject, then keep alignments within the top max_rank
+    distinct bitscores and min_frac of the best bitscore.
+    Args:
+        alignments (list[Alignment]): Alignments of one representative.
+        perc_id (float): Minimum percent identity.
+        qcov (float): Minimum percent query coverage.
+        max_rank (int): Maximum dense bitscore rank.
+        min_frac (float): Minimum fraction of the best bitscore.
+    Returns:
+        list[tuple[Alignment, int, float]]: Retained alignments with their dense
+            bitscore rank and bitscore fraction, best first.
+    """
+    best: dict[str, Alignment] = {}
+    for aln in alignments:
+        if aln.identity < perc_id or aln.query_coverage < qcov:
+            continue
+        if aln.subject not in best or aln.bitscore > best[aln.subject].bitscore:
+            best[aln.subject] = aln
+    ranked = sorted(best.values(), key=lambda a: (-a.bitscore, a.subject))
+    selected: list[tuple[Alignment, int, float]] = []
+    rank, frac = 0, 2.0
+    for aln in ranked:
+        aln_frac = aln.bitscore / ranked[0].bitscore if ranked[0].bitscore > 0 else 1.0
+        if aln_frac < min_frac:
+            break
+        if aln_frac < frac:
+            rank, frac = rank + 1, aln_frac
+        if rank > max_rank:
+            break
+        selected.append((aln, rank, frac))
+    return selected
+
+
+def format_blast_row(aln: Alignment, staxid: str, rank: int, frac: float) -> str:
+    """
+    Format an alignment as a row of the filtered BLAST table. Values BLAST
+    reports but minimap2 does not (GI, e-value, gap openings) are NA, and
+    mismatches count all edits.
+    Args:
+        aln (Alignment): Alignment to format.
+        staxid (str): Taxid of the subject sequence.
+        rank (int): Dense bitscore rank of the alignment.
+        frac (float): Fraction of the best bitscore.
+    Returns:
+        str: Tab-separated row, without newline.
+    """
+    plus = aln.strand == "+"
+    fields = [
+        aln.query,
+        aln.subject,
+        PLACEHOLDER,
+        staxid,
+        str(aln.query_len),
+        PLACEHOLDER,
+        f"{aln.bitscore:.1f}",
+        str(round(aln.query_coverage)),
+        str(aln.length),
+        f"{aln.identity:.3f}",
+        str(aln.n_edit),
+        PLACEHOLDER,
+        "plus" if plus else "minus",
+        str(aln.query_start + 1),
+        str(aln.query_end),
+        str(aln.subject_start + 1 if plus else aln.subject_end),
+        str(aln.subject_end if plus else aln.subject_start + 1),
+        str(rank),
+        str(frac),
+    ]
+    return "\t".join(fields)
+
+
+def is_concordant(
+    taxid_1: int | None,
+    taxid_2: int | None,
+    child_to_parent: dict[int, int],
+    path_cache: dict[int, list[int]],
+) -> bool:
+    """Return True if one taxid equals or is an ancestor of the other."""
+    distance_1, distance_2, _ = compute_taxonomic_distance(
+        taxid_1, taxid_2, child_to_parent, path_cache
+    )
+    return distance_1 == 0 or distance_2 == 0
+
+
+def triage_representatives(
+    records: list[tuple[str, str]],
+    alignments: dict[str, list[Alignment]],
+    subject_taxids: dict[str, str],
+    rep_taxids: dict[str, str],
+    child_to_parent: dict[int, int],
+    thresholds: dict[str, float],
+) -> tuple[list[str], list[tuple[str, str]], list[str]]:
+    """
+    Decide for each representative whether minimap2 resolves it.
+    Args:
+        records (list[tuple[str, str]]): Representative FASTA records.
+        alignments (dict[str, list[Alignment]]): Alignments per representative.
+        subject_taxids (dict[str, str]): Taxid of each aligned subject.
+        rep_taxids (dict[str, str]): Assigned taxid of each representative.
+        child_to_parent (dict[int, int]): Dictionary mapping taxids to parents.
+        thresholds (dict[str, float]): perc_id, qcov, max_rank and min_frac.
+    Returns:
+        tuple[list[str], list[tuple[str, str]], list[str]]: Resolved BLAST-format
+            rows (sorted by representative), escalated FASTA records, and
+            decision rows.
+    """
+    path_cache: dict[int, list[int]] = {}
+    resolved: dict[str, list[str]] = {}
+    escalated: list[tuple[str, str]] = []
+    decisions: list[str] = []
+    for header, seq in records:
+        rep_id = record_id(header)
+        rep_alignments = alignments.get(rep_id, [])
+        selected = select_alignments(
+            rep_alignments,
+            thresholds["perc_id"],
+            thresholds["qcov"],
+            int(thresholds["max_rank"]),
+            thresholds["min_frac"],
+        )
+        taxids = {subject_taxids.get(a.subject, PLACEHOLDER) for a, _, _ in selected}
+        mm2_taxid = next(iter(taxids)) if len(taxids) == 1 else PLACEHOLDER
+        if not rep_alignments:
+            decision = UNMAPPED
+        elif not selected:
+            decision = LOW_IDENTITY
+        elif mm2_taxid == PLACEHOLDER or parse_taxid(mm2_taxid) is None:
+            decision = AMBIGUOUS
+        elif not is_concordant(
+            parse_taxid(mm2_taxid),
+            parse_taxid(rep_taxids.get(rep_id, PLACEHOLDER)),
+            child_to_parent,
+            path_cache,
+        ):
+            decision = DISCORDANT
+        else:
+            decision = RESOLVED
+        if decision == RESOLVED:
+            resolved[rep_id] = [
+                format_blast_row(aln, mm2_taxid, rank, frac)
+                for aln, rank, frac in selected
+            ]
+        else:
+            escalated.append((header, seq))
+        decisions.append(
+            "\t".join([rep_id, decision, str(len(rep_alignments)), mm2_taxid])
+        )
+    rows = [row for rep_id in sorted(resolved) for row in resolved[rep_id]]
+    return rows, escalated, decisions
+
+
+def triage_validation_hits(
+    args: argparse.Namespace, metrics: TaskMetrics | None = None
+) -> None:
+    """
+    Load inputs, triage representatives and write the three outputs.
+    Args:
+        args (argparse.Namespace): Parsed command-line arguments.
+        metrics (TaskMetrics | None): Optional metrics to record I/O in.
+    """
+    child_to_parent, _ = parse_nodes_db(args.nodes_db)
+    records = read_fasta(args.fasta, metrics)
+    rep_ids = {record_id(header) for header, _ in records}
+    alignments = load_alignments(args.paf, metrics)
+    subjects = {aln.subject for alns in alignments.values() for aln in alns}
+    # The taxid map covers the whole BLAST DB, so only aligned subjects are kept
+    subject_taxids = load_keyed_column(
+        args.taxids, SUBJECT_FIELD, TAXID_FIELD, subjects, "taxid", metrics
+    )
+    rep_taxids = load_keyed_column(
+        args.hits, SEQ_ID_FIELD, args.taxid_field, rep_ids, "hits", metrics
+    )
+    thresholds = {
+        "perc_id": args.perc_id,
+        "qcov": args.qcov,
+        "max_rank": args.max_rank,
+        "min_frac": args.min_frac,
+    }
+    rows, escalated, decisions = triage_representatives(
+        records, alignments, subject_taxids, rep_taxids, child_to_parent, thresholds
+    )
+    with open_by_suffix(args.resolved, "w", metrics) as f:
+        write_lines(f, ["\t".join(BLAST_HEADER), *rows])
+    with open_by_suffix(args.decisions, "w", metrics) as f:
+        write_lines(f, ["\t".join(DECISIONS_HEADER), *decisions])
+    if escalated:
+        with open_by_suffix(args.escalated, "w", metrics) as f:
+            write_lines(f, (f">{h}\n{s}" for h, s in escalated))
+    logger.info(
+        f"Resolved {len(records) - len(escalated)} of {len(records)} "
+        f"representatives with minimap2; escalating {len(escalated)} to blastn."
+    )
+
+
+# =======================================================================
+# Main function
+# =======================================================================
+
+
+def main() -> None:
+    logger.info("Initializing script.")
+    start_time = time.time()
+    # Parse arguments
+    logger.info("Parsing arguments.")
+    args = parse_args()
+    logger.info(f"Arguments: {args}")
+    with TaskMetrics("triage_validation_hits") as metrics:
+        triage_validation_hits(args, metrics)
+    # Log completion
+    logger.info("Script completed successfully.")
+    end_time = time.time()
+    logger.info(f"Total time elapsed: {end_time - start_time} seconds")
+
+
+if __name__ == "__main__":
+    main()
@@ -1,8 +1,8 @@
 // Unleave an interleaved FASTQ file and save paired output files
-// TODO: Implement streamed version
+// Tool source: rust-tools/fastqkit/
 process UNLEAVE_FASTQ {
     label "small"
-    label "BBTools"
+    label "rust_tools"
     label "testing_only" // Process is currently only used for testing
     tag "id=${sample}"
     input:
@@ -11,10 +11,9 @@ process UNLEAVE_FASTQ {
         tuple val(sample), path("${sample}_unleaved_{1,2}.fastq.gz"), emit: output
         tuple val(sample), path("input_${reads_interleaved}"), emit: input
     script:
-        def par = "t=${task.cpus} -Xmx${task.memory.toGiga()}g"
-        def io = "in=${reads_interleaved} out=${sample}_unleaved_1.fastq.gz out2=${sample}_unleaved_2.fastq.gz"
+        def io = "-i ${reads_interleaved} -1 ${sample}_unleaved_1.fastq.gz -2 ${sample}_unleaved_2.fastq.gz"
         """
-        reformat.sh ${io} ${par}
+        fastqkit deinterleave ${io} -t ${task.cpus}
         ln -s ${reads_interleaved} input_${reads_interleaved} # Link input to output for testing
         """
 }
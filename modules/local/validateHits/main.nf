@@ -0,0 +1,47 @@
+/*
+Given a group's viral hits TSV, clustering TSV and BLAST LCA TSV for its
+cluster representatives, compute the taxonomic distance between each
+representative's original and LCA taxids, then annotate every hit with its
+cluster information and its representative's validation results. Holds the
+cluster and LCA tables in memory and streams the hits TSV, so the output keeps
+the hits' row order.
+
+The input map distance_params should specify the following fields:
+- taxid_field_1: Column header for original taxid in hits TSV
+- taxid_field_2: Column header for validated taxid in LCA TSV
+- distance_field_1: Column header for original taxid distance
+- distance_field_2: Column header for validated taxid distance
+
+The input map partition_params is empty for no partitioned output, or
+specifies the following fields:
+- field: Column to partition hits on (may be one of drop_fields)
+- stats_fields: Comma-separated columns to record per-partition min/max for
+*/
+
+process VALIDATE_HITS {
+    label "python"
+    label "single"
+    tag "id=${sample}"
+    input:
+        tuple val(sample), path(hits_tsv), path(cluster_tsv), path(lca_tsv)
+        path(nodes_db) // TSV containing taxonomic structure (mapping taxids to parent taxids)
+        val(distance_params) // Map specifying input taxid fields and output distance fields
+        val(drop_fields) // Comma-separated list of fields to drop from the output
+        val(index_key) // Column to index BGZF output on, for hits sorted by it (empty for plain gzip)
+        val(partition_params) // Map specifying partition and manifest stats fields (empty for no partitioned output)
+    output:
+        tuple val(sample), path("${sample}_validation_hits.tsv.gz"), emit: output
+        tuple val(sample), path("${sample}_validation_hits.tsv.gz.idx"), emit: index, optional: true
+        tuple val(sample), path("${sample}_validation_hits_by_species"), emit: partitioned, optional: true
+        tuple val(sample), path("input_${hits_tsv}"), emit: input
+    script:
+        def io = "--hits ${hits_tsv} --clusters ${cluster_tsv} --lca ${lca_tsv} -n ${nodes_db} -o ${sample}_validation_hits.tsv.gz"
+        def par = "-t1 ${distance_params.taxid_field_1} -t2 ${distance_params.taxid_field_2} -d1 ${distance_params.distance_field_1} -d2 ${distance_params.distance_field_2}"
+        def index_par = index_key ? "--index-key ${index_key}" : ""
+        def partition_par = partition_params ? "--partition-dir ${sample}_validation_hits_by_species --partition-field ${partition_params.field} --stats-fields \"${partition_params.stats_fields}\"" : ""
+        """
+        validate_hits.py ${io} ${par} --drop-fields "${drop_fields}" ${index_par} ${partition_par}
+        # Link input file to output for testing
+        ln -s ${hits_tsv} input_${hits_tsv}
+        """
+}
@@ -0,0 +1,322 @@
+#!/usr/bin/env python
+
+import gzip
+import importlib.util
+from pathlib import Path
+from types import ModuleType
+from typing import Any
+
+import pytest
+from compute_taxid_distance import parse_nodes_db
+from nao_io import lookup_indexed
+from validate_hits import PartitionWriter, validate_hits
+
+MODULES_DIR = Path(__file__).resolve().parents[4]
+
+NODES = (
+    "1\t|\t1\n"
+    "9000\t|\t1\n"
+    "9001\t|\t9000\n"
+    "9003\t|\t9000\n"
+    "9004\t|\t9003\n"
+    "9005\t|\t9004\n"
+    "9008\t|\t9001\n"
+    "9009\t|\t9008\n"
+    "8000\t|\t1\n"
+    "8001\t|\t8000\n"
+)
+HITS = (
+    "seq_id\ttaxid\textra\tselected_taxid\n"
+    "H1\t9005\ta\t9005\n"
+    "H2\t9008\tb\t9008\n"
+    "R1\t9001\tc\t9001\n"
+    "R2\t9004\td\t9004\n"
+    "R3\t8001\te\t8001\n"
+    "R4\tNA\tf\tNA\n"
+)
+CLUSTERS = (
+    "seq_id\tvsearch_cluster_id\tvsearch_cluster_rep_id\tgroup_species\n"
+    "R2\t1\tR2\tg_9004\n"
+    "H1\t1\tR2\tg_9004\n"
+    "R1\t0\tR1\tg_9001\n"
+    "H2\t0\tR1\tg_9001\n"
+    "R3\t2\tR3\tg_8001\n"
+    "R4\t3\tR4\tg_NA\n"
+)
+LCA = (
+    "qseqid\tlca_taxid\tn_assignments\n"
+    "R1\t9009\t2\n"
+    "R2\t9000\t5\n"
+    "R4\t9000\t1\n"
+    "X9\t9000\t1\n"
+)
+PARTITION_HITS = (
+    "seq_id\ttaxid\textra\tselected_taxid\tprim_align_dup_exemplar\tscore\n"
+    "H1\t9005\ta\t9004\tR2\t2\n"
+    "H2\t9008\tb\t9001\tH2\t10\n"
+    "R1\t9001\tc\t9001\tR1\t9.5\n"
+    "R2\t9004\td\t9004\tR2\tNA\n"
+    "R3\t8001\te\t8001\tR3\tx\n"
+    "R4\tNA\tf\tNA\tR4\t3\n"
+)
+FIELDS = {
+    "taxid_1": "taxid",
+    "taxid_2": "lca_taxid",
+    "distance_1": "dist_1",
+    "distance_2": "dist_2",
+}
+
+
+def load_module_script(module: str, script: str) -> ModuleType:
+    """Import a script from another module's resources."""
+    path = MODULES_DIR / module / "resources/usr/bin" / f"{script}.py"
+    spec = importlib.util.spec_from_file_location(f"_{script}", path)
+    assert spec is not None and spec.loader is not None
+    result = importlib.util.module_from_spec(spec)
+    spec.loader.exec_module(result)
+    return result
+
+
+def sort_by(tsv_factory: Any, path: str, field: str, name: str) -> str:
+    """Sort a TSV's body lines by one field."""
+    lines = tsv_factory.read_gzip(path).splitlines()
+    index = lines[0].split("\t").index(field)
+    body = sorted(lines[1:], key=lambda line: line.split("\t")[index])
+    return str(tsv_factory.create_plain(name, "\n".join([lines[0], *body]) + "\n"))
+
+
+def rehead(tsv_factory: Any, path: str, old: str, new: str, name: str) -> str:
+    """Rename one field of a TSV header."""
+    if path.endswith(".gz"):
+        text = tsv_factory.read_gzip(path)
+    else:
+        text = Path(path).read_text()
+    header, _, body = text.partition("\n")
+    header = "\t".join(new if f == old else f for f in header.split("\t"))
+    return str(tsv_factory.create_plain(name, header + "\n" + body))
+
+
+def chained_output(tsv_factory: Any, hits: str, clusters: str, lca: str) -> str:
+    """Run the original multi-process validation chain on the test inputs."""
+    join = load_module_script("joinTsvs", "join_tsvs").join_tsvs
+    select = load_module_script("selectTsvColumns", "select_tsv_columns")
+    distance = load_module_script("computeTaxidDistance", "compute_taxid_distance")
+    path = tsv_factory.get_path
+    # Validate cluster representatives
+    select.select_columns(hits, path("sel.tsv"), ["seq_id", "taxid"], "keep")
+    lca_seq = rehead(tsv_factory, lca, "qseqid", "seq_id", "lca_seq.tsv")
+    join(path("sel.tsv"), lca_seq, "seq_id", "inner", path("reps.tsv.gz"))
+    child_to_parent, _ = parse_nodes_db(path("nodes.dmp"))
+    distance.process_input_to_output(
+        path("reps.tsv.gz"), path("dist.tsv.gz"), FIELDS, child_to_parent
+    )
+    validation = rehead(
+        tsv_factory,
+        path("dist.tsv.gz"),
+        "seq_id",
+        "vsearch_cluster_rep_id",
+        "validation.tsv",
+    )
+    # Propagate validation information to all hits
+    select.select_columns(validation, path("drop.tsv"), ["taxid"], "drop")
+    rep_field = "vsearch_cluster_rep_id"
+    for src, name in [(clusters, "cl.tsv.gz"), (path("drop.tsv"), "val.tsv.gz")]:
+        tsv_factory.create_gzip(name, Path(src).read_text())
+    sorted_cl = sort_by(tsv_factory, path("cl.tsv.gz"), rep_field, "cl_s.tsv")
+    sorted_val = sort_by(tsv_factory, path("val.tsv.gz"), rep_field, "val_s.tsv")
+    join(sorted_cl, sorted_val, rep_field, "left", path("left.tsv.gz"))
+    sorted_left = sort_by(tsv_factory, path("left.tsv.gz"), "seq_id", "left_s.tsv")
+    select.select_columns(sorted_left, path("left_d.tsv"), ["group"], "drop")
+    join(hits, path("left_d.tsv"), "seq_id", "strict", path("strict.tsv.gz"))
+    select.select_columns(
+        path("strict.tsv.gz"),
+        path("chained.tsv.gz"),
+        ["taxid_species", "selected_taxid"],
+        "drop",
+    )
+    return str(tsv_factory.read_gzip(path("chained.tsv.gz")))
+
+
+class TestValidateHits:
+    @pytest.fixture
+    def inputs(self, tsv_factory: Any) -> tuple[str, str, str, dict[int, int]]:
+        tsv_factory.create_plain("nodes.dmp", NODES)
+        child_to_parent, _ = parse_nodes_db(tsv_factory.get_path("nodes.dmp"))
+        return (
+            tsv_factory.create_plain("hits.tsv", HITS),
+            tsv_factory.create_plain("clusters.tsv", CLUSTERS),
+            tsv_factory.create_plain("lca.tsv", LCA),
+            child_to_parent,
+        )
+
+    def run(self, tsv_factory: Any, inputs: tuple, drop: list[str]) -> list[str]:
+        hits, clusters, lca, child_to_parent = inputs
+        output = tsv_factory.get_path("out.tsv.gz")
+        validate_hits(hits, clusters, lca, output, FIELDS, drop, child_to_parent)
+        return list(tsv_factory.read_gzip(output).splitlines())
+
+    def test_annotates_hits_in_input_order(
+        self, tsv_factory: Any, inputs: tuple
+    ) -> None:
+        lines = self.run(tsv_factory, inputs, ["selected_taxid", "taxid_species"])
+        assert lines == [
+            "seq_id\ttaxid\textra\tvsearch_cluster_id\tvsearch_cluster_rep_id\t"
+            "group_species\tlca_taxid\tn_assignments\tdist_1\tdist_2",
+            "H1\t9005\ta\t1\tR2\tg_9004\t9000\t5\t2\t0",
+            "H2\t9008\tb\t0\tR1\tg_9001\t9009\t2\t0\t2",
+            "R1\t9001\tc\t0\tR1\tg_9001\t9009\t2\t0\t2",
+            "R2\t9004\td\t1\tR2\tg_9004\t9000\t5\t2\t0",
+            "R3\t8001\te\t2\tR3\tg_8001\tNA\tNA\tNA\tNA",
+            "R4\tNA\tf\t3\tR4\tg_NA\t9000\t1\tNA\tNA",
+        ]
+
+    def test_matches_chained_processes(self, tsv_factory: Any, inputs: tuple) -> None:
+        hits, clusters, lca, _ = inputs
+        lines = self.run(tsv_factory, inputs, ["taxid_species", "selected_taxid"])
+        expected = chained_output(tsv_factory, hits, clusters, lca)
+        assert lines == expected.splitlines()
+
+    def test_indexed_output(self, tsv_factory: Any, inputs: tuple) -> None:
+        hits, clusters, lca, child_to_parent = inputs
+        output = tsv_factory.get_path("indexed.tsv.gz")
+        validate_hits(
+            hits, clusters, lca, output, FIELDS, [], child_to_parent, index_key="seq_id"
+        )
+        lines = self.run(tsv_factory, inputs, [])
+        assert tsv_factory.read_gzip(output).splitlines() == lines
+        header, rows = lookup_indexed(output, ["R2", "H1"])
+        assert header == lines[0].split("\t")
+        assert rows == [lines[1], lines[4]]
+
+    def test_header_only_hits(self, tsv_factory: Any, inputs: tuple) -> None:
+        _, clusters, lca, child_to_parent = inputs
+        hits = tsv_factory.create_plain("empty.tsv", HITS.split("\n")[0] + "\n")
+        clusters = tsv_factory.create_plain("cl.tsv", CLUSTERS.split("\n")[0] + "\n")
+        output = tsv_factory.get_path("out.tsv.gz")
+        validate_hits(hits, clusters, lca, output, FIELDS, [], child_to_parent)
+        assert len(tsv_factory.read_gzip(output).splitlines()) == 1
+
+    def test_hit_missing_from_clusters(self, tsv_factory: Any, inputs: tuple) -> None:
+        hits, _, lca, child_to_parent = inputs
+        clusters = tsv_factory.create_plain("cl.tsv", CLUSTERS.replace("R3\t2", "X\t2"))
+        output = tsv_factory.get_path("out.tsv.gz")
+        with pytest.raises(ValueError, match="R3 missing from cluster TSV"):
+            validate_hits(hits, clusters, lca, output, FIELDS, [], child_to_parent)
+
+    def test_cluster_id_missing_from_hits(
+        self, tsv_factory: Any, inputs: tuple
+    ) -> None:
+        hits, clusters, lca, child_to_parent = inputs
+        clusters = tsv_factory.create_plain("cl.tsv", CLUSTERS + "Z1\t4\tZ1\tg\n")
+        output = tsv_factory.get_path("out.tsv.gz")
+        with pytest.raises(ValueError, match="missing from hits TSV"):
+            validate_hits(hits, clusters, lca, output, FIELDS, [], child_to_parent)
+
+    def test_duplicate_cluster_id(self, tsv_factory: Any, inputs: tuple) -> None:
+        hits, _, lca, child_to_parent = inputs
+        clusters = tsv_factory.create_plain("cl.tsv", CLUSTERS + "R4\t3\tR4\tg\n")
+        output = tsv_factory.get_path("out.tsv.gz")
+        with pytest.raises(ValueError, match="Duplicate seq_id in cluster TSV"):
+            validate_hits(hits, clusters, lca, output, FIELDS, [], child_to_parent)
+
+    def test_duplicate_field_across_inputs(
+        self, tsv_factory: Any, inputs: tuple
+    ) -> None:
+        hits, clusters, _, child_to_parent = inputs
+        lca = tsv_factory.create_plain(
+            "lca2.tsv", LCA.replace("n_assignments", "extra")
+        )
+        output = tsv_factory.get_path("out.tsv.gz")
+        with pytest.raises(ValueError, match="Duplicate field name"):
+            validate_hits(hits, clusters, lca, output, FIELDS, [], child_to_parent)
+
+
+class TestPartitionedOutput:
+    @pytest.fixture
+    def partitioned(self, tsv_factory: Any) -> tuple[list[str], Path]:
+        tsv_factory.create_plain("nodes.dmp", NODES)
+        child_to_parent, _ = parse_nodes_db(tsv_factory.get_path("nodes.dmp"))
+        hits = tsv_factory.create_plain("hits.tsv", PARTITION_HITS)
+        clusters = tsv_factory.create_plain("clusters.tsv", CLUSTERS)
+        lca = tsv_factory.create_plain("lca.tsv", LCA)
+        output = tsv_factory.get_path("out.tsv.gz")
+        directory = tsv_factory.get_path("by_species")
+        validate_hits(
+            hits,
+            clusters,
+            lca,
+            output,
+            FIELDS,
+            ["selected_taxid"],
+            child_to_parent,
+            partition_dir=directory,
+            stats_fields=["score", "extra", "absent"],
+        )
+        return list(tsv_factory.read_gzip(output).splitlines()), Path(directory)
+
+    def test_partitions_hold_output_rows(
+        self, tsv_factory: Any, partitioned: tuple
+    ) -> None:
+        lines, directory = partitioned
+        partitions = {
+            "9004": ["H1", "R2"],
+            "9001": ["H2", "R1"],
+            "8001": ["R3"],
+            "NA": ["R4"],
+        }
+        by_id = {line.split("\t")[0]: line for line in lines[1:]}
+        for value, ids in partitions.items():
+            path = directory / f"selected_taxid={value}" / "hits.tsv.gz"
+            assert tsv_factory.read_gzip(str(path)).splitlines() == [
+                lines[0],
+                *[by_id[i] for i in ids],
+            ]
+
+    def test_manifest(self, partitioned: tuple) -> None:
+        _, directory = partitioned
+        manifest = (directory / "manifest.tsv").read_text().splitlines()
+        assert manifest == [
+            "selected_taxid\tpath\tn_rows\tn_dup_exemplars\t"
+            "score_min\tscore_max\textra_min\textra_max",
+            "8001\tselected_taxid=8001/hits.tsv.gz\t1\t1\tx\tx\te\te",
+            "9001\tselected_taxid=9001/hits.tsv.gz\t2\t2\t9.5\t10\tb\tc",
+            "9004\tselected_taxid=9004/hits.tsv.gz\t2\t1\t2\t2\ta\td",
+            "NA\tselected_taxid=NA/hits.tsv.gz\t1\t1\t3\t3\tf\tf",
+        ]
+
+    def test_flushes_append_members(self, tsv_factory: Any) -> None:
+        directory = tsv_factory.get_path("parts")
+        writer = PartitionWriter(directory, "k", ["id", "v"], ["v"], buffer_bytes=8)
+        rows = [(str(i % 3), [f"r{i}", str(i)]) for i in range(20)]
+        for value, values in rows:
+            writer.add(value, values, "\t".join(values))
+        writer.close()
+        for key in "012":
+            text = tsv_factory.read_gzip(f"{directory}/k={key}/hits.tsv.gz")
+            expected = ["\t".join(v) for k, v in rows if k == key]
+            assert text.splitlines() == ["id\tv", *expected]
+        manifest = Path(directory, "manifest.tsv").read_text().splitlines()
+        assert manifest[1] == "0\tk=0/hits.tsv.gz\t7\t0\t18"
+
+    def test_invalid_partition_value(self, tsv_factory: Any) -> None:
+        writer = PartitionWriter(tsv_factory.get_path("parts"), "k", ["id"], [])
+        with pytest.raises(ValueError, match="Invalid k for partitioning"):
+            writer.add("../x", ["a"], "a")
+
+
+def test_taxonomy_copy_identical() -> None:
+    source = MODULES_DIR / "computeTaxidDistance/resources/usr/bin"
+    copy = (Path(__file__).parent / "compute_taxid_distance.py").read_bytes()
+    assert copy == (source / "compute_taxid_distance.py").read_bytes()
+
+
+def test_gzip_output(tsv_factory: Any) -> None:
+    tsv_factory.create_plain("nodes.dmp", NODES)
+    child_to_parent, _ = parse_nodes_db(tsv_factory.get_path("nodes.dmp"))
+    hits = tsv_factory.create_gzip("hits.tsv.gz", HITS)
+    clusters = tsv_factory.create_gzip("clusters.tsv.gz", CLUSTERS)
+    lca = tsv_factory.create_gzip("lca.tsv.gz", LCA)
+    output = tsv_factory.get_path("out.tsv.gz")
+    validate_hits(hits, clusters, lca, output, FIELDS, [], child_to_parent)
+    with gzip.open(output, "rt") as f:
+        assert sum(1 for _ in f) == 7
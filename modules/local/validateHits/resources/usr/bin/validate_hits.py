@@ -0,0 +1,679 @@
+#!/usr/bin/env python
+
+DESC = """
+Given a group's viral hits TSV, its clustering TSV and the BLAST LCA TSV for
+its cluster representatives, annotate every hit with its cluster information
+and the validation results of its cluster representative. Produces the same
+table as validating representatives (inner join with the LCA TSV plus
+taxonomic distances) and then propagating to all hits (left join onto the
+clusters, strict join onto the hits), but holds the small cluster and LCA
+tables in memory and streams the hits once, in input order. Optionally also
+writes the annotated hits partitioned by species (one gzipped TSV per
+selected_taxid under <dir>/selected_taxid=<value>/) with a manifest of row
+counts and per-partition min/max values of chosen columns, so downstream
+queries can skip whole species without decompressing them.
+"""
+
+# =======================================================================
+# Import libraries
+# =======================================================================
+
+import argparse
+import logging
+import os
+import re
+import time
+from collections.abc import Iterator
+from dataclasses import dataclass, field
+from datetime import UTC, datetime
+
+from compute_taxid_distance import (
+    compute_taxonomic_distance,
+    parse_nodes_db,
+    parse_taxid,
+)
+from nao_io import TaskMetrics, iter_lines, open_by_suffix, write_lines
+
+# =======================================================================
+# Configure logging
+# =======================================================================
+
+
+class UTCFormatter(logging.Formatter):
+    def formatTime(self, record: logging.LogRecord, datefmt: str | None = None) -> str:
+        dt = datetime.fromtimestamp(record.created, UTC)
+        return dt.strftime("%Y-%m-%d %H:%M:%S UTC")
+
+
+logging.basicConfig(level=logging.INFO)
+logger = logging.getLogger()
+handler = logging.StreamHandler()
+formatter = UTCFormatter("[%(asctime)s] %(message)s")
+handler.setFormatter(formatter)
+logger.handlers.clear()
+logger.addHandler(handler)
+
+# =======================================================================
+# Define constants
+# =======================================================================
+
+SEQ_ID_FIELD = "seq_id"
+LCA_ID_FIELD = "qseqid"
+REP_ID_FIELD = "vsearch_cluster_rep_id"
+# Cluster TSV columns that are never carried over to the output
+CLUSTER_DROP_FIELDS = ["group"]
+PLACEHOLDER = "NA"
+# Partitioned output layout
+PARTITION_FILE = "hits.tsv.gz"
+MANIFEST_FILE = "manifest.tsv"
+DUP_EXEMPLAR_FIELD = "prim_align_dup_exemplar"
+PARTITION_VALUE_PATTERN = re.compile(r"^[A-Za-z0-9_.-]+$")
+# Buffered partition rows are flushed to disk once they exceed this size
+PARTITION_BUFFER_BYTES = 64 * 1024 * 1024
+
+# =======================================================================
+# I/O functions
+# =======================================================================
+
+
+def parse_args() -> argparse.Namespace:
+    """Parse command-line arguments."""
+    # Create parser
+    parser = argparse.ArgumentParser(description=DESC)
+    # Add arguments
+    parser.add_argument("--hits", required=True, help="Path to viral hits TSV.")
+    parser.add_argument(
+        "--clusters", required=True, help="Path to clustering TSV for the hits."
+    )
+    parser.add_argument(
+        "--lca", required=True, help="Path to LCA TSV for cluster representatives."
+    )
+    parser.add_argument("--output", "-o", required=True, help="Path to output TSV.")
+    parser.add_argument(
+        "--nodes-db", "-n", required=True, help="Path to taxonomy nodes DB."
+    )
+    parser.add_argument(
+        "--taxid-field-1", "-t1", help="Column header for taxid field in hits TSV."
+    )
+    parser.add_argument(
+        "--taxid-field-2", "-t2", help="Column header for taxid field in LCA TSV."
+    )
+    parser.add_argument(
+        "--distance-field-1",
+        "-d1",
+        help="Column header for output distance field for the hits taxid.",
+    )
+    parser.add_argument(
+        "--distance-field-2",
+        "-d2",
+        help="Column header for output distance field for the LCA taxid.",
+    )
+    parser.add_argument(
+        "--drop-fields",
+        default="",
+        help="Comma-separated list of fields to drop from the output, if present.",
+    )
+    parser.add_argument(
+        "--index-key",
+        help="Write BGZF output with an <output>.idx index on this column.",
+    )
+    parser.add_argument(
+        "--partition-dir",
+        help="Also write hits partitioned by --partition-field to this directory.",
+    )
+    parser.add_argument(
+        "--partition-field",
+        default="selected_taxid",
+        help="Field to partition hits on (default selected_taxid).",
+    )
+    parser.add_argument(
+        "--stats-fields",
+        default="",
+        help="Comma-separated fields to record partition min/max values for.",
+    )
+    # Return parsed arguments
+    return parser.parse_args()
+
+
+# =======================================================================
+# Table loading functions
+# =======================================================================
+
+
+def read_header(lines: Iterator[str], label: str) -> list[str]:
+    """Read the header line of a TSV, raising an error if the file is empty."""
+    header_line = next(lines, "")
+    if not header_line:
+        msg = f"{label} TSV is empty (no header)."
+        logger.error(msg)
+        raise ValueError(msg)
+    return header_line.split("\t")
+
+
+def get_index(header: list[str], field: str, label: str) -> int:
+    """Get the index of a field in a TSV header."""
+    try:
+        return header.index(field)
+    except ValueError as e:
+        msg = f"Field not found in {label} TSV header: {field}"
+        logger.error(msg)
+        raise ValueError(msg) from e
+
+
+def load_table(
+    path: str,
+    key_field: str,
+    drop_fields: list[str],
+    label: str,
+    metrics: TaskMetrics | None = None,
+) -> tuple[list[str], dict[str, list[str]]]:
+    """
+    Load a small TSV into a dictionary keyed on one column.
+    Args:
+        path (str): Path to TSV.
+        key_field (str): Column to key on; must have unique values.
+        drop_fields (list[str]): Columns to discard, if present.
+        label (str): Name of the table for log and error messages.
+        metrics (TaskMetrics | None): Optional metrics to record I/O in.
+    Returns:
+        tuple[list[str], dict[str, list[str]]]: Header of the retained non-key
+            columns, and a dictionary mapping each key to its retained values.
+    """
+    with open_by_suffix(path, "r", metrics) as f:
+        lines = iter_lines(f)
+        header = read_header(lines, label)
+        key_index = get_index(header, key_field, label)
+        keep = [
+            i
+            for i, field in enumerate(header)
+            if i != key_index and field not in drop_fields
+        ]
+        table: dict[str, list[str]] = {}
+        for line in lines:
+            if not line:
+                continue
+            fields = line.split("\t")
+            key = fields[key_index]
+            if key in table:
+                msg = f"Duplicate {key_field} in {label} TSV: {key}"
+                logger.error(msg)
+                raise ValueError(msg)
+            table[key] = [fields[i] for i in keep]
+    logger.info(f"Loaded {len(table)} rows from {label} TSV.")
+    return [header[i] for i in keep], table
+
+
+def load_representative_taxids(
+    path: str,
+    taxid_field: str,
+    rep_ids: set[str],
+    metrics: TaskMetrics | None = None,
+) -> dict[str, str]:
+    """
+    Scan the ID and taxid columns of the hits TSV for the given representatives.
+    Only the leading columns up to the rightmost of the two are split.
+    Args:
+        path (str): Path to hits TSV.
+        taxid_field (str): Column header for taxid field.
+        rep_ids (set[str]): Sequence IDs of validated cluster representatives.
+        metrics (TaskMetrics | None): Optional metrics to record I/O in.
+    Returns:
+        dict[str, str]: Mapping from representative ID to its taxid string.
+    """
+    taxids: dict[str, str] = {}
+    with open_by_suffix(path, "r", metrics) as f:
+        lines = iter_lines(f)
+        header = read_header(lines, "hits")
+        id_index = get_index(header, SEQ_ID_FIELD, "hits")
+        taxid_index = get_index(header, taxid_field, "hits")
+        max_split = max(id_index, taxid_index) + 1
+        for line in lines:
+            if not line:
+                continue
+            fields = line.split("\t", max_split)
+            if fields[id_index] in rep_ids:
+                taxids[fields[id_index]] = fields[taxid_index]
+    return taxids
+
+
+# =======================================================================
+# Partitioning functions
+# =======================================================================
+
+
+@dataclass
+class ColumnRange:
+    """
+    Running min/max of one column, ignoring NA and empty values. Values are
+    compared numerically while all of them parse as numbers, and as strings
+    otherwise; bounds are reported in their original text form.
+    """
+
+    numeric: bool = True
+    low: tuple[float, str] | None = None
+    high: tuple[float, str] | None = None
+    text_low: str | None = None
+    text_high: str | None = None
+
+    def update(self, value: str) -> None:
+        """Update the range with one value."""
+        if value in ("", PLACEHOLDER):
+            return
+        if self.text_low is None or value < self.text_low:
+            self.text_low = value
+        if self.text_high is None or value > self.text_high:
+            self.text_high = value
+        if not self.numeric:
+            return
+        try:
+            number = float(value)
+        except ValueError:
+            self.numeric = False
+            return
+        if self.low is None or number < self.low[0]:
+            self.low = (number, value)
+        if self.high is None or number > self.high[0]:
+            self.high = (number, value)
+
+    def bounds(self) -> tuple[str, str]:
+        """Return the (min, max) values, or NA if no values were seen."""
+        if self.text_low is None or self.text_high is None:
+            return PLACEHOLDER, PLACEHOLDER
+        if self.numeric and self.low is not None and self.high is not None:
+            return self.low[1], self.high[1]
+        return self.text_low, self.text_high
+
+
+@dataclass
+class Partition:
+    """Output state of one partition."""
+
+    path: str
+    ranges: list[ColumnRange]
+    n_rows: int = 0
+    n_exemplars: int = 0
+    n_written: int = 0
+    buffer: list[str] = field(default_factory=list)
+
+
+class PartitionWriter:
+    """
+    Write rows to one gzipped TSV per partition value, plus a manifest with each
+    partition's row count, duplicate-exemplar count and column ranges. Rows are
+    buffered in memory and appended to their partition files as new gzip
+    members, so only one partition file is open at a time.
+    """
+
+    def __init__(
+        self,
+        directory: str,
+        partition_field: str,
+        header: list[str],
+        stats_fields: list[str],
+        metrics: TaskMetrics | None = None,
+        buffer_bytes: int = PARTITION_BUFFER_BYTES,
+    ) -> None:
+        """
+        Args:
+            directory (str): Output directory; created if absent.
+            partition_field (str): Name of the partition field.
+            header (list[str]): Header of the rows passed to add().
+            stats_fields (list[str]): Fields to record min/max values for;
+                fields absent from the header are skipped with a warning.
+            metrics (TaskMetrics | None): Optional metrics to record I/O in.
+            buffer_bytes (int): Buffered row size above which to flush.
+        """
+        self.directory = directory
+        self.partition_field = partition_field
+        self.header = header
+        self.metrics = metrics
+        self.buffer_bytes = buffer_bytes
+        self.buffered = 0
+        self.partitions: dict[str, Partition] = {}
+        missing = [f for f in stats_fields if f not in header]
+        if missing:
+            logger.warning(f"Skipping stats fields absent from output: {missing}")
+        self.stats_fields = [f for f in stats_fields if f in header]
+        self.stats_indices = [header.index(f) for f in self.stats_fields]
+        self.exemplar_indices = (
+            (header.index(SEQ_ID_FIELD), header.index(DUP_EXEMPLAR_FIELD))
+            if SEQ_ID_FIELD in header and DUP_EXEMPLAR_FIELD in header
+            else None
+        )
+        os.makedirs(directory, exist_ok=True)
+
+    def get_partition(self, value: str) -> Partition:
+        """Get the state of a partition, creating it on first use."""
+        partition = self.partitions.get(value)
+        if partition is None:
+            if not PARTITION_VALUE_PATTERN.match(value):
+                msg = f"Invalid {self.partition_field} for partitioning: '{value}'"
+                logger.error(msg)
+                raise ValueError(msg)
+            subdir = f"{self.partition_field}={value}"
+            os.makedirs(os.path.join(self.directory, subdir), exist_ok=True)
+            partition = Partition(
+                path=f"{subdir}/{PARTITION_FILE}",
+                ranges=[ColumnRange() for _ in self.stats_indices],
+            )
+            self.partitions[value] = partition
+        return partition
+
+    def add(self, value: str, values: list[str], line: str) -> None:
+        """
+        Add one row to a partition.
+        Args:
+            value (str): Partition value of the row.
+            values (list[str]): Row values, matching the header.
+            line (str): Row values joined into a TSV line.
+        """
+        partition = self.get_partition(value)
+        partition.n_rows += 1
+        partition.buffer.append(line)
+        for column_range, index in zip(partition.ranges, self.stats_indices):
+            column_range.update(values[index])
+        if self.exemplar_indices is not None:
+            id_index, exemplar_index = self.exemplar_indices
+            if values[id_index] == values[exemplar_index]:
+                partition.n_exemplars += 1
+        self.buffered += len(line) + 1
+        if self.buffered > self.buffer_bytes:
+            self.flush()
+
+    def flush(self) -> None:
+        """Append all buffered rows to their partition files."""
+        for partition in self.partitions.values():
+            if not partition.buffer:
+                continue
+            path = os.path.join(self.directory, partition.path)
+            mode = "a" if partition.n_written else "w"
+            with open_by_suffix(path, mode, self.metrics) as f:
+                if not partition.n_written:
+                    write_lines(f, ["\t".join(self.header)])
+                partition.n_written += write_lines(f, partition.buffer)
+            partition.buffer = []
+        self.buffered = 0
+
+    def close(self) -> None:
+        """Flush buffered rows and write the manifest, sorted by partition."""
+        self.flush()
+        columns = [self.partition_field, "path", "n_rows"]
+        if self.exemplar_indices is not None:
+            columns.append("n_dup_exemplars")
+        for stats_field in self.stats_fields:
+            columns += [f"{stats_field}_min", f"{stats_field}_max"]
+        rows = []
+        for value in sorted(self.partitions, key=partition_sort_key):
+            partition = self.partitions[value]
+            row = [value, partition.path, str(partition.n_rows)]
+            if self.exemplar_indices is not None:
+                row.append(str(partition.n_exemplars))
+            for column_range in partition.ranges:
+                row += column_range.bounds()
+            rows.append("\t".join(row))
+        manifest_path = os.path.join(self.directory, MANIFEST_FILE)
+        with open_by_suffix(manifest_path, "w", self.metrics) as f:
+            write_lines(f, ["\t".join(columns), *rows])
+        logger.info(f"Wrote {len(rows)} partitions to {self.directory}.")
+
+
+def partition_sort_key(value: str) -> tuple[int, int, str]:
+    """Sort integer partition values numerically, before any others."""
+    return (0, int(value), "") if value.isdigit() else (1, 0, value)
+
+
+# =======================================================================
+# Validation functions
+# =======================================================================
+
+
+def validate_representatives(
+    lca_table: dict[str, list[str]],
+    lca_taxid_index: int,
+    rep_taxids: dict[str, str],
+    child_to_parent: dict[int, int],
+) -> dict[str, list[str]]:
+    """
+    Compute taxonomic distances between each representative's original and
+    LCA taxids. Representatives absent from the hits TSV are dropped.
+    Args:
+        lca_table (dict[str, list[str]]): LCA values keyed by representative ID.
+        lca_taxid_index (int): Index of the LCA taxid among the LCA values.
+        rep_taxids (dict[str, str]): Original taxid of each representative.
+        child_to_parent (dict[int, int]): Dictionary mapping taxids to parents.
+    Returns:
+        dict[str, list[str]]: Validation values (LCA values followed by the two
+            distances) keyed by representative ID.
+    """
+    path_cache: dict[int, list[int]] = {}
+    validation: dict[str, list[str]] = {}
+    for rep_id, values in lca_table.items():
+        if rep_id not in rep_taxids:
+            continue
+        distance_1, distance_2, path_cache = compute_taxonomic_distance(
+            parse_taxid(rep_taxids[rep_id]),
+            parse_taxid(values[lca_taxid_index]),
+            child_to_parent,
+            path_cache,
+        )
+        validation[rep_id] = values + [
+            str(distance_1) if distance_1 is not None else PLACEHOLDER,
+            str(distance_2) if distance_2 is not None else PLACEHOLDER,
+        ]
+    logger.info(f"Validated {len(validation)} cluster representatives.")
+    return validation
+
+
+def check_duplicate_fields(header: list[str]) -> None:
+    """Raise an error if a field name occurs more than once in a header."""
+    seen: set[str] = set()
+    for field in header:
+        if field in seen:
+            msg = f"Duplicate field name found across input files: '{field}'."
+            logger.error(msg)
+            raise ValueError(msg)
+        seen.add(field)
+
+
+def annotate_hits(
+    lines: Iterator[str],
+    id_index: int,
+    keep: list[int],
+    cluster_table: dict[str, list[str]],
+    rep_index: int,
+    validation: dict[str, list[str]],
+    n_validation_fields: int,
+    partitions: PartitionWriter | None = None,
+    partition_index: int = -1,
+) -> Iterator[str]:
+    """
+    Append cluster and validation values to each hit. Every hit must have a
+    cluster entry; hits whose representative was not validated get NA values.
+    Consumes entries from cluster_table as it goes.
+    Args:
+        lines (Iterator[str]): Hits TSV body lines.
+        id_index (int): Index of the sequence ID in the hits TSV.
+        keep (list[int]): Indices of the joined row to write.
+        cluster_table (dict[str, list[str]]): Cluster values keyed by seq_id.
+        rep_index (int): Index of the representative ID among cluster values.
+        validation (dict[str, list[str]]): Validation values keyed by rep ID.
+        n_validation_fields (int): Number of validation fields.
+        partitions (PartitionWriter | None): Optional writer to also pass each
+            output row to, keyed by its partition value.
+        partition_index (int): Index of the partition field in the joined row
+            (which may be a dropped field).
+    Yields:
+        str: Annotated output lines.
+    """
+    placeholder = [PLACEHOLDER] * n_validation_fields
+    for line in lines:
+        if not line:
+            continue
+        fields = line.split("\t")
+        seq_id = fields[id_index]
+        cluster_values = cluster_table.pop(seq_id, None)
+        if cluster_values is None:
+            msg = f"Hit {seq_id} missing from cluster TSV."
+            logger.error(msg)
+            raise ValueError(msg)
+        rep_values = validation.get(cluster_values[rep_index], placeholder)
+        row = fields + cluster_values + rep_values
+        values = [row[i] for i in keep]
+        line = "\t".join(values)
+        if partitions is not None:
+            partitions.add(row[partition_index], values, line)
+        yield line
+
+
+def validate_hits(
+    hits_path: str,
+    clusters_path: str,
+    lca_path: str,
+    output_path: str,
+    field_names: dict[str, str],
+    drop_fields: list[str],
+    child_to_parent: dict[int, int],
+    metrics: TaskMetrics | None = None,
+    index_key: str | None = None,
+    partition_dir: str | None = None,
+    partition_field: str = "selected_taxid",
+    stats_fields: list[str] | None = None,
+) -> None:
+    """
+    Annotate a hits TSV with cluster and representative validation information.
+    Args:
+        hits_path (str): Path to hits TSV.
+        clusters_path (str): Path to clustering TSV.
+        lca_path (str): Path to LCA TSV.
+        output_path (str): Path to output TSV.
+        field_names (dict[str, str]): Taxid and distance field names.
+        drop_fields (list[str]): Fields to drop from the output, if present.
+        child_to_parent (dict[int, int]): Dictionary mapping taxids to parents.
+        metrics (TaskMetrics | None): Optional metrics to record I/O in.
+        index_key (str | None): If given, write BGZF output indexed on this
+            column (hits must be sorted on it).
+        partition_dir (str | None): If given, also write the output partitioned
+            by partition_field to this directory, with a manifest.
+        partition_field (str): Field to partition on; may be a dropped field.
+        stats_fields (list[str] | None): Output fields to record per-partition
+            min/max values for in the manifest.
+    """
+    # Load small tables
+    cluster_header, cluster_table = load_table(
+        clusters_path, SEQ_ID_FIELD, CLUSTER_DROP_FIELDS, "cluster", metrics
+    )
+    rep_index = get_index(cluster_header, REP_ID_FIELD, "cluster")
+    lca_header, lca_table = load_table(lca_path, LCA_ID_FIELD, [], "LCA", metrics)
+    lca_taxid_index = get_index(lca_header, field_names["taxid_2"], "LCA")
+    # Validate representatives against their original taxids
+    rep_taxids = load_representative_taxids(
+        hits_path, field_names["taxid_1"], set(lca_table), metrics
+    )
+    validation = validate_representatives(
+        lca_table, lca_taxid_index, rep_taxids, child_to_parent
+    )
+    validation_header = lca_header + [
+        field_names["distance_1"],
+        field_names["distance_2"],
+    ]
+    # Stream hits to output
+    with (
+        open_by_suffix(hits_path, "r", metrics) as inf,
+        open_by_suffix(output_path, "w", metrics, index_key) as outf,
+    ):
+        lines = iter_lines(inf)
+        hits_header = read_header(lines, "hits")
+        id_index = get_index(hits_header, SEQ_ID_FIELD, "hits")
+        header = hits_header + cluster_header + validation_header
+        check_duplicate_fields(header)
+        keep = [i for i, field in enumerate(header) if field not in drop_fields]
+        output_header = [header[i] for i in keep]
+        write_lines(outf, ["\t".join(output_header)])
+        partitions = None
+        partition_index = -1
+        if partition_dir:
+            partition_index = get_index(header, partition_field, "joined")
+            partitions = PartitionWriter(
+                partition_dir,
+                partition_field,
+                output_header,
+                stats_fields or [],
+                metrics,
+            )
+        n_hits = write_lines(
+            outf,
+            annotate_hits(
+                lines,
+                id_index,
+                keep,
+                cluster_table,
+                rep_index,
+                validation,
+                len(validation_header),
+                partitions,
+                partition_index,
+            ),
+        )
+        if partitions is not None:
+            partitions.close()
+    if cluster_table:
+        missing = next(iter(cluster_table))
+        msg = (
+            f"Cluster TSV contains {len(cluster_table)} IDs missing from hits TSV "
+            f"(e.g. {missing})."
+        )
+        logger.error(msg)
+        raise ValueError(msg)
+    logger.info(f"Annotated {n_hits} hits.")
+
+
+# =======================================================================
+# Main function
+# =======================================================================
+
+
+def main() -> None:
+    logger.info("Initializing script.")
+    start_time = time.time()
+    # Parse arguments
+    logger.info("Parsing arguments.")
+    args = parse_args()
+    logger.info(f"Arguments: {args}")
+    fields = {
+        "taxid_1": args.taxid_field_1,
+        "taxid_2": args.taxid_field_2,
+        "distance_1": args.distance_field_1,
+        "distance_2": args.distance_field_2,
+    }
+    drop_fields = [f for f in args.drop_fields.split(",") if f]
+    with TaskMetrics("validate_hits") as metrics:
+        # Import taxonomy DB
+        logger.info("Parsing taxonomy DB.")
+        with metrics.phase("parse"):
+            child_to_parent, _ = parse_nodes_db(args.nodes_db)
+        logger.info(f"Parsed taxonomy information for {len(child_to_parent)} taxids.")
+        # Validate and annotate hits
+        logger.info("Validating cluster representatives and annotating hits.")
+        with metrics.phase("annotate"):
+            validate_hits(
+                args.hits,
+                args.clusters,
+                args.lca,
+                args.output,
+                fields,
+                drop_fields,
+                child_to_parent,
+                metrics,
+                args.index_key,
+                args.partition_dir,
+                args.partition_field,
+                [f for f in args.stats_fields.split(",") if f],
+            )
+    # Log completion
+    logger.info("Script completed successfully.")
+    end_time = time.time()
+    logger.info(f"Total time elapsed: {end_time - start_time} seconds")
+
+
+if __name__ == "__main__":
+    main()
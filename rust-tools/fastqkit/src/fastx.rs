@@ -0,0 +1,253 @@
+//! Minimal FASTQ/FASTA record reader and writers.
+//!
+//! The format is detected from the first byte of the input (`@` for FASTQ, `>` for FASTA);
+//! an empty input yields no records. FASTQ records are four lines; FASTA sequences may span
+//! multiple lines and are joined. Trailing `\r` characters and blank lines between records are
+//! tolerated. A record's ID is its header up to the first space or tab, as used by seqtk and
+//! seqkit.
+
+use std::error::Error;
+use std::io::{self, BufRead, Write};
+
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum Format {
+    Fastq,
+    Fasta,
+}
+
+#[derive(Debug, Default, Clone, PartialEq, Eq)]
+pub struct Record {
+    /// Header line without the leading `@`/`>`
+    pub header: Vec<u8>,
+    pub seq: Vec<u8>,
+    /// FASTQ `+` line without the leading `+` (empty for FASTA)
+    pub plus: Vec<u8>,
+    /// Quality string (empty for FASTA)
+    pub qual: Vec<u8>,
+}
+
+impl Record {
+    /// Record ID: the header up to the first space or tab.
+    pub fn id(&self) -> &[u8] {
+        id_of(&self.header)
+    }
+}
+
+/// Leading whitespace-delimited token of a header or ID-file line.
+pub fn id_of(line: &[u8]) -> &[u8] {
+    let end = line
+        .iter()
+        .position(|&b| b == b' ' || b == b'\t')
+        .unwrap_or(line.len());
+    &line[..end]
+}
+
+pub struct FastxReader {
+    inner: Box<dyn BufRead + Send>,
+    format: Option<Format>,
+    line: Vec<u8>,
+    line_num: u64,
+}
+
+fn read_line_trimmed(reader: &mut dyn BufRead, buf: &mut Vec<u8>) -> io::Result<bool> {
+    buf.clear();
+    if reader.read_until(b'\n', buf)? == 0 {
+        return Ok(false);
+    }
+    while buf.last().is_some_and(|&b| b == b'\n' || b == b'\r') {
+        buf.pop();
+    }
+    Ok(true)
+}
+
+impl FastxReader {
+    pub fn new(mut inner: Box<dyn BufRead + Send>) -> io::Result<Self> {
+        // Skip leading blank lines, then sniff the format
+        let format = loop {
+            let buf = inner.fill_buf()?;
+            match buf.first() {
+                None => break None,
+                Some(b'\n') | Some(b'\r') => inner.consume(1),
+                Some(b'@') => break Some(Format::Fastq),
+                Some(b'>') => break Some(Format::Fasta),
+                Some(_) => {
+                    return Err(io::Error::new(
+                        io::ErrorKind::InvalidData,
+                        "Input is neither FASTQ (@) nor FASTA (>)",
+                    ))
+                }
+            }
+        };
+        Ok(Self {
+            inner,
+            format,
+            line: Vec::new(),
+            line_num: 0,
+        })
+    }
+
+    /// Detected format, or None for an empty input.
+    pub fn format(&self) -> Option<Format> {
+        self.format
+    }
+
+    // Next non-blank line into self.line
+    fn next_line(&mut self) -> io::Result<bool> {
+        loop {
+            if !read_line_trimmed(self.inner.as_mut(), &mut self.line)? {
+                return Ok(false);
+            }
+            self.line_num += 1;
+            if !self.line.is_empty() {
+                return Ok(true);
+            }
+        }
+    }
+
+    fn malformed(&self, what: &str) -> Box<dyn Error> {
+        format!("{} record ending at line {}", what, self.line_num).into()
+    }
+
+    /// Read the next record into `record`, returning false at end of input.
+    pub fn read(&mut self, record: &mut Record) -> Result<bool, Box<dyn Error>> {
+        match self.format {
+            None => Ok(false),
+            Some(Format::Fastq) => self.read_fastq(record),
+            Some(Format::Fasta) => self.read_fasta(record),
+        }
+    }
+
+    fn read_fastq(&mut self, record: &mut Record) -> Result<bool, Box<dyn Error>> {
+        if !self.next_line()? {
+            return Ok(false);
+        }
+        if self.line[0] != b'@' {
+            return Err(self.malformed("Malformed FASTQ"));
+        }
+        record.header.clear();
+        record.header.extend_from_slice(&self.line[1..]);
+        let inner = self.inner.as_mut();
+        let complete = read_line_trimmed(inner, &mut record.seq)?
+            && read_line_trimmed(inner, &mut record.plus)?
+            && read_line_trimmed(inner, &mut record.qual)?;
+        self.line_num += 3;
+        if !complete {
+            return Err(self.malformed("Truncated FASTQ"));
+        }
+        if record.plus.first() != Some(&b'+') || record.seq.len() != record.qual.len() {
+            return Err(self.malformed("Malformed FASTQ"));
+        }
+        record.plus.remove(0);
+        Ok(true)
+    }
+
+    fn read_fasta(&mut self, record: &mut Record) -> Result<bool, Box<dyn Error>> {
+        // The header line is consumed by the previous call's lookahead, except for the first
+        if self.line.first() != Some(&b'>') && !self.next_line()? {
+            return Ok(false);
+        }
+        if self.line.first() != Some(&b'>') {
+            return Err(self.malformed("Malformed FASTA"));
+        }
+        record.header.clear();
+        record.header.extend_from_slice(&self.line[1..]);
+        record.seq.clear();
+        record.plus.clear();
+        record.qual.clear();
+        self.line.clear();
+        while self.next_line()? {
+            if self.line[0] == b'>' {
+                return Ok(true);
+            }
+            record.seq.extend_from_slice(&self.line);
+        }
+        self.line.clear();
+        Ok(true)
+    }
+}
+
+/// Write a record in its input format.
+pub fn write_record(out: &mut dyn Write, record: &Record, format: Format) -> io::Result<()> {
+    match format {
+        Format::Fastq => write_fastq(out, record),
+        Format::Fasta => write_fasta(out, record),
+    }
+}
+
+pub fn write_fastq(out: &mut dyn Write, record: &Record) -> io::Result<()> {
+    out.write_all(b"@")?;
+    out.write_all(&record.header)?;
+    out.write_all(b"\n")?;
+    out.write_all(&record.seq)?;
+    out.write_all(b"\n+")?;
+    out.write_all(&record.plus)?;
+    out.write_all(b"\n")?;
+    out.write_all(&record.qual)?;
+    out.write_all(b"\n")
+}
+
+/// Write a record as single-line FASTA (as `seqtk seq -a`).
+pub fn write_fasta(out: &mut dyn Write, record: &Record) -> io::Result<()> {
+    out.write_all(b">")?;
+    out.write_all(&record.header)?;
+    out.write_all(b"\n")?;
+    out.write_all(&record.seq)?;
+    out.write_all(b"\n")
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn reader(data: &'static str) -> FastxReader {
+        FastxReader::new(Box::new(data.as_bytes())).unwrap()
+    }
+
+    fn read_all(mut r: FastxReader) -> Vec<Record> {
+        let mut out = Vec::new();
+        let mut record = Record::default();
+        while r.read(&mut record).unwrap() {
+            out.push(record.clone());
+        }
+        out
+    }
+
+    #[test]
+    fn test_fastq() {
+        let records = read_all(reader("@r1 c\r\nACGT\r\n+\r\nIIII\r\n\n@r2\nA\n+r2\nI\n"));
+        assert_eq!(records.len(), 2);
+        assert_eq!(records[0].id(), b"r1");
+        assert_eq!(records[0].header, b"r1 c");
+        assert_eq!(records[1].plus, b"r2");
+    }
+
+    #[test]
+    fn test_multiline_fasta() {
+        let records = read_all(reader(">a x\nAC\nGT\n>b\n\nTT\n"));
+        assert_eq!(records.len(), 2);
+        assert_eq!(records[0].seq, b"ACGT");
+        assert_eq!(records[1].id(), b"b");
+        assert_eq!(records[1].seq, b"TT");
+    }
+
+    #[test]
+    fn test_empty_and_blank_inputs() {
+        assert_eq!(reader("").format(), None);
+        assert!(read_all(reader("\n\n")).is_empty());
+    }
+
+    #[test]
+    fn test_truncated_and_invalid() {
+        let mut r = reader("@r1\nACGT\n+\n");
+        assert!(r.read(&mut Record::default()).is_err());
+        assert!(FastxReader::new(Box::new(&b"ACGT\n"[..])).is_err());
+        let mut r = reader("@r1\nACGT\n+\nII\n");
+        assert!(r.read(&mut Record::default()).is_err());
+    }
+
+    #[test]
+    fn test_id_of_tab() {
+        assert_eq!(id_of(b"read\t1:N"), b"read");
+        assert_eq!(id_of(b"read"), b"read");
+    }
+}
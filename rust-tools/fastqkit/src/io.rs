@@ -0,0 +1,550 @@
+//! Parallel compressed I/O shared by all subcommands.
+//!
+//! Outputs ending in `.gz` are written as BGZF: the stream is cut into blocks of at most
+//! `BGZF_BLOCK_SIZE` bytes, batches of blocks are deflated on worker threads, and a writer
+//! thread emits them in order followed by the standard BGZF EOF block. BGZF is a valid
+//! multi-member gzip stream, so outputs stay readable by zcat/gzip/pigz and are also
+//! bgzip/htslib-compatible. Empty outputs are a lone EOF block, i.e. a valid empty gzip file.
+//!
+//! Inputs are decompressed on a dedicated thread so that inflating overlaps with parsing. BGZF
+//! inputs (e.g. the outputs of other fastqkit calls) are additionally inflated block-parallel;
+//! plain gzip inputs are inherently sequential and use a single decoder.
+//!
+//! Inputs and outputs count their decompressed and uncompressed data in the task metrics.
+
+use std::collections::BTreeMap;
+use std::fs::File;
+use std::io::{self, BufRead, BufReader, BufWriter, Read, Write};
+use std::sync::mpsc::{sync_channel, Receiver, SyncSender};
+use std::sync::{Arc, Mutex};
+use std::thread::{self, JoinHandle};
+
+use flate2::read::{DeflateDecoder, MultiGzDecoder};
+use flate2::write::DeflateEncoder;
+use flate2::{Compression, Crc};
+use task_metrics::{CountingWriter, TaskMetrics};
+
+// Same uncompressed block size as htslib, leaving headroom for incompressible data
+const BGZF_BLOCK_SIZE: usize = 0xff00;
+const BLOCKS_PER_JOB: usize = 16;
+const READ_CHUNK_SIZE: usize = 1 << 20;
+const BGZF_HEADER_SIZE: usize = 18;
+const BGZF_EOF: [u8; 28] = [
+    0x1f, 0x8b, 0x08, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0x06, 0x00, 0x42, 0x43, 0x02, 0x00,
+    0x1b, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+];
+
+type Job = (usize, Vec<Vec<u8>>);
+
+fn worker_count(threads: usize) -> usize {
+    threads.max(1)
+}
+
+// ------------------------------------------------------------------------------------------------
+// OUTPUT
+// ------------------------------------------------------------------------------------------------
+
+/// Compress one BGZF block (header with BSIZE extra field, raw deflate data, CRC32, ISIZE).
+fn bgzf_block(data: &[u8], level: u32) -> io::Result<Vec<u8>> {
+    let mut encoder = DeflateEncoder::new(
+        Vec::with_capacity(data.len() / 2 + 64),
+        Compression::new(level),
+    );
+    encoder.write_all(data)?;
+    let deflated = encoder.finish()?;
+    let block_size = BGZF_HEADER_SIZE + deflated.len() + 8;
+    let bsize = u16::try_from(block_size - 1)
+        .map_err(|_| io::Error::new(io::ErrorKind::InvalidData, "BGZF block overflow"))?;
+    let mut block = Vec::with_capacity(block_size);
+    block.extend_from_slice(&[
+        0x1f, 0x8b, 0x08, 0x04, 0, 0, 0, 0, 0, 0xff, 6, 0, b'B', b'C', 2, 0,
+    ]);
+    block.extend_from_slice(&bsize.to_le_bytes());
+    block.extend_from_slice(&deflated);
+    let mut crc = Crc::new();
+    crc.update(data);
+    block.extend_from_slice(&crc.sum().to_le_bytes());
+    block.extend_from_slice(&(data.len() as u32).to_le_bytes());
+    Ok(block)
+}
+
+/// Parallel BGZF writer. Call `finish` to flush, join the worker threads and surface errors.
+pub struct BgzfWriter {
+    buf: Vec<u8>,
+    batch: Vec<Vec<u8>>,
+    next_job: usize,
+    jobs: Option<SyncSender<Job>>,
+    workers: Vec<JoinHandle<io::Result<()>>>,
+    writer: Option<JoinHandle<io::Result<()>>>,
+}
+
+impl BgzfWriter {
+    pub fn new(sink: Box<dyn Write + Send>, threads: usize, level: u32) -> Self {
+        let n = worker_count(threads);
+        let (job_tx, job_rx) = sync_channel::<Job>(n * 2);
+        let (done_tx, done_rx) = sync_channel::<(usize, Vec<u8>)>(n * 2);
+        let job_rx = Arc::new(Mutex::new(job_rx));
+        let workers = (0..n)
+            .map(|_| {
+                let job_rx = Arc::clone(&job_rx);
+                let done_tx = done_tx.clone();
+                thread::spawn(move || -> io::Result<()> {
+                    loop {
+                        let job = job_rx.lock().unwrap().recv();
+                        let Ok((index, blocks)) = job else {
+                            return Ok(());
+                        };
+                        let mut out = Vec::new();
+                        for block in &blocks {
+                            out.extend_from_slice(&bgzf_block(block, level)?);
+                        }
+                        if done_tx.send((index, out)).is_err() {
+                            return Ok(());
+                        }
+                    }
+                })
+            })
+            .collect();
+        drop(done_tx);
+        let writer = thread::spawn(move || write_in_order(done_rx, sink));
+        Self {
+            buf: Vec::with_capacity(BGZF_BLOCK_SIZE),
+            batch: Vec::with_capacity(BLOCKS_PER_JOB),
+            next_job: 0,
+            jobs: Some(job_tx),
+            workers,
+            writer: Some(writer),
+        }
+    }
+
+    fn send_batch(&mut self) -> io::Result<()> {
+        if self.batch.is_empty() {
+            return Ok(());
+        }
+        let blocks = std::mem::replace(&mut self.batch, Vec::with_capacity(BLOCKS_PER_JOB));
+        let sent = self
+            .jobs
+            .as_ref()
+            .map(|jobs| jobs.send((self.next_job, blocks)).is_ok())
+            .unwrap_or(false);
+        self.next_job += 1;
+        if sent {
+            Ok(())
+        } else {
+            // A worker or the writer has stopped; `finish` reports the underlying error
+            Err(io::Error::new(
+                io::ErrorKind::BrokenPipe,
+                "BGZF writer stopped",
+            ))
+        }
+    }
+
+    pub fn finish(mut self) -> io::Result<()> {
+        if !self.buf.is_empty() {
+            let block = std::mem::take(&mut self.buf);
+            self.batch.push(block);
+        }
+        let sent = self.send_batch();
+        self.jobs = None;
+        let mut result = Ok(());
+        for worker in self.workers.drain(..) {
+            let joined = worker.join().expect("BGZF worker panicked");
+            result = result.and(joined);
+        }
+        if let Some(writer) = self.writer.take() {
+            result = result.and(writer.join().expect("BGZF writer panicked"));
+        }
+        result.and(sent)
+    }
+}
+
+fn write_in_order(
+    receiver: Receiver<(usize, Vec<u8>)>,
+    sink: Box<dyn Write + Send>,
+) -> io::Result<()> {
+    let mut out = BufWriter::with_capacity(READ_CHUNK_SIZE, sink);
+    let mut pending: BTreeMap<usize, Vec<u8>> = BTreeMap::new();
+    let mut next = 0usize;
+    for (index, data) in receiver {
+        pending.insert(index, data);
+        while let Some(data) = pending.remove(&next) {
+            out.write_all(&data)?;
+            next += 1;
+        }
+    }
+    if !pending.is_empty() {
+        return Err(io::Error::other("BGZF compression job lost"));
+    }
+    out.write_all(&BGZF_EOF)?;
+    out.flush()
+}
+
+impl Write for BgzfWriter {
+    fn write(&mut self, data: &[u8]) -> io::Result<usize> {
+        let mut rest = data;
+        while !rest.is_empty() {
+            let take = (BGZF_BLOCK_SIZE - self.buf.len()).min(rest.len());
+            self.buf.extend_from_slice(&rest[..take]);
+            rest = &rest[take..];
+            if self.buf.len() == BGZF_BLOCK_SIZE {
+                let block = std::mem::replace(&mut self.buf, Vec::with_capacity(BGZF_BLOCK_SIZE));
+                self.batch.push(block);
+                if self.batch.len() == BLOCKS_PER_JOB {
+                    self.send_batch()?;
+                }
+            }
+        }
+        Ok(data.len())
+    }
+
+    fn flush(&mut self) -> io::Result<()> {
+        // Blocks are only emitted when full or on `finish`
+        Ok(())
+    }
+}
+
+/// A FASTQ/FASTA/text output: BGZF if the path ends in `.gz`, otherwise plain.
+pub enum Output {
+    Plain(BufWriter<CountingWriter<Box<dyn Write + Send>>>),
+    Bgzf(CountingWriter<BgzfWriter>),
+}
+
+impl Output {
+    /// Create an output at `path` ("-" for stdout).
+    pub fn create(
+        path: &str,
+        threads: usize,
+        level: u32,
+        metrics: &TaskMetrics,
+    ) -> io::Result<Self> {
+        let sink: Box<dyn Write + Send> = if path == "-" {
+            Box::new(io::stdout())
+        } else {
+            Box::new(File::create(path)?)
+        };
+        if path.ends_with(".gz") {
+            Ok(Output::Bgzf(
+                metrics.count_writer(path, BgzfWriter::new(sink, threads, level)),
+            ))
+        } else {
+            Ok(Output::Plain(BufWriter::with_capacity(
+                READ_CHUNK_SIZE,
+                metrics.count_writer(path, sink),
+            )))
+        }
+    }
+
+    pub fn finish(self) -> io::Result<()> {
+        match self {
+            Output::Plain(mut out) => out.flush(),
+            Output::Bgzf(out) => out.into_inner().finish(),
+        }
+    }
+}
+
+impl Write for Output {
+    fn write(&mut self, data: &[u8]) -> io::Result<usize> {
+        match self {
+            Output::Plain(out) => out.write(data),
+            Output::Bgzf(out) => out.write(data),
+        }
+    }
+
+    fn write_all(&mut self, data: &[u8]) -> io::Result<()> {
+        match self {
+            Output::Plain(out) => out.write_all(data),
+            Output::Bgzf(out) => out.write_all(data),
+        }
+    }
+
+    fn flush(&mut self) -> io::Result<()> {
+        match self {
+            Output::Plain(out) => out.flush(),
+            Output::Bgzf(out) => out.flush(),
+        }
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+// INPUT
+// ------------------------------------------------------------------------------------------------
+
+/// Reader over chunks produced by a background decompression thread.
+struct ChunkReader {
+    chunks: Receiver<io::Result<Vec<u8>>>,
+    current: Vec<u8>,
+    pos: usize,
+}
+
+impl Read for ChunkReader {
+    fn read(&mut self, out: &mut [u8]) -> io::Result<usize> {
+        while self.pos == self.current.len() {
+            match self.chunks.recv() {
+                Ok(chunk) => {
+                    self.current = chunk?;
+                    self.pos = 0;
+                }
+                Err(_) => return Ok(0),
+            }
+        }
+        let n = out.len().min(self.current.len() - self.pos);
+        out[..n].copy_from_slice(&self.current[self.pos..self.pos + n]);
+        self.pos += n;
+        Ok(n)
+    }
+}
+
+// Decompress a gzip stream sequentially, forwarding fixed-size chunks
+fn spawn_gzip_reader(source: BufReader<Box<dyn Read + Send>>) -> ChunkReader {
+    let (tx, rx) = sync_channel(4);
+    thread::spawn(move || {
+        let mut decoder = MultiGzDecoder::new(source);
+        loop {
+            let mut chunk = vec![0u8; READ_CHUNK_SIZE];
+            let mut filled = 0;
+            let result = loop {
+                match decoder.read(&mut chunk[filled..]) {
+                    Ok(0) => break Ok(()),
+                    Ok(n) => {
+                        filled += n;
+                        if filled == chunk.len() {
+                            break Ok(());
+                        }
+                    }
+                    Err(e) if e.kind() == io::ErrorKind::Interrupted => {}
+                    Err(e) => break Err(e),
+                }
+            };
+            if let Err(e) = result {
+                let _ = tx.send(Err(e));
+                return;
+            }
+            if filled == 0 {
+                return;
+            }
+            chunk.truncate(filled);
+            if tx.send(Ok(chunk)).is_err() {
+                return;
+            }
+        }
+    });
+    ChunkReader {
+        chunks: rx,
+        current: Vec::new(),
+        pos: 0,
+    }
+}
+
+// Read one raw BGZF block (header to ISIZE), or None at a clean end of stream
+fn read_bgzf_block(source: &mut dyn Read) -> io::Result<Option<Vec<u8>>> {
+    let mut header = [0u8; BGZF_HEADER_SIZE];
+    let mut filled = 0;
+    while filled < header.len() {
+        match source.read(&mut header[filled..])? {
+            0 if filled == 0 => return Ok(None),
+            0 => {
+                return Err(io::Error::new(
+                    io::ErrorKind::UnexpectedEof,
+                    "Truncated BGZF block",
+                ))
+            }
+            n => filled += n,
+        }
+    }
+    if !is_bgzf_header(&header) {
+        return Err(io::Error::new(
+            io::ErrorKind::InvalidData,
+            "Not a BGZF block",
+        ));
+    }
+    let block_size = u16::from_le_bytes([header[16], header[17]]) as usize + 1;
+    let mut block = header.to_vec();
+    block.resize(block_size, 0);
+    source.read_exact(&mut block[BGZF_HEADER_SIZE..])?;
+    Ok(Some(block))
+}
+
+fn inflate_bgzf_block(block: &[u8]) -> io::Result<Vec<u8>> {
+    let data_end = block.len() - 8;
+    let isize = u32::from_le_bytes(block[data_end + 4..].try_into().unwrap()) as usize;
+    let mut out = Vec::with_capacity(isize);
+    DeflateDecoder::new(&block[BGZF_HEADER_SIZE..data_end]).read_to_end(&mut out)?;
+    let mut crc = Crc::new();
+    crc.update(&out);
+    let expected = u32::from_le_bytes(block[data_end..data_end + 4].try_into().unwrap());
+    if out.len() != isize || crc.sum() != expected {
+        return Err(io::Error::new(
+            io::ErrorKind::InvalidData,
+            "Corrupt BGZF block",
+        ));
+    }
+    Ok(out)
+}
+
+// Split a BGZF stream into blocks on one thread, inflate batches of blocks on `threads`
+// workers, and reassemble them in order
+fn spawn_bgzf_reader(mut source: BufReader<Box<dyn Read + Send>>, threads: usize) -> ChunkReader {
+    let n = worker_count(threads);
+    let (job_tx, job_rx) = sync_channel::<Job>(n * 2);
+    let (done_tx, done_rx) = sync_channel::<(usize, io::Result<Vec<u8>>)>(n * 2);
+    let (chunk_tx, chunk_rx) = sync_channel(4);
+    let job_rx = Arc::new(Mutex::new(job_rx));
+    for _ in 0..n {
+        let job_rx = Arc::clone(&job_rx);
+        let done_tx = done_tx.clone();
+        thread::spawn(move || loop {
+            let job = job_rx.lock().unwrap().recv();
+            let Ok((index, blocks)) = job else {
+                return;
+            };
+            let mut out = Vec::new();
+            let result = blocks.iter().try_for_each(|block| {
+                out.extend_from_slice(&inflate_bgzf_block(block)?);
+                Ok(())
+            });
+            if done_tx.send((index, result.map(|_| out))).is_err() {
+                return;
+            }
+        });
+    }
+    // Splitter: errors are forwarded through the result channel under the next index
+    let split_done = done_tx.clone();
+    thread::spawn(move || {
+        let mut index = 0usize;
+        let mut batch = Vec::with_capacity(BLOCKS_PER_JOB);
+        loop {
+            match read_bgzf_block(&mut source) {
+                Ok(Some(block)) => {
+                    batch.push(block);
+                    if batch.len() < BLOCKS_PER_JOB {
+                        continue;
+                    }
+                }
+                Ok(None) => {
+                    if !batch.is_empty() {
+                        let _ = job_tx.send((index, batch));
+                    }
+                    return;
+                }
+                Err(e) => {
+                    if !batch.is_empty() && job_tx.send((index, batch)).is_ok() {
+                        index += 1;
+                    }
+                    let _ = split_done.send((index, Err(e)));
+                    return;
+                }
+            }
+            let full = std::mem::replace(&mut batch, Vec::with_capacity(BLOCKS_PER_JOB));
+            if job_tx.send((index, full)).is_err() {
+                return;
+            }
+            index += 1;
+        }
+    });
+    drop(done_tx);
+    // Reorderer
+    thread::spawn(move || {
+        let mut pending = BTreeMap::new();
+        let mut next = 0usize;
+        for (index, result) in done_rx {
+            pending.insert(index, result);
+            while let Some(result) = pending.remove(&next) {
+                let failed = result.is_err();
+                if chunk_tx.send(result).is_err() || failed {
+                    return;
+                }
+                next += 1;
+            }
+        }
+    });
+    ChunkReader {
+        chunks: chunk_rx,
+        current: Vec::new(),
+        pos: 0,
+    }
+}
+
+fn is_bgzf_header(buf: &[u8]) -> bool {
+    buf.len() >= BGZF_HEADER_SIZE
+        && buf[0] == 0x1f
+        && buf[1] == 0x8b
+        && buf[2] == 0x08
+        && buf[3] & 0x04 != 0
+        && buf[10] == 6
+        && buf[11] == 0
+        && buf[12] == b'B'
+        && buf[13] == b'C'
+        && buf[14] == 2
+        && buf[15] == 0
+}
+
+/// Open an input ("-" for stdin), transparently decompressing gzip or BGZF (like `zcat -f`).
+pub fn open_input(
+    path: &str,
+    threads: usize,
+    metrics: &TaskMetrics,
+) -> io::Result<Box<dyn BufRead + Send>> {
+    let raw: Box<dyn Read + Send> = if path == "-" {
+        Box::new(io::stdin())
+    } else {
+        Box::new(File::open(path)?)
+    };
+    let mut reader = BufReader::with_capacity(READ_CHUNK_SIZE, raw);
+    let head = reader.fill_buf()?;
+    if is_bgzf_header(head) {
+        Ok(Box::new(BufReader::with_capacity(
+            READ_CHUNK_SIZE,
+            metrics.count_reader(path, spawn_bgzf_reader(reader, threads)),
+        )))
+    } else if head.len() >= 2 && head[0] == 0x1f && head[1] == 0x8b {
+        Ok(Box::new(BufReader::with_capacity(
+            READ_CHUNK_SIZE,
+            metrics.count_reader(path, spawn_gzip_reader(reader)),
+        )))
+    } else {
+        Ok(Box::new(BufReader::with_capacity(
+            READ_CHUNK_SIZE,
+            metrics.count_reader(path, reader),
+        )))
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_bgzf_roundtrip_is_plain_gzip() {
+        let data: Vec<u8> = (0..300_000u32)
+            .flat_map(|i| (i % 251).to_le_bytes())
+            .collect();
+        let mut compressed = Vec::new();
+        for chunk in data.chunks(BGZF_BLOCK_SIZE) {
+            compressed.extend_from_slice(&bgzf_block(chunk, 6).unwrap());
+        }
+        compressed.extend_from_slice(&BGZF_EOF);
+        let mut plain = Vec::new();
+        MultiGzDecoder::new(&compressed[..])
+            .read_to_end(&mut plain)
+            .unwrap();
+        assert_eq!(plain, data);
+    }
+
+    #[test]
+    fn test_eof_block_is_empty_gzip() {
+        let mut plain = Vec::new();
+        MultiGzDecoder::new(&BGZF_EOF[..])
+            .read_to_end(&mut plain)
+            .unwrap();
+        assert!(plain.is_empty());
+        assert!(is_bgzf_header(&BGZF_EOF));
+    }
+
+    #[test]
+    fn test_corrupt_block_detected() {
+        let mut block = bgzf_block(b"ACGTACGT", 6).unwrap();
+        let n = block.len();
+        block[n - 5] ^= 0xff; // CRC
+        assert!(inflate_bgzf_block(&block).is_err());
+    }
+}
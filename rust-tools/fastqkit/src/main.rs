@@ -0,0 +1,442 @@
+//! Multi-threaded FASTQ/FASTA plumbing, replacing the zcat/paste, seqtk and seqkit pipelines
+//! in the simple read-shuffling modules.
+//!
+//! Subcommands:
+//!   interleave    R1 + R2 -> interleaved (paste <(zcat R1) <(zcat R2) | tr)
+//!   deinterleave  interleaved -> R1 + R2 (reformat.sh)
+//!   to-fasta      FASTQ -> single-line FASTA (seqtk seq -a)
+//!   subseq        keep records whose ID is in a hash set of IDs (seqtk subseq / seqkit grep -f),
+//!                 with IDs taken from a list, another FASTQ/FASTA, or a TSV column
+//!   ids           record IDs, optionally sorted and deduplicated (seqkit seq -ni | sort -u)
+//!
+//! Every input may be plain, gzip or BGZF; outputs ending in `.gz` are BGZF, compressed on
+//! worker threads (see io.rs). Empty inputs produce valid empty outputs.
+//!
+//! Metrics (see the task_metrics crate) are written as `fastqkit_<subcommand>`, with phases
+//! "read" (loading IDs), "process" (streaming records to the output) and "write" (writing
+//! collected IDs and finishing the outputs' compression).
+
+// ------------------------------------------------------------------------------------------------
+// IMPORTS
+// ------------------------------------------------------------------------------------------------
+
+mod fastx;
+mod io;
+
+use std::collections::{BTreeSet, HashSet};
+use std::error::Error;
+use std::io::{BufRead, Write};
+
+use clap::{Args as ClapArgs, Parser, Subcommand};
+use task_metrics::TaskMetrics;
+
+use crate::fastx::{id_of, write_fasta, write_fastq, write_record, FastxReader, Format, Record};
+use crate::io::{open_input, Output};
+
+// ------------------------------------------------------------------------------------------------
+// ARGUMENTS
+// ------------------------------------------------------------------------------------------------
+
+#[derive(Parser, Debug)]
+#[command(name = "fastqkit")]
+#[command(about = "Multi-threaded FASTQ/FASTA utilities with parallel gzip (BGZF) I/O")]
+struct Cli {
+    #[command(subcommand)]
+    command: Command,
+
+    #[command(flatten)]
+    io: IoArgs,
+}
+
+#[derive(ClapArgs, Debug)]
+struct IoArgs {
+    /// Threads for (de)compression
+    #[arg(short = 't', long, default_value_t = 4, global = true)]
+    threads: usize,
+
+    /// Gzip compression level for `.gz` outputs
+    #[arg(short = 'l', long, default_value_t = 6, global = true)]
+    compression_level: u32,
+}
+
+#[derive(Subcommand, Debug)]
+enum Command {
+    /// Interleave paired FASTQ files
+    Interleave {
+        /// Read 1 FASTQ
+        #[arg(short = '1', long)]
+        in1: String,
+        /// Read 2 FASTQ
+        #[arg(short = '2', long)]
+        in2: String,
+        /// Interleaved output
+        #[arg(short = 'o', long)]
+        output: String,
+    },
+    /// Split an interleaved FASTQ into read 1 and read 2 files
+    Deinterleave {
+        /// Interleaved FASTQ
+        #[arg(short = 'i', long)]
+        input: String,
+        /// Read 1 output
+        #[arg(short = '1', long)]
+        out1: String,
+        /// Read 2 output
+        #[arg(short = '2', long)]
+        out2: String,
+    },
+    /// Convert FASTQ to single-line FASTA
+    ToFasta {
+        #[arg(short = 'i', long)]
+        input: String,
+        #[arg(short = 'o', long)]
+        output: String,
+    },
+    /// Keep records whose ID is in a set of IDs
+    Subseq {
+        /// FASTQ/FASTA to subset
+        #[arg(short = 'i', long)]
+        input: String,
+        #[arg(short = 'o', long)]
+        output: String,
+        #[command(flatten)]
+        ids: IdSource,
+        /// Column of --ids-tsv holding the IDs
+        #[arg(long, requires = "ids_tsv")]
+        column: Option<String>,
+        /// Also write the IDs read from the ID source, in source order
+        #[arg(long)]
+        ids_out: Option<String>,
+    },
+    /// Write record IDs, one per line
+    Ids {
+        #[arg(short = 'i', long)]
+        input: String,
+        #[arg(short = 'o', long)]
+        output: String,
+        /// Sort and deduplicate IDs (byte order, as `LC_ALL=C sort -u`)
+        #[arg(long)]
+        unique: bool,
+    },
+}
+
+#[derive(ClapArgs, Debug)]
+#[group(required = true, multiple = false)]
+struct IdSource {
+    /// File of IDs, one per line (first whitespace-delimited token; "-" for stdin)
+    #[arg(long)]
+    ids: Option<String>,
+    /// FASTQ/FASTA whose record IDs to keep
+    #[arg(long)]
+    ids_fastx: Option<String>,
+    /// TSV whose --column values to keep (an empty file, without header, has no IDs)
+    #[arg(long, requires = "column")]
+    ids_tsv: Option<String>,
+}
+
+// ------------------------------------------------------------------------------------------------
+// ID SOURCES
+// ------------------------------------------------------------------------------------------------
+
+fn read_id_list(
+    path: &str,
+    threads: usize,
+    metrics: &TaskMetrics,
+) -> Result<Vec<Vec<u8>>, Box<dyn Error>> {
+    let mut reader = open_input(path, threads, metrics)?;
+    let mut ids = Vec::new();
+    let mut line = Vec::new();
+    while reader.read_until(b'\n', &mut line)? > 0 {
+        while line.last().is_some_and(|&b| b == b'\n' || b == b'\r') {
+            line.pop();
+        }
+        let id = id_of(&line);
+        if !id.is_empty() {
+            ids.push(id.to_vec());
+        }
+        line.clear();
+    }
+    Ok(ids)
+}
+
+fn read_fastx_ids(
+    path: &str,
+    threads: usize,
+    metrics: &TaskMetrics,
+) -> Result<Vec<Vec<u8>>, Box<dyn Error>> {
+    let mut reader = FastxReader::new(open_input(path, threads, metrics)?)?;
+    let mut record = Record::default();
+    let mut ids = Vec::new();
+    while reader.read(&mut record)? {
+        ids.push(record.id().to_vec());
+    }
+    Ok(ids)
+}
+
+fn read_tsv_column(
+    path: &str,
+    column: &str,
+    threads: usize,
+    metrics: &TaskMetrics,
+) -> Result<Vec<Vec<u8>>, Box<dyn Error>> {
+    let mut reader = open_input(path, threads, metrics)?;
+    let mut line = Vec::new();
+    if reader.read_until(b'\n', &mut line)? == 0 {
+        return Ok(Vec::new());
+    }
+    let trim = |line: &mut Vec<u8>| {
+        while line.last().is_some_and(|&b| b == b'\n' || b == b'\r') {
+            line.pop();
+        }
+    };
+    trim(&mut line);
+    let index = line
+        .split(|&b| b == b'\t')
+        .position(|field| field == column.as_bytes())
+        .ok_or_else(|| format!("ERROR: No column named '{}' in header of {}", column, path))?;
+    let mut ids = Vec::new();
+    line.clear();
+    while reader.read_until(b'\n', &mut line)? > 0 {
+        trim(&mut line);
+        let field = line
+            .split(|&b| b == b'\t')
+            .nth(index)
+            .ok_or_else(|| format!("Row of {} has no column {}", path, index + 1))?;
+        ids.push(field.to_vec());
+        line.clear();
+    }
+    Ok(ids)
+}
+
+// ------------------------------------------------------------------------------------------------
+// SUBCOMMANDS
+// ------------------------------------------------------------------------------------------------
+
+fn interleave(
+    in1: &str,
+    in2: &str,
+    output: &str,
+    io: &IoArgs,
+    metrics: &TaskMetrics,
+) -> Result<u64, Box<dyn Error>> {
+    let mut r1 = FastxReader::new(open_input(in1, io.threads, metrics)?)?;
+    let mut r2 = FastxReader::new(open_input(in2, io.threads, metrics)?)?;
+    let mut out = Output::create(output, io.threads, io.compression_level, metrics)?;
+    let (mut a, mut b) = (Record::default(), Record::default());
+    let mut pairs = 0u64;
+    let timer = metrics.start_phase("process");
+    loop {
+        match (r1.read(&mut a)?, r2.read(&mut b)?) {
+            (true, true) => {
+                write_fastq(&mut out, &a)?;
+                write_fastq(&mut out, &b)?;
+                pairs += 1;
+            }
+            (false, false) => break,
+            _ => return Err(format!("{} and {} have different numbers of reads", in1, in2).into()),
+        }
+    }
+    drop(timer);
+    metrics.phase("write", || out.finish())?;
+    Ok(pairs)
+}
+
+fn deinterleave(
+    input: &str,
+    out1: &str,
+    out2: &str,
+    io: &IoArgs,
+    metrics: &TaskMetrics,
+) -> Result<u64, Box<dyn Error>> {
+    let mut reader = FastxReader::new(open_input(input, io.threads, metrics)?)?;
+    // Split the compression threads between the two outputs
+    let threads = (io.threads / 2).max(1);
+    let mut w1 = Output::create(out1, threads, io.compression_level, metrics)?;
+    let mut w2 = Output::create(out2, threads, io.compression_level, metrics)?;
+    let (mut a, mut b) = (Record::default(), Record::default());
+    let mut pairs = 0u64;
+    let timer = metrics.start_phase("process");
+    while reader.read(&mut a)? {
+        if !reader.read(&mut b)? {
+            return Err(format!("{} has an odd number of reads", input).into());
+        }
+        write_fastq(&mut w1, &a)?;
+        write_fastq(&mut w2, &b)?;
+        pairs += 1;
+    }
+    drop(timer);
+    metrics.phase("write", || -> std::io::Result<()> {
+        w1.finish()?;
+        w2.finish()
+    })?;
+    Ok(pairs)
+}
+
+fn to_fasta(
+    input: &str,
+    output: &str,
+    io: &IoArgs,
+    metrics: &TaskMetrics,
+) -> Result<u64, Box<dyn Error>> {
+    let mut reader = FastxReader::new(open_input(input, io.threads, metrics)?)?;
+    let mut out = Output::create(output, io.threads, io.compression_level, metrics)?;
+    let mut record = Record::default();
+    let mut n = 0u64;
+    metrics.phase("process", || -> Result<(), Box<dyn Error>> {
+        while reader.read(&mut record)? {
+            write_fasta(&mut out, &record)?;
+            n += 1;
+        }
+        Ok(())
+    })?;
+    metrics.phase("write", || out.finish())?;
+    Ok(n)
+}
+
+fn subseq(
+    input: &str,
+    output: &str,
+    source: &IdSource,
+    column: Option<&str>,
+    ids_out: Option<&str>,
+    io: &IoArgs,
+    metrics: &TaskMetrics,
+) -> Result<(u64, u64), Box<dyn Error>> {
+    let ids = metrics.phase("read", || {
+        match (&source.ids, &source.ids_fastx, &source.ids_tsv) {
+            (Some(path), _, _) => read_id_list(path, io.threads, metrics),
+            (_, Some(path), _) => read_fastx_ids(path, io.threads, metrics),
+            (_, _, Some(path)) => read_tsv_column(path, column.unwrap(), io.threads, metrics),
+            _ => unreachable!("clap requires one ID source"),
+        }
+    })?;
+    if let Some(path) = ids_out {
+        metrics.phase("write", || -> std::io::Result<()> {
+            let mut out = Output::create(path, io.threads, io.compression_level, metrics)?;
+            for id in &ids {
+                out.write_all(id)?;
+                out.write_all(b"\n")?;
+            }
+            out.finish()
+        })?;
+    }
+    let wanted: HashSet<Vec<u8>> = metrics.phase("read", || ids.into_iter().collect());
+    let mut reader = FastxReader::new(open_input(input, io.threads, metrics)?)?;
+    let mut out = Output::create(output, io.threads, io.compression_level, metrics)?;
+    let format = reader.format().unwrap_or(Format::Fastq);
+    let mut record = Record::default();
+    let (mut seen, mut kept) = (0u64, 0u64);
+    metrics.phase("process", || -> Result<(), Box<dyn Error>> {
+        while reader.read(&mut record)? {
+            seen += 1;
+            if wanted.contains(record.id()) {
+                write_record(&mut out, &record, format)?;
+                kept += 1;
+            }
+        }
+        Ok(())
+    })?;
+    metrics.phase("write", || out.finish())?;
+    Ok((seen, kept))
+}
+
+fn ids(
+    input: &str,
+    output: &str,
+    unique: bool,
+    io: &IoArgs,
+    metrics: &TaskMetrics,
+) -> Result<u64, Box<dyn Error>> {
+    let mut reader = FastxReader::new(open_input(input, io.threads, metrics)?)?;
+    let mut out = Output::create(output, io.threads, io.compression_level, metrics)?;
+    let mut record = Record::default();
+    let mut n = 0u64;
+    if unique {
+        let set = metrics.phase("read", || -> Result<_, Box<dyn Error>> {
+            let mut set = BTreeSet::new();
+            while reader.read(&mut record)? {
+                set.insert(record.id().to_vec());
+            }
+            Ok(set)
+        })?;
+        metrics.phase("write", || -> std::io::Result<()> {
+            for id in &set {
+                out.write_all(id)?;
+                out.write_all(b"\n")?;
+            }
+            Ok(())
+        })?;
+        n = set.len() as u64;
+    } else {
+        metrics.phase("process", || -> Result<(), Box<dyn Error>> {
+            while reader.read(&mut record)? {
+                out.write_all(record.id())?;
+                out.write_all(b"\n")?;
+                n += 1;
+            }
+            Ok(())
+        })?;
+    }
+    metrics.phase("write", || out.finish())?;
+    Ok(n)
+}
+
+// ------------------------------------------------------------------------------------------------
+// MAIN
+// ------------------------------------------------------------------------------------------------
+
+fn main() -> Result<(), Box<dyn Error>> {
+    let cli = Cli::parse();
+    let io = &cli.io;
+    let name = match &cli.command {
+        Command::Interleave { .. } => "interleave",
+        Command::Deinterleave { .. } => "deinterleave",
+        Command::ToFasta { .. } => "to_fasta",
+        Command::Subseq { .. } => "subseq",
+        Command::Ids { .. } => "ids",
+    };
+    // Write metrics once outputs are closed
+    let metrics = TaskMetrics::new(&format!("fastqkit_{}", name));
+    match &cli.command {
+        Command::Interleave { in1, in2, output } => {
+            let pairs = interleave(in1, in2, output, io, &metrics)?;
+            eprintln!("Interleaved {} read pairs", pairs);
+        }
+        Command::Deinterleave { input, out1, out2 } => {
+            let pairs = deinterleave(input, out1, out2, io, &metrics)?;
+            eprintln!("Deinterleaved {} read pairs", pairs);
+        }
+        Command::ToFasta { input, output } => {
+            let n = to_fasta(input, output, io, &metrics)?;
+            eprintln!("Converted {} records", n);
+        }
+        Command::Subseq {
+            input,
+            output,
+            ids,
+            column,
+            ids_out,
+        } => {
+            let (seen, kept) = subseq(
+                input,
+                output,
+                ids,
+                column.as_deref(),
+                ids_out.as_deref(),
+                io,
+                &metrics,
+            )?;
+            eprintln!("Kept {} of {} records", kept, seen);
+        }
+        Command::Ids {
+            input,
+            output,
+            unique,
+        } => {
+            let n = ids(input, output, *unique, io, &metrics)?;
+            eprintln!("Wrote {} IDs", n);
+        }
+    }
+    metrics.write()?;
+    Ok(())
+}
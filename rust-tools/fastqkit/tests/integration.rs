@@ -0,0 +1,334 @@
+use std::fs::{self, File};
+use std::io::{Read, Write};
+use std::path::{Path, PathBuf};
+use std::process::{Command, Output};
+
+use flate2::read::MultiGzDecoder;
+use flate2::write::GzEncoder;
+use flate2::Compression;
+
+fn binary_path() -> PathBuf {
+    PathBuf::from(env!("CARGO_BIN_EXE_fastqkit"))
+}
+
+fn fixture(name: &str) -> PathBuf {
+    PathBuf::from(env!("CARGO_MANIFEST_DIR"))
+        .join("tests/fixtures")
+        .join(name)
+}
+
+// Per-test scratch directory, removed on drop
+struct Scratch(PathBuf);
+
+impl Scratch {
+    fn new(name: &str) -> Self {
+        let dir = std::env::temp_dir().join(format!("fastqkit_{}_{}", name, std::process::id()));
+        fs::create_dir_all(&dir).unwrap();
+        Self(dir)
+    }
+
+    fn path(&self, name: &str) -> String {
+        self.0.join(name).to_str().unwrap().to_string()
+    }
+
+    fn gzip(&self, name: &str, content: &str) -> String {
+        let path = self.path(name);
+        let mut encoder = GzEncoder::new(File::create(&path).unwrap(), Compression::default());
+        encoder.write_all(content.as_bytes()).unwrap();
+        encoder.finish().unwrap();
+        path
+    }
+}
+
+impl Drop for Scratch {
+    fn drop(&mut self) {
+        fs::remove_dir_all(&self.0).ok();
+    }
+}
+
+fn run(args: &[&str]) -> Output {
+    Command::new(binary_path()).args(args).output().unwrap()
+}
+
+fn run_ok(args: &[&str]) {
+    let output = run(args);
+    assert!(
+        output.status.success(),
+        "stderr: {}",
+        String::from_utf8_lossy(&output.stderr)
+    );
+}
+
+fn read_text(path: &str) -> String {
+    let mut raw = Vec::new();
+    File::open(path).unwrap().read_to_end(&mut raw).unwrap();
+    if Path::new(path).extension().is_some_and(|e| e == "gz") {
+        let mut text = String::new();
+        MultiGzDecoder::new(&raw[..])
+            .read_to_string(&mut text)
+            .unwrap();
+        text
+    } else {
+        String::from_utf8(raw).unwrap()
+    }
+}
+
+fn records(text: &str, lines_per_record: usize) -> Vec<String> {
+    let lines: Vec<&str> = text.lines().collect();
+    lines
+        .chunks(lines_per_record)
+        .map(|c| c.join("\n"))
+        .collect()
+}
+
+fn synthetic_fastq(n: usize) -> String {
+    (0..n)
+        .map(|i| {
+            let seq: String = (0..100)
+                .map(|j| b"ACGT"[(i * 7 + j * 3) % 4] as char)
+                .collect();
+            format!("@syn{} extra\n{}\n+\n{}\n", i, seq, "I".repeat(100))
+        })
+        .collect()
+}
+
+#[test]
+fn test_interleave_deinterleave_roundtrip() {
+    let s = Scratch::new("roundtrip");
+    let r1 = fixture("pairs_1.fastq");
+    let r2 = fixture("pairs_2.fastq");
+    let (r1, r2) = (r1.to_str().unwrap(), r2.to_str().unwrap());
+    let inter = s.path("inter.fastq.gz");
+    run_ok(&["interleave", "-1", r1, "-2", r2, "-o", &inter]);
+    let inter_records = records(&read_text(&inter), 4);
+    let r1_records = records(&read_text(r1), 4);
+    let r2_records = records(&read_text(r2), 4);
+    assert_eq!(inter_records.len(), 6);
+    for i in 0..3 {
+        assert_eq!(inter_records[2 * i], r1_records[i]);
+        assert_eq!(inter_records[2 * i + 1], r2_records[i]);
+    }
+    let (out1, out2) = (s.path("out_1.fastq.gz"), s.path("out_2.fastq"));
+    run_ok(&["deinterleave", "-i", &inter, "-1", &out1, "-2", &out2]);
+    assert_eq!(read_text(&out1), read_text(r1));
+    assert_eq!(read_text(&out2), read_text(r2));
+}
+
+#[test]
+fn test_interleave_mismatched_counts_fails() {
+    let s = Scratch::new("mismatch");
+    let short = s.gzip("short.fastq.gz", "@read1\nACGT\n+\nIIII\n");
+    let r2 = fixture("pairs_2.fastq");
+    let output = run(&[
+        "interleave",
+        "-1",
+        &short,
+        "-2",
+        r2.to_str().unwrap(),
+        "-o",
+        &s.path("o.fastq.gz"),
+    ]);
+    assert!(!output.status.success());
+    assert!(String::from_utf8_lossy(&output.stderr).contains("different numbers of reads"));
+}
+
+#[test]
+fn test_to_fasta() {
+    let s = Scratch::new("to_fasta");
+    let out = s.path("out.fasta.gz");
+    run_ok(&[
+        "to-fasta",
+        "-i",
+        fixture("pairs_1.fastq").to_str().unwrap(),
+        "-o",
+        &out,
+    ]);
+    assert_eq!(
+        read_text(&out),
+        ">read1 1:N:0:ACGT\nACGTACGTAC\n>read2 1:N:0:ACGT\nTTTTGGGGCC\n>read3 1:N:0:ACGT\nGATTACA\n"
+    );
+}
+
+#[test]
+fn test_subseq_id_sources() {
+    let s = Scratch::new("subseq");
+    let inter = s.path("inter.fastq.gz");
+    let (r1, r2) = (fixture("pairs_1.fastq"), fixture("pairs_2.fastq"));
+    run_ok(&[
+        "interleave",
+        "-1",
+        r1.to_str().unwrap(),
+        "-2",
+        r2.to_str().unwrap(),
+        "-o",
+        &inter,
+    ]);
+    // ID list: both mates of read3 are kept
+    let ids = s.path("ids.txt");
+    fs::write(&ids, "read3\tfoo\nmissing\n").unwrap();
+    let out = s.path("list.fastq.gz");
+    run_ok(&["subseq", "-i", &inter, "-o", &out, "--ids", &ids]);
+    let kept = records(&read_text(&out), 4);
+    assert_eq!(kept.len(), 2);
+    assert!(kept.iter().all(|r| r.starts_with("@read3 ")));
+    // FASTQ source
+    let source = s.gzip("source.fastq.gz", "@read2 x\nA\n+\nI\n@read1\nA\n+\nI\n");
+    let out = s.path("fastx.fastq");
+    run_ok(&["subseq", "-i", &inter, "-o", &out, "--ids-fastx", &source]);
+    let kept = records(&read_text(&out), 4);
+    assert_eq!(kept.len(), 4);
+    assert!(kept[0].starts_with("@read1 1:N") && kept[3].starts_with("@read2 2:N"));
+    // TSV column source, with the IDs echoed out
+    let tsv = s.gzip("hits.tsv.gz", "taxid\tseq_id\n1\tread2\n2\tread2\n");
+    let (out, ids_out) = (s.path("tsv.fastq.gz"), s.path("ids.txt.gz"));
+    run_ok(&[
+        "subseq",
+        "-i",
+        &inter,
+        "-o",
+        &out,
+        "--ids-tsv",
+        &tsv,
+        "--column",
+        "seq_id",
+        "--ids-out",
+        &ids_out,
+    ]);
+    assert_eq!(records(&read_text(&out), 4).len(), 2);
+    assert_eq!(read_text(&ids_out), "read2\nread2\n");
+    // Missing column
+    let output = run(&[
+        "subseq",
+        "-i",
+        &inter,
+        "-o",
+        &out,
+        "--ids-tsv",
+        &tsv,
+        "--column",
+        "nope",
+    ]);
+    assert!(!output.status.success());
+    assert!(String::from_utf8_lossy(&output.stderr).contains("No column named 'nope'"));
+}
+
+#[test]
+fn test_subseq_fasta_input() {
+    let s = Scratch::new("subseq_fasta");
+    let fasta = s.path("in.fasta");
+    fs::write(&fasta, ">a one\nAC\nGT\n>b two\nTT\n").unwrap();
+    let ids = s.path("ids.txt");
+    fs::write(&ids, "b\n").unwrap();
+    let out = s.path("out.fasta");
+    run_ok(&["subseq", "-i", &fasta, "-o", &out, "--ids", &ids]);
+    assert_eq!(read_text(&out), ">b two\nTT\n");
+}
+
+#[test]
+fn test_ids() {
+    let s = Scratch::new("ids");
+    let inter = s.path("inter.fastq");
+    let (r1, r2) = (fixture("pairs_1.fastq"), fixture("pairs_2.fastq"));
+    run_ok(&[
+        "interleave",
+        "-1",
+        r1.to_str().unwrap(),
+        "-2",
+        r2.to_str().unwrap(),
+        "-o",
+        &inter,
+    ]);
+    let out = s.path("ids.txt");
+    run_ok(&["ids", "-i", &inter, "-o", &out]);
+    assert_eq!(
+        read_text(&out),
+        "read1\nread1\nread2\nread2\nread3\nread3\n"
+    );
+    let fasta = s.path("in.fasta");
+    fs::write(&fasta, ">b\nA\n>a\nC\n>b\nG\n").unwrap();
+    run_ok(&["ids", "-i", &fasta, "-o", &out, "--unique"]);
+    assert_eq!(read_text(&out), "a\nb\n");
+}
+
+#[test]
+fn test_empty_inputs() {
+    let s = Scratch::new("empty");
+    let empty = s.gzip("empty.fastq.gz", "");
+    let empty_tsv = s.gzip("empty.tsv.gz", "");
+    let (o1, o2, o3) = (
+        s.path("o1.fastq.gz"),
+        s.path("o2.fastq.gz"),
+        s.path("o3.txt.gz"),
+    );
+    run_ok(&["interleave", "-1", &empty, "-2", &empty, "-o", &o1]);
+    run_ok(&["deinterleave", "-i", &empty, "-1", &o1, "-2", &o2]);
+    run_ok(&["to-fasta", "-i", &empty, "-o", &o1]);
+    run_ok(&["ids", "-i", &empty, "-o", &o1, "--unique"]);
+    run_ok(&[
+        "subseq",
+        "-i",
+        &empty,
+        "-o",
+        &o1,
+        "--ids-tsv",
+        &empty_tsv,
+        "--column",
+        "seq_id",
+        "--ids-out",
+        &o3,
+    ]);
+    for path in [&o1, &o2, &o3] {
+        assert_eq!(read_text(path), "");
+    }
+}
+
+#[test]
+fn test_large_input_through_parallel_bgzf() {
+    let s = Scratch::new("large");
+    let content = synthetic_fastq(20_000);
+    let input = s.gzip("in.fastq.gz", &content);
+    // gzip -> BGZF (multi-block, parallel compression) -> BGZF (parallel decompression)
+    let (a, b) = (s.path("a.fastq.gz"), s.path("b.fastq.gz"));
+    run_ok(&["deinterleave", "-i", &input, "-1", &a, "-2", &b, "-t", "4"]);
+    let inter = s.path("inter.fastq.gz");
+    run_ok(&["interleave", "-1", &a, "-2", &b, "-o", &inter, "-t", "3"]);
+    assert_eq!(read_text(&inter), content);
+    let single = s.path("single.fastq.gz");
+    run_ok(&["interleave", "-1", &a, "-2", &b, "-o", &single, "-t", "1"]);
+    assert_eq!(fs::read(&single).unwrap(), fs::read(&inter).unwrap());
+}
+
+#[test]
+fn test_task_metrics() {
+    let s = Scratch::new("metrics");
+    let input = s.gzip("in.fastq.gz", &synthetic_fastq(10));
+    let ids = s.path("ids.txt");
+    fs::write(&ids, "syn1\nsyn4\nsyn7\n").unwrap();
+    let out = s.path("out.fastq.gz");
+    let output = Command::new(binary_path())
+        .current_dir(&s.0)
+        .env("NAO_TASK_METRICS", "1")
+        .args(["subseq", "-i", &input, "--ids", &ids, "-o", &out])
+        .output()
+        .unwrap();
+    assert!(
+        output.status.success(),
+        "stderr: {}",
+        String::from_utf8_lossy(&output.stderr)
+    );
+    let json = fs::read_to_string(s.0.join("fastqkit_subseq.metrics.json")).unwrap();
+    // 3 ID lines and 40 FASTQ lines are read; 3 records are written
+    assert!(
+        json.contains("\"rows_in\": 43,\n  \"rows_out\": 12,"),
+        "Metrics: {}",
+        json
+    );
+    for phase in ["read", "process", "write"] {
+        assert!(
+            json.contains(&format!("\"{}\": {{", phase)),
+            "Missing phase {}: {}",
+            phase,
+            json
+        );
+    }
+}
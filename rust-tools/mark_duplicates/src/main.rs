@@ -11,6 +11,7 @@ use flate2::{Compression as GzCompression, write::GzEncoder, read::GzDecoder};
 use bzip2::{Compression as BzCompression, write::BzEncoder, read::BzDecoder};
 use rayon::prelude::*;
 use clap::Parser;
+use task_metrics::TaskMetrics;
 
 // ------------------------------------------------------------------------------------------------
 // STRUCTS AND TYPES
@@ -38,6 +39,15 @@ struct DuplicateGroup {
 // Map from query_name to (genome_id, exemplar_name) for efficient lookup during second pass
 type ExemplarMap = HashMap<String, (String, String)>;
 
+// One group of a --manifest batch: a label for error messages plus its input and output paths
+#[derive(Debug, Clone)]
+struct ManifestEntry {
+    label: String,
+    input: String,
+    output_db: String,
+    output_meta: String,
+}
+
 // ------------------------------------------------------------------------------------------------
 // ARGUMENT PARSING
 // ------------------------------------------------------------------------------------------------
@@ -47,14 +57,18 @@ type ExemplarMap = HashMap<String, (String, String)>;
 #[command(author, version, about, long_about = None)]
 struct Args {
     /// Input TSV file path
-    #[arg(short, long)]
-    input: String,
+    #[arg(short, long, required_unless_present = "manifest")]
+    input: Option<String>,
     /// Output database file path
-    #[arg(short = 'o', long)]
-    output_db: String,
+    #[arg(short = 'o', long, required_unless_present = "manifest")]
+    output_db: Option<String>,
     /// Output metadata file path
-    #[arg(short = 'm', long)]
-    output_meta: String,
+    #[arg(short = 'm', long, required_unless_present = "manifest")]
+    output_meta: Option<String>,
+    /// Headerless TSV of groups to process concurrently, one per line (label, input, output_db,
+    /// output_meta), instead of a single input
+    #[arg(long, conflicts_with_all = ["input", "output_db", "output_meta"])]
+    manifest: Option<String>,
     /// Position deviation tolerance (0, 1, or 2)
     #[arg(short, long, default_value_t = 0, value_parser = clap::value_parser!(u8).range(0..=2))]
     deviation: u8,
@@ -90,34 +104,61 @@ fn compare_read_coordinates(a: &ReadEntry, b: &ReadEntry) -> Ordering {
     }
 }
 
-// Define a reader based on the file extension
-fn open_reader(filename: &str) -> std::io::Result<Box<dyn BufRead>> {
+// Define a reader based on the file extension, counting decompressed input in the metrics
+fn open_reader(filename: &str, metrics: &TaskMetrics) -> std::io::Result<Box<dyn BufRead>> {
     let file = File::open(filename)?;
     if filename.ends_with(".gz") {
         let decoder = GzDecoder::new(file);
-        Ok(Box::new(BufReader::new(decoder)))
+        Ok(Box::new(BufReader::new(metrics.count_reader(filename, decoder))))
     } else if filename.ends_with(".bz2") {
         let decoder = BzDecoder::new(file);
-        Ok(Box::new(BufReader::new(decoder)))
+        Ok(Box::new(BufReader::new(metrics.count_reader(filename, decoder))))
     } else {
-        Ok(Box::new(BufReader::new(file)))
+        Ok(Box::new(BufReader::new(metrics.count_reader(filename, file))))
     }
 }
 
-// Define a writer based on the file extension
-fn open_writer(filename: &str) -> std::io::Result<Box<dyn Write>> {
+// Define a writer based on the file extension, counting uncompressed output in the metrics
+fn open_writer(filename: &str, metrics: &TaskMetrics) -> std::io::Result<Box<dyn Write>> {
     if filename.ends_with(".gz") {
         let file = File::create(filename)?;
         let encoder = GzEncoder::new(file, GzCompression::default());
-        Ok(Box::new(BufWriter::new(encoder)))
+        Ok(Box::new(BufWriter::new(metrics.count_writer(filename, encoder))))
     } else if filename.ends_with(".bz2") {
         let file = File::create(filename)?;
         let encoder = BzEncoder::new(file, BzCompression::default());
-        Ok(Box::new(BufWriter::new(encoder)))
+        Ok(Box::new(BufWriter::new(metrics.count_writer(filename, encoder))))
     } else {
         let file = File::create(filename)?;
-        Ok(Box::new(BufWriter::new(file)))
+        Ok(Box::new(BufWriter::new(metrics.count_writer(filename, file))))
+    }
+}
+
+// Read a --manifest file of (label, input, output_db, output_meta) lines, skipping blank lines
+fn read_manifest(path: &str) -> Result<Vec<ManifestEntry>, Box<dyn Error>> {
+    let reader = BufReader::new(File::open(path)?);
+    let mut entries = Vec::new();
+    for (line_num, line) in reader.lines().enumerate() {
+        let line = line?;
+        if line.is_empty() {
+            continue;
+        }
+        let fields: Vec<&str> = line.split('\t').collect();
+        if fields.len() != 4 {
+            return Err(std::io::Error::new(
+                std::io::ErrorKind::InvalidData,
+                format!("Manifest line {} has {} fields (expected label, input, output_db, output_meta)",
+                    line_num + 1, fields.len())
+            ).into());
+        }
+        entries.push(ManifestEntry {
+            label: fields[0].to_string(),
+            input: fields[1].to_string(),
+            output_db: fields[2].to_string(),
+            output_meta: fields[3].to_string(),
+        });
     }
+    Ok(entries)
 }
 
 // Implement a custom match function for comparing ReadEntries
@@ -383,10 +424,11 @@ fn process_chunk_parallel(
 }
 
 fn extract_read_groups(input_path: &str,
-    chunk_size: u32
+    chunk_size: u32,
+    metrics: &TaskMetrics,
 ) -> Result<(String, HashMap<String, Vec<Vec<ReadEntry>>>, usize), Box<dyn Error>> {
     // Open the input file
-    let reader = open_reader(input_path)?;
+    let reader = open_reader(input_path, metrics)?;
     // Process the header line and derive the required fields
     let mut lines = reader.lines();
     let header_line = lines.next().ok_or_else(|| std::io::Error::new(std::io::ErrorKind::InvalidData, "Empty input file"))??;
@@ -398,44 +440,49 @@ fn extract_read_groups(input_path: &str,
     // Get the seq_id column index for later use
     let seq_id_index = indices["seq_id"];
     // Collect reads by genome_id
-    let mut genome_accumulators: HashMap<String, Vec<ReadEntry>> = HashMap::new();
-    // Read and process the input file in chunks
-    let mut line_buffer = Vec::new();
-    for line in lines {
-        let line = line?;
-        line_buffer.push(line);
-        // Process chunk when buffer is full
-        if line_buffer.len() >= chunk_size as usize {
-            // Process this chunk in parallel
+    let genome_accumulators = metrics.phase("parse", || -> Result<_, Box<dyn Error>> {
+        let mut genome_accumulators: HashMap<String, Vec<ReadEntry>> = HashMap::new();
+        // Read and process the input file in chunks
+        let mut line_buffer = Vec::new();
+        for line in lines {
+            let line = line?;
+            line_buffer.push(line);
+            // Process chunk when buffer is full
+            if line_buffer.len() >= chunk_size as usize {
+                // Process this chunk in parallel
+                let read_entries = process_chunk_parallel(&line_buffer, &indices, header_count)?;
+                // Partition reads by genome_id
+                for read_entry in read_entries {
+                    genome_accumulators.entry(read_entry.genome_id.clone())
+                        .or_insert_with(Vec::new)
+                        .push(read_entry);
+                }
+                // Clear the buffer
+                line_buffer.clear();
+            }
+        }
+        // Process remaining lines in the buffer
+        if !line_buffer.is_empty() {
             let read_entries = process_chunk_parallel(&line_buffer, &indices, header_count)?;
-            // Partition reads by genome_id
             for read_entry in read_entries {
                 genome_accumulators.entry(read_entry.genome_id.clone())
                     .or_insert_with(Vec::new)
                     .push(read_entry);
             }
-            // Clear the buffer
-            line_buffer.clear();
         }
-    }
-    // Process remaining lines in the buffer
-    if !line_buffer.is_empty() {
-        let read_entries = process_chunk_parallel(&line_buffer, &indices, header_count)?;
-        for read_entry in read_entries {
-            genome_accumulators.entry(read_entry.genome_id.clone())
-                .or_insert_with(Vec::new)
-                .push(read_entry);
-        }
-    }
+        Ok(genome_accumulators)
+    })?;
     // Process reads for each genome_id into read groups using optimized sorting approach
-    let genome_results: Vec<(String, Vec<Vec<ReadEntry>>)> = genome_accumulators
-        .into_par_iter()
-        .map(|(genome_id, reads)| {
-            // Use optimized sorted sliding window approach
-            let groups = build_groups_from_sorted_reads(reads);
-            (genome_id, groups)
-        })
-        .collect();
+    let genome_results: Vec<(String, Vec<Vec<ReadEntry>>)> = metrics.phase("group", || {
+        genome_accumulators
+            .into_par_iter()
+            .map(|(genome_id, reads)| {
+                // Use optimized sorted sliding window approach
+                let groups = build_groups_from_sorted_reads(reads);
+                (genome_id, groups)
+            })
+            .collect()
+    });
     // Collect results back into the main groups HashMap
     let mut final_groups = HashMap::new();
     for (genome_id, genome_group_list) in genome_results {
@@ -528,9 +575,10 @@ fn process_read_groups(
 fn write_metadata_file(
     duplicate_groups: &Vec<DuplicateGroup>,
     output_path_meta: &str,
+    metrics: &TaskMetrics,
 ) -> Result<(), Box<dyn Error>> {
     // Open the metadata output file
-    let mut writer_meta = open_writer(output_path_meta)?;
+    let mut writer_meta = open_writer(output_path_meta, metrics)?;
     // Write header
     let header_meta = "prim_align_genome_id_all\tprim_align_dup_exemplar\tprim_align_dup_count\tprim_align_dup_pairwise_match_frac";
     writeln!(writer_meta, "{}", header_meta)?;
@@ -549,11 +597,12 @@ fn write_database_file(
     exemplar_map: &ExemplarMap,
     seq_id_index: usize,
     output_path_db: &str,
+    metrics: &TaskMetrics,
 ) -> Result<(), Box<dyn Error>> {
     // Open input file for second pass
-    let reader = open_reader(input_path)?;
+    let reader = open_reader(input_path, metrics)?;
     // Open the database output file
-    let mut writer_db = open_writer(output_path_db)?;
+    let mut writer_db = open_writer(output_path_db, metrics)?;
     // Write header
     writeln!(writer_db, "{}", header_out)?;
     // Process input file line by line for output generation
@@ -583,20 +632,39 @@ fn write_database_file(
 // Define the deviation value
 static mut DEVIATION: u8 = 0;
 
-// Two-pass processing for improved memory efficiency
+// Two-pass processing for improved memory efficiency, timing the parse, group and write phases
 fn process_tsv(input_path: &str,
     output_path_db: &str,
     output_path_meta: &str,
-    chunk_size: u32) -> Result<(), Box<dyn Error>> {
+    chunk_size: u32,
+    metrics: &TaskMetrics) -> Result<(), Box<dyn Error>> {
     // Extract read groups from the input file
-    let (header_out, groups, seq_id_index) = extract_read_groups(input_path, chunk_size)?;
+    let (header_out, groups, seq_id_index) = extract_read_groups(input_path, chunk_size, metrics)?;
     // Process duplicate groups to create exemplar mapping and metadata
-    let (exemplar_map, duplicate_groups) = process_read_groups(groups)?;
-    // Write metadata file
-    write_metadata_file(&duplicate_groups, output_path_meta)?;
-    // Write database file
-    write_database_file(input_path, &header_out, &exemplar_map, seq_id_index, output_path_db)?;
-    Ok(())
+    let (exemplar_map, duplicate_groups) = metrics.phase("group", || process_read_groups(groups))?;
+    metrics.phase("write", || -> Result<(), Box<dyn Error>> {
+        // Write metadata file
+        write_metadata_file(&duplicate_groups, output_path_meta, metrics)?;
+        // Write database file
+        write_database_file(input_path, &header_out, &exemplar_map, seq_id_index, output_path_db, metrics)
+    })
+}
+
+// Process every manifest group concurrently on the shared rayon pool; each group's parsing and
+// grouping also run on the pool, so many small groups keep all threads busy in one task
+fn process_manifest(entries: &[ManifestEntry],
+    chunk_size: u32,
+    metrics: &TaskMetrics) -> Result<(), Box<dyn Error>> {
+    let results: Result<Vec<()>, String> = entries
+        .par_iter()
+        .map(|entry| {
+            process_tsv(&entry.input, &entry.output_db, &entry.output_meta, chunk_size, metrics)
+                .map_err(|e| format!("Group {}: {}", entry.label, e))
+        })
+        .collect();
+    results.map(|_| ()).map_err(|e| -> Box<dyn Error> {
+        std::io::Error::new(std::io::ErrorKind::InvalidData, e).into()
+    })
 }
 
 fn main() -> Result<(), Box<dyn Error>> {
@@ -612,6 +680,22 @@ fn main() -> Result<(), Box<dyn Error>> {
     unsafe {
         DEVIATION = args.deviation;
     }
-    // Run the main processing function
-    return process_tsv(&args.input, &args.output_db, &args.output_meta, args.chunk_size);
+    // Run the main processing function, then write metrics once outputs are closed
+    let metrics = TaskMetrics::new("mark_duplicates");
+    match &args.manifest {
+        Some(manifest) => {
+            let entries = read_manifest(manifest)?;
+            process_manifest(&entries, args.chunk_size, &metrics)?;
+        }
+        None => {
+            // clap requires all three paths when no manifest is given
+            let (Some(input), Some(output_db), Some(output_meta)) =
+                (&args.input, &args.output_db, &args.output_meta) else {
+                unreachable!("input and output paths are required without --manifest");
+            };
+            process_tsv(input, output_db, output_meta, args.chunk_size, &metrics)?;
+        }
+    }
+    metrics.write()?;
+    Ok(())
 }
@@ -7,7 +7,10 @@ use nao_dedup::{DedupContext, DedupParams, MinimizerParams, ReadPair};
 use std::collections::HashMap;
 use std::fs::File;
 use std::io::{BufRead, BufReader, BufWriter, Write};
+use std::sync::atomic::{AtomicUsize, Ordering};
+use std::thread;
 use std::time::Instant;
+use task_metrics::TaskMetrics;
 
 // ------------------------------------------------------------------------------------------------
 // ARGUMENT PARSING
@@ -18,10 +21,24 @@ use std::time::Instant;
 #[command(author, version, about, long_about = None)]
 struct Args {
     /// Input gzipped TSV file path
-    #[arg(short, long)]
-    input: String,
+    #[arg(short, long, required_unless_present = "manifest")]
+    input: Option<String>,
     /// Output gzipped TSV file path
-    #[arg(short, long)]
+    #[arg(short, long, required_unless_present = "manifest")]
+    output: Option<String>,
+    /// Headerless TSV of groups to process, one per line (label, input, output), instead of a
+    /// single input
+    #[arg(long, conflicts_with_all = ["input", "output"])]
+    manifest: Option<String>,
+    /// Number of manifest groups to process concurrently
+    #[arg(short, long, default_value_t = 1)]
+    threads: usize,
+}
+
+// One group of a --manifest batch: a label for error messages plus its input and output paths
+struct ManifestEntry {
+    label: String,
+    input: String,
     output: String,
 }
 
@@ -36,16 +53,64 @@ fn find_column(header_fields: &[&str], name: &str) -> Result<usize> {
         .with_context(|| format!("Missing required column: {}", name))
 }
 
+// Read a --manifest file of (label, input, output) lines, skipping blank lines
+fn read_manifest(path: &str) -> Result<Vec<ManifestEntry>> {
+    let file = File::open(path).with_context(|| format!("Cannot open manifest: {}", path))?;
+    let mut entries = Vec::new();
+    for (line_num, line_result) in BufReader::new(file).lines().enumerate() {
+        let line = line_result.context("Failed to read manifest line")?;
+        if line.is_empty() {
+            continue;
+        }
+        let fields: Vec<&str> = line.split('\t').collect();
+        if fields.len() != 3 {
+            bail!(
+                "Manifest line {} has {} fields (expected label, input, output)",
+                line_num + 1,
+                fields.len()
+            );
+        }
+        entries.push(ManifestEntry {
+            label: fields[0].to_string(),
+            input: fields[1].to_string(),
+            output: fields[2].to_string(),
+        });
+    }
+    Ok(entries)
+}
+
+// Process manifest groups on up to `threads` worker threads, each claiming the next
+// unprocessed group until none remain; the first error is reported with its group label
+fn process_manifest(entries: &[ManifestEntry], threads: usize, metrics: &TaskMetrics) -> Result<()> {
+    let next = AtomicUsize::new(0);
+    let n_workers = threads.clamp(1, entries.len().max(1));
+    thread::scope(|scope| {
+        let workers: Vec<_> = (0..n_workers)
+            .map(|_| {
+                scope.spawn(|| -> Result<()> {
+                    loop {
+                        let Some(entry) = entries.get(next.fetch_add(1, Ordering::Relaxed)) else {
+                            return Ok(());
+                        };
+                        mark_similarity_duplicates(&entry.input, &entry.output, metrics)
+                            .with_context(|| format!("Group {}", entry.label))?;
+                    }
+                })
+            })
+            .collect();
+        workers
+            .into_iter()
+            .try_for_each(|worker| worker.join().expect("Worker thread panicked"))
+    })
+}
+
 // ------------------------------------------------------------------------------------------------
-// MAIN
+// DUPLICATE MARKING
 // ------------------------------------------------------------------------------------------------
 
-fn main() -> Result<()> {
-    let args = Args::parse();
-    let input_path = &args.input;
-    let output_path = &args.output;
-
+fn mark_similarity_duplicates(input_path: &str, output_path: &str, metrics: &TaskMetrics) -> Result<()> {
     let start_time = Instant::now();
+    let parse_phase = metrics.start_phase("parse");
 
     // Create deduplication context with default parameters
     let dedup_params = DedupParams::default();
@@ -62,7 +127,7 @@ fn main() -> Result<()> {
     let file = File::open(input_path)
         .with_context(|| format!("Cannot open input file: {}", input_path))?;
     let decoder = GzDecoder::new(file);
-    let reader = BufReader::new(decoder);
+    let reader = BufReader::new(metrics.count_reader(input_path, decoder));
     let mut lines = reader.lines();
 
     // Read header
@@ -142,8 +207,10 @@ fn main() -> Result<()> {
         alignment_unique_count, n_reads
     );
     eprintln!("Found {} unique sequence clusters", unique_clusters);
+    drop(parse_phase);
 
     // Finalize Pass 1
+    let group_phase = metrics.start_phase("group");
     ctx.finalize();
 
     // Compute similarity duplicate group sizes.
@@ -155,20 +222,22 @@ fn main() -> Result<()> {
         *group_sizes.entry(sim_exemplar).or_insert(0) += count;
     }
     drop(align_dup_counts);
+    drop(group_phase);
 
     // Pass 2: Write output with sim_dup_exemplar column
     eprintln!("Pass 2: Writing output with sim_dup_exemplar column...");
+    let write_phase = metrics.start_phase("write");
 
     let file_in = File::open(input_path)
         .with_context(|| format!("Cannot open input file: {}", input_path))?;
     let decoder = GzDecoder::new(file_in);
-    let reader = BufReader::new(decoder);
+    let reader = BufReader::new(metrics.count_reader(input_path, decoder));
     let mut lines = reader.lines();
 
     let file_out = File::create(output_path)
         .with_context(|| format!("Cannot create output file: {}", output_path))?;
     let encoder = GzEncoder::new(file_out, Compression::default());
-    let mut writer = BufWriter::new(encoder);
+    let mut writer = BufWriter::new(metrics.count_writer(output_path, encoder));
 
     // Skip header line and write stored header with new column
     lines.next();
@@ -228,6 +297,9 @@ fn main() -> Result<()> {
     }
 
     writer.flush().context("Failed to flush output")?;
+    // Close the output (writing the gzip trailer) before its size is recorded
+    drop(writer);
+    drop(write_phase);
 
     let elapsed = start_time.elapsed().as_secs();
     eprintln!("Done!");
@@ -242,3 +314,27 @@ fn main() -> Result<()> {
 
     Ok(())
 }
+
+// ------------------------------------------------------------------------------------------------
+// MAIN
+// ------------------------------------------------------------------------------------------------
+
+fn main() -> Result<()> {
+    let args = Args::parse();
+    let metrics = TaskMetrics::new("mark_duplicates_similarity");
+    match &args.manifest {
+        Some(manifest) => {
+            let entries = read_manifest(manifest)?;
+            process_manifest(&entries, args.threads, &metrics)?;
+        }
+        None => {
+            // clap requires both paths when no manifest is given
+            let (Some(input), Some(output)) = (&args.input, &args.output) else {
+                unreachable!("input and output paths are required without --manifest");
+            };
+            mark_similarity_duplicates(input, output, &metrics)?;
+        }
+    }
+    metrics.write().context("Failed to write task metrics")?;
+    Ok(())
+}
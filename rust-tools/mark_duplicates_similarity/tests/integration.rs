@@ -388,3 +388,84 @@ read1\tACGT\n";
         stderr
     );
 }
+
+#[test]
+fn test_manifest_matches_single_runs() {
+    let seq1 = "A".repeat(76);
+    let seq2 = "C".repeat(76);
+    let qual = "I".repeat(76);
+
+    let group1 = TestFiles::new("manifest_1");
+    group1.write_input(&build_tsv(&[
+        ("read1", &seq1, &qual, "read1"),
+        ("read2", &seq2, &qual, "read1"),
+        ("read3", &seq1, &qual, "read3"),
+    ]));
+    let group2 = TestFiles::new("manifest_2");
+    group2.write_input(&build_tsv(&[
+        ("read4", &seq2, &qual, "read4"),
+        ("read5", &seq1, &qual, "read5"),
+    ]));
+    let expected: Vec<Vec<String>> = [&group1, &group2]
+        .iter()
+        .map(|files| {
+            assert!(files.run().status.success());
+            read_gzipped_lines(&files.output_gz)
+        })
+        .collect();
+
+    // Rerun both groups as one manifest batch, writing to fresh outputs
+    let dir = group1.input_gz.parent().unwrap();
+    let outputs = [dir.join("batch_1.tsv.gz"), dir.join("batch_2.tsv.gz")];
+    let manifest = dir.join("manifest.tsv");
+    let manifest_content = format!(
+        "g1\t{}\t{}\ng2\t{}\t{}\n",
+        group1.input_gz.display(),
+        outputs[0].display(),
+        group2.input_gz.display(),
+        outputs[1].display()
+    );
+    std::fs::write(&manifest, manifest_content).unwrap();
+    let output = Command::new(binary_path())
+        .args(["--manifest", manifest.to_str().unwrap(), "-t", "2"])
+        .output()
+        .unwrap();
+    assert!(
+        output.status.success(),
+        "Binary failed: {}",
+        String::from_utf8_lossy(&output.stderr)
+    );
+
+    for (path, lines) in outputs.iter().zip(&expected) {
+        assert_eq!(&read_gzipped_lines(path), lines);
+    }
+}
+
+#[test]
+fn test_manifest_error_names_group() {
+    let files = TestFiles::new("manifest_err");
+    files.write_input("seq_id\tquery_seq\n");
+    let dir = files.input_gz.parent().unwrap();
+    let manifest = dir.join("manifest.tsv");
+    std::fs::write(
+        &manifest,
+        format!(
+            "bad_group\t{}\t{}\n",
+            files.input_gz.display(),
+            files.output_gz.display()
+        ),
+    )
+    .unwrap();
+
+    let output = Command::new(binary_path())
+        .args(["--manifest", manifest.to_str().unwrap()])
+        .output()
+        .unwrap();
+    assert!(!output.status.success());
+    let stderr = String::from_utf8_lossy(&output.stderr);
+    assert!(
+        stderr.contains("Group bad_group"),
+        "Expected group label in error, got: {}",
+        stderr
+    );
+}
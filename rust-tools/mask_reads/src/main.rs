@@ -0,0 +1,728 @@
+//! Multi-threaded low-complexity masker for FASTQ reads, replacing `bbmask.sh`'s entropy mode.
+//!
+//! For each read, slides a window of `window` bases along the sequence and computes the
+//! normalized Shannon entropy of the k-mers (default k=5) in that window, as BBMask does:
+//!   H = -sum_c (c / W) * ln(c / W) / ln(W),  W = window - k + 1
+//! where c ranges over the counts of the distinct k-mers in the window. Every window with
+//! no N bases and H < cutoff is masked to N. K-mer counts and the count-of-counts histogram
+//! are updated incrementally as the window slides, so each base costs O(1) updates plus one
+//! fixed-width pass over the W-entry histogram. Reads shorter than the window are untouched,
+//! as are quality strings.
+//!
+//! Optionally applies filtlong-style read filters (min/max length, min mean quality) in the
+//! same pass, writing the unmasked passing reads to a second output.
+//!
+//! Threading: the main thread parses FASTQ records into batches; worker threads filter, mask
+//! and gzip-compress each batch into an independent gzip member; a writer thread emits the
+//! members in input order. Concatenated gzip members are a valid gzip stream (as with pigz
+//! or BGZF), so outputs are readable by zcat/gzip.
+//!
+//! Metrics (see the task_metrics crate): since the stages overlap, "read" covers parsing the
+//! whole input, "process" the masking left when parsing ends, and "write" the output left when
+//! masking ends. Workers count each batch's uncompressed output before compressing it.
+
+// ------------------------------------------------------------------------------------------------
+// IMPORTS
+// ------------------------------------------------------------------------------------------------
+
+use std::collections::BTreeMap;
+use std::error::Error;
+use std::fs::File;
+use std::io::{self, BufRead, BufReader, BufWriter, Read, Write};
+use std::sync::mpsc::{sync_channel, Receiver};
+use std::sync::{Arc, Mutex};
+use std::thread;
+
+use clap::Parser;
+use flate2::read::MultiGzDecoder;
+use flate2::write::GzEncoder;
+use flate2::Compression;
+use task_metrics::{Counter, TaskMetrics};
+
+// ------------------------------------------------------------------------------------------------
+// ARGUMENT PARSING
+// ------------------------------------------------------------------------------------------------
+
+/// Mask low-complexity regions of FASTQ reads by sliding-window k-mer entropy
+#[derive(Parser)]
+#[command(author, version, about, long_about = None)]
+struct Args {
+    /// Input FASTQ path, gzipped or plain ("-" for stdin)
+    #[arg(short, long)]
+    input: String,
+    /// Output path for masked reads (gzipped FASTQ)
+    #[arg(short, long)]
+    output: String,
+    /// Optional output path for unmasked reads passing the length/quality filters (gzipped FASTQ)
+    #[arg(long)]
+    filtered_output: Option<String>,
+    /// Window size in bases (BBMask `window`)
+    #[arg(short, long, default_value_t = 80, value_parser = clap::value_parser!(u32).range(2..))]
+    window: u32,
+    /// Mask windows with entropy below this cutoff (BBMask `entropy`)
+    #[arg(short, long, default_value_t = 0.70)]
+    entropy: f32,
+    /// K-mer length used for entropy calculation (BBMask `ke`)
+    #[arg(short = 'k', long, default_value_t = 5, value_parser = clap::value_parser!(u32).range(1..=15))]
+    entropy_k: u32,
+    /// Discard reads shorter than this (filtlong `--min_length`)
+    #[arg(long)]
+    min_length: Option<usize>,
+    /// Discard reads longer than this (filtlong `--max_length`)
+    #[arg(long)]
+    max_length: Option<usize>,
+    /// Discard reads with mean base accuracy (0-100) below this (filtlong `--min_mean_q`)
+    #[arg(long)]
+    min_mean_q: Option<f64>,
+    /// Number of worker threads
+    #[arg(short = 't', long, default_value_t = 4, value_parser = clap::value_parser!(u32).range(1..))]
+    threads: u32,
+    /// Gzip compression level for outputs
+    #[arg(short = 'l', long, default_value_t = 1, value_parser = clap::value_parser!(u32).range(0..=9))]
+    compression_level: u32,
+    /// Number of reads per batch handed to a worker
+    #[arg(long, default_value_t = 2000, value_parser = clap::value_parser!(u32).range(1..))]
+    batch_size: u32,
+}
+
+// ------------------------------------------------------------------------------------------------
+// STRUCTS AND TYPES
+// ------------------------------------------------------------------------------------------------
+
+struct FastqRecord {
+    header: Vec<u8>,
+    seq: Vec<u8>,
+    plus: Vec<u8>,
+    qual: Vec<u8>,
+}
+
+struct Batch {
+    index: usize,
+    records: Vec<FastqRecord>,
+}
+
+#[derive(Default, Clone, Copy)]
+struct Counts {
+    reads_in: u64,
+    reads_out: u64,
+    bases_in: u64,
+    bases_masked: u64,
+}
+
+struct CompressedBatch {
+    index: usize,
+    masked: Vec<u8>,
+    filtered: Option<Vec<u8>>,
+    counts: Counts,
+}
+
+#[derive(Clone)]
+struct ReadFilter {
+    min_length: Option<usize>,
+    max_length: Option<usize>,
+    min_mean_q: Option<f64>,
+}
+
+const INVALID_KMER: u32 = u32::MAX;
+
+// Map bases to 2-bit codes; anything other than ACGT (either case) breaks k-mers like an N
+const fn base_codes() -> [u8; 256] {
+    let mut lut = [4u8; 256];
+    lut[b'A' as usize] = 0;
+    lut[b'a' as usize] = 0;
+    lut[b'C' as usize] = 1;
+    lut[b'c' as usize] = 1;
+    lut[b'G' as usize] = 2;
+    lut[b'g' as usize] = 2;
+    lut[b'T' as usize] = 3;
+    lut[b't' as usize] = 3;
+    lut
+}
+static BASE_CODES: [u8; 256] = base_codes();
+
+// ------------------------------------------------------------------------------------------------
+// ENTROPY MASKING
+// ------------------------------------------------------------------------------------------------
+
+/// Rolling k-mer entropy tracker, reused across reads to avoid per-read allocation
+struct EntropyMasker {
+    k: usize,
+    window: usize,
+    window_kmers: usize,
+    kmer_mask: u32,
+    cutoff: f32,
+    entropy_mult: f64,
+    // plogp[c] = (c / W) * ln(c / W), for c in 0..=W
+    plogp: Vec<f64>,
+    // Count of each k-mer within the current window
+    counts: Vec<u16>,
+    // count_counts[c] = number of distinct k-mers occurring c times in the window
+    count_counts: Vec<u32>,
+    // Ring buffer of the k-mers ending at the last W positions
+    ring: Vec<u32>,
+    intervals: Vec<(usize, usize)>,
+}
+
+impl EntropyMasker {
+    fn new(k: usize, window: usize, cutoff: f32) -> Result<Self, Box<dyn Error>> {
+        if window <= k {
+            return Err(
+                format!("Window ({}) must be longer than entropy k ({})", window, k).into(),
+            );
+        }
+        let window_kmers = window - k + 1;
+        let plogp = (0..=window_kmers)
+            .map(|c| {
+                if c == 0 {
+                    0.0
+                } else {
+                    let p = c as f64 / window_kmers as f64;
+                    p * p.ln()
+                }
+            })
+            .collect();
+        Ok(Self {
+            k,
+            window,
+            window_kmers,
+            kmer_mask: if k >= 16 {
+                u32::MAX
+            } else {
+                (1u32 << (2 * k)) - 1
+            },
+            cutoff,
+            entropy_mult: -1.0 / (window_kmers as f64).ln(),
+            plogp,
+            counts: vec![0; 1usize << (2 * k)],
+            count_counts: vec![0; window_kmers + 1],
+            ring: vec![INVALID_KMER; window_kmers],
+            intervals: Vec::new(),
+        })
+    }
+
+    fn reset(&mut self) {
+        for slot in self.ring.iter_mut() {
+            if *slot != INVALID_KMER {
+                self.counts[*slot as usize] = 0;
+            }
+            *slot = INVALID_KMER;
+        }
+        self.count_counts.iter_mut().for_each(|c| *c = 0);
+        self.intervals.clear();
+    }
+
+    #[inline]
+    fn add_kmer(&mut self, kmer: u32) {
+        let c = self.counts[kmer as usize] as usize;
+        if c > 0 {
+            self.count_counts[c] -= 1;
+        }
+        self.count_counts[c + 1] += 1;
+        self.counts[kmer as usize] += 1;
+    }
+
+    #[inline]
+    fn remove_kmer(&mut self, kmer: u32) {
+        let c = self.counts[kmer as usize] as usize;
+        self.count_counts[c] -= 1;
+        if c > 1 {
+            self.count_counts[c - 1] += 1;
+        }
+        self.counts[kmer as usize] -= 1;
+    }
+
+    /// Normalized entropy of the current window (all W k-mers must be valid)
+    #[inline]
+    fn entropy(&self) -> f32 {
+        // Fixed-width dot product over the count histogram; c = 0 contributes nothing
+        let sum: f64 = self.count_counts[1..]
+            .iter()
+            .zip(&self.plogp[1..])
+            .map(|(&n, &p)| n as f64 * p)
+            .sum();
+        (sum * self.entropy_mult) as f32
+    }
+
+    /// Mask low-entropy windows of `seq` to N in place; returns the number of bases masked
+    fn mask(&mut self, seq: &mut [u8]) -> usize {
+        let n = seq.len();
+        if n < self.window {
+            return 0;
+        }
+        self.reset();
+        let mut kmer: u32 = 0;
+        let mut defined_run = 0usize;
+        let mut ns_in_window = 0usize;
+        for i in 0..n {
+            let code = BASE_CODES[seq[i] as usize];
+            if code < 4 {
+                kmer = ((kmer << 2) | code as u32) & self.kmer_mask;
+                defined_run += 1;
+            } else {
+                defined_run = 0;
+                ns_in_window += 1;
+            }
+            if i >= self.window && BASE_CODES[seq[i - self.window] as usize] >= 4 {
+                ns_in_window -= 1;
+            }
+            // Slide the k-mer window: drop the k-mer ending W positions ago, add this one
+            let slot = i % self.window_kmers;
+            let old = self.ring[slot];
+            if old != INVALID_KMER {
+                self.remove_kmer(old);
+            }
+            let new = if defined_run >= self.k {
+                kmer
+            } else {
+                INVALID_KMER
+            };
+            self.ring[slot] = new;
+            if new != INVALID_KMER {
+                self.add_kmer(new);
+            }
+            if i + 1 >= self.window && ns_in_window == 0 && self.entropy() < self.cutoff {
+                let start = i + 1 - self.window;
+                match self.intervals.last_mut() {
+                    Some(last) if start <= last.1 + 1 => last.1 = i,
+                    _ => self.intervals.push((start, i)),
+                }
+            }
+        }
+        let mut masked = 0;
+        for &(start, end) in &self.intervals {
+            for base in &mut seq[start..=end] {
+                if *base != b'N' {
+                    *base = b'N';
+                    masked += 1;
+                }
+            }
+        }
+        masked
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+// FILTERING
+// ------------------------------------------------------------------------------------------------
+
+/// Mean per-base accuracy on a 0-100 scale, as used by filtlong's `--min_mean_q`
+fn mean_accuracy(qual: &[u8]) -> f64 {
+    if qual.is_empty() {
+        return 0.0;
+    }
+    let error_sum: f64 = qual
+        .iter()
+        .map(|&q| 10f64.powf(-((q.saturating_sub(33)) as f64) / 10.0))
+        .sum();
+    100.0 * (1.0 - error_sum / qual.len() as f64)
+}
+
+impl ReadFilter {
+    fn is_active(&self) -> bool {
+        self.min_length.is_some() || self.max_length.is_some() || self.min_mean_q.is_some()
+    }
+
+    fn passes(&self, record: &FastqRecord) -> bool {
+        let len = record.seq.len();
+        if self.min_length.is_some_and(|min| len < min)
+            || self.max_length.is_some_and(|max| len > max)
+        {
+            return false;
+        }
+        match self.min_mean_q {
+            Some(min_q) => mean_accuracy(&record.qual) >= min_q,
+            None => true,
+        }
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+// I/O
+// ------------------------------------------------------------------------------------------------
+
+// Open a FASTQ input, transparently decompressing gzip (like `zcat -f`), counting decompressed
+// input in the metrics
+fn open_input(path: &str, metrics: &TaskMetrics) -> io::Result<Box<dyn BufRead + Send>> {
+    let raw: Box<dyn Read + Send> = if path == "-" {
+        Box::new(io::stdin())
+    } else {
+        Box::new(File::open(path)?)
+    };
+    let mut reader = BufReader::with_capacity(1 << 20, raw);
+    let is_gzip = {
+        let buf = reader.fill_buf()?;
+        buf.len() >= 2 && buf[0] == 0x1f && buf[1] == 0x8b
+    };
+    if is_gzip {
+        Ok(Box::new(BufReader::with_capacity(
+            1 << 20,
+            metrics.count_reader(path, MultiGzDecoder::new(reader)),
+        )))
+    } else {
+        Ok(Box::new(BufReader::with_capacity(
+            1 << 20,
+            metrics.count_reader(path, reader),
+        )))
+    }
+}
+
+fn read_line_trimmed(reader: &mut dyn BufRead, buf: &mut Vec<u8>) -> io::Result<bool> {
+    buf.clear();
+    if reader.read_until(b'\n', buf)? == 0 {
+        return Ok(false);
+    }
+    while buf.last().is_some_and(|&b| b == b'\n' || b == b'\r') {
+        buf.pop();
+    }
+    Ok(true)
+}
+
+fn read_record(
+    reader: &mut dyn BufRead,
+    line_num: &mut u64,
+) -> Result<Option<FastqRecord>, Box<dyn Error>> {
+    let mut header = Vec::new();
+    if !read_line_trimmed(reader, &mut header)? {
+        return Ok(None);
+    }
+    if header.is_empty() {
+        // Tolerate trailing blank lines
+        return read_record(reader, line_num);
+    }
+    let mut seq = Vec::new();
+    let mut plus = Vec::new();
+    let mut qual = Vec::new();
+    let complete = read_line_trimmed(reader, &mut seq)?
+        && read_line_trimmed(reader, &mut plus)?
+        && read_line_trimmed(reader, &mut qual)?;
+    *line_num += 4;
+    if !complete {
+        return Err(format!("Truncated FASTQ record ending at line {}", line_num).into());
+    }
+    if header[0] != b'@' || plus.first() != Some(&b'+') || seq.len() != qual.len() {
+        return Err(format!("Malformed FASTQ record ending at line {}", line_num).into());
+    }
+    Ok(Some(FastqRecord {
+        header,
+        seq,
+        plus,
+        qual,
+    }))
+}
+
+fn write_record(out: &mut Vec<u8>, record: &FastqRecord, seq: &[u8]) {
+    out.extend_from_slice(&record.header);
+    out.push(b'\n');
+    out.extend_from_slice(seq);
+    out.push(b'\n');
+    out.extend_from_slice(&record.plus);
+    out.push(b'\n');
+    out.extend_from_slice(&record.qual);
+    out.push(b'\n');
+}
+
+fn gzip_member(data: &[u8], level: u32) -> io::Result<Vec<u8>> {
+    let mut encoder = GzEncoder::new(Vec::with_capacity(data.len() / 3), Compression::new(level));
+    encoder.write_all(data)?;
+    encoder.finish()
+}
+
+// ------------------------------------------------------------------------------------------------
+// WORKERS
+// ------------------------------------------------------------------------------------------------
+
+fn process_batch(
+    batch: Batch,
+    masker: &mut EntropyMasker,
+    filter: &ReadFilter,
+    write_filtered: bool,
+    level: u32,
+    written: &Counter,
+) -> io::Result<CompressedBatch> {
+    let mut counts = Counts::default();
+    let mut masked_buf = Vec::new();
+    let mut filtered_buf = Vec::new();
+    let mut seq = Vec::new();
+    for record in &batch.records {
+        counts.reads_in += 1;
+        counts.bases_in += record.seq.len() as u64;
+        if !filter.passes(record) {
+            continue;
+        }
+        counts.reads_out += 1;
+        if write_filtered {
+            write_record(&mut filtered_buf, record, &record.seq);
+        }
+        seq.clear();
+        seq.extend_from_slice(&record.seq);
+        counts.bases_masked += masker.mask(&mut seq) as u64;
+        write_record(&mut masked_buf, record, &seq);
+    }
+    written.add(&masked_buf);
+    written.add(&filtered_buf);
+    Ok(CompressedBatch {
+        index: batch.index,
+        masked: gzip_member(&masked_buf, level)?,
+        filtered: if write_filtered {
+            Some(gzip_member(&filtered_buf, level)?)
+        } else {
+            None
+        },
+        counts,
+    })
+}
+
+fn write_in_order(
+    receiver: Receiver<io::Result<CompressedBatch>>,
+    masked_path: String,
+    filtered_path: Option<String>,
+    level: u32,
+) -> io::Result<Counts> {
+    let mut masked_out = BufWriter::new(File::create(&masked_path)?);
+    let mut filtered_out = match &filtered_path {
+        Some(path) => Some(BufWriter::new(File::create(path)?)),
+        None => None,
+    };
+    let mut pending: BTreeMap<usize, CompressedBatch> = BTreeMap::new();
+    let mut next = 0usize;
+    let mut totals = Counts::default();
+    for result in receiver {
+        let batch = result?;
+        pending.insert(batch.index, batch);
+        while let Some(batch) = pending.remove(&next) {
+            masked_out.write_all(&batch.masked)?;
+            if let (Some(out), Some(data)) = (filtered_out.as_mut(), batch.filtered.as_ref()) {
+                out.write_all(data)?;
+            }
+            totals.reads_in += batch.counts.reads_in;
+            totals.reads_out += batch.counts.reads_out;
+            totals.bases_in += batch.counts.bases_in;
+            totals.bases_masked += batch.counts.bases_masked;
+            next += 1;
+        }
+    }
+    // Empty input still yields valid (empty) gzip outputs
+    if next == 0 {
+        masked_out.write_all(&gzip_member(&[], level)?)?;
+        if let Some(out) = filtered_out.as_mut() {
+            out.write_all(&gzip_member(&[], level)?)?;
+        }
+    }
+    masked_out.flush()?;
+    if let Some(out) = filtered_out.as_mut() {
+        out.flush()?;
+    }
+    Ok(totals)
+}
+
+// ------------------------------------------------------------------------------------------------
+// MAIN
+// ------------------------------------------------------------------------------------------------
+
+fn main() -> Result<(), Box<dyn Error>> {
+    let args = Args::parse();
+    let filter = ReadFilter {
+        min_length: args.min_length,
+        max_length: args.max_length,
+        min_mean_q: args.min_mean_q,
+    };
+    if args.filtered_output.is_some() && !filter.is_active() {
+        eprintln!("Warning: --filtered-output given without any filter; it will copy the input.");
+    }
+    // Validate masking parameters up front rather than in each worker
+    EntropyMasker::new(args.entropy_k as usize, args.window as usize, args.entropy)?;
+
+    let n_workers = args.threads as usize;
+    let level = args.compression_level;
+    let write_filtered = args.filtered_output.is_some();
+    let metrics = TaskMetrics::new("mask_reads");
+    metrics.add_output(&args.output);
+    if let Some(path) = &args.filtered_output {
+        metrics.add_output(path);
+    }
+    let (batch_tx, batch_rx) = sync_channel::<Batch>(n_workers * 2);
+    let batch_rx = Arc::new(Mutex::new(batch_rx));
+    let (out_tx, out_rx) = sync_channel::<io::Result<CompressedBatch>>(n_workers * 2);
+
+    let writer = {
+        let masked_path = args.output.clone();
+        let filtered_path = args.filtered_output.clone();
+        thread::spawn(move || write_in_order(out_rx, masked_path, filtered_path, level))
+    };
+    let workers: Vec<_> = (0..n_workers)
+        .map(|_| {
+            let batch_rx = Arc::clone(&batch_rx);
+            let out_tx = out_tx.clone();
+            let filter = filter.clone();
+            let (k, window, cutoff) = (args.entropy_k as usize, args.window as usize, args.entropy);
+            let written = metrics.written_counter();
+            thread::spawn(move || {
+                let mut masker = EntropyMasker::new(k, window, cutoff).expect("validated above");
+                loop {
+                    let batch = match batch_rx.lock().unwrap().recv() {
+                        Ok(batch) => batch,
+                        Err(_) => break,
+                    };
+                    let result =
+                        process_batch(batch, &mut masker, &filter, write_filtered, level, &written);
+                    if out_tx.send(result).is_err() {
+                        break;
+                    }
+                }
+            })
+        })
+        .collect();
+    drop(out_tx);
+
+    // Parse input on the main thread and hand batches to the workers
+    let parse_timer = metrics.start_phase("read");
+    let parse_result: Result<(), Box<dyn Error>> = (|| {
+        let mut reader = open_input(&args.input, &metrics)?;
+        let mut line_num = 0u64;
+        let mut index = 0usize;
+        let mut records = Vec::with_capacity(args.batch_size as usize);
+        while let Some(record) = read_record(reader.as_mut(), &mut line_num)? {
+            records.push(record);
+            if records.len() >= args.batch_size as usize {
+                let full =
+                    std::mem::replace(&mut records, Vec::with_capacity(args.batch_size as usize));
+                batch_tx.send(Batch {
+                    index,
+                    records: full,
+                })?;
+                index += 1;
+            }
+        }
+        if !records.is_empty() {
+            batch_tx.send(Batch { index, records })?;
+        }
+        Ok(())
+    })();
+    drop(batch_tx);
+    drop(parse_timer);
+    metrics.phase("process", || -> Result<(), Box<dyn Error>> {
+        for worker in workers {
+            worker.join().map_err(|_| "Worker thread panicked")?;
+        }
+        Ok(())
+    })?;
+    let totals = metrics.phase("write", || {
+        writer.join().map_err(|_| "Writer thread panicked")
+    })??;
+    parse_result?;
+    metrics.write()?;
+
+    eprintln!(
+        "Reads in: {}, reads out: {}, bases in: {}, bases masked: {}",
+        totals.reads_in, totals.reads_out, totals.bases_in, totals.bases_masked
+    );
+    Ok(())
+}
+
+// ------------------------------------------------------------------------------------------------
+// TESTS
+// ------------------------------------------------------------------------------------------------
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    // Reference implementation: recompute each window's entropy from scratch
+    fn naive_mask(seq: &[u8], k: usize, window: usize, cutoff: f32) -> Vec<u8> {
+        let mut out = seq.to_vec();
+        if seq.len() < window {
+            return out;
+        }
+        let w = window - k + 1;
+        for start in 0..=(seq.len() - window) {
+            let win = &seq[start..start + window];
+            if win.iter().any(|&b| BASE_CODES[b as usize] >= 4) {
+                continue;
+            }
+            let mut counts = std::collections::HashMap::new();
+            for kmer in win.windows(k) {
+                *counts.entry(kmer.to_ascii_uppercase()).or_insert(0usize) += 1;
+            }
+            let sum: f64 = counts
+                .values()
+                .map(|&c| {
+                    let p = c as f64 / w as f64;
+                    p * p.ln()
+                })
+                .sum();
+            let entropy = (sum * (-1.0 / (w as f64).ln())) as f32;
+            if entropy < cutoff {
+                out[start..start + window]
+                    .iter_mut()
+                    .for_each(|b| *b = b'N');
+            }
+        }
+        out
+    }
+
+    fn lcg_sequence(len: usize, seed: u64) -> Vec<u8> {
+        let mut state = seed;
+        (0..len)
+            .map(|_| {
+                state = state
+                    .wrapping_mul(6364136223846793005)
+                    .wrapping_add(1442695040888963407);
+                b"ACGT"[(state >> 62) as usize]
+            })
+            .collect()
+    }
+
+    #[test]
+    fn test_homopolymer_is_masked() {
+        let mut masker = EntropyMasker::new(5, 25, 0.55).unwrap();
+        let mut seq = vec![b'A'; 40];
+        assert_eq!(masker.mask(&mut seq), 40);
+        assert!(seq.iter().all(|&b| b == b'N'));
+    }
+
+    #[test]
+    fn test_short_read_untouched() {
+        let mut masker = EntropyMasker::new(5, 25, 0.55).unwrap();
+        let mut seq = vec![b'A'; 24];
+        assert_eq!(masker.mask(&mut seq), 0);
+        assert_eq!(seq, vec![b'A'; 24]);
+    }
+
+    #[test]
+    fn test_matches_naive_recomputation() {
+        let mut masker = EntropyMasker::new(5, 25, 0.55).unwrap();
+        for seed in 0..50u64 {
+            // Random flanks around a dinucleotide repeat, with an N in some reads
+            let mut seq = lcg_sequence(60, seed);
+            seq.extend(b"ACACACACACACACACACACACACACACAC");
+            seq.extend(lcg_sequence(60, seed + 1000));
+            if seed % 3 == 0 {
+                seq[(seed as usize * 7) % 150] = b'N';
+            }
+            let expected = naive_mask(&seq, 5, 25, 0.55);
+            let mut actual = seq.clone();
+            masker.mask(&mut actual);
+            assert_eq!(
+                String::from_utf8_lossy(&actual),
+                String::from_utf8_lossy(&expected),
+                "seed {}",
+                seed
+            );
+        }
+    }
+
+    #[test]
+    fn test_window_with_n_is_skipped() {
+        let mut masker = EntropyMasker::new(5, 25, 0.55).unwrap();
+        let mut seq = vec![b'A'; 25];
+        seq[12] = b'N';
+        assert_eq!(masker.mask(&mut seq), 0);
+    }
+
+    #[test]
+    fn test_mean_accuracy() {
+        // Q10 everywhere -> 90% accuracy; Q20 -> 99%
+        assert!((mean_accuracy(&[b'+'; 10]) - 90.0).abs() < 1e-9);
+        assert!((mean_accuracy(&[b'5'; 10]) - 99.0).abs() < 1e-9);
+    }
+}
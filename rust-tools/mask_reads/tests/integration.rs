@@ -0,0 +1,220 @@
+use std::fs::{self, File};
+use std::io::{BufRead, BufReader, Write};
+use std::path::PathBuf;
+use std::process::Command;
+
+use flate2::read::MultiGzDecoder;
+use flate2::write::GzEncoder;
+use flate2::Compression;
+
+fn binary_path() -> PathBuf {
+    PathBuf::from(env!("CARGO_BIN_EXE_mask_reads"))
+}
+
+fn fixtures_dir() -> PathBuf {
+    PathBuf::from(env!("CARGO_MANIFEST_DIR")).join("tests/fixtures")
+}
+
+fn gzip_content(content: &str, output_path: &PathBuf) {
+    let file = File::create(output_path).unwrap();
+    let mut encoder = GzEncoder::new(file, Compression::default());
+    encoder.write_all(content.as_bytes()).unwrap();
+}
+
+fn read_gzipped_lines(path: &PathBuf) -> Vec<String> {
+    let file = File::open(path).unwrap();
+    BufReader::new(MultiGzDecoder::new(file))
+        .lines()
+        .map(|l| l.unwrap())
+        .collect()
+}
+
+struct TestFiles {
+    input_gz: PathBuf,
+    masked: PathBuf,
+    filtered: PathBuf,
+}
+
+impl TestFiles {
+    fn new(prefix: &str) -> Self {
+        Self::with_content(
+            prefix,
+            &fs::read_to_string(fixtures_dir().join("tiny.fastq")).unwrap(),
+        )
+    }
+
+    fn with_content(prefix: &str, content: &str) -> Self {
+        let fixtures = fixtures_dir();
+        let input_gz = fixtures.join(format!("{}.fastq.gz", prefix));
+        gzip_content(content, &input_gz);
+        Self {
+            input_gz,
+            masked: fixtures.join(format!("{}_masked.fastq.gz", prefix)),
+            filtered: fixtures.join(format!("{}_filtered.fastq.gz", prefix)),
+        }
+    }
+
+    fn run(&self, extra_args: &[&str]) -> std::process::Output {
+        let output = Command::new(binary_path())
+            .arg("-i")
+            .arg(&self.input_gz)
+            .arg("-o")
+            .arg(&self.masked)
+            .args(extra_args)
+            .output()
+            .unwrap();
+        assert!(
+            output.status.success(),
+            "stderr: {}",
+            String::from_utf8_lossy(&output.stderr)
+        );
+        output
+    }
+}
+
+impl Drop for TestFiles {
+    fn drop(&mut self) {
+        fs::remove_file(&self.input_gz).ok();
+        fs::remove_file(&self.masked).ok();
+        fs::remove_file(&self.filtered).ok();
+    }
+}
+
+fn sequences(lines: &[String]) -> Vec<&str> {
+    lines
+        .iter()
+        .skip(1)
+        .step_by(4)
+        .map(|s| s.as_str())
+        .collect()
+}
+
+#[test]
+fn test_masks_low_complexity_regions() {
+    let files = TestFiles::new("masks_low_complexity");
+    files.run(&["-w", "25", "-e", "0.55"]);
+    let input = read_gzipped_lines(&files.input_gz);
+    let masked = read_gzipped_lines(&files.masked);
+    assert_eq!(input.len(), masked.len());
+    let (in_seqs, out_seqs) = (sequences(&input), sequences(&masked));
+    // Random read untouched
+    assert_eq!(in_seqs[0], out_seqs[0]);
+    // Poly-A core masked, flanks mostly preserved
+    assert!(out_seqs[1].contains(&"N".repeat(40)));
+    assert!(out_seqs[1].len() == in_seqs[1].len() && !out_seqs[1].starts_with('N'));
+    // Reads shorter than the window are untouched
+    assert_eq!(in_seqs[2], out_seqs[2]);
+    // Dinucleotide repeat masked
+    assert!(out_seqs[3].contains(&"N".repeat(50)));
+    // Headers and qualities are unchanged
+    for (i, (a, b)) in input.iter().zip(masked.iter()).enumerate() {
+        if i % 4 != 1 {
+            assert_eq!(a, b);
+        }
+    }
+}
+
+#[test]
+fn test_fused_filters() {
+    let files = TestFiles::new("fused_filters");
+    let filtered = files.filtered.to_str().unwrap().to_string();
+    files.run(&[
+        "-w",
+        "25",
+        "-e",
+        "0.55",
+        "--min-length",
+        "50",
+        "--max-length",
+        "1000",
+        "--min-mean-q",
+        "90",
+        "--filtered-output",
+        &filtered,
+    ]);
+    let masked = read_gzipped_lines(&files.masked);
+    let unmasked = read_gzipped_lines(&files.filtered);
+    let headers: Vec<&str> = masked.iter().step_by(4).map(|s| s.as_str()).collect();
+    // read3 is too short, read5 is Q2 throughout
+    assert_eq!(
+        headers,
+        vec!["@read1 random", "@read2 polyA_core", "@read4 dinucleotide"]
+    );
+    assert_eq!(unmasked.len(), masked.len());
+    let input = read_gzipped_lines(&files.input_gz);
+    assert_eq!(unmasked[0..8], input[0..8]);
+    assert!(!sequences(&unmasked)[1].contains('N'));
+}
+
+#[test]
+fn test_output_independent_of_threads_and_batching() {
+    let files = TestFiles::new("threads_and_batching");
+    files.run(&["-w", "25", "-e", "0.55", "-t", "1"]);
+    let single = read_gzipped_lines(&files.masked);
+    files.run(&["-w", "25", "-e", "0.55", "-t", "4", "--batch-size", "1"]);
+    let multi = read_gzipped_lines(&files.masked);
+    assert_eq!(single, multi);
+}
+
+#[test]
+fn test_empty_input() {
+    let files = TestFiles::with_content("empty_input", "");
+    let filtered = files.filtered.to_str().unwrap().to_string();
+    files.run(&["--min-length", "10", "--filtered-output", &filtered]);
+    assert!(read_gzipped_lines(&files.masked).is_empty());
+    assert!(read_gzipped_lines(&files.filtered).is_empty());
+}
+
+#[test]
+fn test_truncated_input_fails() {
+    let files = TestFiles::with_content("truncated_input", "@read1\nACGT\n+\n");
+    let output = Command::new(binary_path())
+        .arg("-i")
+        .arg(&files.input_gz)
+        .arg("-o")
+        .arg(&files.masked)
+        .output()
+        .unwrap();
+    assert!(!output.status.success());
+    assert!(String::from_utf8_lossy(&output.stderr).contains("Truncated"));
+}
+
+#[test]
+fn test_task_metrics() {
+    let files = TestFiles::new("metrics");
+    let workdir = fixtures_dir().join("metrics_workdir");
+    fs::create_dir_all(&workdir).unwrap();
+    let filtered = files.filtered.to_str().unwrap().to_string();
+    let output = Command::new(binary_path())
+        .current_dir(&workdir)
+        .env("NAO_TASK_METRICS", "1")
+        .arg("-i")
+        .arg(&files.input_gz)
+        .arg("-o")
+        .arg(&files.masked)
+        .args(["--filtered-output", &filtered])
+        .output()
+        .unwrap();
+    let json = fs::read_to_string(workdir.join("mask_reads.metrics.json"));
+    fs::remove_dir_all(&workdir).ok();
+    assert!(
+        output.status.success(),
+        "stderr: {}",
+        String::from_utf8_lossy(&output.stderr)
+    );
+    let json = json.unwrap();
+    // All 20 input lines are written to both outputs
+    assert!(
+        json.contains("\"rows_in\": 20,\n  \"rows_out\": 40,"),
+        "Metrics: {}",
+        json
+    );
+    for phase in ["read", "process", "write"] {
+        assert!(
+            json.contains(&format!("\"{}\": {{", phase)),
+            "Missing phase {}: {}",
+            phase,
+            json
+        );
+    }
+}
@@ -1,6 +1,8 @@
 //! Two-pass streaming processor for VSEARCH UC format:
 //!   Pass 1: Scan file to build cluster_size and cluster_rep lookup tables
 //!   Pass 2: Stream through again, enriching each sequence record with cluster metadata
+//! Metrics (see the task_metrics crate) time pass 1 as "read", ranking the largest clusters
+//! as "process", and pass 2 and the representative IDs as "write".
 
 use std::collections::HashMap;
 use std::error::Error;
@@ -11,6 +13,7 @@ use clap::Parser;
 use flate2::read::GzDecoder;
 use flate2::write::GzEncoder;
 use flate2::Compression;
+use task_metrics::{CountingReader, CountingWriter, TaskMetrics};
 
 // UC format column indices
 const REC_TYPE: usize = 0;
@@ -46,14 +49,21 @@ struct Args {
     output_prefix: String,
 }
 
-fn open_gz_reader(path: &str) -> Result<BufReader<GzDecoder<File>>, Box<dyn Error>> {
+// Readers and writers count decompressed input and uncompressed output in the metrics
+fn open_gz_reader(
+    path: &str,
+    metrics: &TaskMetrics,
+) -> Result<BufReader<CountingReader<GzDecoder<File>>>, Box<dyn Error>> {
     let file = File::open(path)?;
-    Ok(BufReader::new(GzDecoder::new(file)))
+    Ok(BufReader::new(metrics.count_reader(path, GzDecoder::new(file))))
 }
 
-fn open_gz_writer(path: &str) -> Result<BufWriter<GzEncoder<File>>, Box<dyn Error>> {
+fn open_gz_writer(
+    path: &str,
+    metrics: &TaskMetrics,
+) -> Result<BufWriter<CountingWriter<GzEncoder<File>>>, Box<dyn Error>> {
     let file = File::create(path)?;
-    Ok(BufWriter::new(GzEncoder::new(file, Compression::default())))
+    Ok(BufWriter::new(metrics.count_writer(path, GzEncoder::new(file, Compression::default()))))
 }
 
 fn parse_field<T: std::str::FromStr>(
@@ -85,10 +95,10 @@ struct LookupTables {
 }
 
 /// Pass 1: Build cluster_sizes and cluster_reps lookup tables
-fn build_lookup_tables(input_path: &str) -> Result<LookupTables, Box<dyn Error>> {
+fn build_lookup_tables(input_path: &str, metrics: &TaskMetrics) -> Result<LookupTables, Box<dyn Error>> {
     eprintln!("Pass 1: Building lookup tables...");
 
-    let reader = open_gz_reader(input_path)?;
+    let reader = open_gz_reader(input_path, metrics)?;
     let mut cluster_sizes: HashMap<u64, u64> = HashMap::new();
     let mut cluster_reps: HashMap<u64, String> = HashMap::new();
 
@@ -128,11 +138,12 @@ fn write_tsv_output(
     output_path: &str,
     prefix: &str,
     cluster_sizes: &HashMap<u64, u64>,
+    metrics: &TaskMetrics,
 ) -> Result<(), Box<dyn Error>> {
     eprintln!("Pass 2: Writing TSV output...");
 
-    let reader = open_gz_reader(input_path)?;
-    let mut writer = open_gz_writer(output_path)?;
+    let reader = open_gz_reader(input_path, metrics)?;
+    let mut writer = open_gz_writer(output_path, metrics)?;
     writeln!(writer, "{}", format_header(prefix))?;
 
     let mut records_written = 0;
@@ -174,7 +185,8 @@ fn write_tsv_output(
         }
     }
 
-    writer.flush()?;
+    // Finish the gzip stream here so the phase covers compression and the file size is final
+    writer.into_inner().map_err(|e| e.into_error())?.into_inner().finish()?;
     eprintln!("Pass 2 complete: {} records written", records_written);
     Ok(())
 }
@@ -185,19 +197,23 @@ fn write_top_representatives(
     n_clusters: usize,
     cluster_sizes: &HashMap<u64, u64>,
     cluster_reps: &HashMap<u64, String>,
+    metrics: &TaskMetrics,
 ) -> Result<(), Box<dyn Error>> {
     eprintln!("Step 3: Extracting top {} representative IDs...", n_clusters);
 
-    let mut clusters: Vec<(u64, &String)> = cluster_reps
-        .iter()
-        .filter_map(|(cluster_id, rep_id)| cluster_sizes.get(cluster_id).map(|&size| (size, rep_id)))
-        .collect();
-
-    // Sort by cluster_size descending, then representative_id ascending (tie-breaker)
-    clusters.sort_by(|a, b| b.0.cmp(&a.0).then_with(|| a.1.cmp(b.1)));
-
+    let clusters = metrics.phase("process", || {
+        let mut clusters: Vec<(u64, &String)> = cluster_reps
+            .iter()
+            .filter_map(|(cluster_id, rep_id)| cluster_sizes.get(cluster_id).map(|&size| (size, rep_id)))
+            .collect();
+        // Sort by cluster_size descending, then representative_id ascending (tie-breaker)
+        clusters.sort_by(|a, b| b.0.cmp(&a.0).then_with(|| a.1.cmp(b.1)));
+        clusters
+    });
+
+    let _timer = metrics.start_phase("write");
     let file = File::create(output_path)?;
-    let mut writer = BufWriter::new(file);
+    let mut writer = BufWriter::new(metrics.count_writer(output_path, file));
     let n = std::cmp::min(n_clusters, clusters.len());
     for (_, rep_id) in clusters.iter().take(n) {
         writeln!(writer, "{}", rep_id)?;
@@ -218,9 +234,14 @@ fn main() -> Result<(), Box<dyn Error>> {
     eprintln!("  N clusters: {}", args.n_clusters);
     eprintln!("  Prefix: {}", if args.output_prefix.is_empty() { "(none)" } else { &args.output_prefix });
 
-    let tables = build_lookup_tables(&args.vsearch_db)?;
-    write_tsv_output(&args.vsearch_db, &args.output_db, &args.output_prefix, &tables.cluster_sizes)?;
-    write_top_representatives(&args.output_ids, args.n_clusters, &tables.cluster_sizes, &tables.cluster_reps)?;
+    // Write metrics once outputs are closed
+    let metrics = TaskMetrics::new("process_vsearch_cluster_output");
+    let tables = metrics.phase("read", || build_lookup_tables(&args.vsearch_db, &metrics))?;
+    metrics.phase("write", || {
+        write_tsv_output(&args.vsearch_db, &args.output_db, &args.output_prefix, &tables.cluster_sizes, &metrics)
+    })?;
+    write_top_representatives(&args.output_ids, args.n_clusters, &tables.cluster_sizes, &tables.cluster_reps, &metrics)?;
+    metrics.write()?;
 
     eprintln!("Done.");
     Ok(())
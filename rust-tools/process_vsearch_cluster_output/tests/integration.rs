@@ -178,3 +178,32 @@ fn test_error_on_malformed_input() {
     let stderr = String::from_utf8_lossy(&output.stderr);
     assert!(stderr.contains("expected") && stderr.contains("fields"), "Error: {}", stderr);
 }
+
+#[test]
+fn test_task_metrics() {
+    let files = TestFiles::new("metrics");
+    let workdir = fixtures_dir().join("metrics_workdir");
+    fs::create_dir_all(&workdir).unwrap();
+
+    let output = Command::new(binary_path())
+        .current_dir(&workdir)
+        .env("NAO_TASK_METRICS", "1")
+        .args([
+            files.input_gz.to_str().unwrap(),
+            files.output_tsv.to_str().unwrap(),
+            files.output_ids.to_str().unwrap(),
+            "-n", "2",
+        ])
+        .output()
+        .unwrap();
+    let json = fs::read_to_string(workdir.join("process_vsearch_cluster_output.metrics.json"));
+    fs::remove_dir_all(&workdir).ok();
+
+    assert!(output.status.success(), "Failed: {}", String::from_utf8_lossy(&output.stderr));
+    let json = json.unwrap();
+    // Both passes read the 9 input lines; 7 TSV lines and 2 IDs are written
+    assert!(json.contains("\"rows_in\": 18,\n  \"rows_out\": 9,"), "Metrics: {}", json);
+    for phase in ["read", "process", "write"] {
+        assert!(json.contains(&format!("\"{}\": {{", phase)), "Missing phase {}: {}", phase, json);
+    }
+}
@@ -0,0 +1,396 @@
+//! Per-task metrics shared by the workspace tools.
+//!
+//! A `TaskMetrics` records what one run of a tool did: lines and bytes through its files
+//! (on disk and uncompressed), wall and CPU time per named phase (e.g. parse, group, write),
+//! and peak RSS. When `NAO_TASK_METRICS` is set (see the workflow's `task_metrics` parameter)
+//! it is written to `<tool>.metrics.json` in the task directory, in the same schema as the
+//! Python scripts' `nao_io.TaskMetrics`, for `bin/collect_task_metrics.py` to gather.
+//!
+//! Lines and uncompressed bytes are counted by wrapping decompressed readers and
+//! pre-compression writers with `count_reader`/`count_writer`; files are counted each time
+//! they are read, so two-pass tools report their input twice. Tools that compress blocks on
+//! worker threads can instead count each uncompressed block with `Counter::add`, after
+//! recording the output with `add_output`.
+
+use std::fs;
+use std::io::{self, Read, Write};
+use std::path::{Path, PathBuf};
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::{Arc, Mutex};
+use std::time::Instant;
+
+/// Suffix of metrics files, after the tool name
+pub const METRICS_SUFFIX: &str = ".metrics.json";
+
+/// Whether tools should write metrics files, from `NAO_TASK_METRICS`.
+pub fn enabled() -> bool {
+    match std::env::var("NAO_TASK_METRICS") {
+        Ok(value) => !matches!(value.to_lowercase().as_str(), "" | "0" | "false"),
+        Err(_) => false,
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+// COUNTERS
+// ------------------------------------------------------------------------------------------------
+
+/// Bytes and lines passing through one side (read or written) of a tool; cheap to clone
+/// into readers and writers on other threads.
+#[derive(Clone, Debug, Default)]
+pub struct Counter(Arc<(AtomicU64, AtomicU64)>);
+
+impl Counter {
+    /// Count data passing through outside a counting reader or writer.
+    pub fn add(&self, data: &[u8]) {
+        let lines = data.iter().filter(|&&b| b == b'\n').count() as u64;
+        self.0 .0.fetch_add(data.len() as u64, Ordering::Relaxed);
+        self.0 .1.fetch_add(lines, Ordering::Relaxed);
+    }
+
+    pub fn bytes(&self) -> u64 {
+        self.0 .0.load(Ordering::Relaxed)
+    }
+
+    pub fn lines(&self) -> u64 {
+        self.0 .1.load(Ordering::Relaxed)
+    }
+}
+
+pub struct CountingReader<R> {
+    inner: R,
+    counter: Counter,
+}
+
+impl<R: Read> Read for CountingReader<R> {
+    fn read(&mut self, buf: &mut [u8]) -> io::Result<usize> {
+        let n = self.inner.read(buf)?;
+        self.counter.add(&buf[..n]);
+        Ok(n)
+    }
+}
+
+pub struct CountingWriter<W> {
+    inner: W,
+    counter: Counter,
+}
+
+impl<W> CountingWriter<W> {
+    /// Unwrap the inner writer, e.g. to finish a compressor.
+    pub fn into_inner(self) -> W {
+        self.inner
+    }
+}
+
+impl<W: Write> Write for CountingWriter<W> {
+    fn write(&mut self, buf: &[u8]) -> io::Result<usize> {
+        let n = self.inner.write(buf)?;
+        self.counter.add(&buf[..n]);
+        Ok(n)
+    }
+
+    fn flush(&mut self) -> io::Result<()> {
+        self.inner.flush()
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+// TASK METRICS
+// ------------------------------------------------------------------------------------------------
+
+#[derive(Debug, Clone, PartialEq)]
+struct Phase {
+    name: String,
+    wall_s: f64,
+    cpu_s: f64,
+}
+
+pub struct TaskMetrics {
+    tool: String,
+    read: Counter,
+    written: Counter,
+    inputs: Mutex<Vec<String>>,
+    outputs: Mutex<Vec<String>>,
+    phases: Mutex<Vec<Phase>>,
+    start: Instant,
+    start_cpu: f64,
+}
+
+impl TaskMetrics {
+    pub fn new(tool: &str) -> Self {
+        Self {
+            tool: tool.to_string(),
+            read: Counter::default(),
+            written: Counter::default(),
+            inputs: Mutex::new(Vec::new()),
+            outputs: Mutex::new(Vec::new()),
+            phases: Mutex::new(Vec::new()),
+            start: Instant::now(),
+            start_cpu: cpu_seconds(),
+        }
+    }
+
+    /// Record an input file and count what is read through the returned reader, which should
+    /// wrap the decompressed stream.
+    pub fn count_reader<R: Read>(&self, path: &str, inner: R) -> CountingReader<R> {
+        self.inputs.lock().unwrap().push(path.to_string());
+        CountingReader {
+            inner,
+            counter: self.read.clone(),
+        }
+    }
+
+    /// Record an output file and count what is written through the returned writer, which
+    /// should sit in front of any compressor.
+    pub fn count_writer<W: Write>(&self, path: &str, inner: W) -> CountingWriter<W> {
+        self.add_output(path);
+        CountingWriter {
+            inner,
+            counter: self.written.clone(),
+        }
+    }
+
+    /// Record an output file whose uncompressed data is counted with `written_counter`.
+    pub fn add_output(&self, path: &str) {
+        self.outputs.lock().unwrap().push(path.to_string());
+    }
+
+    /// Counter of uncompressed data written, for writers on other threads.
+    pub fn written_counter(&self) -> Counter {
+        self.written.clone()
+    }
+
+    /// Start timing a named phase, which ends when the returned timer is dropped. Time is
+    /// added to any earlier phase of that name; CPU time covers all threads of the process.
+    pub fn start_phase(&self, name: &str) -> PhaseTimer<'_> {
+        PhaseTimer {
+            metrics: self,
+            name: name.to_string(),
+            start: Instant::now(),
+            start_cpu: cpu_seconds(),
+        }
+    }
+
+    /// Run `f` as a named phase (see `start_phase`).
+    pub fn phase<T>(&self, name: &str, f: impl FnOnce() -> T) -> T {
+        let _timer = self.start_phase(name);
+        f()
+    }
+
+    fn add_phase(&self, name: &str, wall_s: f64, cpu_s: f64) {
+        let mut phases = self.phases.lock().unwrap();
+        match phases.iter_mut().find(|p| p.name == name) {
+            Some(phase) => {
+                phase.wall_s += wall_s;
+                phase.cpu_s += cpu_s;
+            }
+            None => phases.push(Phase {
+                name: name.to_string(),
+                wall_s,
+                cpu_s,
+            }),
+        }
+    }
+
+    /// Metrics as JSON, in the schema shared with nao_io.TaskMetrics.
+    pub fn to_json(&self) -> String {
+        let size = |paths: &Mutex<Vec<String>>| -> u64 {
+            paths.lock().unwrap().iter().map(|p| file_size(p)).sum()
+        };
+        let phases: Vec<String> = self
+            .phases
+            .lock()
+            .unwrap()
+            .iter()
+            .map(|p| {
+                format!(
+                    "    \"{}\": {{\n      \"wall_s\": {:.6},\n      \"cpu_s\": {:.6}\n    }}",
+                    escape(&p.name),
+                    p.wall_s,
+                    p.cpu_s
+                )
+            })
+            .collect();
+        let phases = if phases.is_empty() {
+            "{}".to_string()
+        } else {
+            format!("{{\n{}\n  }}", phases.join(",\n"))
+        };
+        let peak_rss = peak_rss_bytes().map_or("null".to_string(), |b| b.to_string());
+        format!(
+            "{{\n  \"tool\": \"{}\",\n  \"rows_in\": {},\n  \"rows_out\": {},\n  \
+             \"bytes_read\": {},\n  \"bytes_read_uncompressed\": {},\n  \
+             \"bytes_written\": {},\n  \"bytes_written_uncompressed\": {},\n  \
+             \"wall_s\": {:.6},\n  \"cpu_s\": {:.6},\n  \"phases\": {},\n  \
+             \"peak_rss_bytes\": {}\n}}\n",
+            escape(&self.tool),
+            self.read.lines(),
+            self.written.lines(),
+            size(&self.inputs),
+            self.read.bytes(),
+            size(&self.outputs),
+            self.written.bytes(),
+            self.start.elapsed().as_secs_f64(),
+            cpu_seconds() - self.start_cpu,
+            phases,
+            peak_rss,
+        )
+    }
+
+    /// Write `<tool>.metrics.json` into `dir`, regardless of `NAO_TASK_METRICS`. If a task
+    /// runs the tool more than once (e.g. once per file in a loop), later runs write
+    /// `<tool>.<n>.metrics.json` for the first free n from 2.
+    pub fn write_to(&self, dir: &Path) -> io::Result<PathBuf> {
+        let mut path = dir.join(format!("{}{}", self.tool, METRICS_SUFFIX));
+        let mut n = 2;
+        while path.exists() {
+            path = dir.join(format!("{}.{}{}", self.tool, n, METRICS_SUFFIX));
+            n += 1;
+        }
+        fs::write(&path, self.to_json())?;
+        Ok(path)
+    }
+
+    /// Write `<tool>.metrics.json` into the working (task) directory if metrics are enabled.
+    /// Call after all outputs are flushed and closed, so their on-disk sizes are final.
+    pub fn write(&self) -> io::Result<Option<PathBuf>> {
+        if !enabled() {
+            return Ok(None);
+        }
+        self.write_to(Path::new(".")).map(Some)
+    }
+}
+
+pub struct PhaseTimer<'a> {
+    metrics: &'a TaskMetrics,
+    name: String,
+    start: Instant,
+    start_cpu: f64,
+}
+
+impl Drop for PhaseTimer<'_> {
+    fn drop(&mut self) {
+        let wall_s = self.start.elapsed().as_secs_f64();
+        let cpu_s = cpu_seconds() - self.start_cpu;
+        self.metrics.add_phase(&self.name, wall_s, cpu_s);
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+// HELPERS
+// ------------------------------------------------------------------------------------------------
+
+fn escape(s: &str) -> String {
+    s.replace('\\', "\\\\").replace('"', "\\\"")
+}
+
+fn file_size(path: &str) -> u64 {
+    fs::metadata(path)
+        .ok()
+        .filter(|m| m.is_file())
+        .map_or(0, |m| m.len())
+}
+
+/// User + system CPU seconds of the process and its waited-for children, from
+/// /proc/self/stat (in clock ticks of 1/100 s); 0 where /proc is unavailable.
+fn cpu_seconds() -> f64 {
+    fs::read_to_string("/proc/self/stat")
+        .ok()
+        .and_then(|stat| parse_stat_cpu_ticks(&stat))
+        .map_or(0.0, |ticks| ticks as f64 / 100.0)
+}
+
+fn parse_stat_cpu_ticks(stat: &str) -> Option<u64> {
+    // The command name may contain spaces, so split after its closing parenthesis; the
+    // remaining fields start at field 3 (state), putting utime..cstime (14-17) at 11..=14
+    let fields: Vec<&str> = stat
+        .get(stat.rfind(')')? + 1..)?
+        .split_whitespace()
+        .collect();
+    fields
+        .get(11..15)?
+        .iter()
+        .map(|f| f.parse::<u64>().ok())
+        .sum()
+}
+
+/// Peak resident set size (VmHWM) of the process, from /proc/self/status.
+fn peak_rss_bytes() -> Option<u64> {
+    parse_vm_hwm(&fs::read_to_string("/proc/self/status").ok()?)
+}
+
+fn parse_vm_hwm(status: &str) -> Option<u64> {
+    let line = status.lines().find(|l| l.starts_with("VmHWM:"))?;
+    let kib: u64 = line.split_whitespace().nth(1)?.parse().ok()?;
+    Some(kib * 1024)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_counting_reader_and_writer() {
+        let metrics = TaskMetrics::new("tool");
+        let mut text = String::new();
+        metrics
+            .count_reader("missing.tsv", &b"h\na\nb"[..])
+            .read_to_string(&mut text)
+            .unwrap();
+        let mut out = metrics.count_writer("missing.out", Vec::new());
+        out.write_all(b"a\nb\n").unwrap();
+        assert_eq!((metrics.read.bytes(), metrics.read.lines()), (5, 2));
+        assert_eq!((metrics.written.bytes(), metrics.written.lines()), (4, 2));
+        assert_eq!(out.into_inner(), b"a\nb\n");
+        metrics.add_output("missing.gz");
+        metrics.written_counter().add(b"c\n");
+        assert_eq!((metrics.written.bytes(), metrics.written.lines()), (6, 3));
+        assert_eq!(metrics.outputs.lock().unwrap().len(), 2);
+    }
+
+    #[test]
+    fn test_phases_accumulate() {
+        let metrics = TaskMetrics::new("tool");
+        assert_eq!(metrics.phase("parse", || 1 + 1), 2);
+        let timer = metrics.start_phase("group");
+        drop(timer);
+        metrics.phase("parse", || ());
+        let phases = metrics.phases.lock().unwrap();
+        let names: Vec<&str> = phases.iter().map(|p| p.name.as_str()).collect();
+        assert_eq!(names, ["parse", "group"]);
+    }
+
+    #[test]
+    fn test_json_file() {
+        let dir = std::env::temp_dir().join(format!("task_metrics_{}", std::process::id()));
+        fs::create_dir_all(&dir).unwrap();
+        let input = dir.join("in.tsv");
+        fs::write(&input, "x\ny\n").unwrap();
+        let metrics = TaskMetrics::new("tool");
+        let mut sink = Vec::new();
+        metrics
+            .count_reader(input.to_str().unwrap(), fs::File::open(&input).unwrap())
+            .read_to_end(&mut sink)
+            .unwrap();
+        metrics.phase("parse", || ());
+        let path = metrics.write_to(&dir).unwrap();
+        let json = fs::read_to_string(&path).unwrap();
+        let second = metrics.write_to(&dir).unwrap();
+        fs::remove_dir_all(&dir).unwrap();
+        assert_eq!(path, dir.join("tool.metrics.json"));
+        assert_eq!(second, dir.join("tool.2.metrics.json"));
+        assert!(json.starts_with("{\n  \"tool\": \"tool\",\n  \"rows_in\": 2,\n"));
+        assert!(json.contains("\"bytes_read\": 4,\n  \"bytes_read_uncompressed\": 4,"));
+        assert!(json.contains("\"phases\": {\n    \"parse\": {\n      \"wall_s\": "));
+        assert!(json.ends_with("}\n"));
+    }
+
+    #[test]
+    fn test_parse_proc() {
+        let stat = "42 (my tool) S 1 2 3 4 5 6 7 8 9 10 150 50 3 2 20 0";
+        assert_eq!(parse_stat_cpu_ticks(stat), Some(205));
+        assert_eq!(parse_stat_cpu_ticks("garbage"), None);
+        let status = "Name:\tx\nVmPeak:\t  9 kB\nVmHWM:\t    1234 kB\n";
+        assert_eq!(parse_vm_hwm(status), Some(1234 * 1024));
+        assert_eq!(parse_vm_hwm("Name:\tx\n"), None);
+    }
+}
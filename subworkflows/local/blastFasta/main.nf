@@ -32,6 +32,7 @@ workflow BLAST_FASTA {
                    // taxid_artificial: Parent taxid for artificial sequences in NCBI taxonomy
                    // lca_prefix: Prefix for LCA column names (e.g. "blast")
                    // db_download_timeout: Timeout in seconds for database downloads
+                   // blast_output_name: Name suffix of the filtered BLAST output (optional; default "blast_filtered.tsv.gz")
     main:
         // Get reference paths
         // INDEX publishes the BLAST DB under the constant "blast_db" alias
@@ -47,7 +48,8 @@ workflow BLAST_FASTA {
         // 3. Filter BLAST output to only high-scoring alignments within each query
         sort_str_2 = "-t\$\'\\t\' -k1,1 -k7,7nr" // Sort by query and bitscore only
         sort_ch_2 = SORT_BLAST_2(filter_ch_1.output, sort_str_2, "blast")
-        filter_ch_2 = FILTER_BLAST(sort_ch_2.output, params_map.blast_max_rank, params_map.blast_min_frac).output // Filter on relative bitscores
+        filter_ch_2 = FILTER_BLAST(sort_ch_2.output, params_map.blast_max_rank, params_map.blast_min_frac,
+            params_map.blast_output_name ?: "blast_filtered.tsv.gz").output // Filter on relative bitscores
         // 4. Apply LCA to BLAST output
         lca_params = [
             group_field: "qseqid",
@@ -2,9 +2,9 @@
 | MODULES AND SUBWORKFLOWS |
 ***************************/
 
-include { ADD_SAMPLE_COLUMN as ADD_GROUP_COLUMN } from "../../../modules/local/addSampleColumn"
+include { ADD_SAMPLE_COLUMN_NAMED as ADD_GROUP_COLUMN } from "../../../modules/local/addSampleColumn"
 include { CONCATENATE_TSVS_LABELED } from "../../../modules/local/concatenateTsvs"
-include { COPY_FILE } from "../../../modules/local/copyFile"
+include { MERGE_SORTED_TSVS_LABELED } from "../../../modules/local/mergeSortedTsvs"
 
 /***********
 | WORKFLOW |
@@ -15,6 +15,7 @@ workflow CONCAT_BY_GROUP {
         files        // tuple(label, sample, file, group)
         suffix       // string file suffix to filter on, e.g. "virus_hits.tsv"
         output_name  // string, e.g. "grouped_hits"
+        sort_key     // column every per-sample file is sorted on, to merge them into a group file sorted on it; null to concatenate
     main:
         // Filter for files matching the suffix using exact matching
         filtered = files
@@ -26,11 +27,14 @@ workflow CONCAT_BY_GROUP {
         files_by_group = filtered
             .map { _label, _sample, file, group -> [group, file] }
             .groupTuple()
-        concatenated_ch = CONCATENATE_TSVS_LABELED(files_by_group, "concat").output
-        // Add group column to concatenated files
-        grouped_ch = ADD_GROUP_COLUMN(concatenated_ch, "group", "grouped").output
-        // Rename to final output name: {group}_{output_name}.tsv.gz
-        renamed_ch = COPY_FILE(grouped_ch, "${output_name}.tsv.gz")
+        if (sort_key) {
+            // Streaming k-way merge that keeps the group file sorted and adds the group column in the same pass
+            grouped_ch = MERGE_SORTED_TSVS_LABELED(files_by_group, sort_key, "group", "${output_name}.tsv.gz").output
+        } else {
+            concatenated_ch = CONCATENATE_TSVS_LABELED(files_by_group, "concat").output
+            // Add group column to concatenated files, writing the final output name: {group}_{output_name}.tsv.gz
+            grouped_ch = ADD_GROUP_COLUMN(concatenated_ch, "group", "${output_name}.tsv.gz").output
+        }
     emit:
-        groups = renamed_ch
+        groups = grouped_ch
 }
@@ -3,7 +3,6 @@
 ***************************/
 
 include { COMBINE_SAMPLE_JSONS } from "../../../modules/local/combineSampleJsons"
-include { COPY_FILE } from "../../../modules/local/copyFile"
 
 /***********
 | WORKFLOW |
@@ -23,13 +22,11 @@ workflow CONCAT_JSON_BY_GROUP {
                 def name = f.getFileName().toString()
                 name == "${sample}_${suffix}"
             }
-        // Group files by group and combine
+        // Group files by group and combine under the final output name: {group}_{output_name}.json
         files_by_group = filtered
             .map { _label, _sample, file, group -> [group, file] }
             .groupTuple()
-        combined_ch = COMBINE_SAMPLE_JSONS(files_by_group, suffix).output
-        // Rename to final output name: {group}_{output_name}.json
-        renamed_ch = COPY_FILE(combined_ch, "${output_name}.json")
+        combined_ch = COMBINE_SAMPLE_JSONS(files_by_group, suffix, "${output_name}.json").output
     emit:
-        groups = renamed_ch
+        groups = combined_ch
 }
@@ -26,20 +26,20 @@ workflow CONCAT_RUN_OUTPUTS_BY_GROUP {
     take:
         files  // tuple(label, sample, file, group) from DISCOVER_RUN_OUTPUT
     main:
-        hits_ch                              = CONCAT_HITS_BY_GROUP(files, "virus_hits.tsv", "grouped_hits").groups
-        read_counts_ch                       = CONCAT_READ_COUNTS_BY_GROUP(files, "read_counts.tsv", "read_counts").groups
-        kraken_ch                            = CONCAT_KRAKEN_BY_GROUP(files, "kraken.tsv", "kraken").groups
-        bracken_ch                           = CONCAT_BRACKEN_BY_GROUP(files, "bracken.tsv", "bracken").groups
-        qc_adapter_stats_cleaned_ch          = CONCAT_QC_ADAPTER_STATS_CLEANED_BY_GROUP(files, "qc_adapter_stats_cleaned.tsv", "qc_adapter_stats_cleaned").groups
-        qc_adapter_stats_raw_ch              = CONCAT_QC_ADAPTER_STATS_RAW_BY_GROUP(files, "qc_adapter_stats_raw.tsv", "qc_adapter_stats_raw").groups
-        qc_basic_stats_cleaned_ch            = CONCAT_QC_BASIC_STATS_CLEANED_BY_GROUP(files, "qc_basic_stats_cleaned.tsv", "qc_basic_stats_cleaned").groups
-        qc_basic_stats_raw_ch                = CONCAT_QC_BASIC_STATS_RAW_BY_GROUP(files, "qc_basic_stats_raw.tsv", "qc_basic_stats_raw").groups
-        qc_length_stats_cleaned_ch           = CONCAT_QC_LENGTH_STATS_CLEANED_BY_GROUP(files, "qc_length_stats_cleaned.tsv", "qc_length_stats_cleaned").groups
-        qc_length_stats_raw_ch               = CONCAT_QC_LENGTH_STATS_RAW_BY_GROUP(files, "qc_length_stats_raw.tsv", "qc_length_stats_raw").groups
-        qc_quality_base_stats_cleaned_ch     = CONCAT_QC_QUALITY_BASE_STATS_CLEANED_BY_GROUP(files, "qc_quality_base_stats_cleaned.tsv", "qc_quality_base_stats_cleaned").groups
-        qc_quality_base_stats_raw_ch         = CONCAT_QC_QUALITY_BASE_STATS_RAW_BY_GROUP(files, "qc_quality_base_stats_raw.tsv", "qc_quality_base_stats_raw").groups
-        qc_quality_sequence_stats_cleaned_ch = CONCAT_QC_QUALITY_SEQUENCE_STATS_CLEANED_BY_GROUP(files, "qc_quality_sequence_stats_cleaned.tsv", "qc_quality_sequence_stats_cleaned").groups
-        qc_quality_sequence_stats_raw_ch     = CONCAT_QC_QUALITY_SEQUENCE_STATS_RAW_BY_GROUP(files, "qc_quality_sequence_stats_raw.tsv", "qc_quality_sequence_stats_raw").groups
+        hits_ch                              = CONCAT_HITS_BY_GROUP(files, "virus_hits.tsv", "grouped_hits", "seq_id").groups
+        read_counts_ch                       = CONCAT_READ_COUNTS_BY_GROUP(files, "read_counts.tsv", "read_counts", null).groups
+        kraken_ch                            = CONCAT_KRAKEN_BY_GROUP(files, "kraken.tsv", "kraken", null).groups
+        bracken_ch                           = CONCAT_BRACKEN_BY_GROUP(files, "bracken.tsv", "bracken", null).groups
+        qc_adapter_stats_cleaned_ch          = CONCAT_QC_ADAPTER_STATS_CLEANED_BY_GROUP(files, "qc_adapter_stats_cleaned.tsv", "qc_adapter_stats_cleaned", null).groups
+        qc_adapter_stats_raw_ch              = CONCAT_QC_ADAPTER_STATS_RAW_BY_GROUP(files, "qc_adapter_stats_raw.tsv", "qc_adapter_stats_raw", null).groups
+        qc_basic_stats_cleaned_ch            = CONCAT_QC_BASIC_STATS_CLEANED_BY_GROUP(files, "qc_basic_stats_cleaned.tsv", "qc_basic_stats_cleaned", null).groups
+        qc_basic_stats_raw_ch                = CONCAT_QC_BASIC_STATS_RAW_BY_GROUP(files, "qc_basic_stats_raw.tsv", "qc_basic_stats_raw", null).groups
+        qc_length_stats_cleaned_ch           = CONCAT_QC_LENGTH_STATS_CLEANED_BY_GROUP(files, "qc_length_stats_cleaned.tsv", "qc_length_stats_cleaned", null).groups
+        qc_length_stats_raw_ch               = CONCAT_QC_LENGTH_STATS_RAW_BY_GROUP(files, "qc_length_stats_raw.tsv", "qc_length_stats_raw", null).groups
+        qc_quality_base_stats_cleaned_ch     = CONCAT_QC_QUALITY_BASE_STATS_CLEANED_BY_GROUP(files, "qc_quality_base_stats_cleaned.tsv", "qc_quality_base_stats_cleaned", null).groups
+        qc_quality_base_stats_raw_ch         = CONCAT_QC_QUALITY_BASE_STATS_RAW_BY_GROUP(files, "qc_quality_base_stats_raw.tsv", "qc_quality_base_stats_raw", null).groups
+        qc_quality_sequence_stats_cleaned_ch = CONCAT_QC_QUALITY_SEQUENCE_STATS_CLEANED_BY_GROUP(files, "qc_quality_sequence_stats_cleaned.tsv", "qc_quality_sequence_stats_cleaned", null).groups
+        qc_quality_sequence_stats_raw_ch     = CONCAT_QC_QUALITY_SEQUENCE_STATS_RAW_BY_GROUP(files, "qc_quality_sequence_stats_raw.tsv", "qc_quality_sequence_stats_raw", null).groups
         fastp_json_ch                        = CONCAT_FASTP_JSON_BY_GROUP(files, "fastp.json", "fastp").groups
     emit:
         hits  = hits_ch
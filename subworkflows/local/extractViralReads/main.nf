@@ -19,8 +19,9 @@ workflow EXTRACT_VIRAL_READS {
         params_map  // Map: full params object
     main:
         if (params_map.platform == "ont") {
-            ont_ch = EXTRACT_VIRAL_READS_ONT(reads_ch, params_map.ref_dir, params_map.taxid_artificial, params_map.db_download_timeout)
+            ont_ch = EXTRACT_VIRAL_READS_ONT(reads_ch, params_map.ref_dir, params_map)
             hits_final = ont_ch.hits_final
+            hits_index = ont_ch.hits_index
             inter_lca = ont_ch.inter_lca
             inter_aligner = ont_ch.inter_minimap2
             kmer_match = channel.empty()
@@ -33,6 +34,7 @@ workflow EXTRACT_VIRAL_READS {
             ]
             short_ch = EXTRACT_VIRAL_READS_SHORT(reads_ch, params_map.ref_dir, short_params)
             hits_final = short_ch.hits_final
+            hits_index = short_ch.hits_index
             inter_lca = short_ch.inter_lca
             inter_aligner = short_ch.inter_bowtie
             kmer_match = short_ch.kmer_match
@@ -40,6 +42,7 @@ workflow EXTRACT_VIRAL_READS {
         }
     emit:
         hits_final
+        hits_index
         inter_lca
         inter_aligner
         kmer_match
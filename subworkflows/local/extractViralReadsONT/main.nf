@@ -5,8 +5,12 @@
 include { MINIMAP2 as MINIMAP2_VIRUS } from "../../../modules/local/minimap2"
 include { MINIMAP2 as MINIMAP2_HUMAN } from "../../../modules/local/minimap2"
 include { MINIMAP2_NON_STREAMED as MINIMAP2_CONTAM } from "../../../modules/local/minimap2"
+include { MINIMAP2_CHAINED } from "../../../modules/local/minimap2"
+include { COLLAPSE_DUPLICATE_READS } from "../../../modules/local/collapseDuplicateReads"
+include { EXPAND_DUPLICATE_READS } from "../../../modules/local/collapseDuplicateReads"
 include { FILTLONG } from "../../../modules/local/filtlong"
 include { MASK_FASTQ_READS } from "../../../modules/local/maskRead"
+include { MASK_FASTQ_READS_NATIVE } from "../../../modules/local/maskRead"
 include { EXTRACT_SHARED_FASTQ_READS as EXTRACT_VIRAL_FILTERED_READS } from "../../../modules/local/extractSharedFastq"
 include { PROCESS_VIRAL_MINIMAP2_SAM } from "../../../modules/local/processViralMinimap2Sam"
 include { LCA_TSV } from "../../../modules/local/lcaTsv"
@@ -15,7 +19,6 @@ include { SORT_TSV as SORT_LCA } from "../../../modules/local/sortTsv"
 include { JOIN_TSVS } from "../../../modules/local/joinTsvs"
 include { FILTER_TSV_COLUMN_BY_VALUE } from "../../../modules/local/filterTsvColumnByValue"
 include { PROCESS_LCA_ALIGNER_OUTPUT } from "../../../subworkflows/local/processLcaAlignerOutput/"
-include { COPY_FILE as RENAME_VIRUS_HITS } from "../../../modules/local/copyFile"
 
 /***********
 | WORKFLOW |
@@ -25,14 +28,15 @@ workflow EXTRACT_VIRAL_READS_ONT {
     take:
         reads_ch
         ref_dir
-        taxid_artificial
-        db_download_timeout // Timeout in seconds for database downloads
+        params_map // taxid_artificial, db_download_timeout, ont_native_masker, ont_chained_minimap2 (optional), collapse_duplicate_reads (optional), late_payload_columns (optional), compact_payload (optional), index_hits (optional)
     main:
         // Get reference_paths
         minimap2_virus_index = "${ref_dir}/results/mm2-virus-index"
         minimap2_human_index = "${ref_dir}/results/mm2-human-index"
         minimap2_contam_index = "${ref_dir}/results/mm2-other-index"
-        genome_meta_path = "${ref_dir}/results/virus-genome-metadata-gid.tsv.gz"
+        // Prefer the memory-mappable genome taxid index; fall back to the metadata TSV for older indexes
+        def genome_taxid_index = file("${ref_dir}/results/virus-genome-taxid-index.bin")
+        genome_meta_path = genome_taxid_index.exists() ? genome_taxid_index : "${ref_dir}/results/virus-genome-metadata-gid.tsv.gz"
         virus_db_path = "${ref_dir}/results/total-virus-db-annotated.tsv.gz"
         nodes_db = "${ref_dir}/results/taxonomy-nodes.dmp"
         names_db = "${ref_dir}/results/taxonomy-names.dmp"
@@ -45,29 +49,80 @@ workflow EXTRACT_VIRAL_READS_ONT {
                                "query_qual"]
         col_keep_add_prefix = ["genome_id_all", "taxid_all", "best_alignment_score", "edit_distance",  
                                "ref_start", "query_rc"]
-        // Filter reads by length and quality scores
-        filtered_ch = FILTLONG(reads_ch, 50, 15000, 90)
-        // Mask non-complex read sections
-        masked_ch = MASK_FASTQ_READS(filtered_ch, 25, 0.55)
-        // Drop human reads before pathogen identification
-        minimap2_base_params = [remove_sq: false, db_download_timeout: db_download_timeout]
-        human_minimap2_params = minimap2_base_params + [suffix: "human", alignment_params: ""]
-        human_minimap2_ch = MINIMAP2_HUMAN(masked_ch.masked, minimap2_human_index, human_minimap2_params)
-        no_human_ch = human_minimap2_ch.reads_unmapped
-        // Identify other contaminants
-        contam_minimap2_params = minimap2_base_params + [suffix: "other", alignment_params: ""]
-        contam_minimap2_ch = MINIMAP2_CONTAM(no_human_ch, minimap2_contam_index, contam_minimap2_params)
-        no_contam_ch = contam_minimap2_ch.reads_unmapped
-        // Identify virus reads with multiple alignments for LCA analysis
-        virus_minimap2_params = minimap2_base_params + [suffix: "virus", alignment_params: "-N 10"]
-        virus_minimap2_ch = MINIMAP2_VIRUS(no_contam_ch, minimap2_virus_index, virus_minimap2_params)
-        virus_sam_ch = virus_minimap2_ch.sam
-        // Pre-filter unmasked reads to only virus-mapped reads before SAM processing
-        viral_filtered_reads_ch = EXTRACT_VIRAL_FILTERED_READS(
-            virus_minimap2_ch.reads_mapped.join(filtered_ch.reads)
-        )
+        // Optionally carry read sequences and qualities in a side file through the LCA join and filters
+        payload_cols = params_map.late_payload_columns ? col_keep_no_prefix.findAll { c -> c.startsWith("query_seq") || c.startsWith("query_qual") } : []
+        // and optionally pack sequences there (restored exactly); Illumina quality binning does not apply to ONT
+        payload_encoding = [
+            pack: params_map.compact_payload ? payload_cols.findAll { c -> c.startsWith("query_seq") } : [],
+            bin: []
+        ]
+        // Filter reads by length and quality scores, then mask non-complex read sections
+        if (params_map.ont_native_masker) {
+            // Single fused pass; unmasked passing reads are emitted alongside masked reads
+            filter_params = [min_length: 50, max_length: 15000, min_mean_q: 90]
+            native_ch = MASK_FASTQ_READS_NATIVE(reads_ch, 25, 0.55, filter_params)
+            filtered_reads_ch = native_ch.filtered
+            masked_reads_ch = native_ch.masked
+        } else {
+            filtered_ch = FILTLONG(reads_ch, 50, 15000, 90)
+            masked_ch = MASK_FASTQ_READS(filtered_ch, 25, 0.55)
+            filtered_reads_ch = filtered_ch.reads
+            masked_reads_ch = masked_ch.masked
+        }
+        minimap2_base_params = [remove_sq: false, db_download_timeout: params_map.db_download_timeout]
+        if (params_map.ont_chained_minimap2) {
+            // Human, contaminant and virus screening in one streaming task
+            index_dirs = [human: minimap2_human_index, contam: minimap2_contam_index, virus: minimap2_virus_index]
+            chained_params = minimap2_base_params + [
+                human_alignment_params: "",
+                contam_alignment_params: "",
+                virus_alignment_params: "-N 10"
+            ]
+            chained_ch = MINIMAP2_CHAINED(masked_reads_ch.join(filtered_reads_ch), index_dirs, chained_params)
+            virus_sam_ch = chained_ch.sam
+            viral_filtered_fastq_ch = chained_ch.reads_mapped
+            test_fastq_filtered_human_ch = channel.empty()
+            test_fastq_filtered_contam_ch = channel.empty()
+        } else {
+            // Drop human reads before pathogen identification
+            human_minimap2_params = minimap2_base_params + [suffix: "human", alignment_params: ""]
+            human_minimap2_ch = MINIMAP2_HUMAN(masked_reads_ch, minimap2_human_index, human_minimap2_params)
+            no_human_ch = human_minimap2_ch.reads_unmapped
+            // Identify other contaminants
+            contam_minimap2_params = minimap2_base_params + [suffix: "other", alignment_params: ""]
+            contam_minimap2_ch = MINIMAP2_CONTAM(no_human_ch, minimap2_contam_index, contam_minimap2_params)
+            no_contam_ch = contam_minimap2_ch.reads_unmapped
+            // Identify virus reads with multiple alignments for LCA analysis
+            virus_minimap2_params = minimap2_base_params + [suffix: "virus", alignment_params: "-N 10"]
+            if (params_map.collapse_duplicate_reads) {
+                // Align one representative of each set of identical masked reads,
+                // then expand its alignments back to every original read
+                collapsed_ch = COLLAPSE_DUPLICATE_READS(no_contam_ch, false)
+                virus_reads_ch = collapsed_ch.output.map { sample, reads, _duplicates -> [sample, reads] }
+            } else {
+                virus_reads_ch = no_contam_ch
+            }
+            virus_minimap2_ch = MINIMAP2_VIRUS(virus_reads_ch, minimap2_virus_index, virus_minimap2_params)
+            if (params_map.collapse_duplicate_reads) {
+                duplicates_ch = collapsed_ch.output.map { sample, _reads, duplicates -> [sample, duplicates] }
+                expand_ch = virus_minimap2_ch.sam.join(virus_minimap2_ch.reads_mapped).join(duplicates_ch)
+                expanded_ch = EXPAND_DUPLICATE_READS(expand_ch, "virus_minimap2_mapped")
+                virus_sam_ch = expanded_ch.sam
+                virus_mapped_ch = expanded_ch.reads_mapped
+            } else {
+                virus_sam_ch = virus_minimap2_ch.sam
+                virus_mapped_ch = virus_minimap2_ch.reads_mapped
+            }
+            // Pre-filter unmasked reads to only virus-mapped reads before SAM processing
+            viral_filtered_reads_ch = EXTRACT_VIRAL_FILTERED_READS(
+                virus_mapped_ch.join(filtered_reads_ch)
+            )
+            viral_filtered_fastq_ch = viral_filtered_reads_ch.output
+            test_fastq_filtered_human_ch = human_minimap2_ch.reads_unmapped
+            test_fastq_filtered_contam_ch = contam_minimap2_ch.reads_unmapped
+        }
         // Group cleaned reads and sam files by sample
-        sam_fastq_ch = virus_sam_ch.join(viral_filtered_reads_ch.output)
+        sam_fastq_ch = virus_sam_ch.join(viral_filtered_fastq_ch)
         // Generate TSV of viral hits, and sort
         processed_minimap2_ch = PROCESS_VIRAL_MINIMAP2_SAM(sam_fastq_ch, genome_meta_path, virus_db_path)
         processed_minimap2_sorted_ch = SORT_MINIMAP2_VIRAL(processed_minimap2_ch.output, "seq_id")
@@ -76,25 +131,27 @@ workflow EXTRACT_VIRAL_READS_ONT {
             group_field: "seq_id",
             taxid_field: "taxid",
             score_field: "length_normalized_score",
-            taxid_artificial: taxid_artificial,
+            taxid_artificial: params_map.taxid_artificial,
             prefix: "aligner"
         ]
         lca_ch = LCA_TSV(processed_minimap2_sorted_ch.sorted, nodes_db, names_db, lca_params)
-        // Process LCA and Minimap2 columns
+        // Process LCA and Minimap2 columns into the final {sample}_virus_hits.tsv.gz
         processed_ch = PROCESS_LCA_ALIGNER_OUTPUT(
             lca_ch.output,
             processed_minimap2_sorted_ch.sorted,
             col_keep_no_prefix,
             col_keep_add_prefix,
-            "prim_align_"
+            "prim_align_",
+            payload_cols,
+            params_map.index_hits ? "seq_id" : "",
+            payload_encoding
         )
-        // Rename virus hits to clean file name
-        renamed_hits_ch = RENAME_VIRUS_HITS(processed_ch.viral_hits_tsv, "virus_hits.tsv.gz")
     emit:
-        hits_final = renamed_hits_ch
+        hits_final = processed_ch.viral_hits_tsv
+        hits_index = processed_ch.viral_hits_index
         inter_lca = processed_ch.lca_tsv
         inter_minimap2 = processed_ch.aligner_tsv
         test_minimap2_virus = virus_sam_ch
-        test_fastq_filtered_human = human_minimap2_ch.reads_unmapped
-        test_fastq_filtered_contam = contam_minimap2_ch.reads_unmapped
+        test_fastq_filtered_human = test_fastq_filtered_human_ch
+        test_fastq_filtered_contam = test_fastq_filtered_contam_ch
 }
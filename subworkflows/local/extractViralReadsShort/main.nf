@@ -8,6 +8,9 @@ include { FASTP } from "../../../modules/local/fastp"
 include { BOWTIE2 as BOWTIE2_VIRUS } from "../../../modules/local/bowtie2"
 include { BOWTIE2 as BOWTIE2_HUMAN } from "../../../modules/local/bowtie2"
 include { BOWTIE2 as BOWTIE2_OTHER } from "../../../modules/local/bowtie2"
+include { BOWTIE2 as BOWTIE2_CONTAMINANT } from "../../../modules/local/bowtie2"
+include { COLLAPSE_DUPLICATE_READS } from "../../../modules/local/collapseDuplicateReads"
+include { EXPAND_DUPLICATE_READS } from "../../../modules/local/collapseDuplicateReads"
 include { PROCESS_VIRAL_BOWTIE2_SAM } from "../../../modules/local/processViralBowtie2Sam"
 include { SORT_TSV as SORT_BOWTIE_VIRAL } from "../../../modules/local/sortTsv"
 include { LCA_TSV } from "../../../modules/local/lcaTsv"
@@ -15,7 +18,6 @@ include { SORT_FASTQ } from "../../../modules/local/sortFastq"
 include { SORT_FILE } from "../../../modules/local/sortFile"
 include { FILTER_VIRAL_SAM } from "../../../modules/local/filterViralSam"
 include { PROCESS_LCA_ALIGNER_OUTPUT } from "../../../subworkflows/local/processLcaAlignerOutput/"
-include { COPY_FILE as RENAME_VIRUS_HITS } from "../../../modules/local/copyFile"
 
 /***********
 | WORKFLOW |
@@ -25,7 +27,7 @@ workflow EXTRACT_VIRAL_READS_SHORT {
     take:
         reads_ch
         ref_dir
-        params_map // aln_score_threshold, adapters, minhits, k, kmer_suffix, taxid_artificial
+        params_map // aln_score_threshold, adapters, minhits, k, kmer_suffix, taxid_artificial, bt2_combined_contaminants (optional), collapse_duplicate_reads (optional), late_payload_columns (optional), compact_payload (optional), bin_payload_qualities (optional), index_hits (optional)
     main:
         // Get reference paths
         viral_kmer_index_path = "${ref_dir}/results/virus-genomes-masked.nucleaze.bin"
@@ -40,10 +42,19 @@ workflow EXTRACT_VIRAL_READS_SHORT {
             )
         }
         def nucleaze_k = index_params.nucleaze_k.toString()
-        genome_meta_path = "${ref_dir}/results/virus-genome-metadata-gid.tsv.gz"
+        if (params_map.bt2_combined_contaminants && !index_params.bt2_combined_contaminants) {
+            throw new IllegalStateException(
+                "Index at ${ref_dir} has no combined contaminant Bowtie2 index; " +
+                "rebuild with bt2_combined_contaminants = true or unset bt2_combined_contaminants."
+            )
+        }
+        // Prefer the memory-mappable genome taxid index; fall back to the metadata TSV for older indexes
+        def genome_taxid_index = file("${ref_dir}/results/virus-genome-taxid-index.bin")
+        genome_meta_path = genome_taxid_index.exists() ? genome_taxid_index : "${ref_dir}/results/virus-genome-metadata-gid.tsv.gz"
         bt2_virus_index_path = "${ref_dir}/results/bt2-virus-index"
         bt2_human_index_path = "${ref_dir}/results/bt2-human-index"
         bt2_other_index_path = "${ref_dir}/results/bt2-other-index"
+        bt2_contaminant_index_path = "${ref_dir}/results/bt2-contaminant-index"
         virus_db_path = "${ref_dir}/results/total-virus-db-annotated.tsv.gz"
         nodes_db = "${ref_dir}/results/taxonomy-nodes.dmp"
         names_db = "${ref_dir}/results/taxonomy-names.dmp"
@@ -58,6 +69,13 @@ workflow EXTRACT_VIRAL_READS_SHORT {
                                "best_alignment_score", "best_alignment_score_rev",
                                "edit_distance", "edit_distance_rev", "ref_start", 
                                "ref_start_rev", "query_rc", "query_rc_rev", "pair_status"]
+        // Optionally carry read sequences and qualities in a side file through the LCA join and filters
+        payload_cols = params_map.late_payload_columns ? col_keep_no_prefix.findAll { c -> c.startsWith("query_seq") || c.startsWith("query_qual") } : []
+        // and optionally store them compactly there (packed bases are restored exactly; binned qualities are lossy)
+        payload_encoding = [
+            pack: params_map.compact_payload ? payload_cols.findAll { c -> c.startsWith("query_seq") } : [],
+            bin: params_map.bin_payload_qualities ? payload_cols.findAll { c -> c.startsWith("query_qual") } : []
+        ]
          // 1. Run initial k-mer screen against viral genomes with nucleaze.
          // keep_nomatch: false — the subworkflow only consumes the match
          // fraction; skipping nomatch compression is a noticeable win.
@@ -79,18 +97,45 @@ workflow EXTRACT_VIRAL_READS_SHORT {
         ]
         par_virus = "--local --very-sensitive-local --score-min G,0.1,19 -k 10 -X 850"
         bowtie2_virus_params = bowtie_base_params + [par_string: par_virus, suffix: "virus"]
-        bowtie2_ch = BOWTIE2_VIRUS(fastp_ch.reads, bt2_virus_index_path, bowtie2_virus_params)
+        if (params_map.collapse_duplicate_reads) {
+            // Align one representative of each set of identical read pairs, then
+            // expand its alignments back to every original pair
+            collapsed_ch = COLLAPSE_DUPLICATE_READS(fastp_ch.reads, true)
+            virus_reads_ch = collapsed_ch.output.map { sample, reads, _duplicates -> [sample, reads] }
+        } else {
+            virus_reads_ch = fastp_ch.reads
+        }
+        bowtie2_ch = BOWTIE2_VIRUS(virus_reads_ch, bt2_virus_index_path, bowtie2_virus_params)
+        if (params_map.collapse_duplicate_reads) {
+            duplicates_ch = collapsed_ch.output.map { sample, _reads, duplicates -> [sample, duplicates] }
+            expand_ch = bowtie2_ch.sam.join(bowtie2_ch.reads_mapped).join(duplicates_ch)
+            expanded_ch = EXPAND_DUPLICATE_READS(expand_ch, "virus_bowtie2_mapped")
+            virus_sam_ch = expanded_ch.sam
+            virus_mapped_ch = expanded_ch.reads_mapped
+        } else {
+            virus_sam_ch = bowtie2_ch.sam
+            virus_mapped_ch = bowtie2_ch.reads_mapped
+        }
 
         // 4. Filter contaminants
         par_contaminants = "--local --very-sensitive-local -X 850"
-        bowtie2_human_params = bowtie_base_params + [par_string: par_contaminants, suffix: "human"]
-        human_bt2_ch = BOWTIE2_HUMAN(bowtie2_ch.reads_mapped, bt2_human_index_path, bowtie2_human_params)
-        bowtie2_other_params = bowtie_base_params + [par_string: par_contaminants, suffix: "other"]
-        other_bt2_ch = BOWTIE2_OTHER(human_bt2_ch.reads_unmapped, bt2_other_index_path, bowtie2_other_params)
+        if (params_map.bt2_combined_contaminants) {
+            // Single pass against the combined human ("human|") + other ("other|") index:
+            // a read aligning to either reference set is removed, as with the two-pass screen
+            bowtie2_contaminant_params = bowtie_base_params + [par_string: par_contaminants, suffix: "contaminant"]
+            contaminant_bt2_ch = BOWTIE2_CONTAMINANT(virus_mapped_ch, bt2_contaminant_index_path, bowtie2_contaminant_params)
+            clean_reads_ch = contaminant_bt2_ch.reads_unmapped
+        } else {
+            bowtie2_human_params = bowtie_base_params + [par_string: par_contaminants, suffix: "human"]
+            human_bt2_ch = BOWTIE2_HUMAN(virus_mapped_ch, bt2_human_index_path, bowtie2_human_params)
+            bowtie2_other_params = bowtie_base_params + [par_string: par_contaminants, suffix: "other"]
+            other_bt2_ch = BOWTIE2_OTHER(human_bt2_ch.reads_unmapped, bt2_other_index_path, bowtie2_other_params)
+            clean_reads_ch = other_bt2_ch.reads_unmapped
+        }
 
         // 5. Sort SAM and FASTQ files before filtering
-        bowtie2_sam_sorted_ch = SORT_FILE(bowtie2_ch.sam, "-t\$\'\\t\' -k1,1", "sam")
-        other_fastq_sorted_ch = SORT_FASTQ(other_bt2_ch.reads_unmapped)
+        bowtie2_sam_sorted_ch = SORT_FILE(virus_sam_ch, "-t\$\'\\t\' -k1,1", "sam")
+        other_fastq_sorted_ch = SORT_FASTQ(clean_reads_ch)
         // 6. Consolidated viral SAM filtering: keep contaminant-free reads, applies score threshold, adds missing mates
         bowtie2_ch_combined = bowtie2_sam_sorted_ch.output.combine(other_fastq_sorted_ch.output, by: 0)
         bowtie2_filtered_ch = FILTER_VIRAL_SAM(bowtie2_ch_combined, params_map.aln_score_threshold)
@@ -105,24 +150,26 @@ workflow EXTRACT_VIRAL_READS_SHORT {
             prefix: "aligner"
         ]
         lca_ch = LCA_TSV(bowtie2_tsv_ch.output, nodes_db, names_db, lca_params)
-        // 9. Process LCA and Bowtie2 columns
+        // 9. Process LCA and Bowtie2 columns into the final {sample}_virus_hits.tsv.gz
         processed_ch = PROCESS_LCA_ALIGNER_OUTPUT(
             lca_ch.output,
             bowtie2_tsv_ch.output,
             col_keep_no_prefix,
             col_keep_add_prefix,
-            "prim_align_"
+            "prim_align_",
+            payload_cols,
+            params_map.index_hits ? "seq_id" : "",
+            payload_encoding
         )
-        // 10. Rename virus hits to clean file name
-        renamed_hits_ch = RENAME_VIRUS_HITS(processed_ch.viral_hits_tsv, "virus_hits.tsv.gz")
     emit:
         kmer_match = kmer_ch.match
         kmer_trimmed = fastp_ch.reads
-        hits_final = renamed_hits_ch
+        hits_final = processed_ch.viral_hits_tsv
+        hits_index = processed_ch.viral_hits_index
         inter_lca = processed_ch.lca_tsv
         inter_bowtie = processed_ch.aligner_tsv
         hits_prelca = bowtie2_tsv_ch.output
-        test_reads = other_bt2_ch.reads_unmapped
+        test_reads = clean_reads_ch
         test_filt_bowtie = bowtie2_filtered_ch.sam
-        test_unfilt_bowtie = bowtie2_ch.sam
+        test_unfilt_bowtie = virus_sam_ch
 }
@@ -0,0 +1,32 @@
+/*
+Build a single Bowtie2 index over the human genome and the other contaminant
+genomes, so RUN can screen reads against both in one pass. Sequence names are
+prefixed with "human|" or "other|" so alignments can still be attributed to
+their source.
+*/
+
+/***************************
+| MODULES AND SUBWORKFLOWS |
+***************************/
+
+include { PREFIX_FASTA_HEADERS as PREFIX_HUMAN } from "../../../modules/local/prefixFastaHeaders"
+include { PREFIX_FASTA_HEADERS as PREFIX_OTHER } from "../../../modules/local/prefixFastaHeaders"
+include { CONCATENATE_FASTA_GZIPPED } from "../../../modules/local/concatenateFasta"
+include { BOWTIE2_INDEX } from "../../../modules/local/bowtie2"
+
+/***********
+| WORKFLOW |
+***********/
+
+workflow MAKE_COMBINED_CONTAMINANT_INDEX {
+    take:
+        human_fasta // Human genome FASTA (from MAKE_HUMAN_INDEX)
+        other_fasta // Concatenated other contaminant FASTA (from MAKE_CONTAMINANT_INDEX)
+    main:
+        human_ch = PREFIX_HUMAN(human_fasta, "human")
+        other_ch = PREFIX_OTHER(other_fasta, "other")
+        combined_ch = CONCATENATE_FASTA_GZIPPED(human_ch.mix(other_ch).collect(), "contaminant_concat")
+        bowtie2_ch = BOWTIE2_INDEX(combined_ch, "bt2-contaminant-index")
+    emit:
+        bt2 = bowtie2_ch
+}
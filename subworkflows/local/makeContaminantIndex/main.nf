@@ -38,4 +38,5 @@ workflow MAKE_CONTAMINANT_INDEX {
     emit:
         bt2 = bowtie2_ch
         mm2 = minimap2_ch.output
+        fasta = genome_ch
 }
@@ -22,4 +22,5 @@ workflow MAKE_HUMAN_INDEX {
     emit:
         bt2 = bowtie2_ch
         mm2 = minimap2_ch.output
+        fasta = genome_ch
 }
@@ -3,6 +3,7 @@
 ***************************/
 
 include { MINIMAP2_INDEX } from "../../../modules/local/minimap2"
+include { NUCLEAZE_INDEX } from "../../../modules/local/nucleazeIndex"
 
 /***********
 | WORKFLOW |
@@ -11,8 +12,11 @@ include { MINIMAP2_INDEX } from "../../../modules/local/minimap2"
 workflow MAKE_RIBO_INDEX {
     take:
         ribo_ref
+        nucleaze_k
     main:
         minimap2_ch = MINIMAP2_INDEX(ribo_ref,"mm2-ribo-index")
+        nucleaze_ch = NUCLEAZE_INDEX(ribo_ref, nucleaze_k)
     emit:
         mm2 = minimap2_ch.output
+        nucleaze = nucleaze_ch.index
 }
@@ -7,6 +7,7 @@ include { FILTER_VIRAL_GENBANK_METADATA } from "../../../modules/local/filterVir
 include { DOWNLOAD_VIRAL_GENOMES } from "../../../modules/local/downloadViralGenomes"
 include { PREPARE_VIRAL_METADATA } from "../../../modules/local/prepareViralMetadata"
 include { ADD_GENBANK_GENOME_IDS } from "../../../modules/local/addGenbankGenomeIDs"
+include { BUILD_GENOME_TAXID_INDEX } from "../../../modules/local/buildGenomeTaxidIndex"
 include { CONCATENATE_GENOME_FASTA } from "../../../modules/local/concatenateGenomeFasta"
 include { FILTER_GENOME_FASTA } from "../../../modules/local/filterGenomeFasta"
 include { MASK_GENOME_FASTA } from "../../../modules/local/maskGenomeFasta"
@@ -56,6 +57,8 @@ workflow MAKE_VIRUS_GENOME_DB {
         )
         // 5. Add per-sequence genome IDs by reading FASTA headers.
         gid_ch = ADD_GENBANK_GENOME_IDS(prepare_ch.metadata, prepare_ch.genomes, "virus-genome").output
+        // 5b. Build a memory-mappable genome ID -> taxid index for RUN's SAM processors.
+        taxid_index_ch = BUILD_GENOME_TAXID_INDEX(gid_ch, virus_db).index
         // 6. Concatenate matching genomes.
         genome_concat_ch = CONCATENATE_GENOME_FASTA(prepare_ch.genomes, prepare_ch.paths)
         // 7. Filter to remove undesired/contaminated genomes by sequence-header
@@ -67,5 +70,6 @@ workflow MAKE_VIRUS_GENOME_DB {
     emit:
         fasta = mask_ch.masked
         metadata = gid_ch
+        taxid_index = taxid_index_ch
         raw_metadata = raw_metadata_ch  // pre-filter assembly metadata, for benchmarking
 }
@@ -2,13 +2,12 @@
 | MODULES AND SUBWORKFLOWS |
 ***************************/
 
-include { MARK_ALIGNMENT_DUPLICATES } from "../../../modules/local/markAlignmentDuplicates"
-include { SORT_TSV as SORT_STATS } from "../../../modules/local/sortTsv"
-include { SORT_TSV as SORT_READS } from "../../../modules/local/sortTsv"
-include { COPY_FILE as COPY_STATS } from "../../../modules/local/copyFile"
-include { COPY_FILE as COPY_READS } from "../../../modules/local/copyFile"
-include { COPY_FILE as COPY_SIM_DUP } from "../../../modules/local/copyFile"
-include { MARK_SIMILARITY_DUPLICATES } from "../../../modules/local/markSimilarityDuplicates"
+include { SHARD_TSV_BY_GENOME } from "../../../modules/local/shardTsvByGenome"
+include { MARK_ALIGNMENT_DUPLICATES; MARK_ALIGNMENT_DUPLICATES_BATCH } from "../../../modules/local/markAlignmentDuplicates"
+include { MERGE_SORTED_TSVS_LABELED as MERGE_SHARD_READS } from "../../../modules/local/mergeSortedTsvs"
+include { CONCATENATE_TSVS_LABELED as CONCAT_SHARD_STATS } from "../../../modules/local/concatenateTsvs"
+include { SORT_TSV_NAMED as SORT_STATS } from "../../../modules/local/sortTsv"
+include { MARK_SIMILARITY_DUPLICATES; MARK_SIMILARITY_DUPLICATES_BATCH } from "../../../modules/local/markSimilarityDuplicates"
 
 /***********
 | WORKFLOW |
@@ -16,23 +15,57 @@ include { MARK_SIMILARITY_DUPLICATES } from "../../../modules/local/markSimilari
 
 workflow MARK_VIRAL_DUPLICATES {
     take:
-        groups // Labeled viral hit TSVs partitioned by group
+        groups // Labeled viral hit TSVs partitioned by group, each sorted by seq_id
         deviation // Maximum alignment deviation that qualifies as a duplicate
+        n_shards // Number of genome-partitioned tasks per group for alignment duplicate marking (1 = unsharded)
+        batch_size // Maximum number of small groups (or shards) marked together in one task (1 = one task each)
+        batch_max_mb // Inputs up to this size in MB are batched; larger inputs keep their own task
     main:
+        // Small inputs are marked in multi-group tasks that process their groups concurrently,
+        // while large inputs keep their own task; outputs are identical either way, and batches are
+        // formed in group order once all inputs are in, so they are stable across -resume
+        def batchable = { tsv -> batch_size > 1 && tsv.size() <= batch_max_mb * 1024 * 1024 }
+        def batched = { ch -> ch.toList().flatMap { items -> BatchUtils.toBatches(items, batch_size) } }
+        def unbatched = { ch, suffix -> ch.flatMap { samples, files -> BatchUtils.fromNamedBatch(samples, files, suffix) } }
         // 1. Mark duplicates
-        dup_ch = MARK_ALIGNMENT_DUPLICATES(groups, deviation).output
-        // 2. Sort output
-        reads_ch = dup_ch.map{ id, reads, _stats -> tuple(id, reads) }
-        stats_ch = dup_ch.map{ id, _reads, stats -> tuple(id, stats) }
-        reads_sorted_ch = SORT_READS(reads_ch, "seq_id").sorted
-        stats_sorted_ch = SORT_STATS(stats_ch, "prim_align_genome_id_all").sorted
-        // 3. Rename and prepare files for output
-        reads_out_ch = COPY_READS(reads_sorted_ch, "duplicate_reads.tsv.gz")
-        stats_out_ch = COPY_STATS(stats_sorted_ch, "duplicate_stats.tsv.gz")
+        if ( n_shards > 1 ) {
+            // Alignment duplicates always share a normalised genome ID, so shards can be marked
+            // independently; shards keep input order, so merging them by seq_id restores the unsharded row order
+            align_in_ch = SHARD_TSV_BY_GENOME(groups, "prim_align_genome_id_all", n_shards).output
+                .transpose()
+                .map{ id, shard -> tuple("${id}_${shard.name.tokenize('_')[1]}", shard) }
+        } else {
+            align_in_ch = groups
+        }
+        align_split_ch = align_in_ch.branch{ _id, tsv ->
+            batch: batchable(tsv)
+            single: true
+        }
+        align_batch_ch = MARK_ALIGNMENT_DUPLICATES_BATCH(batched(align_split_ch.batch), deviation)
+        dup_ch = MARK_ALIGNMENT_DUPLICATES(align_split_ch.single, deviation).output
+            .mix(unbatched(align_batch_ch.reads, "duplicate_reads.tsv.gz").join(unbatched(align_batch_ch.stats, "duplicate_stats.tsv.gz")))
+        if ( n_shards > 1 ) {
+            shard_dup_ch = dup_ch
+                .map{ shard_id, reads, stats -> tuple(shard_id.replaceFirst(/_\d+$/, ""), reads, stats) }
+                .groupTuple(size: n_shards, sort: { a, b -> a.name <=> b.name })
+            reads_out_ch = MERGE_SHARD_READS(shard_dup_ch.map{ id, reads, _stats -> tuple(id, reads) }, "seq_id", "", "duplicate_reads.tsv.gz").output
+            stats_ch = CONCAT_SHARD_STATS(shard_dup_ch.map{ id, _reads, stats -> tuple(id, stats) }, "duplicate_stats").output
+        } else {
+            // MARK_ALIGNMENT_DUPLICATES keeps input order, so reads are already sorted by seq_id
+            reads_out_ch = dup_ch.map{ id, reads, _stats -> tuple(id, reads) }
+            stats_ch = dup_ch.map{ id, _reads, stats -> tuple(id, stats) }
+        }
+        // 2. Sort stats, writing final output file names
+        stats_out_ch = SORT_STATS(stats_ch, "prim_align_genome_id_all", "duplicate_stats.tsv.gz").sorted
         out_ch = reads_out_ch.combine(stats_out_ch, by: 0)
-        // 4. Run similarity-based duplicate marking on alignment-deduplicated reads
-        sim_dup_raw_ch = MARK_SIMILARITY_DUPLICATES(reads_out_ch).output
-        sim_dup_ch = COPY_SIM_DUP(sim_dup_raw_ch, "duplicate_reads_similarity.tsv.gz")
+        // 3. Run similarity-based duplicate marking on alignment-deduplicated reads
+        sim_split_ch = reads_out_ch.branch{ _id, tsv ->
+            batch: batchable(tsv)
+            single: true
+        }
+        sim_batch_ch = MARK_SIMILARITY_DUPLICATES_BATCH(batched(sim_split_ch.batch), "duplicate_reads_similarity.tsv.gz").output
+        sim_dup_ch = MARK_SIMILARITY_DUPLICATES(sim_split_ch.single, "duplicate_reads_similarity.tsv.gz").output
+            .mix(unbatched(sim_batch_ch, "duplicate_reads_similarity.tsv.gz"))
     emit:
         dup = out_ch
         sim_dup = sim_dup_ch
@@ -8,7 +8,8 @@ include { SORT_TSV as SORT_ALIGNER } from "../../../modules/local/sortTsv"
 include { JOIN_TSVS } from "../../../modules/local/joinTsvs"
 include { FILTER_TSV_COLUMN_BY_VALUE } from "../../../modules/local/filterTsvColumnByValue"
 include { SELECT_TSV_COLUMNS } from "../../../modules/local/selectTsvColumns"
-include { REHEAD_TSV } from "../../../modules/local/reheadTsv"
+include { REHEAD_TSV; REHEAD_TSV_NAMED } from "../../../modules/local/reheadTsv"
+include { SPLIT_PAYLOAD_COLUMNS; ATTACH_PAYLOAD_COLUMNS } from "../../../modules/local/payloadColumns"
 include { ADD_SAMPLE_COLUMN as ADD_SAMPLE_COLUMN_ALIGNER } from "../../../modules/local/addSampleColumn"
 include { ADD_SAMPLE_COLUMN as ADD_SAMPLE_COLUMN_LCA } from "../../../modules/local/addSampleColumn"
 
@@ -23,27 +24,49 @@ workflow PROCESS_LCA_ALIGNER_OUTPUT {
         col_keep_no_prefix // Columns to keep without prefix
         col_keep_add_prefix // Columns to keep with prefix
         column_prefix  // Prefix to add to specified columns
+        payload_cols   // Unprefixed columns to carry in a side file and re-attach at the end (empty list to disable)
+        hits_index_key // Column to index the BGZF virus hits on (empty for plain gzip)
+        payload_encoding // Map of payload columns to pack (pack) and quality-bin (bin) in the side file (empty for plain text)
     main:
         // Step 1: Sort LCA tsv by seq_id (aligner_tsv is already sorted)
         lca_sorted_ch = SORT_LCA(lca_tsv, "seq_id")
         // Step 2: Add sample column to aligner TSV
         aligner_labeled_tsv = ADD_SAMPLE_COLUMN_ALIGNER(aligner_tsv, "sample", "aligner")
-        // Step 3: Join LCA and aligner TSV on seq_id
-        joined_input_ch = lca_sorted_ch.sorted.join(aligner_labeled_tsv.output, by: 0)
+        // Step 3: Join LCA and aligner TSV on seq_id, optionally splitting wide payload columns out of the aligner TSV first
+        // (join, filter and select keep aligner row order, so the payload can be re-attached in one streaming pass)
+        late_payload = payload_cols as boolean
+        if (late_payload) {
+            split_ch = SPLIT_PAYLOAD_COLUMNS(aligner_labeled_tsv.output, payload_cols, payload_encoding)
+            aligner_join_ch = split_ch.output.map { sample, narrow, _payload -> [sample, narrow] }
+            payload_ch = split_ch.output.map { sample, _narrow, payload -> [sample, payload] }
+        } else {
+            aligner_join_ch = aligner_labeled_tsv.output
+        }
+        joined_input_ch = lca_sorted_ch.sorted.join(aligner_join_ch, by: 0)
         joined_ch = JOIN_TSVS(joined_input_ch, "seq_id", "inner", "lca_aligner")
         // Step 4: Filter to keep only primary alignments
         filtered_ch = FILTER_TSV_COLUMN_BY_VALUE(joined_ch.output, "classification", "primary", true)
         // Step 5: Select specific columns
-        col_keep = (col_keep_no_prefix + col_keep_add_prefix).join(",")
+        col_select = late_payload ? (col_keep_no_prefix - payload_cols) + ["payload_row"] : col_keep_no_prefix
+        col_keep = (col_select + col_keep_add_prefix).join(",")
         selected_ch = SELECT_TSV_COLUMNS(filtered_ch.output, col_keep, "keep")
-        // Step 6: Rename columns with prefix using REHEAD_TSV
+        // Step 6: Rename columns with prefix, writing the final virus hits file name ({sample}_virus_hits.tsv.gz)
         old_cols = col_keep_add_prefix.join(",")
-        new_cols = col_keep_add_prefix.collect { c -> "${column_prefix}${c}" }.join(",")
-        renamed_ch = REHEAD_TSV(selected_ch.output, old_cols, new_cols)
+        prefixed_cols = col_keep_add_prefix.collect { c -> "${column_prefix}${c}" }
+        new_cols = prefixed_cols.join(",")
+        if (late_payload) {
+            // Rename the narrow table, then re-attach the payload in the original column order
+            renamed_narrow_ch = REHEAD_TSV(selected_ch.output, old_cols, new_cols)
+            attach_input_ch = renamed_narrow_ch.output.join(payload_ch, by: 0)
+            renamed_ch = ATTACH_PAYLOAD_COLUMNS(attach_input_ch, col_keep_no_prefix + prefixed_cols, "virus_hits.tsv.gz", hits_index_key)
+        } else {
+            renamed_ch = REHEAD_TSV_NAMED(selected_ch.output, old_cols, new_cols, "virus_hits.tsv.gz", hits_index_key)
+        }
         // Step 7: Add sample column to LCA TSV for intermediate output
         lca_labeled_ch = ADD_SAMPLE_COLUMN_LCA(lca_tsv, "sample", "viral_lca")
     emit:
         viral_hits_tsv = renamed_ch.output
+        viral_hits_index = renamed_ch.index
         aligner_tsv = aligner_labeled_tsv.output
         lca_tsv = lca_labeled_ch.output
 }
@@ -7,13 +7,14 @@
 ***************************/
 
 include { BBDUK } from "../../../modules/local/bbduk"
+include { NUCLEAZE_STREAMED } from "../../../modules/local/nucleaze"
 include { MINIMAP2 } from "../../../modules/local/minimap2"
 include { TAXONOMY as TAXONOMY_RIBO } from "../../../subworkflows/local/taxonomy"
 include { TAXONOMY as TAXONOMY_NORIBO } from "../../../subworkflows/local/taxonomy"
-include { ADD_FIXED_COLUMN as ADD_KRAKEN_RIBO } from "../../../modules/local/addFixedColumn"
-include { ADD_FIXED_COLUMN as ADD_BRACKEN_RIBO } from "../../../modules/local/addFixedColumn"
-include { ADD_FIXED_COLUMN as ADD_KRAKEN_NORIBO } from "../../../modules/local/addFixedColumn"
-include { ADD_FIXED_COLUMN as ADD_BRACKEN_NORIBO } from "../../../modules/local/addFixedColumn"
+include { ADD_FIXED_COLUMN_BATCH as ADD_KRAKEN_RIBO } from "../../../modules/local/addFixedColumn"
+include { ADD_FIXED_COLUMN_BATCH as ADD_BRACKEN_RIBO } from "../../../modules/local/addFixedColumn"
+include { ADD_FIXED_COLUMN_BATCH as ADD_KRAKEN_NORIBO } from "../../../modules/local/addFixedColumn"
+include { ADD_FIXED_COLUMN_BATCH as ADD_BRACKEN_NORIBO } from "../../../modules/local/addFixedColumn"
 include { CONCATENATE_TSVS_LABELED as CONCATENATE_KRAKEN_PER_SAMPLE } from "../../../modules/local/concatenateTsvs"
 include { CONCATENATE_TSVS_LABELED as CONCATENATE_BRACKEN_PER_SAMPLE } from "../../../modules/local/concatenateTsvs"
 
@@ -25,7 +26,8 @@ workflow PROFILE {
     take:
         reads_ch
         single_end
-        params_map // Uses: min_kmer_fraction, k, ribo_suffix, bracken_threshold, platform, db_download_timeout, ref_dir
+        params_map // Uses: min_kmer_fraction, k, ribo_suffix, bracken_threshold, platform, db_download_timeout, ref_dir,
+                   //       nucleaze_ribo, micro_batch_size (optional)
     main:
         kraken_db_ch = "${params_map.ref_dir}/results/kraken_db"
         // Separate ribosomal reads
@@ -35,6 +37,25 @@ workflow PROFILE {
             ribo_ch = MINIMAP2(reads_ch, ribo_ref, ribo_minimap2_params)
             ribo_in = ribo_ch.reads_mapped
             noribo_in = ribo_ch.reads_unmapped
+        } else if (params_map.nucleaze_ribo) {
+            // Nucleaze k-mer split; k must match the index, so read it from the index params.
+            // The hit threshold is derived from min_kmer_fraction and each sample's read length, as for BBDuk
+            def index_params_path = file("${params_map.ref_dir}/input/index-params.json", checkIfExists: true)
+            def index_params = new groovy.json.JsonSlurper().parse(index_params_path)
+            if (index_params.nucleaze_ribo_k == null) {
+                throw new IllegalStateException(
+                    "Index at ${params_map.ref_dir} has no nucleaze_ribo_k in input/index-params.json; " +
+                    "rebuild against pipeline >= 3.2.2.1 or unset nucleaze_ribo."
+                )
+            }
+            ribo_index = "${params_map.ref_dir}/results/ribo-ref-concat.nucleaze.bin"
+            ribo_nucleaze_params = single_end.map { se ->
+                [k: index_params.nucleaze_ribo_k.toString(), min_kmer_fraction: params_map.min_kmer_fraction,
+                 suffix: params_map.ribo_suffix, interleaved: !se]
+            }
+            ribo_ch = NUCLEAZE_STREAMED(reads_ch, ribo_index, ribo_nucleaze_params)
+            ribo_in = ribo_ch.match
+            noribo_in = ribo_ch.nomatch
         } else {
             ribo_path = "${params_map.ref_dir}/results/ribo-ref-concat.fasta.gz"
             ribo_bbduk_params = params_map + [interleaved: single_end.map { v -> !v }]
@@ -46,16 +67,19 @@ workflow PROFILE {
         taxonomy_params = params_map + [classification_level: "D"]
         tax_ribo_ch = TAXONOMY_RIBO(ribo_in, kraken_db_ch, single_end, taxonomy_params)
         tax_noribo_ch = TAXONOMY_NORIBO(noribo_in, kraken_db_ch, single_end, taxonomy_params)
-        // Add ribosomal status to output TSVs
-        kr_ribo = ADD_KRAKEN_RIBO(tax_ribo_ch.kraken_reports, "ribosomal", "TRUE", "ribo")
-        kr_noribo = ADD_KRAKEN_NORIBO(tax_noribo_ch.kraken_reports, "ribosomal", "FALSE", "noribo")
-        br_ribo = ADD_BRACKEN_RIBO(tax_ribo_ch.bracken, "ribosomal", "TRUE", "ribo")
-        br_noribo = ADD_BRACKEN_NORIBO(tax_noribo_ch.bracken, "ribosomal", "FALSE", "noribo")
+        // Add ribosomal status to output TSVs, in batches of samples
+        def batch_size = params_map.micro_batch_size ?: 1
+        def batched = { ch -> ch.toList().flatMap { items -> BatchUtils.toBatches(items, batch_size) } }
+        def unbatched = { ch -> ch.flatMap { samples, files -> BatchUtils.fromBatch(samples, files) } }
+        kr_ribo = unbatched(ADD_KRAKEN_RIBO(batched(tax_ribo_ch.kraken_reports), "ribosomal", "TRUE", "ribo").output)
+        kr_noribo = unbatched(ADD_KRAKEN_NORIBO(batched(tax_noribo_ch.kraken_reports), "ribosomal", "FALSE", "noribo").output)
+        br_ribo = unbatched(ADD_BRACKEN_RIBO(batched(tax_ribo_ch.bracken), "ribosomal", "TRUE", "ribo").output)
+        br_noribo = unbatched(ADD_BRACKEN_NORIBO(batched(tax_noribo_ch.bracken), "ribosomal", "FALSE", "noribo").output)
         // Concatenate ribo + noribo for each sample
-        kr_combined = kr_ribo.output.join(kr_noribo.output)
+        kr_combined = kr_ribo.join(kr_noribo)
             .map { sample, ribo_file, noribo_file -> [sample, [ribo_file, noribo_file]] }
         kr_per_sample = CONCATENATE_KRAKEN_PER_SAMPLE(kr_combined, "kraken")
-        br_combined = br_ribo.output.join(br_noribo.output)
+        br_combined = br_ribo.join(br_noribo)
             .map { sample, ribo_file, noribo_file -> [sample, [ribo_file, noribo_file]] }
         br_per_sample = CONCATENATE_BRACKEN_PER_SAMPLE(br_combined, "bracken")
     emit:
@@ -10,7 +10,6 @@ Returns split hits in TSV and FASTQ formats, each as a flattened channel of
 | MODULES AND SUBWORKFLOWS |
 ***************************/
 
-include { SORT_TSV as SORT_SEQ_ID } from "../../../modules/local/sortTsv"
 include { CHECK_TSV_DUPLICATES } from "../../../modules/local/checkTsvDuplicates"
 include { SELECT_TSV_COLUMNS } from "../../../modules/local/selectTsvColumns"
 include { REHEAD_TSV } from "../../../modules/local/reheadTsv"
@@ -32,8 +31,7 @@ workflow SPLIT_VIRAL_TSV_BY_SELECTED_TAXID {
         db // Viral taxonomy DB
     main:
        // 0. Check for duplicate read IDs (throw error if found)
-        sort_seq_id_ch = SORT_SEQ_ID(groups, "seq_id").sorted
-        check_ch = CHECK_TSV_DUPLICATES(sort_seq_id_ch, "seq_id").output
+        check_ch = CHECK_TSV_DUPLICATES(groups, "seq_id").output
         // 1. Prepare taxonomy DB for joining
         db_ch = channel.of("db").combine(db)
         db_select_ch = SELECT_TSV_COLUMNS(db_ch, "taxid,taxid_species", "keep").output
@@ -4,6 +4,7 @@ Perform efficient post-hoc validation of putative viral reads identified by the
 A. Partition putative hits by assigned species
 B. Cluster sequences from each species and identify labeled representative sequences
 C. Align representative sequences against a large reference DB
+   (optionally triaging them with minimap2 first, so only unresolved ones go to BLAST)
 D. Compare taxids assigned to those assigned by RUN workflow
 E. Propagate validation information from cluster representatives to other hits
 */
@@ -17,11 +18,11 @@ include { CLUSTER_VIRAL_ASSIGNMENTS } from "../../../subworkflows/local/clusterV
 include { CONCATENATE_FILES_BY_EXTENSION } from "../../../modules/local/concatenateFilesByExtension"
 include { CONCATENATE_TSVS_LABELED } from "../../../modules/local/concatenateTsvs"
 include { BLAST_FASTA } from "../../../subworkflows/local/blastFasta"
-include { VALIDATE_CLUSTER_REPRESENTATIVES } from "../../../subworkflows/local/validateClusterRepresentatives"
-include { PROPAGATE_VALIDATION_INFORMATION } from "../../../subworkflows/local/propagateValidationInformation"
-include { SELECT_TSV_COLUMNS } from "../../../modules/local/selectTsvColumns"
-include { COPY_FILE as COPY_HITS } from "../../../modules/local/copyFile"
-include { COPY_FILE as COPY_BLAST } from "../../../modules/local/copyFile"
+include { MINIMAP2_PAF } from "../../../modules/local/minimap2"
+include { TRIAGE_VALIDATION_HITS } from "../../../modules/local/triageValidationHits"
+include { LCA_TSV as LCA_MINIMAP2 } from "../../../modules/local/lcaTsv"
+include { CONCATENATE_TSVS_LABELED as CONCATENATE_VALIDATION_LCA } from "../../../modules/local/concatenateTsvs"
+include { VALIDATE_HITS } from "../../../modules/local/validateHits"
 include { CREATE_EMPTY_GROUP_OUTPUTS } from "../../../modules/local/createEmptyGroupOutputs"
 
 /***********
@@ -42,6 +43,10 @@ workflow VALIDATE_VIRAL_ASSIGNMENTS {
                    // - blast_max_rank: Only keep alignments that are in the top-N for that query by bitscore
                    // - blast_min_frac: Only keep alignments that have at least this fraction of the best bitscore for that query
                    // - taxid_artificial: Parent taxid for artificial sequences in NCBI taxonomy
+                   // - index_hits: Write validation hits as indexed BGZF (optional)
+                   // - partition_hits: Also write validation hits partitioned by species (optional)
+                   // - tiered_validation: Pre-validate representatives with minimap2 against the BLAST DB's
+                   //   minimap2 index, running BLAST only on unresolved ones (optional)
     main:
         // 1. Split viral hits TSV by species
         split_ch = SPLIT_VIRAL_TSV_BY_SELECTED_TAXID(groups, db)
@@ -61,26 +66,55 @@ workflow VALIDATE_VIRAL_ASSIGNMENTS {
         concat_fasta_ch = CONCATENATE_FILES_BY_EXTENSION(cluster_ch_fasta, "cluster_reps").output
         concat_cluster_ch = CONCATENATE_TSVS_LABELED(cluster_ch_tsv, "cluster_info")
         // 4. Run BLAST on concatenated cluster representatives (single job per group)
-        blast_fasta_params = params_map + [lca_prefix: "validation"]
-        blast_ch = BLAST_FASTA(concat_fasta_ch, ref_dir, blast_fasta_params)
-        // 5. Validate original group hits against concatenated BLAST results
+        blast_fasta_params = params_map + [lca_prefix: "validation", blast_output_name: "validation_blast.tsv.gz"]
+        nodes_db = "${ref_dir}/results/taxonomy-nodes.dmp"
+        if (params_map.tiered_validation) {
+            // 4a. Align representatives with minimap2 and resolve those with confident, concordant
+            // alignments; only ambiguous, low-identity or discordant representatives go to BLAST
+            mm2_params = [suffix: "validation_minimap2", alignment_params: "-N 50",
+                db_download_timeout: params_map.db_download_timeout]
+            paf_ch = MINIMAP2_PAF(concat_fasta_ch, "${ref_dir}/results/mm2-blast-index", mm2_params).output
+            triage_in_ch = paf_ch.join(concat_fasta_ch).join(groups)
+            triage_ch = TRIAGE_VALIDATION_HITS(triage_in_ch, "${ref_dir}/results/blast-db-taxids.tsv.gz",
+                nodes_db, params_map)
+            blast_ch = BLAST_FASTA(triage_ch.escalated, ref_dir, blast_fasta_params)
+            // 4b. Apply LCA to resolved alignments and merge with BLAST LCA (if any escalated)
+            lca_params = [
+                group_field: "qseqid",
+                taxid_field: "staxid",
+                score_field: "bitscore",
+                taxid_artificial: params_map.taxid_artificial,
+                prefix: "validation"
+            ]
+            mm2_lca_ch = LCA_MINIMAP2(triage_ch.resolved, nodes_db, "${ref_dir}/results/taxonomy-names.dmp",
+                lca_params).output
+            lca_in_ch = mm2_lca_ch.join(blast_ch.lca, remainder: true).map { label, mm2_lca, blast_lca ->
+                [label, [mm2_lca, blast_lca].findAll { it != null }]
+            }
+            lca_ch = CONCATENATE_VALIDATION_LCA(lca_in_ch, "validation_lca").output
+            output_blast_ch = blast_ch.blast.mix(triage_ch.resolved, triage_ch.decisions)
+        } else {
+            blast_ch = BLAST_FASTA(concat_fasta_ch, ref_dir, blast_fasta_params)
+            lca_ch = blast_ch.lca
+            output_blast_ch = blast_ch.blast
+        }
+        // 5. Validate cluster representatives against BLAST results and propagate
+        // validation information back to individual hits
         distance_params = [
             taxid_field_1: "aligner_taxid_lca",
             taxid_field_2: "validation_staxid_lca",
             distance_field_1: "validation_distance_aligner",
             distance_field_2: "validation_distance_validation"
         ]
-        validate_ch = VALIDATE_CLUSTER_REPRESENTATIVES(groups, blast_ch.lca,
-            ref_dir, distance_params)
-        // 6. Propagate validation information back to individual hits
-        propagate_ch = PROPAGATE_VALIDATION_INFORMATION(groups, concat_cluster_ch.output,
-            validate_ch.output, "aligner_taxid_lca")
-        // 7. Cleanup and generate final outputs
-        regrouped_drop_ch = SELECT_TSV_COLUMNS(propagate_ch.output, "taxid_species,selected_taxid", "drop").output
-        output_hits_ch = COPY_HITS(regrouped_drop_ch, "validation_hits.tsv.gz")
-        output_blast_ch = COPY_BLAST(blast_ch.blast, "validation_blast.tsv.gz")
-
-        // 8. Create empty validation_hits files for groups that produced no output
+        validate_in_ch = groups.combine(concat_cluster_ch.output, by: 0).combine(lca_ch, by: 0)
+        partition_params = params_map.partition_hits ? [
+            field: "selected_taxid",
+            stats_fields: "sample,aligner_length_normalized_score_mean,query_len,prim_align_best_alignment_score,validation_bitscore_max,validation_distance_aligner"
+        ] : [:]
+        validate_hits_ch = VALIDATE_HITS(validate_in_ch, nodes_db, distance_params,
+            "taxid_species,selected_taxid", params_map.index_hits ? "seq_id" : "", partition_params)
+        output_hits_ch = validate_hits_ch.output
+        // 6. Create empty validation_hits files for groups that produced no output
         input_groups = groups.map { label, _file -> label }.collect().ifEmpty([]).map { labels -> ["key", labels] }
         output_groups = output_hits_ch.map { label, _file -> label }.collect().ifEmpty([]).map { labels -> ["key", labels] }
         groups_without_output = input_groups.join(output_groups).map { _key, input_list, output_list ->
@@ -101,6 +135,8 @@ workflow VALIDATE_VIRAL_ASSIGNMENTS {
     emit:
         // Main output
         annotated_hits = all_hits_ch
+        annotated_hits_index = validate_hits_ch.index
+        annotated_hits_partitioned = validate_hits_ch.partitioned
         // Intermediate output
         blast_results = output_blast_ch
         // Extra outputs for testing
@@ -112,7 +148,5 @@ workflow VALIDATE_VIRAL_ASSIGNMENTS {
         test_concat_cluster = concat_cluster_ch.output
         test_blast_db = blast_ch.blast
         test_blast_query = blast_ch.query
-        test_blast_lca = blast_ch.lca
-        test_validate = validate_ch.output
-        test_propagate = propagate_ch.output
+        test_blast_lca = lca_ch
 }
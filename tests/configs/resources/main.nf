@@ -6,6 +6,10 @@
 // task.memory.toBytes() value. Per-input rows are aggregated into a single
 // sorted CSV so the workflow's only output emission is one Path — avoiding
 // nf-test channel-sort warnings on tuple emissions containing Long values.
+// PROBE_BBMASK_MEMORY_RETRY simulates an OOM kill (exit 137) on its first
+// attempt so the retry-escalated memory tier can be checked, and
+// PROBE_BBMASK_MEMORY_RETRY_OTHER fails with a non-memory exit (1) on its first
+// attempt, which the label leaves to the profile's errorStrategy.
 
 process MAKE_SPARSE_FILE {
     label "single"
@@ -39,6 +43,40 @@ process PROBE_BBMASK_MEMORY {
         """
 }
 
+process PROBE_BBMASK_MEMORY_RETRY {
+    label "bbmask_resources"
+    label "coreutils"
+
+    input:
+        tuple val(size_bytes), path(reads)
+
+    output:
+        path "row.csv"
+
+    script:
+        """
+        if [ ${task.attempt} -eq 1 ]; then exit 137; fi
+        echo "${size_bytes},${task.attempt},${task.memory.toBytes()}" > row.csv
+        """
+}
+
+process PROBE_BBMASK_MEMORY_RETRY_OTHER {
+    label "bbmask_resources"
+    label "coreutils"
+
+    input:
+        tuple val(size_bytes), path(reads)
+
+    output:
+        path "row.csv"
+
+    script:
+        """
+        if [ ${task.attempt} -eq 1 ]; then exit 1; fi
+        echo "${size_bytes},${task.attempt},${task.memory.toBytes()}" > row.csv
+        """
+}
+
 workflow PROBE_RESOURCE_TIER {
     take:
         sizes_ch  // val: logical file size in bytes
@@ -51,3 +89,29 @@ workflow PROBE_RESOURCE_TIER {
     emit:
         report = report_ch
 }
+
+workflow PROBE_RESOURCE_ESCALATION {
+    take:
+        sizes_ch  // val: logical file size in bytes
+
+    main:
+        sparse_ch = MAKE_SPARSE_FILE(sizes_ch)
+        rows_ch = PROBE_BBMASK_MEMORY_RETRY(sparse_ch)
+        report_ch = rows_ch.collectFile(name: 'report.csv', sort: true)
+
+    emit:
+        report = report_ch
+}
+
+workflow PROBE_RESOURCE_RETRY_OTHER {
+    take:
+        sizes_ch  // val: logical file size in bytes
+
+    main:
+        sparse_ch = MAKE_SPARSE_FILE(sizes_ch)
+        rows_ch = PROBE_BBMASK_MEMORY_RETRY_OTHER(sparse_ch)
+        report_ch = rows_ch.collectFile(name: 'report.csv', sort: true)
+
+    emit:
+        report = report_ch
+}
@@ -14,7 +14,6 @@ include { VALIDATE_VIRAL_ASSIGNMENTS } from "../subworkflows/local/validateViral
 include { COUNT_READS_PER_CLADE } from "../modules/local/countReadsPerClade"
 include { COPY_FILE_BARE as COPY_PYPROJECT } from "../modules/local/copyFile"
 include { COPY_FILE_BARE as COPY_INPUT } from "../modules/local/copyFile"
-include { SORT_TSV as SORT_ONT_HITS } from "../modules/local/sortTsv"
 include { ADD_FIXED_COLUMN as PAD_ONT_COLUMNS } from "../modules/local/addFixedColumn"
 include { WRITE_SENTINEL_DOWNSTREAM } from "../modules/local/writeSentinelDownstream"
 
@@ -30,15 +29,14 @@ workflow DOWNSTREAM {
         // Discover all per-sample output files and match to groups
         pipeline_pyproject_path = file("${projectDir}/pyproject.toml")
         discover_ch = DISCOVER_RUN_OUTPUT(load_ch.run_dirs, load_ch.groups, pipeline_pyproject_path, params.platform).output
-        // Concatenate per-sample outputs into per-group TSVs
+        // Concatenate per-sample outputs into per-group TSVs (hits are merged, so each group's hits stay sorted by seq_id)
         concat_ch = CONCAT_RUN_OUTPUTS_BY_GROUP(discover_ch)
         // Prepare inputs for clade counting and validating taxonomic assignments
         viral_db_path = "${params.ref_dir}/results/total-virus-db-annotated.tsv.gz"
         viral_db = channel.value(viral_db_path)
         // Conditionally mark duplicates and generate clade counts based on platform
         if (params.platform == "ont") {
-            // ONT: Skip duplicate marking and clade counting, but still sort by seq_id
-            viral_hits_ch = SORT_ONT_HITS(concat_ch.hits, "seq_id").sorted
+            // ONT: Skip duplicate marking and clade counting
             // Pad with paired-end columns (NA) so ONT and short-read share the same column set
             def pad_cols = [
                 "query_len_rev", "query_seq_rev", "query_qual_rev",
@@ -48,14 +46,15 @@ workflow DOWNSTREAM {
                 "prim_align_ref_start_rev", "prim_align_query_rc_rev",
                 "prim_align_pair_status", "prim_align_dup_exemplar"
             ].join(",")
-            viral_hits_ch = PAD_ONT_COLUMNS(viral_hits_ch, pad_cols, "NA", "padded").output
+            viral_hits_ch = PAD_ONT_COLUMNS(concat_ch.hits, pad_cols, "NA", "padded").output
             dup_output_ch = channel.empty()
             clade_counts_ch = channel.empty()
             sim_dup_ch = channel.empty()
         }
         else {
             // Short-read: Mark duplicates based on alignment coordinates
-            mark_dup_ch = MARK_VIRAL_DUPLICATES(concat_ch.hits, params.aln_dup_deviation)
+            mark_dup_ch = MARK_VIRAL_DUPLICATES(concat_ch.hits, params.aln_dup_deviation, params.aln_dup_shards,
+                params.dup_batch_size, params.dup_batch_max_mb)
             viral_hits_ch = mark_dup_ch.dup.map { label, tab, _stats -> [label, tab] }
             dup_output_ch = mark_dup_ch.dup.map { label, _reads, stats -> [label, stats] }
             // Generate clade counts
@@ -78,6 +77,8 @@ workflow DOWNSTREAM {
         results_downstream_ch = dup_output_ch.mix(
                                     clade_counts_ch,
                                     validate_ch.annotated_hits,
+                                    validate_ch.annotated_hits_index,
+                                    validate_ch.annotated_hits_partitioned,
                                     concat_ch.other,
                                     concat_ch.fastp_json)
 
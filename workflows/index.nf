@@ -12,8 +12,11 @@ include { WGET as WGET_SSU } from "../modules/local/wget"
 include { WGET as WGET_LSU } from "../modules/local/wget"
 include { JOIN_RIBO_REF } from "../modules/local/joinRiboRef"
 include { DOWNLOAD_BLAST_DB } from "../modules/local/downloadBlastDB"
+include { EXTRACT_BLAST_DB_FASTA } from "../modules/local/extractBlastDbFasta"
+include { MINIMAP2_INDEX as MINIMAP2_INDEX_BLAST } from "../modules/local/minimap2"
 include { MAKE_HUMAN_INDEX } from "../subworkflows/local/makeHumanIndex"
 include { MAKE_CONTAMINANT_INDEX } from "../subworkflows/local/makeContaminantIndex"
+include { MAKE_COMBINED_CONTAMINANT_INDEX } from "../subworkflows/local/makeCombinedContaminantIndex"
 include { MAKE_VIRUS_INDEX } from "../subworkflows/local/makeVirusIndex"
 include { MAKE_RIBO_INDEX } from "../subworkflows/local/makeRiboIndex"
 include { GET_TARBALL as GET_KRAKEN_DB } from "../modules/local/getTarball"
@@ -51,9 +54,24 @@ workflow INDEX {
         virus_index_ch = MAKE_VIRUS_INDEX(genome_ch.fasta, params.nucleaze_k)
         human_index_ch = MAKE_HUMAN_INDEX(params.human_url)
         contaminant_index_ch = MAKE_CONTAMINANT_INDEX(params.genome_urls, params.contaminants)
-        ribo_index_ch = MAKE_RIBO_INDEX(ribo_ref_ch.ribo_ref)
+        // Optional combined human + other contaminant index for RUN's single-pass contaminant screen
+        if (params.bt2_combined_contaminants) {
+            combined_index_ch = MAKE_COMBINED_CONTAMINANT_INDEX(human_index_ch.fasta, contaminant_index_ch.fasta).bt2
+        } else {
+            combined_index_ch = channel.empty()
+        }
+        ribo_index_ch = MAKE_RIBO_INDEX(ribo_ref_ch.ribo_ref, params.nucleaze_ribo_k)
         // Other index files
         blast_db_ch = DOWNLOAD_BLAST_DB(params.blast_db_name).db
+        // Optional minimap2 index over the BLAST DB, for DOWNSTREAM's tiered validation
+        if (params.blast_mm2_index) {
+            blast_fasta_ch = EXTRACT_BLAST_DB_FASTA(blast_db_ch)
+            blast_mm2_ch = MINIMAP2_INDEX_BLAST(blast_fasta_ch.fasta, "mm2-blast-index").output
+            blast_taxids_ch = blast_fasta_ch.taxids
+        } else {
+            blast_mm2_ch = channel.empty()
+            blast_taxids_ch = channel.empty()
+        }
         kraken_ch = GET_KRAKEN_DB(params.kraken_db, "kraken_db", true)
         // Prepare results for publishing
         params_str = groovy.json.JsonOutput.prettyPrint(groovy.json.JsonOutput.toJson(params))
@@ -77,22 +95,27 @@ workflow INDEX {
             // Virus genome database
             genome_ch.fasta,
             genome_ch.metadata,
+            genome_ch.taxid_index,
             genome_ch.raw_metadata,
             // Other reference files & directories
             ribo_ref_ch.ribo_ref,
             blast_db_ch,
+            blast_taxids_ch,
             kraken_ch
         )
         alignment_indexes = human_index_ch.bt2.mix( // Bowtie2 alignment indexes
             contaminant_index_ch.bt2,
             virus_index_ch.bt2,
+            combined_index_ch,
             // Minimap2 alignment indices
             virus_index_ch.mm2,
             human_index_ch.mm2,
             ribo_index_ch.mm2,
             contaminant_index_ch.mm2,
-            // Nucleaze k-mer index for the viral screen in RUN
-            virus_index_ch.nucleaze
+            blast_mm2_ch,
+            // Nucleaze k-mer indexes for the viral screen and ribosomal split in RUN
+            virus_index_ch.nucleaze,
+            ribo_index_ch.nucleaze
         )
         experimental_index = channel.empty()
 }
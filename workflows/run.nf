@@ -36,7 +36,7 @@ workflow RUN {
         // Prepare output streams
         input_log_ch = PREPARE_INPUT_LOGGING(params, compat_ch.index_pyproject_path, compat_ch.pipeline_pyproject_path)
         qc_results_ch = count_ch.output.mix(qc_ch.pre_qc, qc_ch.post_qc, subset_ch.fastp_json)
-        other_results_ch = viral_ch.hits_final.mix(profile_ch.bracken, profile_ch.kraken)
+        other_results_ch = viral_ch.hits_final.mix(viral_ch.hits_index, profile_ch.bracken, profile_ch.kraken)
         // Validate published outputs and write sentinel
         expected_ch = input_log_ch.input_run.mix(input_log_ch.logging_run, qc_results_ch, other_results_ch)
         sentinel_samples = samplesheet_ch.samplesheet.map { sample, _reads -> sample }.collect()